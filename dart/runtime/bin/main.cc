@@ -45,6 +45,11 @@ static File* snapshot_file = NULL;
 // NULL if no output is generated.
 static File* flow_graph_file = NULL;
 
+
+// Global state that stores the file the garbage collection events are logged
+// to. NULL if the events are not logged.
+static File* gc_events_file = NULL;
+
 // Global state that indicates whether there is a debug breakpoint.
 // This pointer points into an argv buffer and does not need to be
 // free'd.
@@ -160,6 +165,15 @@ static void ProcessFlowGraphOption(const char* flowgraph_option) {
 }
 
 
+static void ProcessGcEventsLogOption(const char* filename) {
+  ASSERT(filename != NULL);
+  gc_events_file = File::Open(filename, File::kWriteTruncate);
+  if (gc_events_file == NULL) {
+    fprintf(stderr, "Failed to open the GC events log %s\n", filename);
+  }
+}
+
+
 static struct {
   const char* option_name;
   void (*process)(const char* option);
@@ -167,6 +181,7 @@ static struct {
   { "--break_at=", ProcessBreakpointOption },
   { "--compile_all", ProcessCompileAllOption },
   { "--debug", ProcessDebugOption },
+  { "--gc_events_log=", ProcessGcEventsLogOption },
   { "--generate_flow_graph", ProcessFlowGraphOption },
   { "--generate_perf_events_symbols", ProcessPerfEventsOption },
   { "--generate_pprof_symbols=", ProcessPprofOption },
@@ -204,6 +219,12 @@ static void WriteToFlowGraphFile(const char* buffer, int64_t num_bytes) {
 }
 
 
+static void WriteToGcEventsFile(const char* buffer, int64_t num_bytes) {
+  ASSERT(gc_events_file != NULL);
+  gc_events_file->WriteFully(buffer, num_bytes);
+}
+
+
 // Parse out the command line arguments. Returns -1 if the arguments
 // are incorrect, 0 otherwise.
 static int ParseArguments(int argc,
@@ -250,6 +271,10 @@ static int ParseArguments(int argc,
     Dart_InitFlowGraphPrinting(&WriteToFlowGraphFile);
   }
 
+  if (gc_events_file != NULL) {
+    Dart_InitGcEventsLogging(&WriteToGcEventsFile);
+  }
+
   // Get the script name.
   if (i < argc) {
     *script_name = argv[i];
@@ -531,6 +531,37 @@ DART_EXPORT Dart_Handle Dart_AddGcEpilogueCallback(
 DART_EXPORT Dart_Handle Dart_RemoveGcEpilogueCallback(
     Dart_GcEpilogueCallback callback);
 
+// --- Heap Limits ---
+
+/**
+ * Limits the footprint of the heap of the current isolate, which is the
+ * memory reserved for its new and old generations.
+ *
+ * Above the soft limit the heap is only grown after a garbage collection
+ * failed to free enough memory. The hard limit is never exceeded: an
+ * allocation which does not fit below it throws an OutOfMemoryException,
+ * which the program can catch.
+ *
+ * \param soft_limit The soft limit in bytes, 0 for no limit.
+ * \param hard_limit The hard limit in bytes, 0 for no limit.
+ *
+ * \return Success if the limits were set. Otherwise, returns an error handle.
+ */
+DART_EXPORT Dart_Handle Dart_SetHeapLimits(intptr_t soft_limit,
+                                           intptr_t hard_limit);
+
+/**
+ * Sets the target for the percentage of time the current isolate spends in
+ * garbage collection, the default is given by --heap_growth_time_ratio. The
+ * old generation is allowed to hold more free memory while the collections
+ * take more time than the target, and less when they take much less.
+ *
+ * \param percent The target percentage, between 1 and 100.
+ *
+ * \return Success if the target was set. Otherwise, returns an error handle.
+ */
+DART_EXPORT Dart_Handle Dart_SetGcTimeTarget(intptr_t percent);
+
 // --- Heap Profiler ---
 
 /**
@@ -554,6 +585,84 @@ typedef void (*Dart_HeapProfileWriteCallback)(const void* data,
 DART_EXPORT Dart_Handle Dart_HeapProfile(Dart_HeapProfileWriteCallback callback,
                                          void* stream);
 
+/**
+ * Writes the allocation samples of the current isolate as a heap profile in
+ * the legacy text format of pprof. One allocation every
+ * --allocation_sample_rate bytes is sampled on average. The samples are
+ * aggregated by class and stack, the class of each site is given in a comment
+ * line. The stacks can be symbolized with the file written by
+ * Dart_GetPprofSymbolInfo.
+ *
+ * \param callback A function pointer that will be repeatedly invoked
+ *   with profile data.
+ * \param stream A pointer that will be passed to the callback.
+ *
+ * \return Success if the profile was written.
+ */
+DART_EXPORT Dart_Handle Dart_AllocationProfile(
+    Dart_HeapProfileWriteCallback callback,
+    void* stream);
+
+// --- Garbage Collection Events ---
+
+/**
+ * A record of a garbage collection pause of the current isolate. Times are
+ * in microseconds and sizes in bytes.
+ */
+typedef struct {
+  enum Phase {
+    kRoots = 0,
+    kStoreBuffer,
+    kScavengeCopy,
+    kMark,
+    kWeakProcessing,
+    kSweep,
+    kCompact,
+    kNumPhases
+  };
+
+  enum Space {
+    kNewSpace = 0,
+    kOldSpace,
+    kCodeSpace,
+    kNumSpaces
+  };
+
+  /* The events of an isolate are numbered consecutively from 0. */
+  int64_t id;
+  enum Type {
+    kScavenge = 0,
+    kMarkSweep,
+    kMarkingStep
+  } type;
+  /* The reason of the collection, e.g. "new space" or "full". */
+  const char* reason;
+  int64_t start_micros;
+  int64_t duration_micros;
+  /* Phases are not necessarily disjoint or exhaustive, e.g. the store buffer
+   * and the roots are part of the copying phase of a parallel scavenge. */
+  int64_t phase_micros[kNumPhases];
+  intptr_t used_before[kNumSpaces];
+  intptr_t used_after[kNumSpaces];
+  intptr_t capacity_after[kNumSpaces];
+  /* The size of the objects promoted to the old space by a scavenge. */
+  intptr_t promoted;
+} Dart_GcEvent;
+
+/**
+ * Gets the most recent garbage collection events of the current isolate,
+ * oldest first. A limited number of events is kept, see also
+ * Dart_InitGcEventsLogging which logs all events as lines of JSON.
+ *
+ * \param events An array to receive the events.
+ * \param length The length of the array on entry, the number of events
+ *   copied into the array on return.
+ *
+ * \return Success if the events were copied.
+ */
+DART_EXPORT Dart_Handle Dart_GetGcEvents(Dart_GcEvent* events,
+                                         intptr_t* length);
+
 // --- Initialization and Globals ---
 
 /**
@@ -2729,4 +2838,8 @@ DART_EXPORT void Dart_InitPerfEventsSupport(Dart_FileWriterFunction function);
 // Support for generating flow graph compiler debugging output into a file.
 DART_EXPORT void Dart_InitFlowGraphPrinting(Dart_FileWriterFunction function);
 
+// Support for logging the garbage collection events of all isolates into a
+// file, one line of JSON per event.
+DART_EXPORT void Dart_InitGcEventsLogging(Dart_FileWriterFunction function);
+
 #endif  // INCLUDE_DART_API_H_
@@ -69,6 +69,25 @@ static void LengthCheck(intptr_t len, intptr_t max) {
   return Object::null();
 
 
+// Accesses the four elements starting at element index as one SIMD value.
+#define SIMD_GETTER(ArrayT, ObjectT, ElementT)                          \
+  GETTER_ARGUMENTS(ArrayT, simd128_value_t);                            \
+  intptr_t offset = index.Value() * sizeof(ElementT);                   \
+  RangeCheck(array, offset, sizeof(simd128_value_t));                   \
+  simd128_value_t result;                                               \
+  ByteArray::Copy(&result, array, offset, sizeof(simd128_value_t));     \
+  return ObjectT::New(result);
+
+
+#define SIMD_SETTER(ArrayT, ObjectT, ElementT)                          \
+  SETTER_ARGUMENTS(ArrayT, ObjectT, simd128_value_t);                   \
+  intptr_t offset = index.Value() * sizeof(ElementT);                   \
+  RangeCheck(array, offset, sizeof(simd128_value_t));                   \
+  simd128_value_t value = value_object.value();                         \
+  ByteArray::Copy(array, offset, &value, sizeof(simd128_value_t));      \
+  return Object::null();
+
+
 #define UNALIGNED_GETTER(ArrayT, ObjectT, ValueT)                       \
   GETTER_ARGUMENTS(ArrayT, ValueT);                                     \
   RangeCheck(array, index.Value(), sizeof(ValueT));                     \
@@ -375,6 +394,16 @@ DEFINE_NATIVE_ENTRY(Int32Array_setIndexed, 3) {
 }
 
 
+DEFINE_NATIVE_ENTRY(Int32Array_getInt32x4, 2) {
+  SIMD_GETTER(Int32Array, Int32x4, int32_t);
+}
+
+
+DEFINE_NATIVE_ENTRY(Int32Array_setInt32x4, 3) {
+  SIMD_SETTER(Int32Array, Int32x4, int32_t);
+}
+
+
 // Uint32Array
 
 DEFINE_NATIVE_ENTRY(Uint32Array_new, 1) {
@@ -455,6 +484,16 @@ DEFINE_NATIVE_ENTRY(Float32Array_setIndexed, 3) {
 }
 
 
+DEFINE_NATIVE_ENTRY(Float32Array_getFloat32x4, 2) {
+  SIMD_GETTER(Float32Array, Float32x4, float);
+}
+
+
+DEFINE_NATIVE_ENTRY(Float32Array_setFloat32x4, 3) {
+  SIMD_SETTER(Float32Array, Float32x4, float);
+}
+
+
 // Float64Array
 
 DEFINE_NATIVE_ENTRY(Float64Array_new, 1) {
@@ -535,6 +574,16 @@ DEFINE_NATIVE_ENTRY(ExternalInt32Array_setIndexed, 3) {
 }
 
 
+DEFINE_NATIVE_ENTRY(ExternalInt32Array_getInt32x4, 2) {
+  SIMD_GETTER(ExternalInt32Array, Int32x4, int32_t);
+}
+
+
+DEFINE_NATIVE_ENTRY(ExternalInt32Array_setInt32x4, 3) {
+  SIMD_SETTER(ExternalInt32Array, Int32x4, int32_t);
+}
+
+
 // ExternalUint32Array
 
 DEFINE_NATIVE_ENTRY(ExternalUint32Array_getIndexed, 2) {
@@ -583,6 +632,16 @@ DEFINE_NATIVE_ENTRY(ExternalFloat32Array_setIndexed, 3) {
 }
 
 
+DEFINE_NATIVE_ENTRY(ExternalFloat32Array_getFloat32x4, 2) {
+  SIMD_GETTER(ExternalFloat32Array, Float32x4, float);
+}
+
+
+DEFINE_NATIVE_ENTRY(ExternalFloat32Array_setFloat32x4, 3) {
+  SIMD_SETTER(ExternalFloat32Array, Float32x4, float);
+}
+
+
 // ExternalFloat64Array
 
 DEFINE_NATIVE_ENTRY(ExternalFloat64Array_getIndexed, 2) {
@@ -500,6 +500,23 @@ interface Int32List extends List<int>, ByteArrayViewable
    * is not "int32-aligned."
    */
   Int32List.view(ByteArray array, [int start, int length]);
+
+  /**
+   * Returns the four elements starting at element [index] as an [Int32x4].
+   *
+   * Throws [IndexOutOfRangeException] if [index] is negative or if fewer
+   * than four elements follow it.
+   */
+  Int32x4 getInt32x4(int index);
+
+  /**
+   * Stores the lanes of [value] into the four elements starting at element
+   * [index].
+   *
+   * Throws [IndexOutOfRangeException] if [index] is negative or if fewer
+   * than four elements follow it.
+   */
+  void setInt32x4(int index, Int32x4 value);
 }
 
 
@@ -641,6 +658,23 @@ interface Float32List extends List<double>, ByteArrayViewable
    * is not "float32-aligned."
    */
   Float32List.view(ByteArray array, [int start, int length]);
+
+  /**
+   * Returns the four elements starting at element [index] as a [Float32x4].
+   *
+   * Throws [IndexOutOfRangeException] if [index] is negative or if fewer
+   * than four elements follow it.
+   */
+  Float32x4 getFloat32x4(int index);
+
+  /**
+   * Stores the lanes of [value] into the four elements starting at element
+   * [index].
+   *
+   * Throws [IndexOutOfRangeException] if [index] is negative or if fewer
+   * than four elements follow it.
+   */
+  void setFloat32x4(int index, Float32x4 value);
 }
 
 
@@ -1320,6 +1354,11 @@ class _Int32Array extends _ByteArrayBase implements Int32List {
     return _length() * _BYTES_PER_ELEMENT;
   }
 
+  Int32x4 getInt32x4(int index)
+      native "Int32Array_getInt32x4";
+  void setInt32x4(int index, Int32x4 value)
+      native "Int32Array_setInt32x4";
+
   static const int _BYTES_PER_ELEMENT = 4;
 
   static _Int32Array _new(int length) native "Int32Array_new";
@@ -1572,6 +1611,11 @@ class _Float32Array extends _ByteArrayBase implements Float32List {
     return _length() * _BYTES_PER_ELEMENT;
   }
 
+  Float32x4 getFloat32x4(int index)
+      native "Float32Array_getFloat32x4";
+  void setFloat32x4(int index, Float32x4 value)
+      native "Float32Array_setFloat32x4";
+
   static const int _BYTES_PER_ELEMENT = 4;
 
   static _Float32Array _new(int length) native "Float32Array_new";
@@ -1889,6 +1933,11 @@ class _ExternalInt32Array extends _ByteArrayBase implements Int32List {
     return _length() * _BYTES_PER_ELEMENT;
   }
 
+  Int32x4 getInt32x4(int index)
+      native "ExternalInt32Array_getInt32x4";
+  void setInt32x4(int index, Int32x4 value)
+      native "ExternalInt32Array_setInt32x4";
+
   static const int _BYTES_PER_ELEMENT = 4;
 
   int _getIndexed(int index)
@@ -2097,6 +2146,11 @@ class _ExternalFloat32Array extends _ByteArrayBase implements Float32List {
     return _length() * _BYTES_PER_ELEMENT;
   }
 
+  Float32x4 getFloat32x4(int index)
+      native "ExternalFloat32Array_getFloat32x4";
+  void setFloat32x4(int index, Float32x4 value)
+      native "ExternalFloat32Array_setFloat32x4";
+
   static const int _BYTES_PER_ELEMENT = 4;
 
   double _getIndexed(int index)
@@ -2693,6 +2747,18 @@ class _Int32ArrayView extends _ByteArrayViewBase implements Int32List {
     _array.setInt32(_offset + (index * _BYTES_PER_ELEMENT), _toInt32(value));
   }
 
+  Int32x4 getInt32x4(int index) {
+    return new Int32x4(this[index], this[index + 1],
+                       this[index + 2], this[index + 3]);
+  }
+
+  void setInt32x4(int index, Int32x4 value) {
+    this[index + 3] = value.w;
+    this[index] = value.x;
+    this[index + 1] = value.y;
+    this[index + 2] = value.z;
+  }
+
   Iterator<int> iterator() {
     return new _ByteArrayIterator<int>(this);
   }
@@ -2981,6 +3047,18 @@ class _Float32ArrayView extends _ByteArrayViewBase implements Float32List {
     _array.setFloat32(_offset + (index * _BYTES_PER_ELEMENT), value);
   }
 
+  Float32x4 getFloat32x4(int index) {
+    return new Float32x4(this[index], this[index + 1],
+                         this[index + 2], this[index + 3]);
+  }
+
+  void setFloat32x4(int index, Float32x4 value) {
+    this[index + 3] = value.w;
+    this[index] = value.x;
+    this[index + 1] = value.y;
+    this[index + 2] = value.z;
+  }
+
   Iterator<double> iterator() {
     return new _ByteArrayIterator<double>(this);
   }
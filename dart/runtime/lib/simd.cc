@@ -0,0 +1,245 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/bootstrap_natives.h"
+
+#include "vm/exceptions.h"
+#include "vm/native_entry.h"
+#include "vm/object.h"
+
+namespace dart {
+
+static float DoubleArgument(Isolate* isolate, const Instance& value) {
+  if (!value.IsDouble()) {
+    GrowableArray<const Object*> args;
+    args.Add(&value);
+    Exceptions::ThrowByType(Exceptions::kIllegalArgument, args);
+  }
+  return static_cast<float>(Double::Cast(value).value());
+}
+
+
+static int32_t IntegerArgument(Isolate* isolate, const Instance& value) {
+  if (!value.IsInteger()) {
+    GrowableArray<const Object*> args;
+    args.Add(&value);
+    Exceptions::ThrowByType(Exceptions::kIllegalArgument, args);
+  }
+  return static_cast<int32_t>(Integer::Cast(value).AsInt64Value());
+}
+
+
+static simd128_value_t Shuffle(const simd128_value_t& value,
+                               const Integer& mask) {
+  const int64_t bits = mask.AsInt64Value();
+  if ((bits < 0) || (bits > 0xFF)) {
+    GrowableArray<const Object*> args;
+    args.Add(&mask);
+    Exceptions::ThrowByType(Exceptions::kIllegalArgument, args);
+  }
+  simd128_value_t result;
+  for (intptr_t i = 0; i < 4; i++) {
+    result.int_storage[i] = value.int_storage[(bits >> (2 * i)) & 3];
+  }
+  return result;
+}
+
+
+DEFINE_NATIVE_ENTRY(Float32x4_new, 5) {
+  ASSERT(AbstractTypeArguments::CheckedHandle(arguments->At(0)).IsNull());
+  const float x = DoubleArgument(
+      isolate, Instance::CheckedHandle(isolate, arguments->At(1)));
+  const float y = DoubleArgument(
+      isolate, Instance::CheckedHandle(isolate, arguments->At(2)));
+  const float z = DoubleArgument(
+      isolate, Instance::CheckedHandle(isolate, arguments->At(3)));
+  const float w = DoubleArgument(
+      isolate, Instance::CheckedHandle(isolate, arguments->At(4)));
+  return Float32x4::New(x, y, z, w);
+}
+
+
+DEFINE_NATIVE_ENTRY(Float32x4_zero, 1) {
+  ASSERT(AbstractTypeArguments::CheckedHandle(arguments->At(0)).IsNull());
+  return Float32x4::New(0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+
+DEFINE_NATIVE_ENTRY(Float32x4_splat, 2) {
+  ASSERT(AbstractTypeArguments::CheckedHandle(arguments->At(0)).IsNull());
+  const float v = DoubleArgument(
+      isolate, Instance::CheckedHandle(isolate, arguments->At(1)));
+  return Float32x4::New(v, v, v, v);
+}
+
+
+#define FLOAT32X4_BINARY_OP(name, op)                                          \
+DEFINE_NATIVE_ENTRY(Float32x4_##name, 2) {                                     \
+  const Float32x4& self = Float32x4::CheckedHandle(arguments->At(0));          \
+  GET_NATIVE_ARGUMENT(Float32x4, other, arguments->At(1));                     \
+  return Float32x4::New(self.x() op other.x(), self.y() op other.y(),          \
+                        self.z() op other.z(), self.w() op other.w());         \
+}                                                                              \
+
+
+FLOAT32X4_BINARY_OP(add, +)
+FLOAT32X4_BINARY_OP(sub, -)
+FLOAT32X4_BINARY_OP(mul, *)
+FLOAT32X4_BINARY_OP(div, /)
+
+#undef FLOAT32X4_BINARY_OP
+
+
+#define FLOAT32X4_COMPARISON(name, op)                                         \
+DEFINE_NATIVE_ENTRY(Float32x4_cmp##name, 2) {                                  \
+  const Float32x4& self = Float32x4::CheckedHandle(arguments->At(0));          \
+  GET_NATIVE_ARGUMENT(Float32x4, other, arguments->At(1));                     \
+  return Int32x4::New(self.x() op other.x() ? -1 : 0,                          \
+                      self.y() op other.y() ? -1 : 0,                          \
+                      self.z() op other.z() ? -1 : 0,                          \
+                      self.w() op other.w() ? -1 : 0);                         \
+}                                                                              \
+
+
+FLOAT32X4_COMPARISON(equal, ==)
+FLOAT32X4_COMPARISON(notequal, !=)
+FLOAT32X4_COMPARISON(lessthan, <)
+FLOAT32X4_COMPARISON(lessthanorequal, <=)
+
+#undef FLOAT32X4_COMPARISON
+
+
+DEFINE_NATIVE_ENTRY(Float32x4_scale, 2) {
+  const Float32x4& self = Float32x4::CheckedHandle(arguments->At(0));
+  const float s = DoubleArgument(
+      isolate, Instance::CheckedHandle(isolate, arguments->At(1)));
+  return Float32x4::New(self.x() * s, self.y() * s, self.z() * s, self.w() * s);
+}
+
+
+DEFINE_NATIVE_ENTRY(Float32x4_shuffle, 2) {
+  const Float32x4& self = Float32x4::CheckedHandle(arguments->At(0));
+  GET_NATIVE_ARGUMENT(Integer, mask, arguments->At(1));
+  return Float32x4::New(Shuffle(self.value(), mask));
+}
+
+
+DEFINE_NATIVE_ENTRY(Float32x4_getX, 1) {
+  const Float32x4& self = Float32x4::CheckedHandle(arguments->At(0));
+  return Double::New(self.x());
+}
+
+
+DEFINE_NATIVE_ENTRY(Float32x4_getY, 1) {
+  const Float32x4& self = Float32x4::CheckedHandle(arguments->At(0));
+  return Double::New(self.y());
+}
+
+
+DEFINE_NATIVE_ENTRY(Float32x4_getZ, 1) {
+  const Float32x4& self = Float32x4::CheckedHandle(arguments->At(0));
+  return Double::New(self.z());
+}
+
+
+DEFINE_NATIVE_ENTRY(Float32x4_getW, 1) {
+  const Float32x4& self = Float32x4::CheckedHandle(arguments->At(0));
+  return Double::New(self.w());
+}
+
+
+DEFINE_NATIVE_ENTRY(Int32x4_new, 5) {
+  ASSERT(AbstractTypeArguments::CheckedHandle(arguments->At(0)).IsNull());
+  const int32_t x = IntegerArgument(
+      isolate, Instance::CheckedHandle(isolate, arguments->At(1)));
+  const int32_t y = IntegerArgument(
+      isolate, Instance::CheckedHandle(isolate, arguments->At(2)));
+  const int32_t z = IntegerArgument(
+      isolate, Instance::CheckedHandle(isolate, arguments->At(3)));
+  const int32_t w = IntegerArgument(
+      isolate, Instance::CheckedHandle(isolate, arguments->At(4)));
+  return Int32x4::New(x, y, z, w);
+}
+
+
+DEFINE_NATIVE_ENTRY(Int32x4_bool, 5) {
+  ASSERT(AbstractTypeArguments::CheckedHandle(arguments->At(0)).IsNull());
+  GET_NATIVE_ARGUMENT(Bool, x, arguments->At(1));
+  GET_NATIVE_ARGUMENT(Bool, y, arguments->At(2));
+  GET_NATIVE_ARGUMENT(Bool, z, arguments->At(3));
+  GET_NATIVE_ARGUMENT(Bool, w, arguments->At(4));
+  return Int32x4::New(x.value() ? -1 : 0, y.value() ? -1 : 0,
+                      z.value() ? -1 : 0, w.value() ? -1 : 0);
+}
+
+
+// Addition and subtraction wrap around like the packed instructions.
+#define INT32X4_BINARY_OP(name, op)                                            \
+DEFINE_NATIVE_ENTRY(Int32x4_##name, 2) {                                       \
+  const Int32x4& self = Int32x4::CheckedHandle(arguments->At(0));              \
+  GET_NATIVE_ARGUMENT(Int32x4, other, arguments->At(1));                       \
+  return Int32x4::New(                                                         \
+      static_cast<uint32_t>(self.x()) op static_cast<uint32_t>(other.x()),     \
+      static_cast<uint32_t>(self.y()) op static_cast<uint32_t>(other.y()),     \
+      static_cast<uint32_t>(self.z()) op static_cast<uint32_t>(other.z()),     \
+      static_cast<uint32_t>(self.w()) op static_cast<uint32_t>(other.w()));    \
+}                                                                              \
+
+
+INT32X4_BINARY_OP(and, &)
+INT32X4_BINARY_OP(or, |)
+INT32X4_BINARY_OP(xor, ^)
+INT32X4_BINARY_OP(add, +)
+INT32X4_BINARY_OP(sub, -)
+
+#undef INT32X4_BINARY_OP
+
+
+DEFINE_NATIVE_ENTRY(Int32x4_shuffle, 2) {
+  const Int32x4& self = Int32x4::CheckedHandle(arguments->At(0));
+  GET_NATIVE_ARGUMENT(Integer, mask, arguments->At(1));
+  return Int32x4::New(Shuffle(self.value(), mask));
+}
+
+
+DEFINE_NATIVE_ENTRY(Int32x4_getX, 1) {
+  const Int32x4& self = Int32x4::CheckedHandle(arguments->At(0));
+  return Integer::New(self.x());
+}
+
+
+DEFINE_NATIVE_ENTRY(Int32x4_getY, 1) {
+  const Int32x4& self = Int32x4::CheckedHandle(arguments->At(0));
+  return Integer::New(self.y());
+}
+
+
+DEFINE_NATIVE_ENTRY(Int32x4_getZ, 1) {
+  const Int32x4& self = Int32x4::CheckedHandle(arguments->At(0));
+  return Integer::New(self.z());
+}
+
+
+DEFINE_NATIVE_ENTRY(Int32x4_getW, 1) {
+  const Int32x4& self = Int32x4::CheckedHandle(arguments->At(0));
+  return Integer::New(self.w());
+}
+
+
+DEFINE_NATIVE_ENTRY(Int32x4_select, 3) {
+  const Int32x4& self = Int32x4::CheckedHandle(arguments->At(0));
+  GET_NATIVE_ARGUMENT(Float32x4, true_value, arguments->At(1));
+  GET_NATIVE_ARGUMENT(Float32x4, false_value, arguments->At(2));
+  const simd128_value_t mask = self.value();
+  const simd128_value_t t = true_value.value();
+  const simd128_value_t f = false_value.value();
+  simd128_value_t result;
+  for (intptr_t i = 0; i < 4; i++) {
+    result.int_storage[i] = (mask.int_storage[i] & t.int_storage[i]) |
+                            (~mask.int_storage[i] & f.int_storage[i]);
+  }
+  return Float32x4::New(result);
+}
+
+}  // namespace dart
@@ -0,0 +1,91 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+/**
+ * Four single precision floating point values, operated on as a single
+ * 128-bit SIMD value. Instances are immutable.
+ */
+class Float32x4 {
+  factory Float32x4(double x, double y, double z, double w)
+      native "Float32x4_new";
+  factory Float32x4.zero() native "Float32x4_zero";
+  factory Float32x4.splat(double v) native "Float32x4_splat";
+
+  Float32x4 operator +(Float32x4 other) native "Float32x4_add";
+  Float32x4 operator -(Float32x4 other) native "Float32x4_sub";
+  Float32x4 operator *(Float32x4 other) native "Float32x4_mul";
+  Float32x4 operator /(Float32x4 other) native "Float32x4_div";
+
+  /** Lane-wise comparisons; each lane of the result is all ones or zero. */
+  Int32x4 equal(Float32x4 other) native "Float32x4_cmpequal";
+  Int32x4 notEqual(Float32x4 other) native "Float32x4_cmpnotequal";
+  Int32x4 lessThan(Float32x4 other) native "Float32x4_cmplessthan";
+  Int32x4 lessThanOrEqual(Float32x4 other)
+      native "Float32x4_cmplessthanorequal";
+  Int32x4 greaterThan(Float32x4 other) => other.lessThan(this);
+  Int32x4 greaterThanOrEqual(Float32x4 other) => other.lessThanOrEqual(this);
+
+  /** Multiplies every lane by [s]. */
+  Float32x4 scale(double s) native "Float32x4_scale";
+
+  /**
+   * Lane i of the result is the lane selected by bits 2i and 2i+1 of
+   * [mask], e.g. [WZYX] reverses the lanes.
+   */
+  Float32x4 shuffle(int mask) native "Float32x4_shuffle";
+
+  double get x native "Float32x4_getX";
+  double get y native "Float32x4_getY";
+  double get z native "Float32x4_getZ";
+  double get w native "Float32x4_getW";
+
+  String toString() => "[$x, $y, $z, $w]";
+
+  static const int XXXX = 0x00;
+  static const int YYYY = 0x55;
+  static const int ZZZZ = 0xAA;
+  static const int WWWW = 0xFF;
+  static const int XYZW = 0xE4;
+  static const int WZYX = 0x1B;
+}
+
+
+/**
+ * Four 32-bit integers, operated on as a single 128-bit SIMD value. Used
+ * as lane masks by [select]. Instances are immutable.
+ */
+class Int32x4 {
+  /** The lanes are the low 32 bits of the arguments. */
+  factory Int32x4(int x, int y, int z, int w) native "Int32x4_new";
+  factory Int32x4.bool(bool x, bool y, bool z, bool w)
+      native "Int32x4_bool";
+
+  Int32x4 operator &(Int32x4 other) native "Int32x4_and";
+  Int32x4 operator |(Int32x4 other) native "Int32x4_or";
+  Int32x4 operator ^(Int32x4 other) native "Int32x4_xor";
+  Int32x4 operator +(Int32x4 other) native "Int32x4_add";
+  Int32x4 operator -(Int32x4 other) native "Int32x4_sub";
+
+  /** See [Float32x4.shuffle]. */
+  Int32x4 shuffle(int mask) native "Int32x4_shuffle";
+
+  int get x native "Int32x4_getX";
+  int get y native "Int32x4_getY";
+  int get z native "Int32x4_getZ";
+  int get w native "Int32x4_getW";
+
+  bool get flagX => x != 0;
+  bool get flagY => y != 0;
+  bool get flagZ => z != 0;
+  bool get flagW => w != 0;
+
+  /**
+   * Merges [trueValue] and [falseValue] bitwise: a bit of the result comes
+   * from [trueValue] where the bit of this mask is set.
+   */
+  Float32x4 select(Float32x4 trueValue, Float32x4 falseValue)
+      native "Int32x4_select";
+
+  String toString() => "[$x, $y, $z, $w]";
+}
@@ -152,6 +152,16 @@ typedef uintptr_t uword;
 // Byte sizes.
 const int kWordSize = sizeof(word);
 const int kDoubleSize = sizeof(double);  // NOLINT
+const int kQuadSize = 2 * kDoubleSize;
+
+// The contents of an xmm register: four single precision floats, four 32-bit
+// integers or two doubles.
+typedef union {
+  float float_storage[4];
+  int32_t int_storage[4];
+  double double_storage[2];
+  int64_t int64_storage[2];
+} simd128_value_t;
 #ifdef ARCH_IS_32_BIT
 const int kWordSizeLog2 = 2;
 const uword kUwordMax = kMaxUint32;
@@ -0,0 +1,144 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/allocation_sampler.h"
+
+#include <math.h>
+
+#include "platform/assert.h"
+#include "platform/utils.h"
+#include "vm/flags.h"
+#include "vm/isolate.h"
+#include "vm/object.h"
+#include "vm/os.h"
+#include "vm/stack_frame.h"
+
+namespace dart {
+
+DEFINE_FLAG(int, allocation_sample_rate, 512 * KB,
+            "Sample one allocation every this many bytes on average, "
+            "0 disables the sampling of allocations");
+
+
+AllocationSampler::AllocationSampler()
+    : num_samples_(0),
+      pending_address_(0),
+      old_bytes_until_sample_(0),
+      random_state_(0x2545f4914f6cdd1dULL) {
+  old_bytes_until_sample_ = NextInterval();
+}
+
+
+intptr_t AllocationSampler::NextInterval() {
+  if (FLAG_allocation_sample_rate <= 0) {
+    return 0;
+  }
+  // Xorshift, the quality of the numbers matters little here.
+  random_state_ ^= random_state_ >> 12;
+  random_state_ ^= random_state_ << 25;
+  random_state_ ^= random_state_ >> 27;
+  // A uniformly distributed number in ]0, 1].
+  const double kTwoPow53 = 9007199254740992.0;
+  double uniform = static_cast<double>((random_state_ >> 11) + 1) / kTwoPow53;
+  double interval = -log(uniform) * FLAG_allocation_sample_rate;
+  if (interval > kMaxInt32) {
+    return kMaxInt32;
+  }
+  return Utils::Maximum(static_cast<intptr_t>(interval),
+                        static_cast<intptr_t>(kObjectAlignment));
+}
+
+
+void AllocationSampler::RecordSample(intptr_t cid, intptr_t size) {
+  pending_address_ = 0;
+  SiteKey key;
+  key.push_back(cid);
+  StackFrameIterator frames(StackFrameIterator::kDontValidateFrames);
+  StackFrame* frame = frames.NextFrame();
+  intptr_t num_frames = 0;
+  while ((frame != NULL) && (num_frames < kMaxFrames)) {
+    if (!frame->IsEntryFrame() && !frame->IsExitFrame()) {
+      key.push_back(frame->pc());
+      num_frames++;
+    }
+    frame = frames.NextFrame();
+  }
+  SiteCounts& counts = sites_[key];
+  counts.samples++;
+  counts.bytes += size;
+  num_samples_++;
+}
+
+
+intptr_t AllocationSampler::NumSamplesOfClass(intptr_t cid) const {
+  intptr_t samples = 0;
+  for (SiteMap::const_iterator it = sites_.begin(); it != sites_.end(); ++it) {
+    if (static_cast<intptr_t>(it->first[0]) == cid) {
+      samples += it->second.samples;
+    }
+  }
+  return samples;
+}
+
+
+static void WriteString(Dart_HeapProfileWriteCallback callback,
+                        void* stream,
+                        const char* str) {
+  (*callback)(str, strlen(str), stream);
+}
+
+
+void AllocationSampler::Write(Dart_HeapProfileWriteCallback callback,
+                              void* stream) const {
+  const intptr_t kBufferSize = 256;
+  char buffer[kBufferSize];
+  intptr_t total_samples = 0;
+  intptr_t total_bytes = 0;
+  for (SiteMap::const_iterator it = sites_.begin(); it != sites_.end(); ++it) {
+    total_samples += it->second.samples;
+    total_bytes += it->second.bytes;
+  }
+  // Objects are not tracked after their allocation, the in use and allocated
+  // counts are the same.
+  OS::SNPrint(buffer, kBufferSize,
+              "heap profile: %"Pd": %"Pd" [%"Pd": %"Pd"] @ heap_v2/%d\n",
+              total_samples, total_bytes, total_samples, total_bytes,
+              FLAG_allocation_sample_rate);
+  WriteString(callback, stream, buffer);
+
+  ClassTable* class_table = Isolate::Current()->class_table();
+  Class& cls = Class::Handle();
+  String& name = String::Handle();
+  for (SiteMap::const_iterator it = sites_.begin(); it != sites_.end(); ++it) {
+    const SiteKey& key = it->first;
+    const SiteCounts& counts = it->second;
+    intptr_t cid = key[0];
+    const char* class_name = "<unknown>";
+    if (class_table->IsValidIndex(cid) && class_table->HasValidClassAt(cid)) {
+      cls = class_table->At(cid);
+      name = cls.Name();
+      class_name = name.ToCString();
+    }
+    WriteString(callback, stream, "# ");
+    WriteString(callback, stream, class_name);
+    WriteString(callback, stream, "\n");
+    OS::SNPrint(buffer, kBufferSize,
+                "%"Pd": %"Pd" [%"Pd": %"Pd"] @",
+                counts.samples, counts.bytes, counts.samples, counts.bytes);
+    WriteString(callback, stream, buffer);
+    for (size_t i = 1; i < key.size(); i++) {
+      OS::SNPrint(buffer, kBufferSize, " %#"Px, key[i]);
+      WriteString(callback, stream, buffer);
+    }
+    WriteString(callback, stream, "\n");
+  }
+}
+
+
+void AllocationSampler::Clear() {
+  sites_.clear();
+  num_samples_ = 0;
+}
+
+}  // namespace dart
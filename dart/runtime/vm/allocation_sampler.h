@@ -0,0 +1,95 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_ALLOCATION_SAMPLER_H_
+#define VM_ALLOCATION_SAMPLER_H_
+
+#include <map>
+#include <vector>
+
+#include "include/dart_api.h"
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+// The AllocationSampler records the class and the stack of a sample of the
+// allocations of an isolate, one allocation every --allocation_sample_rate
+// bytes on average, and aggregates the samples by allocation site.
+//
+// The inlined allocation code is not aware of the sampling. Instead the new
+// space lowers the end of its allocation area to the next sampling point, so
+// that the allocation crossing it fails in generated code and is retried in
+// the runtime. The old space counts the bytes it allocates. The allocation
+// picked for a sample is marked as pending and recorded by Object::Allocate
+// once the class of the object is known.
+class AllocationSampler {
+ public:
+  // The maximum number of frames recorded for a sample.
+  static const intptr_t kMaxFrames = 32;
+
+  AllocationSampler();
+  ~AllocationSampler() {}
+
+  // Returns the number of bytes to allocate until the next sample, or 0 if
+  // sampling is disabled. The intervals are exponentially distributed, which
+  // is what pprof assumes to estimate the unsampled sizes.
+  intptr_t NextInterval();
+
+  // Counts an allocation in old space. Returns true if it should be sampled.
+  bool CountOldAllocation(intptr_t size) {
+    if (old_bytes_until_sample_ <= 0) {
+      return false;
+    }
+    old_bytes_until_sample_ -= size;
+    if (old_bytes_until_sample_ > 0) {
+      return false;
+    }
+    old_bytes_until_sample_ = NextInterval();
+    return true;
+  }
+
+  // The address of the allocation to be sampled, 0 if there is none.
+  uword pending_address() const { return pending_address_; }
+  void set_pending_address(uword address) { pending_address_ = address; }
+
+  // Records a sample for the pending allocation of an object of class 'cid'
+  // at the current stack.
+  void RecordSample(intptr_t cid, intptr_t size);
+
+  intptr_t num_samples() const { return num_samples_; }
+  // The number of samples of objects of class 'cid'.
+  intptr_t NumSamplesOfClass(intptr_t cid) const;
+
+  // Writes the samples in the legacy heap profile format of pprof. The stacks
+  // contain the return addresses of the Dart and stub frames, which pprof
+  // symbolizes with the file written by --generate_pprof_symbols. The class
+  // of each site is given in a comment line preceding it.
+  void Write(Dart_HeapProfileWriteCallback callback, void* stream) const;
+
+  // Discards the samples recorded so far.
+  void Clear();
+
+ private:
+  struct SiteCounts {
+    SiteCounts() : samples(0), bytes(0) {}
+    intptr_t samples;
+    intptr_t bytes;
+  };
+  // A site is identified by the class id followed by the return addresses.
+  typedef std::vector<uword> SiteKey;
+  typedef std::map<SiteKey, SiteCounts> SiteMap;
+
+  SiteMap sites_;
+  intptr_t num_samples_;
+  uword pending_address_;
+  intptr_t old_bytes_until_sample_;
+  uint64_t random_state_;
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSampler);
+};
+
+}  // namespace dart
+
+#endif  // VM_ALLOCATION_SAMPLER_H_
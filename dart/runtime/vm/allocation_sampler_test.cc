@@ -0,0 +1,75 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include <string>
+
+#include "platform/assert.h"
+#include "vm/allocation_sampler.h"
+#include "vm/globals.h"
+#include "vm/heap.h"
+#include "vm/symbols.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+DECLARE_FLAG(int, allocation_sample_rate);
+
+static void AppendToProfile(const void* data, intptr_t size, void* stream) {
+  std::string* profile = reinterpret_cast<std::string*>(stream);
+  profile->append(reinterpret_cast<const char*>(data), size);
+}
+
+
+TEST_CASE(AllocationSampler) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  var x;\n"
+      "}\n"
+      "main() {\n"
+      "  var list = new List(16);\n"
+      "  for (var i = 0; i < 100000; i++) {\n"
+      "    list[i % 16] = new A();\n"
+      "  }\n"
+      "  return list;\n"
+      "}\n";
+  intptr_t saved_allocation_sample_rate = FLAG_allocation_sample_rate;
+  FLAG_allocation_sample_rate = 1 * KB;
+  Heap* heap = Isolate::Current()->heap();
+  AllocationSampler* sampler = heap->allocation_sampler();
+  // Pick a sampling point at the new rate.
+  heap->CollectGarbage(Heap::kNew);
+  sampler->Clear();
+
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, Dart_NewString("main"), 0, NULL));
+  const String& name = String::Handle(String::New(TestCase::url()));
+  const Library& library = Library::Handle(Library::LookupLibrary(name));
+  const Class& class_a = Class::Handle(
+      library.LookupClass(String::Handle(Symbols::New("A"))));
+  EXPECT(!class_a.IsNull());
+  // About 1.6MB of A instances were allocated, mostly in generated code.
+  EXPECT_LT(100, sampler->NumSamplesOfClass(class_a.id()));
+  EXPECT_LT(sampler->NumSamplesOfClass(class_a.id()), 10000);
+
+  // Large arrays are allocated in old space by the runtime.
+  intptr_t array_samples = sampler->NumSamplesOfClass(kArrayCid);
+  for (intptr_t i = 0; i < 100; i++) {
+    Array::New(1 * KB, Heap::kOld);
+  }
+  EXPECT_LT(array_samples, sampler->NumSamplesOfClass(kArrayCid));
+
+  std::string profile;
+  EXPECT_VALID(Dart_AllocationProfile(AppendToProfile, &profile));
+  EXPECT_EQ(0, strncmp(profile.c_str(), "heap profile: ", 14));
+  EXPECT_SUBSTRING("@ heap_v2/1024\n", profile.c_str());
+  EXPECT_SUBSTRING("\n# A\n", profile.c_str());
+  EXPECT(Dart_IsError(Dart_AllocationProfile(NULL, &profile)));
+
+  sampler->Clear();
+  EXPECT_EQ(0, sampler->num_samples());
+  FLAG_allocation_sample_rate = saved_allocation_sample_rate;
+  heap->CollectGarbage(Heap::kNew);
+}
+
+}  // namespace dart
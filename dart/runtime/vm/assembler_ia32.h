@@ -331,6 +331,8 @@ class Assembler : public ValueObject {
   void movsd(XmmRegister dst, XmmRegister src);
 
   void movaps(XmmRegister dst, XmmRegister src);
+  void movups(XmmRegister dst, const Address& src);
+  void movups(const Address& dst, XmmRegister src);
 
   void addsd(XmmRegister dst, XmmRegister src);
   void addsd(XmmRegister dst, const Address& src);
@@ -341,6 +343,27 @@ class Assembler : public ValueObject {
   void divsd(XmmRegister dst, XmmRegister src);
   void divsd(XmmRegister dst, const Address& src);
 
+  // Packed operations on two doubles, four floats or four 32-bit integers.
+  void addpd(XmmRegister dst, XmmRegister src);
+  void subpd(XmmRegister dst, XmmRegister src);
+  void mulpd(XmmRegister dst, XmmRegister src);
+  void divpd(XmmRegister dst, XmmRegister src);
+  void addps(XmmRegister dst, XmmRegister src);
+  void subps(XmmRegister dst, XmmRegister src);
+  void mulps(XmmRegister dst, XmmRegister src);
+  void divps(XmmRegister dst, XmmRegister src);
+  void paddd(XmmRegister dst, XmmRegister src);
+  void psubd(XmmRegister dst, XmmRegister src);
+  void pand(XmmRegister dst, XmmRegister src);
+  void por(XmmRegister dst, XmmRegister src);
+  void pxor(XmmRegister dst, XmmRegister src);
+  void pandn(XmmRegister dst, XmmRegister src);
+  void unpcklpd(XmmRegister dst, XmmRegister src);
+  void pshufd(XmmRegister dst, XmmRegister src, const Immediate& order);
+  // The predicate selects equal (0), less than (1), less than or equal (2)
+  // or not equal (4).
+  void cmpps(XmmRegister dst, XmmRegister src, const Immediate& predicate);
+
   void cvtsi2ss(XmmRegister dst, Register src);
   void cvtsi2sd(XmmRegister dst, Register src);
 
@@ -370,6 +393,9 @@ class Assembler : public ValueObject {
 
   void andpd(XmmRegister dst, const Address& src);
 
+  void psrlq(XmmRegister reg, const Immediate& shift_count);
+  void punpckldq(XmmRegister dst, XmmRegister src);
+
   void flds(const Address& src);
   void fstps(const Address& dst);
 
@@ -1655,6 +1655,29 @@ ASSEMBLER_TEST_RUN(XorpdZeroing, entry) {
 }
 
 
+ASSEMBLER_TEST_GENERATE(Int64Halves, assembler) {
+  // Split the argument into its halves and pack them back.
+  __ movsd(XMM0, Address(ESP, kWordSize));
+  __ movd(EAX, XMM0);
+  __ psrlq(XMM0, Immediate(32));
+  __ movd(EDX, XMM0);
+  __ movd(XMM1, EAX);
+  __ movd(XMM2, EDX);
+  __ punpckldq(XMM1, XMM2);
+  __ movsd(Address(ESP, kWordSize), XMM1);
+  __ movl(EAX, Address(ESP, kWordSize));
+  __ movl(EDX, Address(ESP, 2 * kWordSize));
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(Int64Halves, entry) {
+  typedef int64_t (*Int64HalvesCode)(int64_t value);
+  int64_t res = reinterpret_cast<Int64HalvesCode>(entry)(0x123456789ABCDEFLL);
+  EXPECT_EQ(0x123456789ABCDEFLL, res);
+}
+
+
 ASSEMBLER_TEST_GENERATE(DoubleAbs, assembler) {
   __ movsd(XMM0, Address(ESP, kWordSize));
   __ DoubleAbs(XMM0);
@@ -1866,6 +1889,144 @@ ASSEMBLER_TEST_GENERATE(StoreIntoObject, assembler) {
 }
 
 
+ASSEMBLER_TEST_GENERATE(PackedDoubleArithmetic, assembler) {
+  __ movl(EAX, Address(ESP, kWordSize));
+  __ movl(ECX, Address(ESP, 2 * kWordSize));
+  // a = (a + b) * a / b - b
+  __ movups(XMM1, Address(EAX, 0));
+  __ movups(XMM2, Address(ECX, 0));
+  __ movaps(XMM3, XMM1);
+  __ addpd(XMM3, XMM2);
+  __ mulpd(XMM3, XMM1);
+  __ divpd(XMM3, XMM2);
+  __ subpd(XMM3, XMM2);
+  __ movups(Address(EAX, 0), XMM3);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(PackedDoubleArithmetic, entry) {
+  typedef void (*PackedDoubleArithmeticCode)(double* a, const double* b);
+  double a[2] = { 1.5, -3.0 };
+  const double b[2] = { 2.0, 0.5 };
+  reinterpret_cast<PackedDoubleArithmeticCode>(entry)(a, b);
+  EXPECT_EQ(0.625, a[0]);
+  EXPECT_EQ(14.5, a[1]);
+}
+
+
+ASSEMBLER_TEST_GENERATE(PackedSingleArithmetic, assembler) {
+  __ movl(EAX, Address(ESP, kWordSize));
+  __ movl(ECX, Address(ESP, 2 * kWordSize));
+  // a = (a + b) * a / b - b
+  __ movups(XMM1, Address(EAX, 0));
+  __ movups(XMM2, Address(ECX, 0));
+  __ movaps(XMM3, XMM1);
+  __ addps(XMM3, XMM2);
+  __ mulps(XMM3, XMM1);
+  __ divps(XMM3, XMM2);
+  __ subps(XMM3, XMM2);
+  __ movups(Address(EAX, 0), XMM3);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(PackedSingleArithmetic, entry) {
+  typedef void (*PackedSingleArithmeticCode)(float* a, const float* b);
+  float a[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+  const float b[4] = { 0.5f, 2.0f, 4.0f, 8.0f };
+  reinterpret_cast<PackedSingleArithmeticCode>(entry)(a, b);
+  EXPECT_EQ(2.5f, a[0]);
+  EXPECT_EQ(2.0f, a[1]);
+  EXPECT_EQ(1.25f, a[2]);
+  EXPECT_EQ(-2.0f, a[3]);
+}
+
+
+ASSEMBLER_TEST_GENERATE(PackedIntegerArithmetic, assembler) {
+  __ movl(EAX, Address(ESP, kWordSize));
+  __ movl(ECX, Address(ESP, 2 * kWordSize));
+  __ movups(XMM1, Address(EAX, 0));
+  __ movups(XMM2, Address(ECX, 0));
+  __ movaps(XMM3, XMM1);
+  __ paddd(XMM3, XMM2);
+  __ pand(XMM2, XMM1);
+  __ psubd(XMM3, XMM2);
+  __ pxor(XMM3, XMM1);
+  __ movups(Address(EAX, 0), XMM3);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(PackedIntegerArithmetic, entry) {
+  typedef void (*PackedIntegerArithmeticCode)(int32_t* a, const int32_t* b);
+  // Computes b & ~a as ((a + b) - (a & b)) ^ a, the addition wraps around.
+  int32_t a[4] = { 1, -2, 0x7FFFFFFF, 7 };
+  const int32_t b[4] = { 3, 5, 1, 12 };
+  reinterpret_cast<PackedIntegerArithmeticCode>(entry)(a, b);
+  EXPECT_EQ(2, a[0]);
+  EXPECT_EQ(1, a[1]);
+  EXPECT_EQ(0, a[2]);
+  EXPECT_EQ(8, a[3]);
+}
+
+
+ASSEMBLER_TEST_GENERATE(PackedBroadcast, assembler) {
+  __ movl(EAX, Address(ESP, kWordSize));
+  __ movl(ECX, Address(ESP, 2 * kWordSize));
+  __ movl(EDX, Immediate(42));
+  __ movd(XMM1, EDX);
+  __ pshufd(XMM1, XMM1, Immediate(0));
+  __ movups(Address(EAX, 0), XMM1);
+  __ movsd(XMM2, Address(ECX, 0));
+  __ unpcklpd(XMM2, XMM2);
+  __ movups(Address(ECX, 0), XMM2);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(PackedBroadcast, entry) {
+  typedef void (*PackedBroadcastCode)(int32_t* ints, double* doubles);
+  int32_t ints[4] = { 0, 0, 0, 0 };
+  double doubles[2] = { 2.5, 0.0 };
+  reinterpret_cast<PackedBroadcastCode>(entry)(ints, doubles);
+  for (intptr_t i = 0; i < 4; i++) {
+    EXPECT_EQ(42, ints[i]);
+  }
+  EXPECT_EQ(2.5, doubles[0]);
+  EXPECT_EQ(2.5, doubles[1]);
+}
+
+
+ASSEMBLER_TEST_GENERATE(PackedCompareAndSelect, assembler) {
+  __ movl(EAX, Address(ESP, kWordSize));
+  __ movl(ECX, Address(ESP, 2 * kWordSize));
+  // a = (a < b) ? a : b, element-wise.
+  __ movups(XMM1, Address(EAX, 0));
+  __ movups(XMM2, Address(ECX, 0));
+  __ movaps(XMM3, XMM1);
+  __ cmpps(XMM3, XMM2, Immediate(1));
+  __ movaps(XMM4, XMM3);
+  __ pand(XMM3, XMM1);
+  __ pandn(XMM4, XMM2);
+  __ por(XMM3, XMM4);
+  __ movups(Address(EAX, 0), XMM3);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(PackedCompareAndSelect, entry) {
+  typedef void (*PackedCompareAndSelectCode)(float* a, const float* b);
+  float a[4] = { 1.0f, 5.0f, -2.0f, 3.0f };
+  const float b[4] = { 2.0f, 4.0f, -3.0f, 3.0f };
+  reinterpret_cast<PackedCompareAndSelectCode>(entry)(a, b);
+  EXPECT_EQ(1.0f, a[0]);
+  EXPECT_EQ(4.0f, a[1]);
+  EXPECT_EQ(-3.0f, a[2]);
+  EXPECT_EQ(3.0f, a[3]);
+}
+
+
 }  // namespace dart
 
 #endif  // defined TARGET_ARCH_IA32
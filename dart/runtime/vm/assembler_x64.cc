@@ -395,6 +395,30 @@ void Assembler::movd(Register dst, XmmRegister src) {
 }
 
 
+void Assembler::movq(XmmRegister dst, Register src) {
+  ASSERT(dst <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  Operand operand(src);
+  EmitUint8(0x66);
+  EmitOperandREX(0, operand, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0x6E);
+  EmitOperand(dst & 7, operand);
+}
+
+
+void Assembler::movq(Register dst, XmmRegister src) {
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  Operand operand(dst);
+  EmitUint8(0x66);
+  EmitOperandREX(0, operand, REX_W);
+  EmitUint8(0x0F);
+  EmitUint8(0x7E);
+  EmitOperand(src & 7, operand);
+}
+
+
 void Assembler::addss(XmmRegister dst, XmmRegister src) {
   // TODO(srdjan): implement and test XMM8 - XMM15.
   ASSERT(src <= XMM7);
@@ -490,6 +514,26 @@ void Assembler::movaps(XmmRegister dst, XmmRegister src) {
 }
 
 
+void Assembler::movups(XmmRegister dst, const Address& src) {
+  ASSERT(dst <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(0, src, REX_NONE);
+  EmitUint8(0x0F);
+  EmitUint8(0x10);
+  EmitOperand(dst & 7, src);
+}
+
+
+void Assembler::movups(const Address& dst, XmmRegister src) {
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitOperandREX(0, dst, REX_NONE);
+  EmitUint8(0x0F);
+  EmitUint8(0x11);
+  EmitOperand(src & 7, dst);
+}
+
+
 void Assembler::addsd(XmmRegister dst, XmmRegister src) {
   // TODO(srdjan): implement and test XMM8 - XMM15.
   ASSERT(src <= XMM7);
@@ -538,6 +582,196 @@ void Assembler::divsd(XmmRegister dst, XmmRegister src) {
 }
 
 
+void Assembler::addpd(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitUint8(0x0F);
+  EmitUint8(0x58);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::subpd(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitUint8(0x0F);
+  EmitUint8(0x5C);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::mulpd(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitUint8(0x0F);
+  EmitUint8(0x59);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::divpd(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitUint8(0x0F);
+  EmitUint8(0x5E);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::addps(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x0F);
+  EmitUint8(0x58);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::subps(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x0F);
+  EmitUint8(0x5C);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::mulps(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x0F);
+  EmitUint8(0x59);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::divps(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x0F);
+  EmitUint8(0x5E);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::paddd(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitUint8(0x0F);
+  EmitUint8(0xFE);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::psubd(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitUint8(0x0F);
+  EmitUint8(0xFA);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::pand(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitUint8(0x0F);
+  EmitUint8(0xDB);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::por(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitUint8(0x0F);
+  EmitUint8(0xEB);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::pxor(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitUint8(0x0F);
+  EmitUint8(0xEF);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::pandn(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitUint8(0x0F);
+  EmitUint8(0xDF);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::unpcklpd(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitUint8(0x0F);
+  EmitUint8(0x14);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::pshufd(XmmRegister dst,
+                       XmmRegister src,
+                       const Immediate& order) {
+  ASSERT(order.is_uint8());
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x66);
+  EmitUint8(0x0F);
+  EmitUint8(0x70);
+  EmitXmmRegisterOperand(dst, src);
+  EmitUint8(order.value() & 0xFF);
+}
+
+
+void Assembler::cmpps(XmmRegister dst,
+                      XmmRegister src,
+                      const Immediate& predicate) {
+  ASSERT(predicate.is_uint8());
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0x0F);
+  EmitUint8(0xC2);
+  EmitXmmRegisterOperand(dst, src);
+  EmitUint8(predicate.value() & 0xFF);
+}
+
+
 void Assembler::comisd(XmmRegister a, XmmRegister b) {
   ASSERT(a <= XMM7);
   ASSERT(b <= XMM7);
@@ -616,6 +850,28 @@ void Assembler::cvttsd2siq(Register dst, XmmRegister src) {
 }
 
 
+void Assembler::cvtss2sd(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xF3);
+  EmitUint8(0x0F);
+  EmitUint8(0x5A);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
+void Assembler::cvtsd2ss(XmmRegister dst, XmmRegister src) {
+  ASSERT(dst <= XMM7);
+  ASSERT(src <= XMM7);
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  EmitUint8(0xF2);
+  EmitUint8(0x0F);
+  EmitUint8(0x5A);
+  EmitXmmRegisterOperand(dst, src);
+}
+
+
 void Assembler::fldl(const Address& src) {
   AssemblerBuffer::EnsureCapacity ensured(&buffer_);
   EmitUint8(0xDD);
@@ -1599,13 +1855,32 @@ void Assembler::StoreIntoObject(Register object,
                                 Register value) {
   ASSERT(object != value);
   movq(dest, value);
-  Label done;
-  StoreIntoObjectFilter(object, value, &done);
+  Label done, check_marking, update;
+  StoreIntoObjectFilter(object, value, &check_marking);
+  // Mark the card of the slot if the object is located in a large page,
+  // the filter left no live value in the value register.
+  movq(TMP, object);
+  andq(TMP, Immediate(~(PageSpace::kPageAlignment - 1)));
+  cmpq(Address(TMP, HeapPage::card_table_offset()), Immediate(0));
+  j(EQUAL, &update, Assembler::kNearJump);
+  leaq(value, dest);
+  subq(value, TMP);
+  shrq(value, Immediate(HeapPage::kCardSizeLog2));
+  movq(TMP, Address(TMP, HeapPage::card_table_offset()));
+  movb(Address(TMP, value, TIMES_1, 0), Immediate(1));
+  jmp(&done, Assembler::kNearJump);
+  Bind(&update);
   // A store buffer update is required.
   if (value != RAX) pushq(RAX);
   leaq(RAX, dest);
   call(&StubCode::UpdateStoreBufferLabel());
   if (value != RAX) popq(RAX);
+  jmp(&done, Assembler::kNearJump);
+  // While incremental marking is in progress all stores are recorded.
+  Bind(&check_marking);
+  movq(TMP, Immediate(Heap::marking_isolates_address()));
+  cmpq(Address(TMP, 0), Immediate(0));
+  j(NOT_EQUAL, &update);
   Bind(&done);
 }
 
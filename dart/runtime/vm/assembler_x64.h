@@ -334,6 +334,10 @@ class Assembler : public ValueObject {
   void movd(XmmRegister dst, Register src);
   void movd(Register dst, XmmRegister src);
 
+  // Move all 64 bits between a CPU and an XMM register.
+  void movq(XmmRegister dst, Register src);
+  void movq(Register dst, XmmRegister src);
+
   void addss(XmmRegister dst, XmmRegister src);
   void subss(XmmRegister dst, XmmRegister src);
   void mulss(XmmRegister dst, XmmRegister src);
@@ -344,16 +348,42 @@ class Assembler : public ValueObject {
   void movsd(XmmRegister dst, XmmRegister src);
 
   void movaps(XmmRegister dst, XmmRegister src);
+  void movups(XmmRegister dst, const Address& src);
+  void movups(const Address& dst, XmmRegister src);
 
   void addsd(XmmRegister dst, XmmRegister src);
   void subsd(XmmRegister dst, XmmRegister src);
   void mulsd(XmmRegister dst, XmmRegister src);
   void divsd(XmmRegister dst, XmmRegister src);
 
+  // Packed operations on two doubles, four floats or four 32-bit integers.
+  void addpd(XmmRegister dst, XmmRegister src);
+  void subpd(XmmRegister dst, XmmRegister src);
+  void mulpd(XmmRegister dst, XmmRegister src);
+  void divpd(XmmRegister dst, XmmRegister src);
+  void addps(XmmRegister dst, XmmRegister src);
+  void subps(XmmRegister dst, XmmRegister src);
+  void mulps(XmmRegister dst, XmmRegister src);
+  void divps(XmmRegister dst, XmmRegister src);
+  void paddd(XmmRegister dst, XmmRegister src);
+  void psubd(XmmRegister dst, XmmRegister src);
+  void pand(XmmRegister dst, XmmRegister src);
+  void por(XmmRegister dst, XmmRegister src);
+  void pxor(XmmRegister dst, XmmRegister src);
+  void pandn(XmmRegister dst, XmmRegister src);
+  void unpcklpd(XmmRegister dst, XmmRegister src);
+  void pshufd(XmmRegister dst, XmmRegister src, const Immediate& order);
+  // The predicate selects equal (0), less than (1), less than or equal (2)
+  // or not equal (4).
+  void cmpps(XmmRegister dst, XmmRegister src, const Immediate& predicate);
+
   void comisd(XmmRegister a, XmmRegister b);
   void cvtsi2sd(XmmRegister a, Register b);
   void cvttsd2siq(Register dst, XmmRegister src);
 
+  void cvtss2sd(XmmRegister dst, XmmRegister src);
+  void cvtsd2ss(XmmRegister dst, XmmRegister src);
+
   void xchgl(Register dst, Register src);
   void xchgq(Register dst, Register src);
 
@@ -1392,6 +1392,21 @@ ASSEMBLER_TEST_RUN(Int64ToDoubleConversion, entry) {
 }
 
 
+ASSEMBLER_TEST_GENERATE(Int64XmmMoves, assembler) {
+  __ movq(R10, Immediate(0x123456789ABCDEFLL));
+  __ movq(XMM1, R10);
+  __ movq(RAX, XMM1);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(Int64XmmMoves, entry) {
+  typedef int64_t (*Int64XmmMovesCode)();
+  int64_t res = reinterpret_cast<Int64XmmMovesCode>(entry)();
+  EXPECT_EQ(0x123456789ABCDEFLL, res);
+}
+
+
 ASSEMBLER_TEST_GENERATE(DoubleToInt64Conversion, assembler) {
   __ movq(RAX, Immediate(bit_cast<int64_t, double>(12.3)));
   __ pushq(RAX);
@@ -1729,6 +1744,171 @@ ASSEMBLER_TEST_RUN(ExtractSignBits, entry) {
   EXPECT_EQ(1, res);
 }
 
+
+ASSEMBLER_TEST_GENERATE(PackedDoubleArithmetic, assembler) {
+  // a = (a + b) * a / b - b
+  __ movups(XMM1, Address(RDI, 0));
+  __ movups(XMM2, Address(RSI, 0));
+  __ movaps(XMM3, XMM1);
+  __ addpd(XMM3, XMM2);
+  __ mulpd(XMM3, XMM1);
+  __ divpd(XMM3, XMM2);
+  __ subpd(XMM3, XMM2);
+  __ movups(Address(RDI, 0), XMM3);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(PackedDoubleArithmetic, entry) {
+  typedef void (*PackedDoubleArithmeticCode)(double* a, const double* b);
+  double a[2] = { 1.5, -3.0 };
+  const double b[2] = { 2.0, 0.5 };
+  reinterpret_cast<PackedDoubleArithmeticCode>(entry)(a, b);
+  EXPECT_EQ(0.625, a[0]);
+  EXPECT_EQ(14.5, a[1]);
+}
+
+
+ASSEMBLER_TEST_GENERATE(PackedSingleArithmetic, assembler) {
+  // a = (a + b) * a / b - b
+  __ movups(XMM1, Address(RDI, 0));
+  __ movups(XMM2, Address(RSI, 0));
+  __ movaps(XMM3, XMM1);
+  __ addps(XMM3, XMM2);
+  __ mulps(XMM3, XMM1);
+  __ divps(XMM3, XMM2);
+  __ subps(XMM3, XMM2);
+  __ movups(Address(RDI, 0), XMM3);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(PackedSingleArithmetic, entry) {
+  typedef void (*PackedSingleArithmeticCode)(float* a, const float* b);
+  float a[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+  const float b[4] = { 0.5f, 2.0f, 4.0f, 8.0f };
+  reinterpret_cast<PackedSingleArithmeticCode>(entry)(a, b);
+  EXPECT_EQ(2.5f, a[0]);
+  EXPECT_EQ(2.0f, a[1]);
+  EXPECT_EQ(1.25f, a[2]);
+  EXPECT_EQ(-2.0f, a[3]);
+}
+
+
+ASSEMBLER_TEST_GENERATE(PackedIntegerArithmetic, assembler) {
+  __ movups(XMM1, Address(RDI, 0));
+  __ movups(XMM2, Address(RSI, 0));
+  __ movaps(XMM3, XMM1);
+  __ paddd(XMM3, XMM2);
+  __ pand(XMM2, XMM1);
+  __ psubd(XMM3, XMM2);
+  __ pxor(XMM3, XMM1);
+  __ movups(Address(RDI, 0), XMM3);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(PackedIntegerArithmetic, entry) {
+  typedef void (*PackedIntegerArithmeticCode)(int32_t* a, const int32_t* b);
+  // Computes b & ~a as ((a + b) - (a & b)) ^ a, the addition wraps around.
+  int32_t a[4] = { 1, -2, 0x7FFFFFFF, 7 };
+  const int32_t b[4] = { 3, 5, 1, 12 };
+  reinterpret_cast<PackedIntegerArithmeticCode>(entry)(a, b);
+  EXPECT_EQ(2, a[0]);
+  EXPECT_EQ(1, a[1]);
+  EXPECT_EQ(0, a[2]);
+  EXPECT_EQ(8, a[3]);
+}
+
+
+ASSEMBLER_TEST_GENERATE(PackedBroadcast, assembler) {
+  __ movl(RAX, Immediate(42));
+  __ movd(XMM1, RAX);
+  __ pshufd(XMM1, XMM1, Immediate(0));
+  __ movups(Address(RDI, 0), XMM1);
+  __ movsd(XMM2, Address(RSI, 0));
+  __ unpcklpd(XMM2, XMM2);
+  __ movups(Address(RSI, 0), XMM2);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(PackedBroadcast, entry) {
+  typedef void (*PackedBroadcastCode)(int32_t* ints, double* doubles);
+  int32_t ints[4] = { 0, 0, 0, 0 };
+  double doubles[2] = { 2.5, 0.0 };
+  reinterpret_cast<PackedBroadcastCode>(entry)(ints, doubles);
+  for (intptr_t i = 0; i < 4; i++) {
+    EXPECT_EQ(42, ints[i]);
+  }
+  EXPECT_EQ(2.5, doubles[0]);
+  EXPECT_EQ(2.5, doubles[1]);
+}
+
+
+ASSEMBLER_TEST_GENERATE(PackedOr, assembler) {
+  __ movups(XMM1, Address(RDI, 0));
+  __ movups(XMM2, Address(RSI, 0));
+  __ por(XMM1, XMM2);
+  __ movups(Address(RDI, 0), XMM1);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(PackedOr, entry) {
+  typedef void (*PackedOrCode)(int32_t* a, const int32_t* b);
+  int32_t a[4] = { 1, 2, 0x10000, -1 };
+  const int32_t b[4] = { 2, 2, 0x100, 0 };
+  reinterpret_cast<PackedOrCode>(entry)(a, b);
+  EXPECT_EQ(3, a[0]);
+  EXPECT_EQ(2, a[1]);
+  EXPECT_EQ(0x10100, a[2]);
+  EXPECT_EQ(-1, a[3]);
+}
+
+
+ASSEMBLER_TEST_GENERATE(SingleDoubleConversions, assembler) {
+  __ cvtsd2ss(XMM1, XMM0);
+  __ cvtss2sd(XMM0, XMM1);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(SingleDoubleConversions, entry) {
+  typedef double (*SingleDoubleConversionsCode)(double d);
+  double res = reinterpret_cast<SingleDoubleConversionsCode>(entry)(1.1);
+  EXPECT_EQ(static_cast<double>(static_cast<float>(1.1)), res);
+  res = reinterpret_cast<SingleDoubleConversionsCode>(entry)(-0.25);
+  EXPECT_EQ(-0.25, res);
+}
+
+ASSEMBLER_TEST_GENERATE(PackedCompareAndSelect, assembler) {
+  // a = (a < b) ? a : b, element-wise.
+  __ movups(XMM1, Address(RDI, 0));
+  __ movups(XMM2, Address(RSI, 0));
+  __ movaps(XMM3, XMM1);
+  __ cmpps(XMM3, XMM2, Immediate(1));
+  __ movaps(XMM4, XMM3);
+  __ pand(XMM3, XMM1);
+  __ pandn(XMM4, XMM2);
+  __ por(XMM3, XMM4);
+  __ movups(Address(RDI, 0), XMM3);
+  __ ret();
+}
+
+
+ASSEMBLER_TEST_RUN(PackedCompareAndSelect, entry) {
+  typedef void (*PackedCompareAndSelectCode)(float* a, const float* b);
+  float a[4] = { 1.0f, 5.0f, -2.0f, 3.0f };
+  const float b[4] = { 2.0f, 4.0f, -3.0f, 3.0f };
+  reinterpret_cast<PackedCompareAndSelectCode>(entry)(a, b);
+  EXPECT_EQ(1.0f, a[0]);
+  EXPECT_EQ(4.0f, a[1]);
+  EXPECT_EQ(-3.0f, a[2]);
+  EXPECT_EQ(3.0f, a[3]);
+}
+
+
 }  // namespace dart
 
 #endif  // defined TARGET_ARCH_X64
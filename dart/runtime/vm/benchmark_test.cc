@@ -14,6 +14,8 @@
 
 namespace dart {
 
+DECLARE_FLAG(int, scavenger_tasks);
+
 Benchmark* Benchmark::first_ = NULL;
 Benchmark* Benchmark::tail_ = NULL;
 const char* Benchmark::executable_ = NULL;
@@ -309,7 +311,7 @@ BENCHMARK(Dart2JSCompileAll) {
 
 
 //
-// Measure frame lookup during stack traversal.
+// Measure frame and code lookup during stack traversal.
 //
 static void StackFrame_accessFrame(Dart_NativeArguments args) {
   const int kNumIterations = 100;
@@ -327,6 +329,8 @@ static void StackFrame_accessFrame(Dart_NativeArguments args) {
       } else if (frame->IsDartFrame()) {
         code = frame->LookupDartCode();
         EXPECT(code.function() != Function::null());
+        // The debugger and the runtime map arbitrary pcs to their code.
+        EXPECT(Code::LookupCode(frame->pc()) == code.raw());
       }
       frame = frames.NextFrame();
     }
@@ -396,4 +400,184 @@ BENCHMARK(FrameLookup) {
   benchmark->set_score(elapsed_time);
 }
 
+
+//
+// Measure the scavenge pause for different survivor rates, using the mutator
+// thread only and using parallel scavenging tasks.
+//
+static int64_t MeasureScavenge(Isolate* isolate,
+                               intptr_t survivor_percentage,
+                               int scavenger_tasks) {
+  const intptr_t kNumObjects = 64 * KB;
+  const intptr_t kNumIterations = 10;
+  const int saved_scavenger_tasks = FLAG_scavenger_tasks;
+  FLAG_scavenger_tasks = scavenger_tasks;
+  Heap* heap = isolate->heap();
+  Timer timer(true, "Scavenge benchmark");
+  for (intptr_t iteration = 0; iteration < kNumIterations; iteration++) {
+    HandleScope handle_scope(isolate);
+    // Start out with an empty new space.
+    heap->CollectGarbage(Heap::kNew);
+    heap->CollectGarbage(Heap::kNew);
+    // The survivors are kept alive through the store buffer.
+    const Array& survivors =
+        Array::Handle(isolate, Array::New(kNumObjects, Heap::kOld));
+    Array& element = Array::Handle(isolate);
+    for (intptr_t i = 0; i < kNumObjects; i++) {
+      element = Array::New(8);
+      if ((i % 100) < survivor_percentage) {
+        survivors.SetAt(i, element);
+      }
+    }
+    timer.Start();
+    heap->CollectGarbage(Heap::kNew);
+    timer.Stop();
+  }
+  FLAG_scavenger_tasks = saved_scavenger_tasks;
+  return timer.TotalElapsedTime() / kNumIterations;
+}
+
+
+static void RunScavengeBenchmark(Benchmark* benchmark,
+                                 intptr_t survivor_percentage) {
+  const int kScavengerTasks = 3;
+  int64_t serial_time = MeasureScavenge(benchmark->isolate(),
+                                        survivor_percentage,
+                                        0);
+  int64_t parallel_time = MeasureScavenge(benchmark->isolate(),
+                                          survivor_percentage,
+                                          kScavengerTasks);
+  OS::Print("%s: %"Pd"%% survivors, serial %"Pd64"us, "
+            "%d scavenger tasks %"Pd64"us\n",
+            benchmark->name(),
+            survivor_percentage,
+            serial_time,
+            kScavengerTasks,
+            parallel_time);
+  benchmark->set_score(parallel_time);
+}
+
+
+BENCHMARK(ScavengeSurvivors10) {
+  RunScavengeBenchmark(benchmark, 10);
+}
+
+
+BENCHMARK(ScavengeSurvivors50) {
+  RunScavengeBenchmark(benchmark, 50);
+}
+
+
+BENCHMARK(ScavengeSurvivors90) {
+  RunScavengeBenchmark(benchmark, 90);
+}
+
+
+//
+// Measure Float32x4 code against the equivalent scalar code.
+//
+static int64_t MeasureInvoke(Dart_Handle lib, const char* name) {
+  const intptr_t kNumIterations = 100;
+  Dart_Handle function_name = Dart_NewString(name);
+  // Warm up so that the measured invocations run optimized code.
+  EXPECT_VALID(Dart_Invoke(lib, function_name, 0, NULL));
+  Timer timer(true, name);
+  timer.Start();
+  for (intptr_t i = 0; i < kNumIterations; i++) {
+    EXPECT_VALID(Dart_Invoke(lib, function_name, 0, NULL));
+  }
+  timer.Stop();
+  return timer.TotalElapsedTime();
+}
+
+
+static void RunSimdBenchmark(Benchmark* benchmark, const char* script) {
+  Dart_EnterScope();
+  Dart_Handle lib = TestCase::LoadTestScript(script, NULL);
+  int64_t scalar_time = MeasureInvoke(lib, "scalar");
+  int64_t simd_time = MeasureInvoke(lib, "simd");
+  OS::Print("%s: scalar %"Pd64"us, simd %"Pd64"us\n",
+            benchmark->name(),
+            scalar_time,
+            simd_time);
+  Dart_ExitScope();
+  benchmark->set_score(simd_time);
+}
+
+
+// Multiplies 4x4 matrices stored in row major order.
+BENCHMARK(SimdMatrixMultiply) {
+  const char* kScriptChars =
+      "final a = new Float32List(16), b = new Float32List(16);\n"
+      "final c = new Float32List(16);\n"
+      "init() {\n"
+      "  for (var i = 0; i < 16; i++) {\n"
+      "    a[i] = i * 0.5; b[i] = 1.0 - i * 0.25;\n"
+      "  }\n"
+      "}\n"
+      "scalarMultiply(a, b, c) {\n"
+      "  for (var i = 0; i < 16; i += 4) {\n"
+      "    for (var j = 0; j < 4; j++) {\n"
+      "      c[i + j] = a[i] * b[j] + a[i + 1] * b[4 + j] +\n"
+      "          a[i + 2] * b[8 + j] + a[i + 3] * b[12 + j];\n"
+      "    }\n"
+      "  }\n"
+      "}\n"
+      "simdMultiply(a, b, c) {\n"
+      "  var b0 = b.getFloat32x4(0), b1 = b.getFloat32x4(4);\n"
+      "  var b2 = b.getFloat32x4(8), b3 = b.getFloat32x4(12);\n"
+      "  for (var i = 0; i < 16; i += 4) {\n"
+      "    c.setFloat32x4(i, b0.scale(a[i]) + b1.scale(a[i + 1]) +\n"
+      "        b2.scale(a[i + 2]) + b3.scale(a[i + 3]));\n"
+      "  }\n"
+      "}\n"
+      "scalar() {\n"
+      "  init();\n"
+      "  for (var k = 0; k < 10000; k++) scalarMultiply(a, b, c);\n"
+      "}\n"
+      "simd() {\n"
+      "  init();\n"
+      "  for (var k = 0; k < 10000; k++) simdMultiply(a, b, c);\n"
+      "}\n";
+  RunSimdBenchmark(benchmark, kScriptChars);
+}
+
+
+// Blends two images of 1024 RGBA pixels with single precision channels.
+BENCHMARK(SimdImageBlend) {
+  const char* kScriptChars =
+      "final src = new Float32List(4096), dst = new Float32List(4096);\n"
+      "init() {\n"
+      "  for (var i = 0; i < 4096; i++) {\n"
+      "    src[i] = (i % 255) / 255.0; dst[i] = 1.0 - src[i];\n"
+      "  }\n"
+      "}\n"
+      "scalarBlend(src, dst, alpha) {\n"
+      "  var beta = 1.0 - alpha;\n"
+      "  for (var i = 0; i < src.length; i += 4) {\n"
+      "    dst[i] = src[i] * alpha + dst[i] * beta;\n"
+      "    dst[i + 1] = src[i + 1] * alpha + dst[i + 1] * beta;\n"
+      "    dst[i + 2] = src[i + 2] * alpha + dst[i + 2] * beta;\n"
+      "    dst[i + 3] = src[i + 3] * alpha + dst[i + 3] * beta;\n"
+      "  }\n"
+      "}\n"
+      "simdBlend(src, dst, alpha) {\n"
+      "  var a = new Float32x4.splat(alpha);\n"
+      "  var b = new Float32x4.splat(1.0 - alpha);\n"
+      "  for (var i = 0; i < src.length; i += 4) {\n"
+      "    dst.setFloat32x4(i, src.getFloat32x4(i) * a +\n"
+      "        dst.getFloat32x4(i) * b);\n"
+      "  }\n"
+      "}\n"
+      "scalar() {\n"
+      "  init();\n"
+      "  for (var k = 0; k < 100; k++) scalarBlend(src, dst, 0.5);\n"
+      "}\n"
+      "simd() {\n"
+      "  init();\n"
+      "  for (var k = 0; k < 100; k++) simdBlend(src, dst, 0.5);\n"
+      "}\n";
+  RunSimdBenchmark(benchmark, kScriptChars);
+}
+
 }  // namespace dart
@@ -139,6 +139,8 @@ namespace dart {
   V(Int32Array_new, 1)                                                         \
   V(Int32Array_getIndexed, 2)                                                  \
   V(Int32Array_setIndexed, 3)                                                  \
+  V(Int32Array_getInt32x4, 2)                                                  \
+  V(Int32Array_setInt32x4, 3)                                                  \
   V(Uint32Array_new, 1)                                                        \
   V(Uint32Array_getIndexed, 2)                                                 \
   V(Uint32Array_setIndexed, 3)                                                 \
@@ -151,6 +153,8 @@ namespace dart {
   V(Float32Array_new, 1)                                                       \
   V(Float32Array_getIndexed, 2)                                                \
   V(Float32Array_setIndexed, 3)                                                \
+  V(Float32Array_getFloat32x4, 2)                                              \
+  V(Float32Array_setFloat32x4, 3)                                              \
   V(Float64Array_new, 1)                                                       \
   V(Float64Array_getIndexed, 2)                                                \
   V(Float64Array_setIndexed, 3)                                                \
@@ -164,6 +168,8 @@ namespace dart {
   V(ExternalUint16Array_setIndexed, 3)                                         \
   V(ExternalInt32Array_getIndexed, 2)                                          \
   V(ExternalInt32Array_setIndexed, 3)                                          \
+  V(ExternalInt32Array_getInt32x4, 2)                                          \
+  V(ExternalInt32Array_setInt32x4, 3)                                          \
   V(ExternalUint32Array_getIndexed, 2)                                         \
   V(ExternalUint32Array_setIndexed, 3)                                         \
   V(ExternalInt64Array_getIndexed, 2)                                          \
@@ -172,6 +178,8 @@ namespace dart {
   V(ExternalUint64Array_setIndexed, 3)                                         \
   V(ExternalFloat32Array_getIndexed, 2)                                        \
   V(ExternalFloat32Array_setIndexed, 3)                                        \
+  V(ExternalFloat32Array_getFloat32x4, 2)                                      \
+  V(ExternalFloat32Array_setFloat32x4, 3)                                      \
   V(ExternalFloat64Array_getIndexed, 2)                                        \
   V(ExternalFloat64Array_setIndexed, 3)                                        \
   V(isolate_getPortInternal, 0)                                                \
@@ -192,6 +200,36 @@ namespace dart {
   V(GrowableObjectArray_getCapacity, 1)                                        \
   V(GrowableObjectArray_setLength, 2)                                          \
   V(GrowableObjectArray_setData, 2)                                            \
+  V(Float32x4_new, 5)                                                          \
+  V(Float32x4_zero, 1)                                                         \
+  V(Float32x4_splat, 2)                                                        \
+  V(Float32x4_add, 2)                                                          \
+  V(Float32x4_sub, 2)                                                          \
+  V(Float32x4_mul, 2)                                                          \
+  V(Float32x4_div, 2)                                                          \
+  V(Float32x4_cmpequal, 2)                                                     \
+  V(Float32x4_cmpnotequal, 2)                                                  \
+  V(Float32x4_cmplessthan, 2)                                                  \
+  V(Float32x4_cmplessthanorequal, 2)                                           \
+  V(Float32x4_scale, 2)                                                        \
+  V(Float32x4_shuffle, 2)                                                      \
+  V(Float32x4_getX, 1)                                                         \
+  V(Float32x4_getY, 1)                                                         \
+  V(Float32x4_getZ, 1)                                                         \
+  V(Float32x4_getW, 1)                                                         \
+  V(Int32x4_new, 5)                                                            \
+  V(Int32x4_bool, 5)                                                           \
+  V(Int32x4_and, 2)                                                            \
+  V(Int32x4_or, 2)                                                             \
+  V(Int32x4_xor, 2)                                                            \
+  V(Int32x4_add, 2)                                                            \
+  V(Int32x4_sub, 2)                                                            \
+  V(Int32x4_shuffle, 2)                                                        \
+  V(Int32x4_getX, 1)                                                           \
+  V(Int32x4_getY, 1)                                                           \
+  V(Int32x4_getZ, 1)                                                           \
+  V(Int32x4_getW, 1)                                                           \
+  V(Int32x4_select, 3)                                                         \
   V(WeakProperty_new, 2)                                                       \
   V(WeakProperty_getKey, 1)                                                    \
   V(WeakProperty_getValue, 1)                                                  \
@@ -179,6 +179,10 @@ void ClassFinalizer::VerifyBootstrapClasses() {
   ASSERT(ExternalFloat32Array::InstanceSize() == cls.instance_size());
   cls = object_store->external_float64_array_class();
   ASSERT(ExternalFloat64Array::InstanceSize() == cls.instance_size());
+  cls = object_store->float32x4_class();
+  ASSERT(Float32x4::InstanceSize() == cls.instance_size());
+  cls = object_store->int32x4_class();
+  ASSERT(Int32x4::InstanceSize() == cls.instance_size());
   cls = object_store->weak_property_class();
   ASSERT(WeakProperty::InstanceSize() == cls.instance_size());
 #endif  // defined(DEBUG)
@@ -295,6 +299,8 @@ void ClassFinalizer::ResolveSuperType(const Class& cls) {
       case kExternalFloat32ArrayCid:
       case kFloat64ArrayCid:
       case kExternalFloat64ArrayCid:
+      case kFloat32x4Cid:
+      case kInt32x4Cid:
       case kDartFunctionCid:
       case kWeakPropertyCid:
         is_error = true;
@@ -17,10 +17,12 @@
 #include "vm/object_store.h"
 #include "vm/message.h"
 #include "vm/message_handler.h"
+#include "vm/optimization_queue.h"
 #include "vm/parser.h"
 #include "vm/resolver.h"
 #include "vm/runtime_entry.h"
 #include "vm/stack_frame.h"
+#include "vm/stub_code.h"
 #include "vm/symbols.h"
 #include "vm/verifier.h"
 
@@ -34,6 +36,10 @@ DEFINE_FLAG(bool, trace_deopt, false, "Trace deoptimization");
 DEFINE_FLAG(bool, trace_ic, false, "Trace IC handling");
 DEFINE_FLAG(bool, trace_ic_miss_in_optimized, false,
     "Trace IC miss in optimized code");
+DEFINE_FLAG(int, megamorphic_call_threshold, 16,
+    "Number of receiver classes after which an instance call switches from "
+    "its inline cache to the megamorphic cache of its selector, "
+    "-1 means never");
 DEFINE_FLAG(bool, trace_patching, false, "Trace patching of code.");
 DEFINE_FLAG(bool, trace_runtime_calls, false, "Trace runtime calls");
 DEFINE_FLAG(int, optimization_counter_threshold, 2000,
@@ -45,6 +51,11 @@ DECLARE_FLAG(int, deoptimization_counter_threshold);
 DEFINE_FLAG(charp, optimization_filter, NULL, "Optimize only named function");
 DEFINE_FLAG(bool, trace_failed_optimization_attempts, false,
     "Traces all failed optimization attempts");
+DEFINE_FLAG(bool, trace_osr, false, "Trace on-stack replacement.");
+DECLARE_FLAG(bool, use_osr);
+
+// Usage counter of functions which should not be optimized for a while.
+static const intptr_t kLowInvocationCount = -100000000;
 
 
 DEFINE_RUNTIME_ENTRY(TraceFunctionEntry, 1) {
@@ -872,6 +883,85 @@ DEFINE_RUNTIME_ENTRY(BreakpointDynamicHandler, 0) {
 }
 
 
+// Returns the megamorphic cache shared by the instance calls of the given
+// selector, creating it if it does not exist yet.  Arguments descriptors are
+// canonical, so they are compared by identity like the symbols.
+static RawMegamorphicCache* LookupMegamorphicCache(
+    Isolate* isolate,
+    const String& target_name,
+    const Array& arguments_descriptor) {
+  GrowableObjectArray& table =
+      GrowableObjectArray::Handle(isolate->megamorphic_cache_table());
+  if (table.IsNull()) {
+    table = GrowableObjectArray::New(Heap::kOld);
+    isolate->set_megamorphic_cache_table(table.raw());
+  }
+  MegamorphicCache& cache = MegamorphicCache::Handle();
+  for (intptr_t i = 0; i < table.Length(); i++) {
+    cache ^= table.At(i);
+    if ((cache.target_name() == target_name.raw()) &&
+        (cache.arguments_descriptor() == arguments_descriptor.raw())) {
+      return cache.raw();
+    }
+  }
+  cache = MegamorphicCache::New(target_name, arguments_descriptor);
+  table.Add(cache);
+  return cache.raw();
+}
+
+
+// Switches the one argument instance call at the given return address to
+// the megamorphic lookup stub once its IC data has more checks than
+// FLAG_megamorphic_call_threshold.  The checks are copied into the
+// megamorphic cache of the call's selector and kept as type feedback.
+static void TrySwitchToMegamorphicCall(Isolate* isolate,
+                                       uword return_address,
+                                       const ICData& ic_data) {
+  if ((FLAG_megamorphic_call_threshold < 0) ||
+      (ic_data.num_args_tested() != 1) ||
+      (ic_data.NumberOfChecks() <= FLAG_megamorphic_call_threshold)) {
+    return;
+  }
+  int num_arguments = -1;
+  int num_named_arguments = -1;
+  uword target = 0;
+  CodePatcher::GetInstanceCallAt(return_address,
+                                 NULL,
+                                 &num_arguments,
+                                 &num_named_arguments,
+                                 &target);
+  if (target != StubCode::OneArgCheckInlineCacheEntryPoint()) {
+    // The call is patched, e.g. for a breakpoint.
+    return;
+  }
+  const Array& arguments_descriptor = Array::Handle(
+      CodePatcher::GetInstanceCallArgumentsDescriptorAt(return_address));
+  const String& target_name = String::Handle(ic_data.target_name());
+  const MegamorphicCache& cache = MegamorphicCache::Handle(
+      LookupMegamorphicCache(isolate, target_name, arguments_descriptor));
+  Function& check_target = Function::Handle();
+  for (intptr_t i = 0; i < ic_data.NumberOfChecks(); i++) {
+    const intptr_t class_id = ic_data.GetReceiverClassIdAt(i);
+    if (cache.Lookup(class_id) == Function::null()) {
+      check_target = ic_data.GetTargetAt(i);
+      cache.Insert(class_id, check_target);
+    }
+  }
+  ic_data.set_megamorphic_cache(cache);
+  CodePatcher::PatchInstanceCallAt(return_address,
+                                   StubCode::MegamorphicLookupEntryPoint());
+  if (FLAG_trace_ic) {
+    OS::Print("InlineCacheMissHandler call at %#"Px"' switching to "
+              "megamorphic cache of '%s' after %"Pd" classes, "
+              "%"Pd" classes cached\n",
+        return_address,
+        target_name.ToCString(),
+        ic_data.NumberOfChecks(),
+        cache.filled_entry_count());
+  }
+}
+
+
 static RawFunction* InlineCacheMissHandler(
     Isolate* isolate, const GrowableArray<const Instance*>& args) {
   const Instance& receiver = *args[0];
@@ -939,10 +1029,57 @@ static RawFunction* InlineCacheMissHandler(
         Class::Handle(receiver.clazz()).id(),
         target_function.ToCString());
   }
+  TrySwitchToMegamorphicCall(isolate, caller_frame->pc(), ic_data);
   return target_function.raw();
 }
 
 
+// Handles misses of the megamorphic lookup stub by adding the receiver's
+// class to the megamorphic cache of the call site.
+//   Arg0: Receiver object.
+//   Returns: target function with compiled code or null.
+DEFINE_RUNTIME_ENTRY(MegamorphicCacheMissHandler, 1) {
+  ASSERT(arguments.Count() ==
+      kMegamorphicCacheMissHandlerRuntimeEntry.argument_count());
+  const Instance& receiver = Instance::CheckedHandle(arguments.At(0));
+  const Code& target_code =
+      Code::Handle(ResolveCompileInstanceCallTarget(isolate, receiver));
+  if (target_code.IsNull()) {
+    // Let the megamorphic stub handle special cases: NoSuchMethod,
+    // closure calls.
+    if (FLAG_trace_ic) {
+      OS::Print("MegamorphicCacheMissHandler NULL code for receiver: %s\n",
+          receiver.ToCString());
+    }
+    arguments.SetReturn(Function::Handle());
+    return;
+  }
+  const Function& target_function =
+      Function::Handle(target_code.function());
+  ASSERT(!target_function.IsNull());
+  DartFrameIterator iterator;
+  StackFrame* caller_frame = iterator.NextFrame();
+  ASSERT(caller_frame != NULL);
+  const ICData& ic_data = ICData::Handle(
+      CodePatcher::GetInstanceCallIcDataAt(caller_frame->pc()));
+  ASSERT(ic_data.IsMegamorphic());
+  const MegamorphicCache& cache =
+      MegamorphicCache::Handle(ic_data.megamorphic_cache());
+  const intptr_t class_id = Class::Handle(receiver.clazz()).id();
+  cache.Insert(class_id, target_function);
+  if (FLAG_trace_ic) {
+    OS::Print("MegamorphicCacheMissHandler call at %#"Px"' "
+              "adding <%s> id:%"Pd" -> <%s>, %"Pd" classes cached\n",
+        caller_frame->pc(),
+        Class::Handle(receiver.clazz()).ToCString(),
+        class_id,
+        target_function.ToCString(),
+        cache.filled_entry_count());
+  }
+  arguments.SetReturn(target_function);
+}
+
+
 // Handles inline cache misses by updating the IC data array of the call
 // site.
 //   Arg0: Receiver object.
@@ -1270,6 +1407,88 @@ DEFINE_RUNTIME_ENTRY(ClosureArgumentMismatch, 0) {
 }
 
 
+// Continues the loop running in the unoptimized code of the top frame in
+// optimized code compiled for its stack check (on-stack replacement), if the
+// stack check called the runtime because the loop is hot. The optimized code
+// reuses the frame, in which the variables are at the same stack slots.
+static void AttemptOsr(Isolate* isolate) {
+  DartFrameIterator iterator;
+  StackFrame* frame = iterator.NextFrame();
+  ASSERT(frame != NULL);
+  const Code& code = Code::Handle(frame->LookupDartCode());
+  ASSERT(!code.IsNull());
+  if (code.is_optimized()) {
+    return;
+  }
+  const intptr_t osr_id = code.GetOsrIdAtPc(frame->pc());
+  if (osr_id == Isolate::kNoDeoptId) {
+    // Not a loop stack check counting iterations.
+    return;
+  }
+  const Function& function = Function::Handle(code.function());
+  if (function.usage_counter() < (FLAG_optimization_counter_threshold - 1)) {
+    // The stack check called the runtime for an interrupt.
+    return;
+  }
+  if (isolate->debugger()->IsActive()) {
+    // We cannot set breakpoints in optimized code.
+    function.set_usage_counter(0);
+    return;
+  }
+  if ((function.deoptimization_counter() >=
+       FLAG_deoptimization_counter_threshold) ||
+      !function.is_optimizable() ||
+      ((FLAG_optimization_filter != NULL) &&
+       (strstr(function.ToFullyQualifiedCString(),
+               FLAG_optimization_filter) == NULL))) {
+    function.set_usage_counter(kLowInvocationCount);
+    return;
+  }
+  if (FLAG_trace_osr) {
+    OS::Print("Attempting OSR for '%s' at id %"Pd"\n",
+              function.ToFullyQualifiedCString(), osr_id);
+  }
+  Error& error = Error::Handle();
+  if (!function.HasOptimizedCode()) {
+    // The usage counter also counts the calls of the function, which would
+    // have been optimized at a return otherwise. Optimize it as well, so that
+    // its next invocations do not need on-stack replacement.
+    if (FLAG_deferred_optimization) {
+      isolate->optimization_queue()->Add(function);
+    } else {
+      error = Compiler::CompileOptimizedFunction(function);
+      if (!error.IsNull()) {
+        Exceptions::PropagateError(error);
+      }
+      if (!function.is_optimizable()) {
+        // The optimizer bailed out.
+        function.set_usage_counter(kLowInvocationCount);
+        return;
+      }
+    }
+  }
+  const Code& original_code = Code::Handle(function.CurrentCode());
+  error = Compiler::CompileOptimizedFunction(function, osr_id);
+  if (!error.IsNull()) {
+    Exceptions::PropagateError(error);
+  }
+  function.set_usage_counter(0);
+  const Code& osr_code = Code::Handle(function.CurrentCode());
+  if (osr_code.raw() == original_code.raw()) {
+    // The optimizer bailed out.
+    return;
+  }
+  ASSERT(osr_code.is_optimized());
+  // The OSR code cannot be called, restore the code of the function.
+  function.SetCode(original_code);
+  // Return into the optimized code, which marks the frame as its own. Nothing
+  // may allocate from here on, the frame would not match its stackmaps.
+  frame->SetEntrypointMarker(
+      osr_code.EntryPoint() + AssemblerMacros::kOffsetOfSavedPCfromEntrypoint);
+  frame->set_pc(osr_code.EntryPoint());
+}
+
+
 DEFINE_RUNTIME_ENTRY(StackOverflow, 0) {
   ASSERT(arguments.Count() ==
          kStackOverflowRuntimeEntry.argument_count());
@@ -1296,17 +1515,21 @@ DEFINE_RUNTIME_ENTRY(StackOverflow, 0) {
   if (interrupt_bits & Isolate::kMessageInterrupt) {
     isolate->message_handler()->HandleOOBMessages();
   }
+  if (interrupt_bits & Isolate::kOptimizeInterrupt) {
+    isolate->optimization_queue()->OptimizeNext();
+  }
   if (interrupt_bits & Isolate::kApiInterrupt) {
     Dart_IsolateInterruptCallback callback = isolate->InterruptCallback();
     if (callback) {
-      if ((*callback)()) {
-        return;
-      } else {
+      if (!(*callback)()) {
         // TODO(turnidge): Unwind the stack.
         UNIMPLEMENTED();
       }
     }
   }
+  if (FLAG_use_osr) {
+    AttemptOsr(isolate);
+  }
 }
 
 
@@ -1335,7 +1558,6 @@ static void PrintCaller(const char* msg) {
 // Once the invocation counter threshold is reached any entry into the
 // unoptimized code is redirected to this function.
 DEFINE_RUNTIME_ENTRY(OptimizeInvokedFunction, 1) {
-  const intptr_t kLowInvocationCount = -100000000;
   ASSERT(arguments.Count() ==
          kOptimizeInvokedFunctionRuntimeEntry.argument_count());
   const Function& function = Function::CheckedHandle(arguments.At(0));
@@ -1372,7 +1594,12 @@ DEFINE_RUNTIME_ENTRY(OptimizeInvokedFunction, 1) {
     function.set_usage_counter(kLowInvocationCount);
     return;
   }
-  if (function.is_optimizable()) {
+  if (function.is_optimizable() && FLAG_deferred_optimization) {
+    // Keep running the unoptimized code until the function is optimized at
+    // a later safe point.
+    isolate->optimization_queue()->Add(function);
+    function.set_usage_counter(0);
+  } else if (function.is_optimizable()) {
     // Compilation patches the entry of unoptimized code.
     ASSERT(!function.HasOptimizedCode());
     const Error& error =
@@ -1504,11 +1731,13 @@ void DeoptimizeAll() {
 
 // Copy saved registers into the isolate buffer.
 static void CopySavedRegisters(uword saved_registers_address) {
-  double* xmm_registers_copy = new double[kNumberOfXmmRegisters];
+  simd128_value_t* xmm_registers_copy =
+      new simd128_value_t[kNumberOfXmmRegisters];
   ASSERT(xmm_registers_copy != NULL);
   for (intptr_t i = 0; i < kNumberOfXmmRegisters; i++) {
-    xmm_registers_copy[i] = *reinterpret_cast<double*>(saved_registers_address);
-    saved_registers_address += kDoubleSize;
+    xmm_registers_copy[i] =
+        *reinterpret_cast<simd128_value_t*>(saved_registers_address);
+    saved_registers_address += kQuadSize;
   }
   Isolate::Current()->set_deopt_xmm_registers_copy(xmm_registers_copy);
 
@@ -1560,7 +1789,7 @@ DEFINE_LEAF_RUNTIME_ENTRY(intptr_t, DeoptimizeCopyFrame,
 
   // All registers have been saved below last-fp.
   const uword last_fp = saved_registers_address +
-      kNumberOfCpuRegisters * kWordSize + kNumberOfXmmRegisters * kDoubleSize;
+      kNumberOfCpuRegisters * kWordSize + kNumberOfXmmRegisters * kQuadSize;
   CopySavedRegisters(saved_registers_address);
 
   // Get optimized code and frame that need to be deoptimized.
@@ -1666,7 +1895,7 @@ DEFINE_LEAF_RUNTIME_ENTRY(void, DeoptimizeFillFrame, uword last_fp) {
 
   intptr_t* frame_copy = isolate->deopt_frame_copy();
   intptr_t* cpu_registers_copy = isolate->deopt_cpu_registers_copy();
-  double* xmm_registers_copy = isolate->deopt_xmm_registers_copy();
+  simd128_value_t* xmm_registers_copy = isolate->deopt_xmm_registers_copy();
 
   intptr_t deopt_id, deopt_reason, deopt_index;
   GetDeoptIxDescrAtPc(optimized_code, caller_frame->pc(),
@@ -1711,8 +1940,40 @@ DEFINE_LEAF_RUNTIME_ENTRY(void, DeoptimizeFillFrame, uword last_fp) {
 END_LEAF_RUNTIME_ENTRY
 
 
-DEFINE_RUNTIME_ENTRY(DeoptimizeMaterializeDoubles, 0) {
-  DeferredDouble* deferred_double = Isolate::Current()->DetachDeferredDoubles();
+// Allocates a Float32x4 or Int32x4 holding the value.
+static RawInstance* NewSimd128(intptr_t class_id,
+                               const simd128_value_t& value) {
+  if (class_id == kFloat32x4Cid) {
+    return Float32x4::New(value);
+  }
+  ASSERT(class_id == kInt32x4Cid);
+  return Int32x4::New(value);
+}
+
+
+// Allocates the doubles, mints, vectors and objects whose allocation was
+// deferred while filling the unoptimized frame, and stores them into their
+// frame slots.
+DEFINE_RUNTIME_ENTRY(DeoptimizeMaterialize, 0) {
+  // The fields of the deferred objects were copied from the optimized frame
+  // and are not visited by the GC: handle them before allocating.
+  DeferredObject* deferred_object = isolate->DetachDeferredObjects();
+  GrowableArray<const Array*> descriptors;
+  GrowableArray<const Object*> field_values;
+  for (DeferredObject* current = deferred_object;
+       current != NULL;
+       current = current->next()) {
+    descriptors.Add(&Array::Handle(current->descriptor()));
+    for (intptr_t i = 0; i < current->field_count(); i++) {
+      field_values.Add(
+          (current->IsDoubleFieldAt(i) ||
+           current->IsMintFieldAt(i) ||
+           current->IsSimd128FieldAt(i)) ?
+              NULL : &Object::Handle(current->FieldAt(i)));
+    }
+  }
+
+  DeferredDouble* deferred_double = isolate->DetachDeferredDoubles();
 
   while (deferred_double != NULL) {
     DeferredDouble* current = deferred_double;
@@ -1729,6 +1990,91 @@ DEFINE_RUNTIME_ENTRY(DeoptimizeMaterializeDoubles, 0) {
 
     delete current;
   }
+
+  DeferredMint* deferred_mint = isolate->DetachDeferredMints();
+
+  while (deferred_mint != NULL) {
+    DeferredMint* current = deferred_mint;
+    deferred_mint = deferred_mint->next();
+
+    RawMint** slot = current->slot();
+    ASSERT(!Smi::IsValid64(current->value()));
+    *slot = Mint::New(current->value());
+
+    if (FLAG_trace_deopt) {
+      OS::Print("materializing mint at %p: %"Pd64"\n",
+                current->slot(),
+                current->value());
+    }
+
+    delete current;
+  }
+
+  DeferredSimd128* deferred_simd128 = isolate->DetachDeferredSimd128s();
+
+  while (deferred_simd128 != NULL) {
+    DeferredSimd128* current = deferred_simd128;
+    deferred_simd128 = deferred_simd128->next();
+
+    *current->slot() = NewSimd128(current->class_id(), current->value());
+
+    if (FLAG_trace_deopt) {
+      OS::Print("materializing vector at %p\n", current->slot());
+    }
+
+    delete current;
+  }
+
+  // Slots referring to the same descriptor get the same object.
+  GrowableArray<const Instance*> instances;
+  Class& cls = Class::Handle();
+  Field& field = Field::Handle();
+  intptr_t field_index = 0;
+  for (intptr_t i = 0; deferred_object != NULL; i++) {
+    DeferredObject* current = deferred_object;
+    deferred_object = deferred_object->next();
+
+    const Array& descriptor = *descriptors[i];
+    const Instance* instance = NULL;
+    for (intptr_t j = 0; j < i; j++) {
+      if (descriptors[j]->raw() == descriptor.raw()) {
+        instance = instances[j];
+        break;
+      }
+    }
+    if (instance == NULL) {
+      cls ^= descriptor.At(0);
+      instance = &Instance::Handle(Instance::New(cls));
+      for (intptr_t k = 0; k < current->field_count(); k++) {
+        field ^= descriptor.At(1 + 3 * k);
+        if (current->IsDoubleFieldAt(k)) {
+          instance->SetField(field, Double::Handle(
+              Double::New(current->DoubleFieldAt(k))));
+        } else if (current->IsMintFieldAt(k)) {
+          instance->SetField(field, Integer::Handle(
+              Integer::New(current->MintFieldAt(k))));
+        } else if (current->IsSimd128FieldAt(k)) {
+          instance->SetField(field, Instance::Handle(
+              NewSimd128(current->Simd128FieldClassIdAt(k),
+                         current->Simd128FieldAt(k))));
+        } else {
+          instance->SetField(field, *field_values[field_index + k]);
+        }
+      }
+    }
+    instances.Add(instance);
+    field_index += current->field_count();
+
+    *current->slot() = instance->raw();
+
+    if (FLAG_trace_deopt) {
+      OS::Print("materializing object at %p: %s\n",
+                current->slot(),
+                instance->ToCString());
+    }
+
+    delete current;
+  }
 }
 
 
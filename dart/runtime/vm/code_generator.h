@@ -33,6 +33,7 @@ DECLARE_RUNTIME_ENTRY(Instanceof);
 DECLARE_RUNTIME_ENTRY(InstantiateTypeArguments);
 DECLARE_RUNTIME_ENTRY(InvokeImplicitClosureFunction);
 DECLARE_RUNTIME_ENTRY(InvokeNoSuchMethodFunction);
+DECLARE_RUNTIME_ENTRY(MegamorphicCacheMissHandler);
 DECLARE_RUNTIME_ENTRY(OptimizeInvokedFunction);
 DECLARE_RUNTIME_ENTRY(PatchStaticCall);
 DECLARE_RUNTIME_ENTRY(ReportObjectNotClosure);
@@ -44,7 +45,7 @@ DECLARE_RUNTIME_ENTRY(StackOverflow);
 DECLARE_RUNTIME_ENTRY(Throw);
 DECLARE_RUNTIME_ENTRY(TraceFunctionEntry);
 DECLARE_RUNTIME_ENTRY(TraceFunctionExit);
-DECLARE_RUNTIME_ENTRY(DeoptimizeMaterializeDoubles);
+DECLARE_RUNTIME_ENTRY(DeoptimizeMaterialize);
 
 #define DEOPT_REASONS(V)                                                       \
   V(DeoptUnknown)                                                              \
@@ -62,6 +63,7 @@ DECLARE_RUNTIME_ENTRY(DeoptimizeMaterializeDoubles);
   V(DeoptDoubleToDouble)                                                       \
   V(DeoptBinarySmiOp)                                                          \
   V(DeoptBinaryMintOp)                                                         \
+  V(DeoptUnboxInteger)                                                         \
   V(DeoptBinaryDoubleOp)                                                       \
   V(DeoptInstanceSetterSameTarget)                                             \
   V(DeoptInstanceSetter)                                                       \
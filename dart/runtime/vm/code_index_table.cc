@@ -0,0 +1,57 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/code_index_table.h"
+
+#include <algorithm>
+
+#include "platform/assert.h"
+#include "vm/object.h"
+#include "vm/raw_object.h"
+
+namespace dart {
+
+void CodeIndexTable::Add(const Instructions& instructions) {
+  ASSERT(instructions.raw()->IsOldObject());
+  Entry entry;
+  entry.start = instructions.EntryPoint();
+  entry.end = entry.start + instructions.size();
+  entry.instructions = instructions.raw();
+  // Code is mostly allocated at increasing addresses, appending is the
+  // common case.
+  std::vector<Entry>::iterator it =
+      std::lower_bound(entries_.begin(), entries_.end(), entry.start,
+                       StartsBefore);
+  ASSERT((it == entries_.end()) || (entry.end <= it->start));
+  ASSERT((it == entries_.begin()) || ((it - 1)->end <= entry.start));
+  entries_.insert(it, entry);
+}
+
+
+RawInstructions* CodeIndexTable::Lookup(uword pc) const {
+  // Find the last range starting at or below the pc.
+  std::vector<Entry>::const_iterator it =
+      std::upper_bound(entries_.begin(), entries_.end(), pc, StartsAfter);
+  if (it == entries_.begin()) {
+    return Instructions::null();
+  }
+  --it;
+  if (pc >= it->end) {
+    return Instructions::null();
+  }
+  return it->instructions;
+}
+
+
+void CodeIndexTable::RemoveUnmarked() {
+  size_t length = 0;
+  for (size_t i = 0; i < entries_.size(); i++) {
+    if (entries_[i].instructions->IsMarked()) {
+      entries_[length++] = entries_[i];
+    }
+  }
+  entries_.resize(length);
+}
+
+}  // namespace dart
@@ -0,0 +1,63 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_CODE_INDEX_TABLE_H_
+#define VM_CODE_INDEX_TABLE_H_
+
+#include <vector>
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+// Forward declarations.
+class Instructions;
+class RawInstructions;
+
+// The CodeIndexTable maps program counters to the instructions of the code
+// space of a heap containing them. The address ranges of the instructions
+// are kept sorted, so that a lookup is a binary search instead of a walk
+// over the code space. Instructions are added by Code::FinalizeCode and
+// removed by the collections of the code space, which never moves objects.
+// The table does not keep the instructions alive.
+class CodeIndexTable {
+ public:
+  CodeIndexTable() : entries_() {}
+  ~CodeIndexTable() {}
+
+  void Add(const Instructions& instructions);
+
+  // Returns the instructions containing 'pc', or Instructions::null().
+  RawInstructions* Lookup(uword pc) const;
+
+  // Removes the instructions which are not marked, called by a collection of
+  // the code space before it is swept.
+  void RemoveUnmarked();
+
+  intptr_t Length() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    uword start;
+    uword end;
+    RawInstructions* instructions;
+  };
+
+  static bool StartsBefore(const Entry& entry, uword pc) {
+    return entry.start < pc;
+  }
+  static bool StartsAfter(uword pc, const Entry& entry) {
+    return pc < entry.start;
+  }
+
+  // Sorted by start address, the ranges do not overlap.
+  std::vector<Entry> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(CodeIndexTable);
+};
+
+}  // namespace dart
+
+#endif  // VM_CODE_INDEX_TABLE_H_
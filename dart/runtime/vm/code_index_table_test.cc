@@ -0,0 +1,74 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/assert.h"
+#include "vm/code_index_table.h"
+#include "vm/heap.h"
+#include "vm/object.h"
+#include "vm/symbols.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+// Compiler only implemented on IA32 and x64 now.
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
+
+static void CheckLookup(CodeIndexTable* table, const Code& code) {
+  const Instructions& instructions =
+      Instructions::Handle(code.instructions());
+  uword start = instructions.EntryPoint();
+  uword end = start + instructions.size();
+  EXPECT(table->Lookup(start) == instructions.raw());
+  EXPECT(table->Lookup(start + (instructions.size() / 2)) ==
+         instructions.raw());
+  EXPECT(table->Lookup(end - 1) == instructions.raw());
+  EXPECT(table->Lookup(end) != instructions.raw());
+  // The header of the instructions is not part of the code.
+  EXPECT(table->Lookup(start - 1) == Instructions::null());
+  EXPECT(Code::LookupCode(start) == code.raw());
+}
+
+
+TEST_CASE(CodeIndexTable) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static foo(x) => x + 1;\n"
+      "  static bar(x) => foo(x) * 2;\n"
+      "}\n"
+      "main() {\n"
+      "  var sum = 0;\n"
+      "  for (var i = 0; i < 100; i++) {\n"
+      "    sum += A.bar(i);\n"
+      "  }\n"
+      "  return sum;\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, Dart_NewString("main"), 0, NULL));
+
+  CodeIndexTable* table = Isolate::Current()->heap()->code_index_table();
+  EXPECT_LT(0, table->Length());
+  EXPECT(table->Lookup(0) == Instructions::null());
+  EXPECT(table->Lookup(reinterpret_cast<uword>(&table)) ==
+         Instructions::null());
+
+  const String& name = String::Handle(String::New(TestCase::url()));
+  const Library& library = Library::Handle(Library::LookupLibrary(name));
+  const Class& cls = Class::Handle(
+      library.LookupClass(String::Handle(Symbols::New("A"))));
+  EXPECT(!cls.IsNull());
+  Function& function = Function::Handle();
+  Code& code = Code::Handle();
+  function = cls.LookupStaticFunction(String::Handle(Symbols::New("foo")));
+  EXPECT(function.HasCode());
+  code = function.CurrentCode();
+  CheckLookup(table, code);
+  function = cls.LookupStaticFunction(String::Handle(Symbols::New("bar")));
+  EXPECT(function.HasCode());
+  code = function.CurrentCode();
+  CheckLookup(table, code);
+}
+
+#endif  // TARGET_ARCH_IA32 || TARGET_ARCH_X64
+
+}  // namespace dart
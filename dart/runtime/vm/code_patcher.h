@@ -57,6 +57,8 @@ class CodePatcher : public AllStatic {
 
   static RawICData* GetInstanceCallIcDataAt(uword return_address);
 
+  static RawArray* GetInstanceCallArgumentsDescriptorAt(uword return_address);
+
   static intptr_t InstanceCallSizeInBytes();
 
   static void InsertCallAt(uword start, uword target);
@@ -63,6 +63,13 @@ RawICData* CodePatcher::GetInstanceCallIcDataAt(uword return_address) {
 }
 
 
+RawArray* CodePatcher::GetInstanceCallArgumentsDescriptorAt(
+    uword return_address) {
+  UNIMPLEMENTED();
+  return NULL;
+}
+
+
 
 void CodePatcher::InsertCallAt(uword start, uword target) {
   UNIMPLEMENTED();
@@ -62,6 +62,12 @@ class DartCallPattern : public ValueObject {
     return *reinterpret_cast<uint32_t*>(start_ + kInstructionSize + 1);
   }
 
+  RawArray* arguments_descriptor() const {
+    Array& args_desc = Array::Handle();
+    args_desc ^= reinterpret_cast<RawObject*>(immediate_two());
+    return args_desc.raw();
+  }
+
   int argument_count() const {
     Array& args_desc = Array::Handle();
     args_desc ^= reinterpret_cast<RawObject*>(immediate_two());
@@ -255,6 +261,13 @@ RawICData* CodePatcher::GetInstanceCallIcDataAt(uword return_address) {
 }
 
 
+RawArray* CodePatcher::GetInstanceCallArgumentsDescriptorAt(
+    uword return_address) {
+  InstanceCall call(return_address);
+  return call.arguments_descriptor();
+}
+
+
 intptr_t CodePatcher::InstanceCallSizeInBytes() {
   return DartCallPattern::kNumInstructions * DartCallPattern::kInstructionSize;
 }
@@ -64,6 +64,12 @@ class DartCallPattern : public ValueObject {
     return *reinterpret_cast<uint64_t*>(start_ + 10 + 2);
   }
 
+  RawArray* arguments_descriptor() const {
+    Array& args_desc = Array::Handle();
+    args_desc ^= reinterpret_cast<RawObject*>(immediate_two());
+    return args_desc.raw();
+  }
+
   int argument_count() const {
     Array& args_desc = Array::Handle();
     args_desc ^= reinterpret_cast<RawObject*>(immediate_two());
@@ -237,6 +243,13 @@ RawICData* CodePatcher::GetInstanceCallIcDataAt(uword return_address) {
 }
 
 
+RawArray* CodePatcher::GetInstanceCallArgumentsDescriptorAt(
+    uword return_address) {
+  InstanceCall call(return_address);
+  return call.arguments_descriptor();
+}
+
+
 intptr_t CodePatcher::InstanceCallSizeInBytes() {
   return DartCallPattern::kCallPatternSize;
 }
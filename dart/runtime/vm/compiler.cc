@@ -37,10 +37,18 @@ DEFINE_FLAG(bool, trace_bailout, false, "Print bailout from ssa compiler.");
 DEFINE_FLAG(bool, trace_compiler, false, "Trace compiler operations.");
 DEFINE_FLAG(bool, cse, true, "Do common subexpression elimination.");
 DEFINE_FLAG(bool, licm, true, "Do loop invariant code motion.");
+DEFINE_FLAG(bool, range_analysis, true, "Enable range analysis");
+DEFINE_FLAG(bool, vectorize_loops, true,
+    "Vectorize simple loops over typed arrays.");
+DEFINE_FLAG(bool, allocation_sinking, true,
+    "Sink allocations of objects which do not escape.");
 DEFINE_FLAG(int, deoptimization_counter_threshold, 5,
     "How many times we allow deoptimization before we disallow"
     " certain optimizations");
 DEFINE_FLAG(bool, use_inlining, true, "Enable call-site inlining");
+DEFINE_FLAG(bool, use_osr, true,
+    "Count the iterations of loops in unoptimized code and continue hot "
+    "loops in optimized code (on-stack replacement).");
 DECLARE_FLAG(bool, print_flow_graph);
 
 
@@ -125,7 +133,8 @@ static void InstallUnoptimizedCode(const Function& function) {
 
 // Return false if bailed out.
 static bool CompileParsedFunctionHelper(const ParsedFunction& parsed_function,
-                                        bool optimized) {
+                                        bool optimized,
+                                        intptr_t osr_id) {
   TimerScope timer(FLAG_compiler_stats, &CompilerStats::codegen_timer);
   bool is_compiled = false;
   Isolate* isolate = Isolate::Current();
@@ -145,9 +154,11 @@ static bool CompileParsedFunctionHelper(const ParsedFunction& parsed_function,
                        isolate);
       if (optimized) {
         // Transition to optimized code only from unoptimized code ...
-        // for now.
+        // for now. A function running in an unoptimized frame may already
+        // have optimized code when it is compiled for on-stack replacement.
         ASSERT(parsed_function.function().HasCode());
-        ASSERT(!parsed_function.function().HasOptimizedCode());
+        ASSERT((osr_id != Isolate::kNoDeoptId) ||
+               !parsed_function.function().HasOptimizedCode());
         // Extract type feedback before the graph is built, as the graph
         // builder uses it to attach it to nodes.
         // Do not use type feedback to optimize a function that was
@@ -162,7 +173,7 @@ static bool CompileParsedFunctionHelper(const ParsedFunction& parsed_function,
       }
 
       // Build the flow graph.
-      FlowGraphBuilder builder(parsed_function);
+      FlowGraphBuilder builder(parsed_function, osr_id);
       flow_graph = builder.BuildGraph(FlowGraphBuilder::kNotInlining);
 
       // Transform to SSA.
@@ -217,9 +228,28 @@ static bool CompileParsedFunctionHelper(const ParsedFunction& parsed_function,
           flow_graph->ComputeUseLists();
           DominatorBasedCSE::Optimize(flow_graph->graph_entry());
         }
+        if (FLAG_range_analysis) {
+          // Remove the bounds and overflow checks proven redundant.
+          flow_graph->ComputeUseLists();
+          RangeAnalysis range_analysis(flow_graph);
+          range_analysis.Analyze();
+          flow_graph->ComputeUseLists();
+        }
         if (FLAG_licm) {
           LICM::Optimize(flow_graph);
         }
+        if (FLAG_vectorize_loops) {
+          // Process the elements of typed arrays in xmm registers.
+          flow_graph->ComputeUseLists();
+          LoopVectorizer vectorizer(flow_graph);
+          vectorizer.Optimize();
+        }
+        if (FLAG_allocation_sinking) {
+          // Remove the allocations of objects which do not escape.
+          flow_graph->ComputeUseLists();
+          AllocationSinking sinking(flow_graph);
+          sinking.Optimize();
+        }
 
         // Perform register allocation on the SSA graph.
         FlowGraphAllocator allocator(*flow_graph);
@@ -265,10 +295,14 @@ static bool CompileParsedFunctionHelper(const ParsedFunction& parsed_function,
       graph_compiler.FinalizeComments(code);
       if (optimized) {
         function.SetCode(code);
-        CodePatcher::PatchEntry(Code::Handle(function.unoptimized_code()));
-        if (FLAG_trace_compiler) {
-          OS::Print("--> patching entry %#"Px"\n",
-                    Code::Handle(function.unoptimized_code()).EntryPoint());
+        // Code compiled for on-stack replacement cannot be called, the caller
+        // installs the previous code again.
+        if (osr_id == Isolate::kNoDeoptId) {
+          CodePatcher::PatchEntry(Code::Handle(function.unoptimized_code()));
+          if (FLAG_trace_compiler) {
+            OS::Print("--> patching entry %#"Px"\n",
+                      Code::Handle(function.unoptimized_code()).EntryPoint());
+          }
         }
       } else {
         function.set_unoptimized_code(code);
@@ -398,7 +432,8 @@ static void DisassembleCode(const Function& function, bool optimized) {
 
 
 static RawError* CompileFunctionHelper(const Function& function,
-                                       bool optimized) {
+                                       bool optimized,
+                                       intptr_t osr_id) {
   Isolate* isolate = Isolate::Current();
   LongJump* base = isolate->long_jump_base();
   LongJump jump;
@@ -413,16 +448,17 @@ static RawError* CompileFunctionHelper(const Function& function,
     TIMERSCOPE(time_compilation);
     ParsedFunction parsed_function(function);
     if (FLAG_trace_compiler) {
-      OS::Print("Compiling %sfunction: '%s' @ token %"Pd"\n",
+      OS::Print("Compiling %sfunction: '%s' @ token %"Pd"%s\n",
                 (optimized ? "optimized " : ""),
                 function.ToFullyQualifiedCString(),
-                function.token_pos());
+                function.token_pos(),
+                (osr_id != Isolate::kNoDeoptId) ? " for OSR" : "");
     }
     Parser::ParseFunction(&parsed_function);
     parsed_function.AllocateVariables();
 
     const bool success =
-        CompileParsedFunctionHelper(parsed_function, optimized);
+        CompileParsedFunctionHelper(parsed_function, optimized, osr_id);
     if (optimized && !success) {
       // Optimizer bailed out. Disable optimizations and to never try again.
       if (FLAG_trace_compiler) {
@@ -469,12 +505,15 @@ static RawError* CompileFunctionHelper(const Function& function,
 
 
 RawError* Compiler::CompileFunction(const Function& function) {
-  return CompileFunctionHelper(function, false);  // Non-optimized.
+  return CompileFunctionHelper(function,
+                               false,  // Non-optimized.
+                               Isolate::kNoDeoptId);
 }
 
 
-RawError* Compiler::CompileOptimizedFunction(const Function& function) {
-  return CompileFunctionHelper(function, true);  // Optimized.
+RawError* Compiler::CompileOptimizedFunction(const Function& function,
+                                             intptr_t osr_id) {
+  return CompileFunctionHelper(function, true, osr_id);  // Optimized.
 }
 
 
@@ -486,7 +525,7 @@ RawError* Compiler::CompileParsedFunction(
   isolate->set_long_jump_base(&jump);
   if (setjmp(*jump.Set()) == 0) {
     // Non-optimized code generator.
-    CompileParsedFunctionHelper(parsed_function, false);
+    CompileParsedFunctionHelper(parsed_function, false, Isolate::kNoDeoptId);
     isolate->set_long_jump_base(base);
     return Error::null();
   } else {
@@ -563,7 +602,7 @@ RawObject* Compiler::ExecuteOnce(SequenceNode* fragment) {
     parsed_function.AllocateVariables();
 
     // Non-optimized code generator.
-    CompileParsedFunctionHelper(parsed_function, false);
+    CompileParsedFunctionHelper(parsed_function, false, Isolate::kNoDeoptId);
 
     GrowableArray<const Object*> arguments;  // no arguments.
     const Array& kNoArgumentNames = Array::Handle();
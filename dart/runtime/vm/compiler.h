@@ -37,8 +37,15 @@ class Compiler : public AllStatic {
 
   // Generates optimized code for function.
   //
+  // If 'osr_id' is not Isolate::kNoDeoptId, the code is entered at the stack
+  // check of a loop in a frame of the unoptimized code (on-stack
+  // replacement). It is set as the code of the function and the caller must
+  // install the previous code again.
+  //
   // Returns Error::null() if there is no compilation error.
-  static RawError* CompileOptimizedFunction(const Function& function);
+  static RawError* CompileOptimizedFunction(
+      const Function& function,
+      intptr_t osr_id = Isolate::kNoDeoptId);
 
   // Generates code for given parsed function (without parsing it again) and
   // sets its code field.
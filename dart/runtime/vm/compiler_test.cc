@@ -4,13 +4,18 @@
 
 #include "platform/assert.h"
 #include "vm/class_finalizer.h"
+#include "vm/code_patcher.h"
 #include "vm/compiler.h"
+#include "vm/dart_api_impl.h"
 #include "vm/object.h"
+#include "vm/stack_frame.h"
 #include "vm/symbols.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
+DECLARE_FLAG(bool, deferred_optimization);
+
 // Compiler only implemented on IA32 and X64 now.
 #if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
 
@@ -65,6 +70,644 @@ TEST_CASE(CompileFunction) {
   EXPECT(function_moo.HasCode());
 }
 
+
+
+static void IsOptimizedCaller(Dart_NativeArguments args) {
+  Dart_EnterScope();
+  DartFrameIterator iterator;
+  StackFrame* frame = iterator.NextFrame();  // The native function.
+  frame = iterator.NextFrame();
+  EXPECT(frame != NULL);
+  const Code& code = Code::Handle(frame->LookupDartCode());
+  Dart_SetReturnValue(args, Dart_NewBoolean(code.is_optimized()));
+  Dart_ExitScope();
+}
+
+
+static Dart_NativeFunction native_resolver(Dart_Handle name,
+                                           int argument_count) {
+  return reinterpret_cast<Dart_NativeFunction>(&IsOptimizedCaller);
+}
+
+
+TEST_CASE(OnStackReplacement) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static bool isOptimizedCaller() native 'IsOptimizedCaller';\n"
+      "}\n"
+      "main() {\n"
+      "  var sum = 0;\n"
+      "  var s = '';\n"
+      "  for (var i = 0; i < 100000; i++) {\n"
+      "    sum += i % 7;\n"
+      "    s = '$i';\n"
+      "  }\n"
+      "  if (!A.isOptimizedCaller()) return -1;\n"
+      "  return sum + s.length;\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, native_resolver);
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  // The loop continued in optimized code.
+  EXPECT_EQ(300000, value);
+
+  // The function was optimized as well, as its next invocations should not
+  // need on-stack replacement.
+  const String& url = String::Handle(String::New(TestCase::url()));
+  const Library& library = Library::Handle(Library::LookupLibrary(url));
+  const Function& function = Function::Handle(
+      library.LookupLocalFunction(String::Handle(Symbols::New("main"))));
+  EXPECT(!function.IsNull());
+  EXPECT(function.HasOptimizedCode());
+}
+
+
+// Loads the script and checks the result of its function 'main', which is
+// expected to be optimized while it runs.
+static void RunOptimizedMain(const char* script, int64_t expected) {
+  // Deferred optimizations may not have happened by the time main returns.
+  const bool saved_deferred_optimization = FLAG_deferred_optimization;
+  FLAG_deferred_optimization = false;
+  Dart_Handle lib = TestCase::LoadTestScript(script, NULL);
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("main"), 0, NULL);
+  FLAG_deferred_optimization = saved_deferred_optimization;
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(expected, value);
+}
+
+
+// Returns true if the optimized code of the top level function 'caller' of
+// the test script calls a function named 'callee', that is if the calls to
+// 'callee' were not inlined.
+static bool OptimizedCodeCalls(const char* caller, const char* callee) {
+  const String& url = String::Handle(String::New(TestCase::url()));
+  const Library& library = Library::Handle(Library::LookupLibrary(url));
+  const Function& function = Function::Handle(
+      library.LookupLocalFunction(String::Handle(Symbols::New(caller))));
+  EXPECT(!function.IsNull());
+  EXPECT(function.HasOptimizedCode());
+  const Code& code = Code::Handle(function.CurrentCode());
+  const PcDescriptors& descriptors =
+      PcDescriptors::Handle(code.pc_descriptors());
+  const String& callee_name = String::Handle(Symbols::New(callee));
+  Function& target = Function::Handle();
+  String& target_name = String::Handle();
+  for (intptr_t i = 0; i < descriptors.Length(); i++) {
+    uword target_address = 0;
+    switch (descriptors.DescriptorKind(i)) {
+      case PcDescriptors::kIcCall: {
+        int num_arguments = 0;
+        int num_named_arguments = 0;
+        CodePatcher::GetInstanceCallAt(descriptors.PC(i),
+                                       &target_name,
+                                       &num_arguments,
+                                       &num_named_arguments,
+                                       &target_address);
+        break;
+      }
+      case PcDescriptors::kFuncCall:
+        CodePatcher::GetStaticCallAt(descriptors.PC(i),
+                                     &target,
+                                     &target_address);
+        target_name = target.name();
+        break;
+      default:
+        continue;
+    }
+    if (target_name.Equals(callee_name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+TEST_CASE(InlineControlFlow) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static pick(c, x, y) {\n"
+      "    if (c) return x;\n"
+      "    return y;\n"
+      "  }\n"
+      "  static choose(c, x) => pick(c, x, 0);\n"
+      "  static select(c, x, y) => c ? x : y;\n"
+      "}\n"
+      "main() {\n"
+      "  var sum = 0;\n"
+      "  for (var i = 0; i < 10000; i++) {\n"
+      "    if ((i % 4) == 0) {\n"
+      "      var c = (i % 8) == 0;\n"
+      "      sum += A.choose(c, i) + A.select(c, 1, 2);\n"
+      "    }\n"
+      "  }\n"
+      "  return sum;\n"
+      "}\n";
+  RunOptimizedMain(kScriptChars, 6248750);
+  // The callees were inlined, 'pick' into 'choose' first.
+  EXPECT(!OptimizedCodeCalls("main", "choose"));
+  EXPECT(!OptimizedCodeCalls("main", "pick"));
+  EXPECT(!OptimizedCodeCalls("main", "select"));
+}
+
+
+TEST_CASE(InlinePolymorphicCall) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  f(c) => c ? 1 : 2;\n"
+      "}\n"
+      "class B {\n"
+      "  f(c) => 3;\n"
+      "}\n"
+      "class C {\n"
+      "  f(c) {\n"
+      "    if (c) return 4;\n"
+      "    return 5;\n"
+      "  }\n"
+      "}\n"
+      "main() {\n"
+      "  var objects = [new A(), new B(), new B(), new C()];\n"
+      "  var sum = 0;\n"
+      "  for (var i = 0; i < 10000; i++) {\n"
+      "    sum += objects[i % 4].f((i % 8) == 0);\n"
+      "  }\n"
+      "  return sum;\n"
+      "}\n";
+  RunOptimizedMain(kScriptChars, 31250);
+  // The targets were inlined behind tests of the class of the receiver.
+  EXPECT(!OptimizedCodeCalls("main", "f"));
+}
+
+
+TEST_CASE(InlineOptionalParameters) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static second(x, [y = 2]) => y;\n"
+      "}\n"
+      "class B {\n"
+      "  pick(c, [a = 5, b = 6]) => c ? a : b;\n"
+      "}\n"
+      "main() {\n"
+      "  var b = new B();\n"
+      "  var sum = 0;\n"
+      "  for (var i = 0; i < 10000; i++) {\n"
+      "    var c = (i % 2) == 0;\n"
+      "    sum += A.second(i) + A.second(i, 1) + b.pick(c) +\n"
+      "        b.pick(c, 7) + b.pick(c, b: 10) + b.pick(c, b: 8, a: 9);\n"
+      "  }\n"
+      "  return sum;\n"
+      "}\n";
+  RunOptimizedMain(kScriptChars, 310000);
+  // The callees were inlined with the arguments matched to their parameters.
+  EXPECT(!OptimizedCodeCalls("main", "second"));
+  EXPECT(!OptimizedCodeCalls("main", "pick"));
+}
+
+TEST_CASE(RangeAnalysis) {
+  const char* kScriptChars =
+      "sum(a) {\n"
+      "  var s = 0;\n"
+      "  for (var i = 0; i < a.length; i++) {\n"
+      "    s += a[i];\n"
+      "  }\n"
+      "  for (var j = a.length - 1; j >= 0; j--) {\n"
+      "    s -= a[j] & 1;\n"
+      "  }\n"
+      "  return s;\n"
+      "}\n"
+      "sumTo(a, n) {\n"
+      "  var s = 0;\n"
+      "  for (var i = 0; i < n; i++) s += a[i];\n"
+      "  return s;\n"
+      "}\n"
+      "main() {\n"
+      "  var a = new List(100);\n"
+      "  for (var i = 0; i < a.length; i++) a[i] = i;\n"
+      "  var s = 0;\n"
+      "  for (var i = 0; i < 1000; i++) s += sum(a) + sumTo(a, 10);\n"
+      "  try {\n"
+      "    sumTo(a, 101);\n"
+      "  } catch (e) {\n"
+      "    return s;\n"
+      "  }\n"
+      "  return -1;\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  // Bounds checks were only removed where the index is below the length.
+  EXPECT_EQ(4945000, value);
+}
+
+TEST_CASE(RangeAnalysisGrowableArrayLength) {
+  const char* kScriptChars =
+      "class Shrinker {\n"
+      "  var list;\n"
+      "  var shrink = false;\n"
+      "  Shrinker(this.list);\n"
+      "  operator <(other) {\n"
+      "    if (shrink) list.clear();\n"
+      "    return false;\n"
+      "  }\n"
+      "}\n"
+      "sum(list, shrinker) {\n"
+      "  var s = 0;\n"
+      "  for (var i = 0; i < list.length; i++) {\n"
+      "    if (shrinker < i) return -1;\n"
+      "    s += list[i];\n"
+      "  }\n"
+      "  return s;\n"
+      "}\n"
+      "main() {\n"
+      "  var list = [];\n"
+      "  for (var i = 0; i < 10; i++) list.add(i);\n"
+      "  var shrinker = new Shrinker(list);\n"
+      "  var s = 0;\n"
+      "  for (var i = 0; i < 10000; i++) s += sum(list, shrinker);\n"
+      "  shrinker.shrink = true;\n"
+      "  try {\n"
+      "    sum(list, shrinker);\n"
+      "  } catch (e) {\n"
+      "    return (e is IndexOutOfRangeException) ? s : -2;\n"
+      "  }\n"
+      "  return -1;\n"
+      "}\n";
+  // The user defined operator empties the list after its length was loaded,
+  // the bounds check of the access must remain.
+  RunOptimizedMain(kScriptChars, 450000);
+}
+
+TEST_CASE(AllocationSinking) {
+  const char* kScriptChars =
+      "class Point {\n"
+      "  var x;\n"
+      "  var y;\n"
+      "  Point(this.x, this.y);\n"
+      "}\n"
+      "class Vec {\n"
+      "  var x;\n"
+      "  var y = 0;\n"
+      "  Vec(a, b) : x = a, y = b;\n"
+      "}\n"
+      "class Offset {\n"
+      "  operator *(other) => other + 1.0;\n"
+      "}\n"
+      "foo(a, b) {\n"
+      "  var p = new Point(a * 0.5, b);\n"
+      "  var v = new Vec(a, 2.0);\n"
+      "  return p.y * p.x + v.x * v.y;\n"
+      "}\n"
+      "main() {\n"
+      "  var sum = 0.0;\n"
+      "  for (var i = 0; i < 10000; i++) {\n"
+      "    sum += foo(i, 2.0);\n"
+      "  }\n"
+      "  // Deoptimizes with the sunk objects live.\n"
+      "  sum += foo(10000, new Offset());\n"
+      "  return sum.toInt();\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(150010001, value);
+}
+
+
+TEST_CASE(UnboxedMintArithmetic) {
+  const char* kScriptChars =
+      "mix(a, b) => ((a + b) ^ (a - b)) | (a & b);\n"
+      "main() {\n"
+      "  var x = 0x4000000000000000;\n"
+      "  var sum = 0;\n"
+      "  for (var i = 0; i < 10000; i++) {\n"
+      "    x = (x + i) ^ i;\n"
+      "    sum += mix(x, i) & 0xFFFFFFFF;\n"
+      "  }\n"
+      "  // Overflows to a Bigint and deoptimizes.\n"
+      "  if (mix(0x7FFFFFFFFFFFFFFF, 1) != 0xFFFFFFFFFFFFFFFF) return -1;\n"
+      "  return sum;\n"
+      "}\n";
+  int64_t expected = 0;
+  int64_t x = 0x4000000000000000LL;
+  for (int64_t i = 0; i < 10000; i++) {
+    x = (x + i) ^ i;
+    expected += (((x + i) ^ (x - i)) | (x & i)) & 0xFFFFFFFFLL;
+  }
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(expected, value);
+}
+
+TEST_CASE(TypedArrayLoops) {
+  const char* kScriptChars =
+      "axpy(a, x, y, n) {\n"
+      "  for (var i = 0; i < n; i++) y[i] = a * x[i] + y[i];\n"
+      "}\n"
+      "addf(x, y, z, n) {\n"
+      "  for (var i = 0; i < n; i++) z[i] = x[i] + y[i];\n"
+      "}\n"
+      "mix(x, y, z, n) {\n"
+      "  for (var i = 0; i < n; i++) z[i] = (x[i] + y[i]) ^ (x[i] & 7);\n"
+      "}\n"
+      "horner(x, y, n) {\n"
+      "  for (var i = 0; i < n; i++) {\n"
+      "    var t = x[i];\n"
+      "    y[i] = (((((((t * 0.5 + 1.5) * t - 2.5) * t + 3.5) * t - 4.5)\n"
+      "        * t + 5.5) * t - 6.5) * t + 7.5);\n"
+      "  }\n"
+      "}\n"
+      "main() {\n"
+      "  var n = 1003;\n"
+      "  var x = new Float64List(n), y = new Float64List(n);\n"
+      "  var hy = new Float64List(n);\n"
+      "  var fx = new Float32List(n), fy = new Float32List(n);\n"
+      "  var fz = new Float32List(n);\n"
+      "  var ix = new Int32List(n), iy = new Int32List(n);\n"
+      "  var iz = new Int32List(n);\n"
+      "  for (var i = 0; i < n; i++) {\n"
+      "    x[i] = i * 0.5; y[i] = 1.0 * i;\n"
+      "    fx[i] = i / 3; fy[i] = i * 0.25;\n"
+      "    ix[i] = i * 1000003; iy[i] = -i;\n"
+      "  }\n"
+      "  for (var k = 0; k < 50; k++) {\n"
+      "    axpy(0.5, x, y, n);\n"
+      "    addf(fx, fy, fz, n);\n"
+      "    mix(ix, iy, iz, n);\n"
+      "    horner(x, hy, n);\n"
+      "  }\n"
+      "  // Partial loops and a length that does not match.\n"
+      "  axpy(2.0, x, y, 5);\n"
+      "  var ok = false;\n"
+      "  try {\n"
+      "    addf(fx, fy, new Float32List(7), n);\n"
+      "  } catch (e) {\n"
+      "    ok = true;\n"
+      "  }\n"
+      "  if (!ok) return -1;\n"
+      "  var sum = 0.0;\n"
+      "  for (var i = 0; i < n; i++) sum += y[i] + fz[i] + iz[i] + hy[i];\n"
+      "  return sum;\n"
+      "}\n";
+  const intptr_t n = 1003;
+  double x[n], y[n], hy[n];
+  float fx[n], fy[n], fz[n];
+  int32_t ix[n], iy[n], iz[n];
+  for (intptr_t i = 0; i < n; i++) {
+    x[i] = i * 0.5;
+    y[i] = 1.0 * i;
+    fx[i] = static_cast<float>(i / 3.0);
+    fy[i] = static_cast<float>(i * 0.25);
+    ix[i] = static_cast<int32_t>(i * 1000003);
+    iy[i] = static_cast<int32_t>(-i);
+  }
+  for (intptr_t k = 0; k < 50; k++) {
+    for (intptr_t i = 0; i < n; i++) {
+      y[i] = 0.5 * x[i] + y[i];
+      fz[i] = static_cast<float>(static_cast<double>(fx[i]) + fy[i]);
+      iz[i] = (ix[i] + iy[i]) ^ (ix[i] & 7);
+      const double t = x[i];
+      hy[i] = (((((((t * 0.5 + 1.5) * t - 2.5) * t + 3.5) * t - 4.5)
+          * t + 5.5) * t - 6.5) * t + 7.5);
+    }
+  }
+  for (intptr_t i = 0; i < 5; i++) {
+    y[i] = 2.0 * x[i] + y[i];
+  }
+  double expected = 0.0;
+  for (intptr_t i = 0; i < n; i++) {
+    expected += y[i] + fz[i] + iz[i] + hy[i];
+  }
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  double value = 0.0;
+  EXPECT_VALID(Dart_DoubleValue(result, &value));
+  EXPECT_EQ(expected, value);
+}
+
+
+TEST_CASE(TypedArrayLength) {
+  const char* kScriptChars =
+      "main() {\n"
+      "  var x = new Float32List(10);\n"
+      "  var sum = 0;\n"
+      "  for (var i = 0; i < 10000; i++) {\n"
+      "    sum += x.length;\n"
+      "  }\n"
+      "  return sum;\n"
+      "}\n";
+  RunOptimizedMain(kScriptChars, 100000);
+  // The getter of the private _ByteArrayBase class is recognized and
+  // replaced with a load of the length field.
+  EXPECT(!OptimizedCodeCalls("main", "get:length"));
+}
+
+TEST_CASE(MegamorphicCall) {
+  const char* kScriptChars =
+      "class C0 { f(x) => x + 0; }\n"
+      "class C1 { f(x) => x + 1; }\n"
+      "class C2 { f(x) => x + 2; }\n"
+      "class C3 { f(x) => x + 3; }\n"
+      "class C4 { f(x) => x + 4; }\n"
+      "class C5 { f(x) => x + 5; }\n"
+      "class C6 { f(x) => x + 6; }\n"
+      "class C7 { f(x) => x + 7; }\n"
+      "class C8 { f(x) => x + 8; }\n"
+      "class C9 { f(x) => x + 9; }\n"
+      "class C10 { f(x) => x + 10; }\n"
+      "class C11 { f(x) => x + 11; }\n"
+      "class C12 { f(x) => x + 12; }\n"
+      "class C13 { f(x) => x + 13; }\n"
+      "class C14 { f(x) => x + 14; }\n"
+      "class C15 { f(x) => x + 15; }\n"
+      "class C16 { f(x) => x + 16; }\n"
+      "class C17 { f(x) => x + 17; }\n"
+      "class C18 { f(x) => x + 18; }\n"
+      "class C19 { f(x) => x + 19; }\n"
+      "class N {\n"
+      "  noSuchMethod(name, args) => 100;\n"
+      "}\n"
+      "class K {\n"
+      "  var f;\n"
+      "  K() : f = ((x) => x * 2);\n"
+      "}\n"
+      "main() {\n"
+      "  var objects = [\n"
+      "      new C0(), new C1(), new C2(), new C3(), new C4(), new C5(),\n"
+      "      new C6(), new C7(), new C8(), new C9(), new C10(), new C11(),\n"
+      "      new C12(), new C13(), new C14(), new C15(), new C16(),\n"
+      "      new C17(), new C18(), new C19(), new N(), new K()];\n"
+      "  var sum = 0;\n"
+      "  for (var i = 0; i < 11000; i++) {\n"
+      "    sum += objects[i % 22].f(1);\n"
+      "  }\n"
+      "  return sum;\n"
+      "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(156000, value);
+
+  // The call site switched to the megamorphic cache of 'f', which holds the
+  // classes declaring the method.  Misses resolving to noSuchMethod or to a
+  // closure field are not cached.
+  const GrowableObjectArray& table = GrowableObjectArray::Handle(
+      Isolate::Current()->megamorphic_cache_table());
+  EXPECT(!table.IsNull());
+  MegamorphicCache& cache = MegamorphicCache::Handle();
+  bool found = false;
+  for (intptr_t i = 0; i < table.Length(); i++) {
+    cache ^= table.At(i);
+    if (String::Handle(cache.target_name()).Equals("f")) {
+      EXPECT_EQ(20, cache.filled_entry_count());
+      found = true;
+    }
+  }
+  EXPECT(found);
+}
+
+
+TEST_CASE(SimdValues) {
+  const char* kScriptChars =
+      "blend(src, dst, alpha, n) {\n"
+      "  var a = new Float32x4.splat(alpha);\n"
+      "  var b = new Float32x4.splat(1.0 - alpha);\n"
+      "  for (var i = 0; i < n; i += 4) {\n"
+      "    var s = src.getFloat32x4(i);\n"
+      "    var d = dst.getFloat32x4(i);\n"
+      "    dst.setFloat32x4(i, s * a + d * b);\n"
+      "  }\n"
+      "}\n"
+      "clamp(x, n) {\n"
+      "  var lo = new Float32x4.zero();\n"
+      "  var hi = new Float32x4(1.0, 2.0, 3.0, 4.0);\n"
+      "  for (var i = 0; i < n; i += 4) {\n"
+      "    var v = x.getFloat32x4(i);\n"
+      "    v = v.lessThan(lo).select(lo, v);\n"
+      "    v = v.greaterThan(hi).select(hi, v);\n"
+      "    x.setFloat32x4(i, v.shuffle(Float32x4.WZYX));\n"
+      "  }\n"
+      "}\n"
+      "ints(x, n) {\n"
+      "  var m = new Int32x4(0xFFFF, -1, 0x7FFFFFFF, 3);\n"
+      "  var acc = new Int32x4(0, 0, 0, 0);\n"
+      "  for (var i = 0; i < n; i += 4) {\n"
+      "    var v = x.getInt32x4(i);\n"
+      "    acc = (acc + (v & m)) ^ v.shuffle(0x39);\n"
+      "  }\n"
+      "  x.setInt32x4(0, acc);\n"
+      "  return acc;\n"
+      "}\n"
+      "lanes(v) => v.x + v.y + v.z + v.w;\n"
+      "main() {\n"
+      "  var n = 400;\n"
+      "  var src = new Float32List(n), dst = new Float32List(n);\n"
+      "  var c = new Float32List(n), ix = new Int32List(n);\n"
+      "  for (var i = 0; i < n; i++) {\n"
+      "    src[i] = i * 0.75; dst[i] = 100.0 - i; c[i] = (i % 7) - 2.5;\n"
+      "    ix[i] = i * 7919;\n"
+      "  }\n"
+      "  var isum = 0;\n"
+      "  for (var k = 0; k < 30; k++) {\n"
+      "    blend(src, dst, 0.25, n);\n"
+      "    clamp(c, n);\n"
+      "    var acc = ints(ix, n);\n"
+      "    isum += acc.x - acc.w;\n"
+      "  }\n"
+      "  var ok = false;\n"
+      "  try {\n"
+      "    src.getFloat32x4(n - 2);\n"
+      "  } catch (e) {\n"
+      "    ok = true;\n"
+      "  }\n"
+      "  if (!ok) return -1;\n"
+      "  ok = false;\n"
+      "  try {\n"
+      "    blend(src, dst, 0.25, n + 2);\n"
+      "  } catch (e) {\n"
+      "    ok = true;\n"
+      "  }\n"
+      "  if (!ok) return -1;\n"
+      "  var s = new Float32x4(1.5, -2.0, 0.5, 8.0);\n"
+      "  var t = s.scale(2.0) / new Float32x4.splat(4.0) - s;\n"
+      "  var mask = new Int32x4.bool(true, false, true, false);\n"
+      "  var view = new Float32List.view(src.asByteArray(), 16, 8);\n"
+      "  var sum = lanes(mask.select(s, t)) + lanes(view.getFloat32x4(4));\n"
+      "  sum += lanes(s.equal(t).flagX ? s : t) + isum;\n"
+      "  for (var i = 0; i < n; i++) sum += dst[i] + c[i];\n"
+      "  return sum;\n"
+      "}\n";
+  const intptr_t n = 400;
+  float src[n], dst[n], c[n];
+  int32_t ix[n];
+  for (intptr_t i = 0; i < n; i++) {
+    src[i] = static_cast<float>(i * 0.75);
+    dst[i] = static_cast<float>(100.0 - i);
+    c[i] = static_cast<float>((i % 7) - 2.5);
+    ix[i] = static_cast<int32_t>(i * 7919);
+  }
+  const float hi[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+  const uint32_t m[4] = { 0xFFFF, 0xFFFFFFFF, 0x7FFFFFFF, 3 };
+  int64_t isum = 0;
+  for (intptr_t k = 0; k < 30; k++) {
+    for (intptr_t i = 0; i < n; i++) {
+      const float p = src[i] * 0.25f;
+      const float q = dst[i] * 0.75f;
+      dst[i] = p + q;
+    }
+    for (intptr_t i = 0; i < n; i += 4) {
+      float v[4];
+      for (intptr_t j = 0; j < 4; j++) {
+        v[j] = c[i + j];
+        if (v[j] < 0.0f) v[j] = 0.0f;
+        if (hi[j] < v[j]) v[j] = hi[j];
+      }
+      for (intptr_t j = 0; j < 4; j++) c[i + j] = v[3 - j];
+    }
+    uint32_t acc[4] = { 0, 0, 0, 0 };
+    for (intptr_t i = 0; i < n; i += 4) {
+      uint32_t v[4];
+      for (intptr_t j = 0; j < 4; j++) v[j] = ix[i + j];
+      for (intptr_t j = 0; j < 4; j++) {
+        acc[j] = (acc[j] + (v[j] & m[j])) ^ v[(j + 1) & 3];
+      }
+    }
+    for (intptr_t j = 0; j < 4; j++) ix[j] = static_cast<int32_t>(acc[j]);
+    isum += static_cast<int64_t>(ix[0]) - ix[3];
+  }
+  // The blend past the end of the arrays deoptimizes on the bounds check
+  // and throws after blending all elements once more.
+  for (intptr_t i = 0; i < n; i++) {
+    const float p = src[i] * 0.25f;
+    const float q = dst[i] * 0.75f;
+    dst[i] = p + q;
+  }
+  // The selected lanes add up to -1.0, the view lanes to 28.5 and t to -4.0.
+  double expected = -1.0 + 28.5;
+  expected += -4.0 + isum;
+  for (intptr_t i = 0; i < n; i++) {
+    expected += static_cast<double>(dst[i]) + static_cast<double>(c[i]);
+  }
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  double value = 0.0;
+  EXPECT_VALID(Dart_DoubleValue(result, &value));
+  EXPECT_EQ(expected, value);
+}
+
 #endif  // TARGET_ARCH_IA32 || TARGET_ARCH_X64
 
 }  // namespace dart
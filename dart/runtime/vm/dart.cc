@@ -7,6 +7,7 @@
 #include "vm/dart_api_state.h"
 #include "vm/flags.h"
 #include "vm/freelist.h"
+#include "vm/gc_events.h"
 #include "vm/handles.h"
 #include "vm/heap.h"
 #include "vm/isolate.h"
@@ -31,6 +32,7 @@ ThreadPool* Dart::thread_pool_ = NULL;
 Dart_FileWriterFunction Dart::perf_events_writer_ = NULL;
 DebugInfo* Dart::pprof_symbol_generator_ = NULL;
 Dart_FileWriterFunction Dart::flow_graph_writer_ = NULL;
+Dart_FileWriterFunction Dart::gc_events_writer_ = NULL;
 
 // An object visitor which will mark all visited objects. This is used to
 // premark all objects in the vm_isolate_ heap.
@@ -60,6 +62,7 @@ bool Dart::InitOnce(Dart_IsolateCreateCallback create,
   Isolate::InitOnce();
   PortMap::InitOnce();
   FreeListElement::InitOnce();
+  GCEventRecorder::InitOnce();
   Api::InitOnce();
   // Create the VM isolate and finish the VM initialization.
   ASSERT(thread_pool_ == NULL);
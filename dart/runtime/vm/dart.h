@@ -48,12 +48,20 @@ class Dart : public AllStatic {
     return flow_graph_writer_;
   }
 
+  static void set_gc_events_writer(Dart_FileWriterFunction writer_function) {
+    gc_events_writer_ = writer_function;
+  }
+  static Dart_FileWriterFunction gc_events_writer() {
+    return gc_events_writer_;
+  }
+
  private:
   static Isolate* vm_isolate_;
   static ThreadPool* thread_pool_;
   static Dart_FileWriterFunction perf_events_writer_;
   static DebugInfo* pprof_symbol_generator_;
   static Dart_FileWriterFunction flow_graph_writer_;
+  static Dart_FileWriterFunction gc_events_writer_;
 };
 
 }  // namespace dart
@@ -4,6 +4,7 @@
 
 #include "include/dart_api.h"
 
+#include "vm/allocation_sampler.h"
 #include "vm/bigint_operations.h"
 #include "vm/class_finalizer.h"
 #include "vm/compiler.h"
@@ -15,6 +16,7 @@
 #include "vm/debuginfo.h"
 #include "vm/exceptions.h"
 #include "vm/flags.h"
+#include "vm/gc_events.h"
 #include "vm/growable_array.h"
 #include "vm/message.h"
 #include "vm/native_entry.h"
@@ -723,6 +725,75 @@ DART_EXPORT Dart_Handle Dart_HeapProfile(Dart_HeapProfileWriteCallback callback,
   return Api::Success(isolate);
 }
 
+
+DART_EXPORT Dart_Handle Dart_AllocationProfile(
+    Dart_HeapProfileWriteCallback callback,
+    void* stream) {
+  Isolate* isolate = Isolate::Current();
+  DARTSCOPE(isolate);
+  if (callback == NULL) {
+    RETURN_NULL_ERROR(callback);
+  }
+  isolate->heap()->allocation_sampler()->Write(callback, stream);
+  return Api::Success(isolate);
+}
+
+
+// --- Heap Limits ---
+
+
+DART_EXPORT Dart_Handle Dart_SetHeapLimits(intptr_t soft_limit,
+                                           intptr_t hard_limit) {
+  Isolate* isolate = Isolate::Current();
+  CHECK_ISOLATE(isolate);
+  if ((soft_limit < 0) || (hard_limit < 0)) {
+    return Api::NewError("%s expects the limits to be non-negative.",
+                         CURRENT_FUNC);
+  }
+  if ((soft_limit != 0) && (hard_limit != 0) && (soft_limit > hard_limit)) {
+    return Api::NewError(
+        "%s expects the soft limit to be below the hard limit.",
+        CURRENT_FUNC);
+  }
+  isolate->heap()->SetLimits(soft_limit, hard_limit);
+  return Api::Success(isolate);
+}
+
+
+DART_EXPORT Dart_Handle Dart_SetGcTimeTarget(intptr_t percent) {
+  Isolate* isolate = Isolate::Current();
+  CHECK_ISOLATE(isolate);
+  if ((percent < 1) || (percent > 100)) {
+    return Api::NewError("%s expects argument 'percent' to be in [1, 100].",
+                         CURRENT_FUNC);
+  }
+  isolate->heap()->SetGCTimeTarget(percent);
+  return Api::Success(isolate);
+}
+
+
+// --- Garbage Collection Events ---
+
+
+DART_EXPORT Dart_Handle Dart_GetGcEvents(Dart_GcEvent* events,
+                                         intptr_t* length) {
+  Isolate* isolate = Isolate::Current();
+  CHECK_ISOLATE(isolate);
+  if (events == NULL) {
+    RETURN_NULL_ERROR(events);
+  }
+  if (length == NULL) {
+    RETURN_NULL_ERROR(length);
+  }
+  if (*length < 0) {
+    return Api::NewError("%s expects argument 'length' to be non-negative.",
+                         CURRENT_FUNC);
+  }
+  *length = isolate->heap()->gc_events()->GetEvents(events, *length);
+  return Api::Success(isolate);
+}
+
+
 // --- Initialization and Globals ---
 
 
@@ -4444,4 +4515,9 @@ DART_EXPORT void Dart_InitFlowGraphPrinting(Dart_FileWriterFunction function) {
   Dart::set_flow_graph_writer(function);
 }
 
+
+DART_EXPORT void Dart_InitGcEventsLogging(Dart_FileWriterFunction function) {
+  Dart::set_gc_events_writer(function);
+}
+
 }  // namespace dart
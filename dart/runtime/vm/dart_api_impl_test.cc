@@ -2094,6 +2094,141 @@ TEST_CASE(SingleGarbageCollectionCallback) {
   EXPECT_EQ(7, global_epilogue_callback_status);
 }
 
+
+TEST_CASE(GetGcEvents) {
+  Dart_GcEvent events[4];
+  intptr_t length = 4;
+  EXPECT_VALID(Dart_GetGcEvents(events, &length));
+  intptr_t num_events = length;
+
+  Heap* heap = Isolate::Current()->heap();
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kOld);
+
+  // Only the requested number of events is copied, oldest first.
+  length = 1;
+  EXPECT_VALID(Dart_GetGcEvents(events, &length));
+  EXPECT_EQ(1, length);
+  EXPECT_EQ(Dart_GcEvent::kMarkSweep, events[0].type);
+  EXPECT_STREQ("old space", events[0].reason);
+
+  length = 4;
+  EXPECT_VALID(Dart_GetGcEvents(events, &length));
+  EXPECT_EQ(Utils::Minimum<intptr_t>(num_events + 2, 4), length);
+  const Dart_GcEvent& scavenge = events[length - 2];
+  const Dart_GcEvent& mark_sweep = events[length - 1];
+  EXPECT_EQ(Dart_GcEvent::kScavenge, scavenge.type);
+  EXPECT_STREQ("new space", scavenge.reason);
+  EXPECT_EQ(scavenge.id + 1, mark_sweep.id);
+  EXPECT(scavenge.start_micros <= mark_sweep.start_micros);
+  EXPECT(mark_sweep.duration_micros >= 0);
+  EXPECT_EQ(0, scavenge.phase_micros[Dart_GcEvent::kSweep]);
+  EXPECT_EQ(0, mark_sweep.phase_micros[Dart_GcEvent::kScavengeCopy]);
+  // The mark-sweep leaves the new space alone.
+  EXPECT_EQ(heap->CapacityInWords(Heap::kNew) * kWordSize,
+            scavenge.capacity_after[Dart_GcEvent::kNewSpace]);
+  EXPECT_EQ(heap->UsedInWords(Heap::kOld) * kWordSize,
+            mark_sweep.used_after[Dart_GcEvent::kOldSpace]);
+  EXPECT(mark_sweep.used_after[Dart_GcEvent::kOldSpace] <=
+         mark_sweep.used_before[Dart_GcEvent::kOldSpace]);
+
+  EXPECT(Dart_IsError(Dart_GetGcEvents(NULL, &length)));
+  EXPECT(Dart_IsError(Dart_GetGcEvents(events, NULL)));
+  length = -1;
+  EXPECT(Dart_IsError(Dart_GetGcEvents(events, &length)));
+}
+
+
+static intptr_t num_logged_gc_events = 0;
+static char last_logged_gc_event[1024];
+
+
+static void LogGcEvent(const char* buffer, int64_t num_bytes) {
+  // Each event is written at once, as a single line.
+  EXPECT(num_bytes < static_cast<int64_t>(sizeof(last_logged_gc_event)));
+  EXPECT_EQ('\n', buffer[num_bytes - 1]);
+  memmove(last_logged_gc_event, buffer, num_bytes);
+  last_logged_gc_event[num_bytes] = '\0';
+  num_logged_gc_events++;
+}
+
+
+TEST_CASE(GcEventsLogging) {
+  Dart_InitGcEventsLogging(&LogGcEvent);
+  num_logged_gc_events = 0;
+  Heap* heap = Isolate::Current()->heap();
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT_EQ(1, num_logged_gc_events);
+  EXPECT(strstr(last_logged_gc_event, "\"type\":\"Scavenge\"") != NULL);
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT_EQ(2, num_logged_gc_events);
+  EXPECT(strstr(last_logged_gc_event, "\"type\":\"MarkSweep\"") != NULL);
+  EXPECT(strstr(last_logged_gc_event, "\"reason\":\"old space\"") != NULL);
+  Dart_InitGcEventsLogging(NULL);
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT_EQ(2, num_logged_gc_events);
+}
+
+
+TEST_CASE(HeapLimits) {
+  const char* kScriptChars =
+      "fill() {\n"
+      "  var lists = [];\n"
+      "  try {\n"
+      "    while (true) {\n"
+      "      lists.add(new List(64 * 1024));\n"
+      "    }\n"
+      "  } on OutOfMemoryException catch (e) {\n"
+      "    return lists.length;\n"
+      "  }\n"
+      "}\n";
+  Heap* heap = Isolate::Current()->heap();
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  heap->CollectAllGarbage();
+  intptr_t footprint = (heap->CapacityInWords(Heap::kNew) +
+                        heap->CapacityInWords(Heap::kOld)) * kWordSize;
+
+  // The lists of 512KB each only fit below the hard limit 16MB above the
+  // current footprint.
+  EXPECT_VALID(Dart_SetHeapLimits(0, footprint + 16 * MB));
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("fill"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t count = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &count));
+  EXPECT_LT(0, count);
+  EXPECT_LE(count, 32);
+  EXPECT_LE((heap->CapacityInWords(Heap::kNew) +
+             heap->CapacityInWords(Heap::kOld)) * kWordSize,
+            footprint + 16 * MB);
+
+  // The memory is available again once the lists are gone.
+  result = Dart_Invoke(lib, Dart_NewString("fill"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t second_count = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &second_count));
+  EXPECT_LT(0, second_count);
+
+  // Above the soft limit garbage is collected instead of growing the heap.
+  heap->CollectAllGarbage();
+  EXPECT_VALID(Dart_SetHeapLimits(footprint + 1 * MB, 0));
+  for (intptr_t i = 0; i < 1 * KB; i++) {
+    HANDLESCOPE(Isolate::Current());
+    Array::New(1 * KB, Heap::kOld);
+    Array::New(1 * KB, Heap::kNew);
+  }
+  EXPECT_LE((heap->CapacityInWords(Heap::kNew) +
+             heap->CapacityInWords(Heap::kOld)) * kWordSize,
+            footprint + 1 * MB);
+
+  EXPECT(Dart_IsError(Dart_SetHeapLimits(-1, 0)));
+  EXPECT(Dart_IsError(Dart_SetHeapLimits(2 * MB, 1 * MB)));
+  EXPECT_VALID(Dart_SetHeapLimits(0, 0));
+
+  EXPECT_VALID(Dart_SetGcTimeTarget(10));
+  EXPECT(Dart_IsError(Dart_SetGcTimeTarget(0)));
+  EXPECT(Dart_IsError(Dart_SetGcTimeTarget(101)));
+}
+
 TEST_CASE(MultipleGarbageCollectionCallbacks) {
   // Add prologue callbacks.
   EXPECT_VALID(Dart_AddGcPrologueCallback(&PrologueCallbackTimes2));
@@ -113,6 +113,105 @@ class DeoptDoubleStackSlotInstr : public DeoptInstr {
 };
 
 
+// Stores the integer as a Smi if it fits, otherwise defers the allocation
+// of a Mint.
+static void StoreInt64(int64_t value, intptr_t* to_addr) {
+  if (Smi::IsValid64(value)) {
+    *reinterpret_cast<RawSmi**>(to_addr) =
+        Smi::New(static_cast<intptr_t>(value));
+  } else {
+    *reinterpret_cast<RawSmi**>(to_addr) = Smi::New(0);
+    Isolate::Current()->DeferMintMaterialization(
+        value, reinterpret_cast<RawMint**>(to_addr));
+  }
+}
+
+
+class DeoptInt64StackSlotInstr : public DeoptInstr {
+ public:
+  explicit DeoptInt64StackSlotInstr(intptr_t from_index)
+      : stack_slot_index_(from_index) {
+    ASSERT(stack_slot_index_ >= 0);
+  }
+
+  virtual intptr_t from_index() const { return stack_slot_index_; }
+  virtual DeoptInstr::Kind kind() const { return kCopyInt64StackSlot; }
+
+  virtual const char* ToCString() const {
+    const char* format = "ms%"Pd"";
+    intptr_t len = OS::SNPrint(NULL, 0, format, stack_slot_index_);
+    char* chars = Isolate::Current()->current_zone()->Alloc<char>(len + 1);
+    OS::SNPrint(chars, len + 1, format, stack_slot_index_);
+    return chars;
+  }
+
+  void Execute(DeoptimizationContext* deopt_context, intptr_t to_index) {
+    intptr_t from_index =
+       deopt_context->from_frame_size() - stack_slot_index_ - 1;
+    int64_t* from_addr = reinterpret_cast<int64_t*>(
+        deopt_context->GetFromFrameAddressAt(from_index));
+    intptr_t* to_addr = deopt_context->GetToFrameAddressAt(to_index);
+    StoreInt64(*from_addr, to_addr);
+  }
+
+ private:
+  const intptr_t stack_slot_index_;  // First argument is 0, always >= 0.
+
+  DISALLOW_COPY_AND_ASSIGN(DeoptInt64StackSlotInstr);
+};
+
+
+// Returns the class of the boxed vector copied by the deopt instruction.
+static intptr_t Simd128ClassId(bool is_float32x4) {
+  return is_float32x4 ? kFloat32x4Cid : kInt32x4Cid;
+}
+
+
+// Deoptimization instruction moving a Float32x4 or Int32x4 vector from a
+// quad spill slot of the optimized frame.  The allocation of the box is
+// deferred.
+class DeoptSimd128StackSlotInstr : public DeoptInstr {
+ public:
+  DeoptSimd128StackSlotInstr(intptr_t from_index, bool is_float32x4)
+      : stack_slot_index_(from_index), is_float32x4_(is_float32x4) {
+    ASSERT(stack_slot_index_ >= 0);
+  }
+
+  virtual intptr_t from_index() const { return stack_slot_index_; }
+  virtual DeoptInstr::Kind kind() const {
+    return is_float32x4_ ? kCopyFloat32x4QuadStackSlot
+                         : kCopyInt32x4QuadStackSlot;
+  }
+
+  virtual const char* ToCString() const {
+    const char* format = "qs%"Pd"";
+    intptr_t len = OS::SNPrint(NULL, 0, format, stack_slot_index_);
+    char* chars = Isolate::Current()->current_zone()->Alloc<char>(len + 1);
+    OS::SNPrint(chars, len + 1, format, stack_slot_index_);
+    return chars;
+  }
+
+  void Execute(DeoptimizationContext* deopt_context, intptr_t to_index) {
+    intptr_t from_index =
+       deopt_context->from_frame_size() - stack_slot_index_ - 1;
+    simd128_value_t* from_addr = reinterpret_cast<simd128_value_t*>(
+        deopt_context->GetFromFrameAddressAt(from_index));
+    intptr_t* to_addr = deopt_context->GetToFrameAddressAt(to_index);
+    *reinterpret_cast<RawSmi**>(to_addr) = Smi::New(0);
+    Isolate::Current()->DeferSimd128Materialization(
+        *from_addr,
+        Simd128ClassId(is_float32x4_),
+        reinterpret_cast<RawInstance**>(to_addr));
+  }
+
+ private:
+  const intptr_t stack_slot_index_;  // First argument is 0, always >= 0.
+  const bool is_float32x4_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeoptSimd128StackSlotInstr);
+};
+
+
 // Deoptimization instruction creating return address using function and
 // deopt-id stored at 'object_table_index'. Uses the deopt-after
 // continuation point.
@@ -283,6 +382,69 @@ class DeoptXmmRegisterInstr: public DeoptInstr {
 };
 
 
+// Deoptimization instruction moving an XMM register holding an unboxed
+// integer.
+class DeoptInt64XmmRegisterInstr: public DeoptInstr {
+ public:
+  explicit DeoptInt64XmmRegisterInstr(intptr_t reg_as_int)
+      : reg_(static_cast<XmmRegister>(reg_as_int)) {}
+
+  virtual intptr_t from_index() const { return static_cast<intptr_t>(reg_); }
+  virtual DeoptInstr::Kind kind() const { return kCopyInt64XmmRegister; }
+
+  virtual const char* ToCString() const {
+    return Assembler::XmmRegisterName(reg_);
+  }
+
+  void Execute(DeoptimizationContext* deopt_context, intptr_t to_index) {
+    int64_t value = deopt_context->XmmRegisterValueAsInt64(reg_);
+    intptr_t* to_addr = deopt_context->GetToFrameAddressAt(to_index);
+    StoreInt64(value, to_addr);
+  }
+
+ private:
+  const XmmRegister reg_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeoptInt64XmmRegisterInstr);
+};
+
+
+// Deoptimization instruction moving an XMM register holding a Float32x4 or
+// Int32x4 vector.
+class DeoptSimd128XmmRegisterInstr: public DeoptInstr {
+ public:
+  DeoptSimd128XmmRegisterInstr(intptr_t reg_as_int, bool is_float32x4)
+      : reg_(static_cast<XmmRegister>(reg_as_int)),
+        is_float32x4_(is_float32x4) {}
+
+  virtual intptr_t from_index() const { return static_cast<intptr_t>(reg_); }
+  virtual DeoptInstr::Kind kind() const {
+    return is_float32x4_ ? kCopyFloat32x4XmmRegister
+                         : kCopyInt32x4XmmRegister;
+  }
+
+  virtual const char* ToCString() const {
+    return Assembler::XmmRegisterName(reg_);
+  }
+
+  void Execute(DeoptimizationContext* deopt_context, intptr_t to_index) {
+    simd128_value_t value = deopt_context->XmmRegisterValueAsSimd128(reg_);
+    intptr_t* to_addr = deopt_context->GetToFrameAddressAt(to_index);
+    *reinterpret_cast<RawSmi**>(to_addr) = Smi::New(0);
+    Isolate::Current()->DeferSimd128Materialization(
+        value,
+        Simd128ClassId(is_float32x4_),
+        reinterpret_cast<RawInstance**>(to_addr));
+  }
+
+ private:
+  const XmmRegister reg_;
+  const bool is_float32x4_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeoptSimd128XmmRegisterInstr);
+};
+
+
 // Deoptimization instruction creating a PC marker for the code of
 // function at 'object_table_index'.
 class DeoptPcMarkerInstr : public DeoptInstr {
@@ -368,19 +530,141 @@ class DeoptCallerPcInstr : public DeoptInstr {
 };
 
 
+// Deoptimization instruction materializing an object whose allocation was
+// sunk in optimized code.  The descriptor at 'object_table_index' holds the
+// class of the object followed by a (field, kind, from index) triple for
+// each initialized field: the field is copied as by the deoptimization
+// instruction of that kind.  The object is allocated by
+// DeoptimizeMaterialize once the frame is rewritten.
+class DeoptMaterializeObjectInstr : public DeoptInstr {
+ public:
+  explicit DeoptMaterializeObjectInstr(intptr_t object_table_index)
+      : object_table_index_(object_table_index) {
+    ASSERT(object_table_index >= 0);
+  }
+
+  virtual intptr_t from_index() const { return object_table_index_; }
+  virtual DeoptInstr::Kind kind() const { return kMaterializeObject; }
+
+  virtual const char* ToCString() const {
+    const char* format = "mat oti:%"Pd"";
+    intptr_t len = OS::SNPrint(NULL, 0, format, object_table_index_);
+    char* chars = Isolate::Current()->current_zone()->Alloc<char>(len + 1);
+    OS::SNPrint(chars, len + 1, format, object_table_index_);
+    return chars;
+  }
+
+  void Execute(DeoptimizationContext* deopt_context, intptr_t to_index) {
+    Array& descriptor = Array::Handle(deopt_context->isolate());
+    descriptor ^= deopt_context->ObjectAt(object_table_index_);
+    const intptr_t field_count = (descriptor.Length() - 1) / 3;
+    intptr_t* to_addr = deopt_context->GetToFrameAddressAt(to_index);
+    *reinterpret_cast<RawSmi**>(to_addr) = Smi::New(0);
+    DeferredObject* object =
+        deopt_context->isolate()->DeferObjectMaterialization(
+            descriptor.raw(),
+            reinterpret_cast<RawInstance**>(to_addr),
+            field_count);
+    Smi& kind = Smi::Handle(deopt_context->isolate());
+    Smi& from_index = Smi::Handle(deopt_context->isolate());
+    for (intptr_t i = 0; i < field_count; i++) {
+      kind ^= descriptor.At(1 + 3 * i + 1);
+      from_index ^= descriptor.At(1 + 3 * i + 2);
+      CopyField(deopt_context, kind.Value(), from_index.Value(), object, i);
+    }
+  }
+
+ private:
+  static void CopyField(DeoptimizationContext* deopt_context,
+                        intptr_t kind,
+                        intptr_t from_index,
+                        DeferredObject* object,
+                        intptr_t field_index) {
+    switch (kind) {
+      case kCopyConstant:
+        object->SetFieldAt(field_index, deopt_context->ObjectAt(from_index));
+        break;
+      case kCopyRegister:
+        object->SetFieldAt(field_index, reinterpret_cast<RawObject*>(
+            deopt_context->RegisterValue(static_cast<Register>(from_index))));
+        break;
+      case kCopyXmmRegister:
+        object->SetDoubleFieldAt(field_index,
+            deopt_context->XmmRegisterValue(
+                static_cast<XmmRegister>(from_index)));
+        break;
+      case kCopyStackSlot:
+        object->SetFieldAt(field_index, reinterpret_cast<RawObject*>(
+            *deopt_context->GetFromFrameAddressAt(
+                deopt_context->from_frame_size() - from_index - 1)));
+        break;
+      case kCopyDoubleStackSlot:
+        object->SetDoubleFieldAt(field_index, *reinterpret_cast<double*>(
+            deopt_context->GetFromFrameAddressAt(
+                deopt_context->from_frame_size() - from_index - 1)));
+        break;
+      case kCopyInt64XmmRegister:
+        object->SetMintFieldAt(field_index,
+            deopt_context->XmmRegisterValueAsInt64(
+                static_cast<XmmRegister>(from_index)));
+        break;
+      case kCopyInt64StackSlot:
+        object->SetMintFieldAt(field_index, *reinterpret_cast<int64_t*>(
+            deopt_context->GetFromFrameAddressAt(
+                deopt_context->from_frame_size() - from_index - 1)));
+        break;
+      case kCopyFloat32x4XmmRegister:
+      case kCopyInt32x4XmmRegister:
+        object->SetSimd128FieldAt(field_index,
+            deopt_context->XmmRegisterValueAsSimd128(
+                static_cast<XmmRegister>(from_index)),
+            Simd128ClassId(kind == kCopyFloat32x4XmmRegister));
+        break;
+      case kCopyFloat32x4QuadStackSlot:
+      case kCopyInt32x4QuadStackSlot:
+        object->SetSimd128FieldAt(field_index,
+            *reinterpret_cast<simd128_value_t*>(
+                deopt_context->GetFromFrameAddressAt(
+                    deopt_context->from_frame_size() - from_index - 1)),
+            Simd128ClassId(kind == kCopyFloat32x4QuadStackSlot));
+        break;
+      default:
+        UNREACHABLE();
+    }
+  }
+
+  const intptr_t object_table_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeoptMaterializeObjectInstr);
+};
+
+
 DeoptInstr* DeoptInstr::Create(intptr_t kind_as_int, intptr_t from_index) {
   Kind kind = static_cast<Kind>(kind_as_int);
   switch (kind) {
     case kCopyStackSlot: return new DeoptStackSlotInstr(from_index);
     case kCopyDoubleStackSlot: return new DeoptDoubleStackSlotInstr(from_index);
+    case kCopyInt64StackSlot: return new DeoptInt64StackSlotInstr(from_index);
     case kSetRetAfterAddress: return new DeoptRetAddrAfterInstr(from_index);
     case kSetRetBeforeAddress: return new DeoptRetAddrBeforeInstr(from_index);
     case kCopyConstant:  return new DeoptConstantInstr(from_index);
     case kCopyRegister:  return new DeoptRegisterInstr(from_index);
     case kCopyXmmRegister: return new DeoptXmmRegisterInstr(from_index);
+    case kCopyInt64XmmRegister:
+      return new DeoptInt64XmmRegisterInstr(from_index);
+    case kCopyFloat32x4XmmRegister:
+    case kCopyInt32x4XmmRegister:
+      return new DeoptSimd128XmmRegisterInstr(
+          from_index, kind == kCopyFloat32x4XmmRegister);
+    case kCopyFloat32x4QuadStackSlot:
+    case kCopyInt32x4QuadStackSlot:
+      return new DeoptSimd128StackSlotInstr(
+          from_index, kind == kCopyFloat32x4QuadStackSlot);
     case kSetPcMarker:   return new DeoptPcMarkerInstr(from_index);
     case kSetCallerFp:   return new DeoptCallerFpInstr();
     case kSetCallerPc:   return new DeoptCallerPcInstr();
+    case kMaterializeObject:
+      return new DeoptMaterializeObjectInstr(from_index);
   }
   UNREACHABLE();
   return NULL;
@@ -431,34 +715,111 @@ void DeoptInfoBuilder::AddPcMarker(const Function& function,
 }
 
 
-void DeoptInfoBuilder::AddCopy(const Location& from_loc,
-                               const Value& from_value,
-                               const intptr_t to_index) {
-  DeoptInstr* deopt_instr = NULL;
+DeoptInstr* DeoptInfoBuilder::CreateCopyInstr(const Location& from_loc,
+                                              const Value& from_value) const {
+  const bool is_int64 =
+      (from_value.definition()->representation() == kUnboxedMint);
+  // Only Float32 and Int32 vectors, which are boxed as Float32x4 and Int32x4
+  // values, are live in environments.
+  const bool is_vector =
+      (from_value.definition()->representation() == kUnboxedVector);
+  const bool is_float32x4 = is_vector &&
+      (from_value.definition()->GetPropagatedCid() == kFloat32x4Cid);
+  ASSERT(!is_vector || is_float32x4 ||
+         (from_value.definition()->GetPropagatedCid() == kInt32x4Cid));
   if (from_loc.IsConstant()) {
     intptr_t object_table_index = FindOrAddObjectInTable(from_loc.constant());
-    deopt_instr = new DeoptConstantInstr(object_table_index);
+    return new DeoptConstantInstr(object_table_index);
   } else if (from_loc.IsRegister()) {
-    deopt_instr = new DeoptRegisterInstr(from_loc.reg());
+    return new DeoptRegisterInstr(from_loc.reg());
   } else if (from_loc.IsXmmRegister()) {
-    deopt_instr = new DeoptXmmRegisterInstr(from_loc.xmm_reg());
+    if (is_vector) {
+      return new DeoptSimd128XmmRegisterInstr(from_loc.xmm_reg(),
+                                              is_float32x4);
+    }
+    if (is_int64) {
+      return new DeoptInt64XmmRegisterInstr(from_loc.xmm_reg());
+    }
+    return new DeoptXmmRegisterInstr(from_loc.xmm_reg());
   } else if (from_loc.IsStackSlot()) {
     intptr_t from_index = (from_loc.stack_index() < 0) ?
         from_loc.stack_index() + num_args_ :
         from_loc.stack_index() + num_args_ -
             ParsedFunction::kFirstLocalSlotIndex + 1;
-    deopt_instr = new DeoptStackSlotInstr(from_index);
+    return new DeoptStackSlotInstr(from_index);
   } else if (from_loc.IsDoubleStackSlot()) {
     intptr_t from_index = (from_loc.stack_index() < 0) ?
         from_loc.stack_index() + num_args_ :
         from_loc.stack_index() + num_args_ -
             ParsedFunction::kFirstLocalSlotIndex + 1;
-    deopt_instr = new DeoptDoubleStackSlotInstr(from_index);
-  } else {
-    UNREACHABLE();
+    if (is_int64) {
+      return new DeoptInt64StackSlotInstr(from_index);
+    }
+    return new DeoptDoubleStackSlotInstr(from_index);
+  } else if (from_loc.IsQuadStackSlot()) {
+    ASSERT(is_vector);
+    intptr_t from_index = (from_loc.stack_index() < 0) ?
+        from_loc.stack_index() + num_args_ :
+        from_loc.stack_index() + num_args_ -
+            ParsedFunction::kFirstLocalSlotIndex + 1;
+    return new DeoptSimd128StackSlotInstr(from_index, is_float32x4);
+  }
+  UNREACHABLE();
+  return NULL;
+}
+
+
+void DeoptInfoBuilder::AddCopy(const Location& from_loc,
+                               const Value& from_value,
+                               const intptr_t to_index) {
+  MaterializeObjectInstr* materialization =
+      from_value.definition()->AsMaterializeObject();
+  if (materialization != NULL) {
+    AddMaterialization(materialization, to_index);
+    return;
+  }
+  ASSERT(to_index == instructions_.length());
+  instructions_.Add(CreateCopyInstr(from_loc, from_value));
+}
+
+
+void DeoptInfoBuilder::AddMaterialization(
+    MaterializeObjectInstr* materialization,
+    intptr_t to_index) {
+  intptr_t object_table_index = -1;
+  for (intptr_t i = 0; i < materializations_.length(); i++) {
+    if (materializations_[i] == materialization) {
+      object_table_index = descriptor_indices_[i];
+      break;
+    }
+  }
+  if (object_table_index < 0) {
+    object_table_index = AddMaterializationDescriptor(materialization);
+    materializations_.Add(materialization);
+    descriptor_indices_.Add(object_table_index);
   }
   ASSERT(to_index == instructions_.length());
-  instructions_.Add(deopt_instr);
+  instructions_.Add(new DeoptMaterializeObjectInstr(object_table_index));
+}
+
+
+intptr_t DeoptInfoBuilder::AddMaterializationDescriptor(
+    MaterializeObjectInstr* materialization) {
+  const intptr_t field_count = materialization->InputCount();
+  const Array& descriptor =
+      Array::Handle(Array::New(1 + 3 * field_count, Heap::kOld));
+  descriptor.SetAt(0, materialization->cls());
+  for (intptr_t i = 0; i < field_count; i++) {
+    DeoptInstr* copy = CreateCopyInstr(materialization->LocationAt(i),
+                                       *materialization->InputAt(i));
+    descriptor.SetAt(1 + 3 * i, materialization->FieldAt(i));
+    descriptor.SetAt(1 + 3 * i + 1, Smi::Handle(Smi::New(copy->kind())));
+    descriptor.SetAt(1 + 3 * i + 2,
+                     Smi::Handle(Smi::New(copy->from_index())));
+  }
+  const intptr_t object_table_index = object_table_.Length();
+  object_table_.Add(descriptor);
+  return object_table_index;
 }
 
 
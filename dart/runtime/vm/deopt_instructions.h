@@ -13,6 +13,7 @@
 namespace dart {
 
 class Location;
+class MaterializeObjectInstr;
 class Value;
 
 // Holds all data relevant for execution of deoptimization instructions.
@@ -48,6 +49,15 @@ class DeoptimizationContext : public ValueObject {
   }
 
   double XmmRegisterValue(XmmRegister reg) const {
+    return xmm_registers_copy_[reg].double_storage[0];
+  }
+
+  // Reads the bits of the register without going through a double value.
+  int64_t XmmRegisterValueAsInt64(XmmRegister reg) const {
+    return xmm_registers_copy_[reg].int64_storage[0];
+  }
+
+  simd128_value_t XmmRegisterValueAsSimd128(XmmRegister reg) const {
     return xmm_registers_copy_[reg];
   }
 
@@ -62,7 +72,7 @@ class DeoptimizationContext : public ValueObject {
   intptr_t* from_frame_;
   intptr_t from_frame_size_;
   intptr_t* registers_copy_;
-  double* xmm_registers_copy_;
+  simd128_value_t* xmm_registers_copy_;
   const intptr_t num_args_;
   Isolate* isolate_;
 
@@ -93,11 +103,18 @@ class DeoptInstr : public ZoneAllocated {
     kCopyConstant,
     kCopyRegister,
     kCopyXmmRegister,
+    kCopyInt64XmmRegister,
     kCopyStackSlot,
     kCopyDoubleStackSlot,
+    kCopyInt64StackSlot,
+    kCopyFloat32x4XmmRegister,
+    kCopyInt32x4XmmRegister,
+    kCopyFloat32x4QuadStackSlot,
+    kCopyInt32x4QuadStackSlot,
     kSetPcMarker,
     kSetCallerFp,
     kSetCallerPc,
+    kMaterializeObject,
   };
 
   virtual DeoptInstr::Kind kind() const = 0;
@@ -122,7 +139,9 @@ class DeoptInfoBuilder : public ValueObject {
                    const intptr_t num_args)
       : instructions_(),
         object_table_(object_table),
-        num_args_(num_args) {}
+        num_args_(num_args),
+        materializations_(),
+        descriptor_indices_() {}
 
   // Return address before instruction.
   void AddReturnAddressBefore(const Function& function,
@@ -134,10 +153,16 @@ class DeoptInfoBuilder : public ValueObject {
                              intptr_t deopt_id,
                              intptr_t to_index);
 
-  // Copy from optimized frame to unoptimized.
+  // Copy from optimized frame to unoptimized.  A value which materializes
+  // a sunk allocation is added with AddMaterialization.
   void AddCopy(const Location& from_loc,
                const Value& from_value,
                intptr_t to_index);
+  // Allocate the object whose allocation was sunk in optimized code and
+  // initialize its fields from the optimized frame.  Slots of the same
+  // DeoptInfo referring to the same materialization get the same object.
+  void AddMaterialization(MaterializeObjectInstr* materialization,
+                          intptr_t to_index);
   void AddPcMarker(const Function& function, intptr_t to_index);
   void AddCallerFp(intptr_t to_index);
   void AddCallerPc(intptr_t to_index);
@@ -146,10 +171,19 @@ class DeoptInfoBuilder : public ValueObject {
 
  private:
   intptr_t FindOrAddObjectInTable(const Object& obj) const;
+  // Unboxed integer values are copied from the same locations as doubles.
+  DeoptInstr* CreateCopyInstr(const Location& from_loc,
+                              const Value& from_value) const;
+  intptr_t AddMaterializationDescriptor(
+      MaterializeObjectInstr* materialization);
 
   GrowableArray<DeoptInstr*> instructions_;
   const GrowableObjectArray& object_table_;
   const intptr_t num_args_;
+  // The materializations added so far and the indices of their
+  // descriptors in the object table.
+  GrowableArray<MaterializeObjectInstr*> materializations_;
+  GrowableArray<intptr_t> descriptor_indices_;
 
   DISALLOW_COPY_AND_ASSIGN(DeoptInfoBuilder);
 };
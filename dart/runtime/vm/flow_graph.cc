@@ -23,12 +23,14 @@ FlowGraph::FlowGraph(const FlowGraphBuilder& builder,
     num_copied_params_(builder.num_copied_params()),
     num_non_copied_params_(builder.num_non_copied_params()),
     num_stack_locals_(builder.num_stack_locals()),
+    osr_id_(builder.osr_id()),
     graph_entry_(graph_entry),
     preorder_(),
     postorder_(),
     reverse_postorder_(),
     exits_(NULL) {
   DiscoverBlocks();
+  if (IsCompiledForOsr()) InsertOsrEntry();
 }
 
 
@@ -68,6 +70,44 @@ void FlowGraph::DiscoverBlocks() {
 }
 
 
+// Replaces the normal entry of the graph by an entry jumping to a new join
+// inserted before the stack check with the OSR id.  The code preceding the
+// loop of the check is unreachable from the new entry unless the loop is
+// nested.
+void FlowGraph::InsertOsrEntry() {
+  BlockEntryInstr* block = NULL;
+  CheckStackOverflowInstr* check = NULL;
+  for (intptr_t i = 0; (i < preorder_.length()) && (check == NULL); ++i) {
+    block = preorder_[i];
+    for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+      CheckStackOverflowInstr* current = it.Current()->AsCheckStackOverflow();
+      if ((current != NULL) && (current->osr_id() == osr_id_)) {
+        ASSERT(current->in_loop());
+        check = current;
+        break;
+      }
+    }
+  }
+  if (check == NULL) {
+    Bailout("OSR entry not found");
+  }
+  JoinEntryInstr* join = new JoinEntryInstr(block->try_index());
+  check->previous()->set_next(new GotoInstr(join));
+  join->set_next(check);
+  TargetEntryInstr* osr_entry =
+      new TargetEntryInstr(graph_entry_->normal_entry()->try_index());
+  osr_entry->set_next(new GotoInstr(join));
+  graph_entry_->set_normal_entry(osr_entry);
+
+  // Discover the blocks reachable from the new entry.
+  for (intptr_t i = 0; i < preorder_.length(); ++i) {
+    preorder_[i]->set_preorder_number(-1);
+    preorder_[i]->ClearPredecessors();
+  }
+  DiscoverBlocks();
+}
+
+
 #ifdef DEBUG
 // Debugging code to verify the construction of use lists.
 
@@ -500,9 +540,11 @@ void FlowGraph::Rename(GrowableArray<PhiInstr*>* live_phis) {
   constant_null->set_ssa_temp_index(alloc_ssa_temp_index());
   graph_entry_->set_constant_null(constant_null);
 
-  // Initialize start environment.
+  // Initialize start environment.  In OSR code all variables are incoming.
   GrowableArray<Definition*> start_env(variable_count());
-  for (intptr_t i = 0; i < parameter_count(); ++i) {
+  const intptr_t incoming_count =
+      IsCompiledForOsr() ? variable_count() : parameter_count();
+  for (intptr_t i = 0; i < incoming_count; ++i) {
     ParameterInstr* param = new ParameterInstr(i, graph_entry_);
     param->set_ssa_temp_index(alloc_ssa_temp_index());  // New SSA temp.
     start_env.Add(param);
@@ -758,46 +800,116 @@ static void Link(Instruction* prev, Instruction* next) {
 //
 // Assumes the callee graph was computed by BuildGraph with an inlining context
 // and transformed to SSA with ComputeSSA with a correct virtual register
-// number, and that the use lists have been correctly computed.
+// number, and that its parameters were replaced by the arguments of the call.
+//
+// The body of the callee continues the block of the call.  If the callee
+// returns from more than one place, the returns are replaced by gotos to a
+// new join, whose phi replaces the call, and the instructions following the
+// call continue the join.
 //
 // After inlining the caller graph will correctly have adjusted the pre/post
-// orders, the dominator tree and the use lists.
+// orders and the dominator tree.  The uses of the removed returns are left in
+// the use lists, which must be recomputed.
 void FlowGraph::InlineCall(Definition* call, FlowGraph* callee_graph) {
   ASSERT(callee_graph->exits() != NULL);
   ASSERT(callee_graph->graph_entry()->SuccessorCount() == 1);
   ASSERT(callee_graph->max_virtual_register_number() >
          max_virtual_register_number());
 
-  // TODO(zerny): Implement support for callee graphs with control flow.
-  ASSERT(callee_graph->preorder().length() == 2);
-
   // Adjust the SSA temp index by the callee graph's index.
   current_ssa_temp_index_ = callee_graph->max_virtual_register_number();
 
   BlockEntryInstr* caller_entry = GetBlockEntry(call);
   TargetEntryInstr* callee_entry = callee_graph->graph_entry()->normal_entry();
   ZoneGrowableArray<ReturnInstr*>* callee_exits = callee_graph->exits();
+  const bool has_control_flow = (callee_graph->preorder().length() > 2);
 
   // 1. Insert the callee graph into the caller graph.
+  JoinEntryInstr* exit_join = NULL;
+  GrowableArray<BlockEntryInstr*> exit_blocks(callee_exits->length());
   if (callee_exits->is_empty()) {
     // If no normal exits exist, inline and truncate the block after inlining.
+    // The blocks following the call would become unreachable.
+    ASSERT(!has_control_flow);
     Link(call->previous(), callee_entry->next());
     caller_entry->set_last_instruction(callee_entry->last_instruction());
   } else if (callee_exits->length() == 1) {
     ReturnInstr* exit = (*callee_exits)[0];
-    // TODO(zerny): Support one exit graph containing control flow.
-    ASSERT(callee_entry == GetBlockEntry(exit));
     // For just one exit, replace the uses and remove the call from the graph.
     call->ReplaceUsesWith(exit->value()->definition());
     Link(call->previous(), callee_entry->next());
     Link(exit->previous(), call->next());
   } else {
-    // TODO(zerny): Support multiple exits.
-    UNREACHABLE();
+    // The exits of the callee are merged at a join following the callee
+    // body.  The blocks of the exits are the predecessors of the join.
+    exit_join = new JoinEntryInstr(caller_entry->try_index());
+    Link(call->previous(), callee_entry->next());
+    for (intptr_t i = 0; i < callee_exits->length(); ++i) {
+      ReturnInstr* exit = (*callee_exits)[i];
+      BlockEntryInstr* exit_block = GetBlockEntry(exit);
+      exit_blocks.Add((exit_block == callee_entry) ? caller_entry : exit_block);
+      Link(exit->previous(), new GotoInstr(exit_join));
+    }
+    Link(exit_join, call->next());
+  }
+  if (!has_control_flow) return;
+
+  // 2. Discover the blocks of the caller graph again.  The callee body is
+  // entered and left once, so the order of the predecessors of the joins,
+  // and with it the order of the inputs of their phis, does not change.
+  const GrowableArray<BlockEntryInstr*>& callee_blocks =
+      callee_graph->preorder();
+  for (intptr_t i = 0; i < callee_blocks.length(); ++i) {
+    callee_blocks[i]->set_preorder_number(-1);
+    callee_blocks[i]->ClearPredecessors();
+    callee_blocks[i]->ClearDominatedBlocks();
+  }
+  RecomputeDominators();
+
+  // 3. Merge the return values of multiple exits in a phi.
+  if ((exit_join != NULL) && call->HasSSATemp()) {
+    GrowableArray<Definition*> exit_values(callee_exits->length());
+    for (intptr_t i = 0; i < callee_exits->length(); ++i) {
+      exit_values.Add((*callee_exits)[i]->value()->definition());
+    }
+    ReplaceWithPhi(call, exit_join, exit_blocks, exit_values);
   }
+}
+
+
+void FlowGraph::RecomputeDominators() {
+  for (intptr_t i = 0; i < preorder_.length(); ++i) {
+    preorder_[i]->set_preorder_number(-1);
+    preorder_[i]->ClearPredecessors();
+    preorder_[i]->ClearDominatedBlocks();
+  }
+  DiscoverBlocks();
+  GrowableArray<BitVector*> dominance_frontier;
+  ComputeDominators(&preorder_, &parent_, &dominance_frontier);
+}
+
 
-  // TODO(zerny): Adjust pre/post orders.
-  // TODO(zerny): Update dominator tree.
+void FlowGraph::ReplaceWithPhi(Definition* defn,
+                               JoinEntryInstr* join,
+                               const GrowableArray<BlockEntryInstr*>& blocks,
+                               const GrowableArray<Definition*>& values) {
+  ASSERT(blocks.length() == values.length());
+  ASSERT(join->PredecessorCount() == blocks.length());
+  join->InsertPhi(0, 1);
+  PhiInstr* phi = (*join->phis())[0];
+  phi->set_ssa_temp_index(alloc_ssa_temp_index());
+  phi->mark_alive();
+  for (intptr_t i = 0; i < join->PredecessorCount(); ++i) {
+    BlockEntryInstr* pred = join->PredecessorAt(i);
+    intptr_t index = 0;
+    while (blocks[index] != pred) ++index;
+    Value* use = new Value(values[index]);
+    use->set_instruction(phi);
+    use->set_use_index(i);
+    use->AddToInputUseList();
+    phi->SetInputAt(i, use);
+  }
+  defn->ReplaceUsesWith(phi);
 }
 
 
@@ -62,6 +62,12 @@ class FlowGraph : public ZoneAllocated {
     return num_non_copied_params_;
   }
 
+  // The graph of a function compiled for on-stack replacement is entered in
+  // the frame of the unoptimized code of the function at the stack check of
+  // a loop.  All variables are then incoming in their stack slots.
+  bool IsCompiledForOsr() const { return osr_id_ != Isolate::kNoDeoptId; }
+  intptr_t osr_id() const { return osr_id_; }
+
   // Flow graph orders.
   const GrowableArray<BlockEntryInstr*>& preorder() const {
     return preorder_;
@@ -106,6 +112,18 @@ class FlowGraph : public ZoneAllocated {
 
   void InlineCall(Definition* call, FlowGraph* callee_graph);
 
+  // Discovers the blocks again and recomputes the dominator tree after the
+  // control flow of the graph changed.  Blocks added to the graph must not
+  // have been discovered before.
+  void RecomputeDominators();
+
+  // Replaces the uses of a definition with a new phi of a join, which merges
+  // the values flowing in from the given predecessors of the join.
+  void ReplaceWithPhi(Definition* defn,
+                      JoinEntryInstr* join,
+                      const GrowableArray<BlockEntryInstr*>& blocks,
+                      const GrowableArray<Definition*>& values);
+
   // TODO(zerny): Once the SSA is feature complete this should be removed.
   void Bailout(const char* reason) const;
 
@@ -117,6 +135,7 @@ class FlowGraph : public ZoneAllocated {
 
  private:
   void DiscoverBlocks();
+  void InsertOsrEntry();
 
   // SSA transformation methods and fields.
   void ComputeDominators(
@@ -155,6 +174,7 @@ class FlowGraph : public ZoneAllocated {
   const intptr_t num_copied_params_;
   const intptr_t num_non_copied_params_;
   const intptr_t num_stack_locals_;
+  const intptr_t osr_id_;
   GraphEntryInstr* graph_entry_;
   GrowableArray<BlockEntryInstr*> preorder_;
   GrowableArray<BlockEntryInstr*> postorder_;
@@ -68,7 +68,9 @@ FlowGraphAllocator::FlowGraphAllocator(const FlowGraph& flow_graph)
     xmm_regs_(),
     blocked_cpu_registers_(),
     blocked_xmm_registers_(),
-    cpu_spill_slot_count_(0) {
+    cpu_spill_slot_count_(0),
+    vector_vregs_(new BitVector(vreg_count_)),
+    has_vector_values_(false) {
   for (intptr_t i = 0; i < vreg_count_; i++) live_ranges_.Add(NULL);
 
   blocked_cpu_registers_[CTX] = true;
@@ -111,6 +113,18 @@ void FlowGraphAllocator::EliminateEnvironmentUses() {
             it.SetCurrentValue(new Value(constant_null));
             continue;
           }
+
+          MaterializeObjectInstr* materialization =
+              def->AsMaterializeObject();
+          if (materialization != NULL) {
+            for (intptr_t j = 0; j < materialization->InputCount(); ++j) {
+              PhiInstr* field_phi =
+                  materialization->InputAt(j)->definition()->AsPhi();
+              if ((field_phi != NULL) && !field_phi->is_alive()) {
+                materialization->SetInputAt(j, new Value(constant_null));
+              }
+            }
+          }
         }
       } else {
         current->set_env(NULL);
@@ -150,9 +164,16 @@ void FlowGraphAllocator::ComputeInitialSets() {
       // arguments are not allocated by the register allocator).
       if (current->env() != NULL) {
         for (intptr_t i = 0; i < current->env()->Length(); ++i) {
-          Value* value = current->env()->ValueAt(i);
-          if (!value->definition()->IsPushArgument()) {
-            live_in->Add(value->definition()->ssa_temp_index());
+          Definition* def = current->env()->ValueAt(i)->definition();
+          MaterializeObjectInstr* materialization = def->AsMaterializeObject();
+          if (materialization != NULL) {
+            // The fields of a sunk allocation are live instead.
+            for (intptr_t j = 0; j < materialization->InputCount(); ++j) {
+              live_in->Add(
+                  materialization->InputAt(j)->definition()->ssa_temp_index());
+            }
+          } else if (!def->IsPushArgument()) {
+            live_in->Add(def->ssa_temp_index());
           }
         }
       }
@@ -541,7 +562,8 @@ void FlowGraphAllocator::BuildLiveRanges() {
 
     range->set_assigned_location(Location::StackSlot(slot_index));
     range->set_spill_slot(Location::StackSlot(slot_index));
-    if (flow_graph_.num_copied_params() > 0) {
+    // Copied parameters and, in OSR code, locals are in the spill area.
+    if (slot_index >= 0) {
       ASSERT(spill_slots_.length() == slot_index);
       spill_slots_.Add(range->End());
     }
@@ -558,7 +580,7 @@ void FlowGraphAllocator::BuildLiveRanges() {
       CompleteRange(tail, Location::kRegister);
     }
     ConvertAllUses(range);
-    if (flow_graph_.num_copied_params() > 0) {
+    if (slot_index >= 0) {
       MarkAsObjectAtSafepoints(range);
     }
   }
@@ -591,7 +613,9 @@ static Location::Kind RegisterKindFromPolicy(Location loc) {
 
 
 static Location::Kind RegisterKindForResult(Instruction* instr) {
-  if (instr->representation() == kUnboxedDouble) {
+  if ((instr->representation() == kUnboxedDouble) ||
+      (instr->representation() == kUnboxedMint) ||
+      (instr->representation() == kUnboxedVector)) {
     return Location::kXmmRegister;
   } else {
     return Location::kRegister;
@@ -727,7 +751,7 @@ void FlowGraphAllocator::ConnectIncomingPhiMoves(BlockEntryInstr* block) {
       // complete.
       AssignSafepoints(range);
 
-      CompleteRange(range, RegisterKindForResult(phi));
+      CompleteDefinitionRange(range, phi);
 
       move_idx++;
     }
@@ -768,6 +792,16 @@ void FlowGraphAllocator::ProcessEnvironmentUses(BlockEntryInstr* block,
       continue;
     }
 
+    MaterializeObjectInstr* materialization = def->AsMaterializeObject();
+    if (materialization != NULL) {
+      // The object is described by the locations of its fields.
+      locations[i] = Location::NoLocation();
+      if (!materialization->HasLocations()) {
+        ProcessMaterializationUses(block_start_pos, use_pos, materialization);
+      }
+      continue;
+    }
+
     ConstantInstr* constant = def->AsConstant();
     if (constant != NULL) {
       locations[i] = Location::Constant(constant->value());
@@ -784,6 +818,33 @@ void FlowGraphAllocator::ProcessEnvironmentUses(BlockEntryInstr* block,
 }
 
 
+void FlowGraphAllocator::ProcessMaterializationUses(
+    intptr_t block_start_pos,
+    intptr_t use_pos,
+    MaterializeObjectInstr* materialization) {
+  // The values of the fields are used like environment values.
+  Location* locations = Isolate::Current()->current_zone()->Alloc<Location>(
+      materialization->InputCount());
+
+  for (intptr_t i = 0; i < materialization->InputCount(); ++i) {
+    Definition* def = materialization->InputAt(i)->definition();
+    locations[i] = Location::Any();
+
+    ConstantInstr* constant = def->AsConstant();
+    if (constant != NULL) {
+      locations[i] = Location::Constant(constant->value());
+      continue;
+    }
+
+    LiveRange* range = GetLiveRange(def->ssa_temp_index());
+    range->AddUseInterval(block_start_pos, use_pos);
+    range->AddUse(use_pos, &locations[i]);
+  }
+
+  materialization->set_locations(locations);
+}
+
+
 // Create and update live ranges corresponding to instruction's inputs,
 // temporaries and output.
 void FlowGraphAllocator::ProcessOneInstruction(BlockEntryInstr* block,
@@ -1046,7 +1107,7 @@ void FlowGraphAllocator::ProcessOneInstruction(BlockEntryInstr* block,
   }
 
   AssignSafepoints(range);
-  CompleteRange(range, RegisterKindForResult(current));
+  CompleteDefinitionRange(range, current);
 }
 
 
@@ -1494,11 +1555,13 @@ void FlowGraphAllocator::AllocateSpillSlotFor(LiveRange* range) {
     // word size spill slots.  We use the index of the slot with the lowest
     // address as an index for the double spill slot. In terms of indexes
     // this relation is inverted: so we have to take the highest index.
-    const intptr_t slot_idx =
-        idx * kDoubleSpillSlotFactor + (kDoubleSpillSlotFactor - 1);
-    range->set_spill_slot(
-        Location::DoubleStackSlot(
-            cpu_spill_slot_count_ + slot_idx));
+    // Quad spill slots are indexed the same way.
+    const intptr_t factor = XmmSpillSlotFactor();
+    const intptr_t slot_idx = idx * factor + (factor - 1);
+    const intptr_t stack_index = cpu_spill_slot_count_ + slot_idx;
+    range->set_spill_slot(vector_vregs_->Contains(range->vreg())
+                              ? Location::QuadStackSlot(stack_index)
+                              : Location::DoubleStackSlot(stack_index));
   }
 
   spilled_.Add(range);
@@ -1915,6 +1978,16 @@ void FlowGraphAllocator::AddToUnallocated(LiveRange* range) {
 }
 
 
+void FlowGraphAllocator::CompleteDefinitionRange(LiveRange* range,
+                                                 Instruction* defn) {
+  if (defn->representation() == kUnboxedVector) {
+    vector_vregs_->Add(range->vreg());
+    has_vector_values_ = true;
+  }
+  CompleteRange(range, RegisterKindForResult(defn));
+}
+
+
 void FlowGraphAllocator::CompleteRange(LiveRange* range, Location::Kind kind) {
   switch (kind) {
     case Location::kRegister:
@@ -2003,6 +2076,7 @@ bool FlowGraphAllocator::TargetLocationIsSpillSlot(LiveRange* range,
                                                    Location target) {
   if (target.IsStackSlot() ||
       target.IsDoubleStackSlot() ||
+      target.IsQuadStackSlot() ||
       target.IsConstant()) {
     ASSERT(GetLiveRange(range->vreg())->spill_slot().Equals(target));
     return true;
@@ -2129,6 +2203,7 @@ void FlowGraphAllocator::ResolveControlFlow() {
     LiveRange* range = spilled_[i];
     if (range->assigned_location().IsStackSlot() ||
         range->assigned_location().IsDoubleStackSlot() ||
+        range->assigned_location().IsQuadStackSlot() ||
         range->assigned_location().IsConstant()) {
       ASSERT(range->assigned_location().Equals(range->spill_slot()));
     } else {
@@ -2191,9 +2266,9 @@ void FlowGraphAllocator::AllocateRegisters() {
 
   GraphEntryInstr* entry = block_order_[0]->AsGraphEntry();
   ASSERT(entry != NULL);
-  intptr_t double_spill_slot_count =
-      spill_slots_.length() * kDoubleSpillSlotFactor;
-  entry->set_spill_slot_count(cpu_spill_slot_count_ + double_spill_slot_count);
+  intptr_t xmm_spill_slot_count =
+      spill_slots_.length() * XmmSpillSlotFactor();
+  entry->set_spill_slot_count(cpu_spill_slot_count_ + xmm_spill_slot_count);
 
   if (FLAG_print_ssa_liveranges) {
     const Function& function = flow_graph_.parsed_function().function();
@@ -14,6 +14,7 @@ class AllocationFinger;
 class BlockInfo;
 class FlowGraph;
 class LiveRange;
+class MaterializeObjectInstr;
 class UseInterval;
 class UsePosition;
 
@@ -21,6 +22,9 @@ class FlowGraphAllocator : public ValueObject {
  public:
   // Number of stack slots needed for a double spill slot.
   static const intptr_t kDoubleSpillSlotFactor = kDoubleSize / kWordSize;
+  // Number of stack slots needed for a spill slot holding a whole xmm
+  // register.
+  static const intptr_t kQuadSpillSlotFactor = kQuadSize / kWordSize;
 
   explicit FlowGraphAllocator(const FlowGraph& flow_graph);
 
@@ -94,6 +98,9 @@ class FlowGraphAllocator : public ValueObject {
   void BuildLiveRanges();
   Instruction* ConnectOutgoingPhiMoves(BlockEntryInstr* block);
   void ProcessEnvironmentUses(BlockEntryInstr* block, Instruction* current);
+  void ProcessMaterializationUses(intptr_t block_start_pos,
+                                  intptr_t use_pos,
+                                  MaterializeObjectInstr* materialization);
   void ProcessOneInstruction(BlockEntryInstr* block, Instruction* instr);
   void ConnectIncomingPhiMoves(BlockEntryInstr* block);
   void BlockLocation(Location loc, intptr_t from, intptr_t to);
@@ -138,6 +145,8 @@ class FlowGraphAllocator : public ValueObject {
   // by the allocator.
   void AddToUnallocated(LiveRange* range);
   void CompleteRange(LiveRange* range, Location::Kind kind);
+  // Complete the range of the value defined by the given instruction.
+  void CompleteDefinitionRange(LiveRange* range, Instruction* defn);
 #if defined(DEBUG)
   bool UnallocatedIsSorted();
 #endif
@@ -172,6 +181,11 @@ class FlowGraphAllocator : public ValueObject {
   // Split given live range in an optimal position between given positions.
   LiveRange* SplitBetween(LiveRange* range, intptr_t from, intptr_t to);
 
+  // Number of stack slots in each xmm spill slot.
+  intptr_t XmmSpillSlotFactor() const {
+    return has_vector_values_ ? kQuadSpillSlotFactor : kDoubleSpillSlotFactor;
+  }
+
   // Find a spill slot that can be used by the given live range.
   void AllocateSpillSlotFor(LiveRange* range);
 
@@ -269,6 +283,12 @@ class FlowGraphAllocator : public ValueObject {
   GrowableArray<intptr_t> spill_slots_;
   intptr_t cpu_spill_slot_count_;
 
+  // Virtual registers holding 128-bit vector values. Such values are spilled
+  // into quad spill slots and when a function has any of them all xmm spill
+  // slots are quad sized.
+  BitVector* vector_vregs_;
+  bool has_vector_values_;
+
 
   DISALLOW_COPY_AND_ASSIGN(FlowGraphAllocator);
 };
@@ -29,7 +29,8 @@ DEFINE_FLAG(bool, trace_type_check_elimination, false,
 DECLARE_FLAG(bool, enable_type_checks);
 
 
-FlowGraphBuilder::FlowGraphBuilder(const ParsedFunction& parsed_function)
+FlowGraphBuilder::FlowGraphBuilder(const ParsedFunction& parsed_function,
+                                   intptr_t osr_id)
   : parsed_function_(parsed_function),
     num_copied_params_(parsed_function.num_copied_params()),
     // All parameters are copied if any parameter is.
@@ -37,6 +38,7 @@ FlowGraphBuilder::FlowGraphBuilder(const ParsedFunction& parsed_function)
         ? parsed_function.function().num_fixed_parameters()
         : 0),
     num_stack_locals_(parsed_function.num_stack_locals()),
+    osr_id_(osr_id),
     context_level_(0),
     last_used_try_index_(CatchClauseNode::kInvalidTryIndex),
     try_index_(CatchClauseNode::kInvalidTryIndex),
@@ -66,7 +68,9 @@ void EffectGraphVisitor::Append(const EffectGraphVisitor& other_fragment) {
 
 Value* EffectGraphVisitor::Bind(Definition* definition) {
   ASSERT(is_open());
-  ASSERT(!owner()->InInliningContext() || !definition->CanDeoptimize());
+  ASSERT(!owner()->InInliningContext() ||
+         !definition->CanDeoptimize() ||
+         definition->IsStaticCall());
   DeallocateTempIndex(definition->InputCount());
   definition->set_use_kind(Definition::kValue);
   definition->set_temp_index(AllocateTempIndex());
@@ -82,7 +86,9 @@ Value* EffectGraphVisitor::Bind(Definition* definition) {
 
 void EffectGraphVisitor::Do(Definition* definition) {
   ASSERT(is_open());
-  ASSERT(!owner()->InInliningContext() || !definition->CanDeoptimize());
+  ASSERT(!owner()->InInliningContext() ||
+         !definition->CanDeoptimize() ||
+         definition->IsStaticCall());
   DeallocateTempIndex(definition->InputCount());
   definition->set_use_kind(Definition::kEffect);
   if (is_empty()) {
@@ -1195,7 +1201,7 @@ void EffectGraphVisitor::VisitWhileNode(WhileNode* node) {
 
   EffectGraphVisitor for_body(owner(), temp_index());
   for_body.Do(
-      new CheckStackOverflowInstr(node->token_pos()));
+      new CheckStackOverflowInstr(node->token_pos(), true));
   node->body()->Visit(&for_body);
 
   // Labels are set after body traversal.
@@ -1228,7 +1234,7 @@ void EffectGraphVisitor::VisitDoWhileNode(DoWhileNode* node) {
   // Traverse body first in order to generate continue and break labels.
   EffectGraphVisitor for_body(owner(), temp_index());
   for_body.Do(
-      new CheckStackOverflowInstr(node->token_pos()));
+      new CheckStackOverflowInstr(node->token_pos(), true));
   node->body()->Visit(&for_body);
 
   TestGraphVisitor for_test(owner(),
@@ -1284,7 +1290,7 @@ void EffectGraphVisitor::VisitForNode(ForNode* node) {
   // Compose body to set any jump labels.
   EffectGraphVisitor for_body(owner(), temp_index());
   for_body.Do(
-      new CheckStackOverflowInstr(node->token_pos()));
+      new CheckStackOverflowInstr(node->token_pos(), true));
   node->body()->Visit(&for_body);
 
   // Join loop body, increment and compute their end instruction.
@@ -1408,6 +1414,7 @@ void EffectGraphVisitor::VisitArgumentListNode(ArgumentListNode* node) {
 
 void EffectGraphVisitor::VisitArgumentDefinitionTestNode(
     ArgumentDefinitionTestNode* node) {
+  InlineBailout("EffectGraphVisitor::VisitArgumentDefinitionTestNode");
   Definition* load = BuildLoadLocal(node->saved_arguments_descriptor());
   Value* arguments_descriptor = Bind(load);
   ArgumentDefinitionTestInstr* arg_def_test =
@@ -1534,7 +1541,7 @@ void EffectGraphVisitor::VisitInstanceCallNode(InstanceCallNode* node) {
 // <Expression> ::= StaticCall { function: Function
 //                               arguments: <ArgumentList> }
 void EffectGraphVisitor::VisitStaticCallNode(StaticCallNode* node) {
-  InlineBailout("EffectGraphVisitor::VisitStaticCallNode (deopt)");
+  // When inlining, the inliner inlines the call in turn or gives up.
   ZoneGrowableArray<PushArgumentInstr*>* arguments =
       new ZoneGrowableArray<PushArgumentInstr*>(node->arguments()->length());
   BuildPushArguments(*node->arguments(), arguments);
@@ -2621,7 +2628,7 @@ FlowGraph* FlowGraphBuilder::BuildGraph(InliningContext context) {
   EffectGraphVisitor for_effect(this, 0);
   // TODO(kmillikin): We can eliminate stack checks in some cases (e.g., the
   // stack check on entry for leaf routines).
-  for_effect.Do(new CheckStackOverflowInstr(function.token_pos()));
+  for_effect.Do(new CheckStackOverflowInstr(function.token_pos(), false));
   parsed_function().node_sequence()->Visit(&for_effect);
   AppendFragment(normal_entry, for_effect);
   // Check that the graph is properly terminated.
@@ -19,7 +19,10 @@ class ParsedFunction;
 // Build a flow graph from a parsed function's AST.
 class FlowGraphBuilder: public ValueObject {
  public:
-  explicit FlowGraphBuilder(const ParsedFunction& parsed_function);
+  // The graph of a function compiled for on-stack replacement is entered at
+  // the loop stack check with the id 'osr_id'. Otherwise 'osr_id' is
+  // Isolate::kNoDeoptId.
+  FlowGraphBuilder(const ParsedFunction& parsed_function, intptr_t osr_id);
 
   enum InliningContext {
     kNotInlining,
@@ -56,6 +59,8 @@ class FlowGraphBuilder: public ValueObject {
     return num_stack_locals_;
   }
 
+  intptr_t osr_id() const { return osr_id_; }
+
   bool InInliningContext() const { return inlining_context_ != kNotInlining; }
   void AddReturnExit(ReturnInstr* return_instr) {
     if (InInliningContext()) {
@@ -77,6 +82,7 @@ class FlowGraphBuilder: public ValueObject {
   const intptr_t num_copied_params_;
   const intptr_t num_non_copied_params_;
   const intptr_t num_stack_locals_;  // Does not include any parameters.
+  const intptr_t osr_id_;
 
   intptr_t context_level_;
   intptr_t last_used_try_index_;
@@ -29,6 +29,7 @@ DECLARE_FLAG(bool, intrinsify);
 DECLARE_FLAG(bool, report_usage_count);
 DECLARE_FLAG(bool, trace_functions);
 DECLARE_FLAG(int, optimization_counter_threshold);
+DECLARE_FLAG(bool, use_osr);
 
 
 void CompilerDeoptInfo::BuildReturnAddress(DeoptInfoBuilder* builder,
@@ -60,10 +61,13 @@ RawDeoptInfo* CompilerDeoptInfo::CreateDeoptInfo(FlowGraphCompiler* compiler) {
   BuildReturnAddress(&builder, function, slot_ix++);
 
   // Assign locations to values pushed above spill slots with PushArgument.
+  // Sunk allocations have no location: they are described by their fields.
   intptr_t height = compiler->StackSize();
   for (intptr_t i = 0; i < deoptimization_env_->Length(); i++) {
-    if (deoptimization_env_->LocationAt(i).IsInvalid()) {
-      ASSERT(deoptimization_env_->ValueAt(i)->definition()->IsPushArgument());
+    Definition* def = deoptimization_env_->ValueAt(i)->definition();
+    if (deoptimization_env_->LocationAt(i).IsInvalid() &&
+        !def->IsMaterializeObject()) {
+      ASSERT(def->IsPushArgument());
       *deoptimization_env_->LocationSlotAt(i) = Location::StackSlot(height++);
     }
   }
@@ -108,11 +112,18 @@ FlowGraphCompiler::FlowGraphCompiler(Assembler* assembler,
       deopt_infos_(),
       object_table_(GrowableObjectArray::Handle(GrowableObjectArray::New())),
       is_optimizing_(is_optimizing),
+      is_compiled_for_osr_(flow_graph.IsCompiledForOsr()),
       is_dart_leaf_(is_leaf),
       bool_true_(Bool::ZoneHandle(Bool::True())),
       bool_false_(Bool::ZoneHandle(Bool::False())),
       double_class_(Class::ZoneHandle(
           Isolate::Current()->object_store()->double_class())),
+      mint_class_(Class::ZoneHandle(
+          Isolate::Current()->object_store()->mint_class())),
+      float32x4_class_(Class::ZoneHandle(
+          Isolate::Current()->object_store()->float32x4_class())),
+      int32x4_class_(Class::ZoneHandle(
+          Isolate::Current()->object_store()->int32x4_class())),
       parallel_move_resolver_(this) {
   ASSERT(assembler != NULL);
 }
@@ -130,6 +141,7 @@ FlowGraphCompiler::~FlowGraphCompiler() {
 
 bool FlowGraphCompiler::IsLeaf() const {
   return is_dart_leaf_ &&
+         !is_compiled_for_osr_ &&
          !parsed_function_.function().IsClosureFunction() &&
          (parsed_function().num_copied_params() == 0);
 }
@@ -157,6 +169,11 @@ bool FlowGraphCompiler::CanOptimize() {
 }
 
 
+bool FlowGraphCompiler::CanOsrFunction() const {
+  return FLAG_use_osr && CanOptimize() && !is_optimizing();
+}
+
+
 void FlowGraphCompiler::VisitBlocks() {
   for (intptr_t i = 0; i < block_order().length(); ++i) {
     assembler()->Comment("B%"Pd"", i);
@@ -293,7 +310,7 @@ void FlowGraphCompiler::RecordSafepoint(LocationSummary* locs) {
           XmmRegister reg = static_cast<XmmRegister>(i);
           if (regs->ContainsXmmRegister(reg)) {
             for (intptr_t j = 0;
-                 j < FlowGraphAllocator::kDoubleSpillSlotFactor;
+                 j < FlowGraphAllocator::kQuadSpillSlotFactor;
                  ++j) {
               bitmap->Set(bitmap->Length(), false);
             }
@@ -465,6 +482,36 @@ void FlowGraphCompiler::GenerateInstanceCall(
 }
 
 
+// Calls the megamorphic lookup stub directly, the unoptimized call site has
+// already switched to the megamorphic cache shared by all calls of the
+// selector.
+void FlowGraphCompiler::GenerateMegamorphicInstanceCall(
+    const ICData& ic_data,
+    const String& function_name,
+    intptr_t argument_count,
+    const Array& argument_names,
+    intptr_t deopt_id,
+    intptr_t token_pos,
+    LocationSummary* locs) {
+  ASSERT(ic_data.IsMegamorphic());
+  const Array& arguments_descriptor =
+      DartEntry::ArgumentsDescriptor(argument_count, argument_names);
+  const MegamorphicCache& cache =
+      MegamorphicCache::Handle(ic_data.megamorphic_cache());
+  ASSERT(cache.arguments_descriptor() == arguments_descriptor.raw());
+  ICData& megamorphic_ic_data =
+      ICData::ZoneHandle(ICData::New(parsed_function().function(),
+                                     function_name,
+                                     deopt_id,
+                                     1));
+  megamorphic_ic_data.set_megamorphic_cache(cache);
+  ExternalLabel target_label("MegamorphicLookup",
+                             StubCode::MegamorphicLookupEntryPoint());
+  EmitInstanceCall(&target_label, megamorphic_ic_data, arguments_descriptor,
+                   argument_count, deopt_id, token_pos, locs);
+}
+
+
 void FlowGraphCompiler::GenerateStaticCall(intptr_t deopt_id,
                                            intptr_t token_pos,
                                            const Function& function,
@@ -859,4 +906,40 @@ bool FlowGraphCompiler::EvaluateCondition(Condition condition,
 }
 
 
+intptr_t FlowGraphCompiler::ElementSizeFor(intptr_t class_id) {
+  switch (class_id) {
+    case kArrayCid:
+    case kImmutableArrayCid:
+      return kWordSize;
+    case kFloat32ArrayCid:
+      return Float32Array::kBytesPerElement;
+    case kFloat64ArrayCid:
+      return Float64Array::kBytesPerElement;
+    case kInt32ArrayCid:
+      return Int32Array::kBytesPerElement;
+    default:
+      UNIMPLEMENTED();
+      return 0;
+  }
+}
+
+
+intptr_t FlowGraphCompiler::DataOffsetFor(intptr_t class_id) {
+  switch (class_id) {
+    case kArrayCid:
+    case kImmutableArrayCid:
+      return Array::data_offset();
+    case kFloat32ArrayCid:
+      return Float32Array::data_offset();
+    case kFloat64ArrayCid:
+      return Float64Array::data_offset();
+    case kInt32ArrayCid:
+      return Int32Array::data_offset();
+    default:
+      UNIMPLEMENTED();
+      return 0;
+  }
+}
+
+
 }  // namespace dart
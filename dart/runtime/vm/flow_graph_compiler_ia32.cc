@@ -939,16 +939,7 @@ void FlowGraphCompiler::GenerateInlinedMathSqrt(Label* done) {
 }
 
 
-void FlowGraphCompiler::CompileGraph() {
-  InitCompiler();
-  if (TryIntrinsify()) {
-    // Although this intrinsified code will never be patched, it must satisfy
-    // CodePatcher::CodeIsPatchable, which verifies that this code has a minimum
-    // code size.
-    __ int3();
-    __ jmp(&StubCode::FixCallersTargetLabel());
-    return;
-  }
+void FlowGraphCompiler::EmitFrameEntry() {
   // Specialized version of entry code from CodeGenerator::GenerateEntryCode.
   const Function& function = parsed_function().function();
 
@@ -1032,6 +1023,29 @@ void FlowGraphCompiler::CompileGraph() {
       __ movl(Address(EBP, (slot_base - i) * kWordSize), EAX);
     }
   }
+}
+
+
+void FlowGraphCompiler::CompileGraph() {
+  InitCompiler();
+  if (!is_compiled_for_osr() && TryIntrinsify()) {
+    // Although this intrinsified code will never be patched, it must satisfy
+    // CodePatcher::CodeIsPatchable, which verifies that this code has a minimum
+    // code size.
+    __ int3();
+    __ jmp(&StubCode::FixCallersTargetLabel());
+    return;
+  }
+  if (is_compiled_for_osr()) {
+    // The frame of the unoptimized code is entered at the stack check of a
+    // loop, the variables are in their stack slots already.
+    __ Comment("Enter frame for OSR");
+    const intptr_t offset =
+        -StackSize() * kWordSize + kLocalsOffsetFromFP;
+    __ leal(ESP, Address(EBP, offset));
+  } else {
+    EmitFrameEntry();
+  }
 
   if (FLAG_print_scopes) {
     // Print the function scope (again) after generating the prologue in order
@@ -1164,18 +1178,18 @@ void FlowGraphCompiler::SaveLiveRegisters(LocationSummary* locs) {
   // TODO(vegorov): consider saving only caller save (volatile) registers.
   const intptr_t xmm_regs_count = locs->live_registers()->xmm_regs_count();
   if (xmm_regs_count > 0) {
-    __ subl(ESP, Immediate(xmm_regs_count * kDoubleSize));
-    // Store XMM registers with the lowest register number at the lowest
-    // address.
+    __ subl(ESP, Immediate(xmm_regs_count * kQuadSize));
+    // Store all 128 bits of XMM registers, they may hold vector values.
+    // Registers with the lowest register number are at the lowest address.
     intptr_t offset = 0;
     for (intptr_t reg_idx = 0; reg_idx < kNumberOfXmmRegisters; ++reg_idx) {
       XmmRegister xmm_reg = static_cast<XmmRegister>(reg_idx);
       if (locs->live_registers()->ContainsXmmRegister(xmm_reg)) {
-        __ movsd(Address(ESP, offset), xmm_reg);
-        offset += kDoubleSize;
+        __ movups(Address(ESP, offset), xmm_reg);
+        offset += kQuadSize;
       }
     }
-    ASSERT(offset == (xmm_regs_count * kDoubleSize));
+    ASSERT(offset == (xmm_regs_count * kQuadSize));
   }
 
   // Store general purpose registers with the highest register number at the
@@ -1206,11 +1220,11 @@ void FlowGraphCompiler::RestoreLiveRegisters(LocationSummary* locs) {
     for (intptr_t reg_idx = 0; reg_idx < kNumberOfXmmRegisters; ++reg_idx) {
       XmmRegister xmm_reg = static_cast<XmmRegister>(reg_idx);
       if (locs->live_registers()->ContainsXmmRegister(xmm_reg)) {
-        __ movsd(xmm_reg, Address(ESP, offset));
-        offset += kDoubleSize;
+        __ movups(xmm_reg, Address(ESP, offset));
+        offset += kQuadSize;
       }
     }
-    ASSERT(offset == (xmm_regs_count * kDoubleSize));
+    ASSERT(offset == (xmm_regs_count * kQuadSize));
     __ addl(ESP, Immediate(offset));
   }
 }
@@ -1258,9 +1272,11 @@ void ParallelMoveResolver::EmitMove(int index) {
       // Optimization manual recommends using MOVAPS for register
       // to register moves.
       __ movaps(destination.xmm_reg(), source.xmm_reg());
-    } else {
-      ASSERT(destination.IsDoubleStackSlot());
+    } else if (destination.IsDoubleStackSlot()) {
       __ movsd(ToStackSlotAddress(destination), source.xmm_reg());
+    } else {
+      ASSERT(destination.IsQuadStackSlot());
+      __ movups(ToStackSlotAddress(destination), source.xmm_reg());
     }
   } else if (source.IsDoubleStackSlot()) {
     if (destination.IsXmmRegister()) {
@@ -1270,6 +1286,14 @@ void ParallelMoveResolver::EmitMove(int index) {
       __ movsd(XMM0, ToStackSlotAddress(source));
       __ movsd(ToStackSlotAddress(destination), XMM0);
     }
+  } else if (source.IsQuadStackSlot()) {
+    if (destination.IsXmmRegister()) {
+      __ movups(destination.xmm_reg(), ToStackSlotAddress(source));
+    } else {
+      ASSERT(destination.IsQuadStackSlot());
+      __ movups(XMM0, ToStackSlotAddress(source));
+      __ movups(ToStackSlotAddress(destination), XMM0);
+    }
   } else {
     ASSERT(source.IsConstant());
     if (destination.IsRegister()) {
@@ -1307,14 +1331,22 @@ void ParallelMoveResolver::EmitSwap(int index) {
     __ movaps(source.xmm_reg(), destination.xmm_reg());
     __ movaps(destination.xmm_reg(), XMM0);
   } else if (source.IsXmmRegister() || destination.IsXmmRegister()) {
-    ASSERT(destination.IsDoubleStackSlot() || source.IsDoubleStackSlot());
+    ASSERT(destination.IsDoubleStackSlot() ||
+           destination.IsQuadStackSlot() ||
+           source.IsDoubleStackSlot() ||
+           source.IsQuadStackSlot());
     XmmRegister reg = source.IsXmmRegister() ? source.xmm_reg()
                                              : destination.xmm_reg();
-    Address slot_address =
-        ToStackSlotAddress(source.IsXmmRegister() ? destination : source);
+    const Location slot = source.IsXmmRegister() ? destination : source;
+    Address slot_address = ToStackSlotAddress(slot);
 
-    __ movsd(XMM0, slot_address);
-    __ movsd(slot_address, reg);
+    if (slot.IsQuadStackSlot()) {
+      __ movups(XMM0, slot_address);
+      __ movups(slot_address, reg);
+    } else {
+      __ movsd(XMM0, slot_address);
+      __ movsd(slot_address, reg);
+    }
     __ movaps(reg, XMM0);
   } else {
     UNREACHABLE();
@@ -1387,6 +1419,42 @@ void ParallelMoveResolver::Exchange(const Address& mem1, const Address& mem2) {
 
 #undef __
 
+
+static ScaleFactor ToScaleFactor(intptr_t index_scale) {
+  switch (index_scale) {
+    case 1: return TIMES_1;
+    case 2: return TIMES_2;
+    case 4: return TIMES_4;
+    case 8: return TIMES_8;
+    default:
+      UNREACHABLE();
+      return TIMES_1;
+  }
+}
+
+
+FieldAddress FlowGraphCompiler::ElementAddressForIntIndex(intptr_t class_id,
+                                                          Register array,
+                                                          intptr_t index) {
+  const int64_t disp =
+      static_cast<int64_t>(index) * ElementSizeFor(class_id) +
+      DataOffsetFor(class_id);
+  ASSERT(Utils::IsInt(32, disp));
+  return FieldAddress(array, static_cast<int32_t>(disp));
+}
+
+
+FieldAddress FlowGraphCompiler::ElementAddressForRegIndex(intptr_t class_id,
+                                                          Register array,
+                                                          Register index) {
+  // Note that index is Smi, i.e, times 2.
+  ASSERT(kSmiTagShift == 1);
+  return FieldAddress(array,
+                      index,
+                      ToScaleFactor(ElementSizeFor(class_id) / 2),
+                      DataOffsetFor(class_id));
+}
+
 }  // namespace dart
 
 #endif  // defined TARGET_ARCH_IA32
@@ -49,7 +49,12 @@ class FlowGraphCompiler : public ValueObject {
     current_block_ = value;
   }
   static bool CanOptimize();
+  // True if the loops of unoptimized code count their iterations in order to
+  // continue in optimized code (on-stack replacement) once they are hot.
+  bool CanOsrFunction() const;
   bool is_optimizing() const { return is_optimizing_; }
+  // True if the code is entered in the frame of the unoptimized code.
+  bool is_compiled_for_osr() const { return is_compiled_for_osr_; }
 
   const GrowableArray<BlockInfo*>& block_info() const { return block_info_; }
   ParallelMoveResolver* parallel_move_resolver() {
@@ -109,6 +114,14 @@ class FlowGraphCompiler : public ValueObject {
                             intptr_t checked_argument_count,
                             LocationSummary* locs);
 
+  void GenerateMegamorphicInstanceCall(const ICData& ic_data,
+                                       const String& function_name,
+                                       intptr_t argument_count,
+                                       const Array& argument_names,
+                                       intptr_t deopt_id,
+                                       intptr_t token_pos,
+                                       LocationSummary* locs);
+
   void GenerateStaticCall(intptr_t deopt_id,
                           intptr_t token_pos,
                           const Function& function,
@@ -188,6 +201,9 @@ class FlowGraphCompiler : public ValueObject {
   const Bool& bool_true() const { return bool_true_; }
   const Bool& bool_false() const { return bool_false_; }
   const Class& double_class() const { return double_class_; }
+  const Class& mint_class() const { return mint_class_; }
+  const Class& float32x4_class() const { return float32x4_class_; }
+  const Class& int32x4_class() const { return int32x4_class_; }
 
   // Returns true if the compiled function has a finally clause.
   bool HasFinally() const;
@@ -212,6 +228,16 @@ class FlowGraphCompiler : public ValueObject {
 
   static bool EvaluateCondition(Condition condition, intptr_t l, intptr_t r);
 
+  // Array elements are accessed with a Smi index or a constant index.
+  static intptr_t ElementSizeFor(intptr_t class_id);
+  static intptr_t DataOffsetFor(intptr_t class_id);
+  static FieldAddress ElementAddressForIntIndex(intptr_t class_id,
+                                                Register array,
+                                                intptr_t index);
+  static FieldAddress ElementAddressForRegIndex(intptr_t class_id,
+                                                Register array,
+                                                Register index);
+
  private:
   void GenerateDeferredCode();
 
@@ -277,6 +303,7 @@ class FlowGraphCompiler : public ValueObject {
 
   void GenerateBoolToJump(Register bool_reg, Label* is_true, Label* is_false);
 
+  void EmitFrameEntry();
   void CopyParameters();
 
   void GenerateInlinedGetter(intptr_t offset);
@@ -308,11 +335,15 @@ class FlowGraphCompiler : public ValueObject {
   GrowableArray<SlowPathCode*> slow_path_code_;
   const GrowableObjectArray& object_table_;
   const bool is_optimizing_;
+  const bool is_compiled_for_osr_;
   const bool is_dart_leaf_;
 
   const Bool& bool_true_;
   const Bool& bool_false_;
   const Class& double_class_;
+  const Class& mint_class_;
+  const Class& float32x4_class_;
+  const Class& int32x4_class_;
 
   ParallelMoveResolver parallel_move_resolver_;
 
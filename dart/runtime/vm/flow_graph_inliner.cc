@@ -16,6 +16,17 @@ namespace dart {
 
 DEFINE_FLAG(bool, trace_inlining, false, "Trace inlining");
 DEFINE_FLAG(charp, inlining_filter, NULL, "Inline only in named function");
+DEFINE_FLAG(int, inlining_size_threshold, 50,
+            "Inline only callees with at most this many instructions");
+DEFINE_FLAG(int, inlining_depth_threshold, 3,
+            "Inline calls in inlined callees up to this depth");
+DEFINE_FLAG(int, inlining_growth_threshold, 500,
+            "Stop inlining into a function once it grew by this many "
+            "instructions");
+DEFINE_FLAG(int, inlining_polymorphic_targets, 4,
+            "Inline at most this many of the targets of a polymorphic call, "
+            "the most frequently called first");
+DECLARE_FLAG(bool, enable_type_checks);
 DECLARE_FLAG(bool, print_flow_graph);
 
 #define TRACE_INLINING(statement)                                              \
@@ -24,28 +35,96 @@ DECLARE_FLAG(bool, print_flow_graph);
   } while (false)
 
 
+// Number of instructions of a graph, used to measure the size of callees
+// and the growth of callers.
+static intptr_t GraphSize(const FlowGraph& graph) {
+  intptr_t size = 0;
+  const GrowableArray<BlockEntryInstr*>& blocks = graph.preorder();
+  for (intptr_t i = 0; i < blocks.length(); ++i) {
+    for (ForwardInstructionIterator it(blocks[i]); !it.Done(); it.Advance()) {
+      ++size;
+    }
+  }
+  return size;
+}
+
+
+// Returns the first instruction of the graph which may deoptimize, or NULL.
+static Instruction* FindDeoptimizingInstruction(const FlowGraph& graph) {
+  const GrowableArray<BlockEntryInstr*>& blocks = graph.preorder();
+  for (intptr_t i = 0; i < blocks.length(); ++i) {
+    for (ForwardInstructionIterator it(blocks[i]); !it.Done(); it.Advance()) {
+      if (it.Current()->CanDeoptimize()) return it.Current();
+    }
+  }
+  return NULL;
+}
+
+
+// Links a new instruction after the given one and records its inputs in the
+// use lists of their definitions.  Returns the new instruction.
+static Instruction* AppendInstruction(Instruction* prev, Instruction* instr) {
+  prev->set_next(instr);
+  instr->set_previous(prev);
+  for (intptr_t i = 0; i < instr->InputCount(); ++i) {
+    Value* use = instr->InputAt(i);
+    use->set_instruction(instr);
+    use->set_use_index(i);
+    use->AddToInputUseList();
+  }
+  return instr;
+}
+
+
+// Inlines the calls of a graph.  The call sites are collected first, as
+// inlining a callee with control flow changes the blocks of the graph.  The
+// graphs of the callees have the calls of their own inlined first, up to the
+// depth threshold.  Inlined code cannot deoptimize, so a callee is only
+// inlined if all its calls were inlined in turn.
 class CallSiteInliner : public FlowGraphVisitor {
  public:
-  explicit CallSiteInliner(FlowGraph* flow_graph)
+  CallSiteInliner(FlowGraph* flow_graph, intptr_t depth)
       : FlowGraphVisitor(flow_graph->postorder()),
         caller_graph_(flow_graph),
+        depth_(depth),
         next_ssa_temp_index_(flow_graph->max_virtual_register_number()),
-        inlined_(false) { }
+        inlined_(false),
+        growth_(0),
+        call_sites_() { }
+
+  void InlineCalls() {
+    VisitBlocks();
+    for (intptr_t i = 0; i < call_sites_.length(); ++i) {
+      Definition* call = call_sites_[i];
+      if (call->IsStaticCall()) {
+        InlineStaticCall(call->AsStaticCall());
+      } else if (call->IsClosureCall()) {
+        InlineClosureCall(call->AsClosureCall());
+      } else {
+        InlinePolymorphicInstanceCall(call->AsPolymorphicInstanceCall());
+      }
+    }
+    if (inlined_) {
+      caller_graph_->ComputeUseLists();
+    }
+  }
 
   bool TryInlining(const Function& function,
+                   const Array& argument_names,
                    GrowableArray<Value*>* arguments,
                    Definition* call) {
-    TRACE_INLINING(OS::Print("  => %s\n", function.ToCString()));
-
-    // Abort if the callee has optional parameters.
-    if (function.HasOptionalParameters()) {
-      TRACE_INLINING(OS::Print("     Bailout: optional parameters\n"));
+    TRACE_INLINING(OS::Print("%*s  => %s\n",
+                             Indent(), "", function.ToCString()));
+
+    // Abort if the arguments do not match the parameters: the call throws.
+    if (!function.AreValidArguments(arguments->length(),
+                                    argument_names,
+                                    NULL)) {
+      TRACE_INLINING(OS::Print("%*s     Bailout: argument mismatch\n",
+                               Indent(), ""));
       return false;
     }
 
-    // Assuming no optional parameters the actual/formal count should match.
-    ASSERT(arguments->length() == function.num_fixed_parameters());
-
     Isolate* isolate = Isolate::Current();
     // Save and clear IC data.
     const Array& old_ic_data = Array::Handle(isolate->ic_data_array());
@@ -59,20 +138,12 @@ class CallSiteInliner : public FlowGraphVisitor {
       ParsedFunction parsed_function(function);
       Parser::ParseFunction(&parsed_function);
       parsed_function.AllocateVariables();
-      FlowGraphBuilder builder(parsed_function);
+      FlowGraphBuilder builder(parsed_function, Isolate::kNoDeoptId);
 
       // Build the callee graph.
       FlowGraph* callee_graph =
           builder.BuildGraph(FlowGraphBuilder::kValueContext);
 
-      // Abort if the callee graph contains control flow.
-      if (callee_graph->preorder().length() != 2) {
-        isolate->set_long_jump_base(base);
-        isolate->set_ic_data_array(old_ic_data.raw());
-        TRACE_INLINING(OS::Print("     Bailout: control flow\n"));
-        return false;
-      }
-
       if (FLAG_trace_inlining && FLAG_print_flow_graph) {
         OS::Print("Callee graph before SSA %s\n",
                   parsed_function.function().ToFullyQualifiedCString());
@@ -92,11 +163,55 @@ class CallSiteInliner : public FlowGraphVisitor {
 
       callee_graph->ComputeUseLists();
 
+      // Inline the calls of the callee.
+      if (depth_ < FLAG_inlining_depth_threshold) {
+        CallSiteInliner inliner(callee_graph, depth_ + 1);
+        inliner.InlineCalls();
+      }
+
       // TODO(zerny): Do optimization passes on the callee graph.
 
-      // TODO(zerny): If result is more than size threshold then abort.
+      const char* bailout = NULL;
+      const intptr_t size = GraphSize(*callee_graph);
+      Instruction* deopt_instr = FindDeoptimizingInstruction(*callee_graph);
+      if (deopt_instr != NULL) {
+        bailout = deopt_instr->IsStaticCall()
+            ? "call not inlined"
+            : "deoptimizing instruction";
+      } else if (callee_graph->exits()->is_empty() &&
+                 (callee_graph->preorder().length() > 2)) {
+        bailout = "control flow without normal exit";
+      } else if (size > FLAG_inlining_size_threshold) {
+        bailout = "size threshold";
+      } else if (growth_ + size > FLAG_inlining_growth_threshold) {
+        bailout = "caller growth threshold";
+      }
+      if (bailout != NULL) {
+        isolate->set_long_jump_base(base);
+        isolate->set_ic_data_array(old_ic_data.raw());
+        TRACE_INLINING(OS::Print("%*s     Bailout: %s (%"Pd" instructions)\n",
+                                 Indent(), "", bailout, size));
+        return false;
+      }
+
+      // Replace all the formal parameters with the actuals, or with their
+      // default values if they are not passed.
+      GrowableArray<Definition*> parameter_values(function.NumParameters());
+      MatchArgumentsToParameters(parsed_function,
+                                 argument_names,
+                                 *arguments,
+                                 callee_graph,
+                                 &parameter_values);
+      for (intptr_t i = 0; i < parameter_values.length(); ++i) {
+        Value* val = callee_graph->graph_entry()->start_env()->ValueAt(i);
+        ParameterInstr* param = val->definition()->AsParameter();
+        ASSERT(param != NULL);
+        param->ReplaceUsesWith(parameter_values[i]);
+      }
 
-      // TODO(zerny): If effort is less than threshold then inline recursively.
+      // Replace callee's null constant with caller's null constant.
+      callee_graph->graph_entry()->constant_null()->ReplaceUsesWith(
+          caller_graph_->graph_entry()->constant_null());
 
       // Plug result in the caller graph.
       caller_graph_->InlineCall(call, callee_graph);
@@ -109,19 +224,11 @@ class CallSiteInliner : public FlowGraphVisitor {
         push->RemoveFromGraph();
       }
 
-      // Replace all the formal parameters with the actuals.
-      for (intptr_t i = 0; i < arguments->length(); ++i) {
-        Value* val = callee_graph->graph_entry()->start_env()->ValueAt(i);
-        ParameterInstr* param = val->definition()->AsParameter();
-        ASSERT(param != NULL);
-        param->ReplaceUsesWith((*arguments)[i]->definition());
-      }
-
-      // Replace callee's null constant with caller's null constant.
-      callee_graph->graph_entry()->constant_null()->ReplaceUsesWith(
-          caller_graph_->graph_entry()->constant_null());
-
-      TRACE_INLINING(OS::Print("     Success\n"));
+      // The call and its pushed arguments are gone.
+      growth_ += size - (call->ArgumentCount() + 1);
+      TRACE_INLINING(OS::Print("%*s     Success: %"Pd" instructions, "
+                               "caller grew by %"Pd"\n",
+                               Indent(), "", size, growth_));
 
       // Build succeeded so we restore the bailout jump.
       inlined_ = true;
@@ -134,60 +241,461 @@ class CallSiteInliner : public FlowGraphVisitor {
       isolate->object_store()->clear_sticky_error();
       isolate->set_long_jump_base(base);
       isolate->set_ic_data_array(old_ic_data.raw());
-      TRACE_INLINING(OS::Print("     Bailout: %s\n", error.ToErrorCString()));
+      TRACE_INLINING(OS::Print("%*s     Bailout: %s\n",
+                               Indent(), "", error.ToErrorCString()));
       return false;
     }
   }
 
+  // Matches the arguments of a call to the parameters of the callee, as the
+  // prologue of the callee would: positional arguments first, then named
+  // arguments by name.  Optional parameters which are not passed get their
+  // default values, as constants at the entry of the callee graph.
+  static void MatchArgumentsToParameters(
+      const ParsedFunction& parsed_function,
+      const Array& argument_names,
+      const GrowableArray<Value*>& arguments,
+      FlowGraph* callee_graph,
+      GrowableArray<Definition*>* parameter_values) {
+    const Function& function = parsed_function.function();
+    const intptr_t num_named_arguments =
+        argument_names.IsNull() ? 0 : argument_names.Length();
+    const intptr_t num_positional_arguments =
+        arguments.length() - num_named_arguments;
+    String& name = String::Handle();
+    String& argument_name = String::Handle();
+    for (intptr_t i = 0; i < function.NumParameters(); ++i) {
+      if (i < num_positional_arguments) {
+        parameter_values->Add(arguments[i]->definition());
+        continue;
+      }
+      name = function.ParameterNameAt(i);
+      intptr_t index = 0;
+      while (index < num_named_arguments) {
+        argument_name ^= argument_names.At(index);
+        if (argument_name.Equals(name)) break;
+        ++index;
+      }
+      if (index < num_named_arguments) {
+        parameter_values->Add(
+            arguments[num_positional_arguments + index]->definition());
+        continue;
+      }
+      const Object& default_value = Object::ZoneHandle(
+          parsed_function.default_parameter_values().At(
+              i - function.num_fixed_parameters()));
+      ConstantInstr* constant = new ConstantInstr(default_value);
+      constant->set_ssa_temp_index(callee_graph->alloc_ssa_temp_index());
+      constant->InsertAfter(callee_graph->graph_entry()->normal_entry());
+      parameter_values->Add(constant);
+    }
+  }
+
   void VisitClosureCall(ClosureCallInstr* call) {
-    TRACE_INLINING(OS::Print("  ClosureCall\n"));
+    call_sites_.Add(call);
+  }
+
+  void VisitPolymorphicInstanceCall(PolymorphicInstanceCallInstr* instr) {
+    call_sites_.Add(instr);
+  }
+
+  void VisitStaticCall(StaticCallInstr* call) {
+    call_sites_.Add(call);
+  }
+
+  bool inlined() const { return inlined_; }
+
+ private:
+  // Indentation of the trace, by inlining depth.
+  int Indent() const { return static_cast<int>(2 * depth_); }
+
+  void InlineClosureCall(ClosureCallInstr* call) {
+    TRACE_INLINING(OS::Print("%*s  ClosureCall\n", Indent(), ""));
     // Find the closure of the callee.
     ASSERT(call->ArgumentCount() > 0);
     const CreateClosureInstr* closure =
         call->ArgumentAt(0)->value()->definition()->AsCreateClosure();
     if (closure == NULL) {
-      TRACE_INLINING(OS::Print("     Bailout: non-closure operator\n"));
+      TRACE_INLINING(OS::Print("%*s     Bailout: non-closure operator\n",
+                               Indent(), ""));
       return;
     }
     GrowableArray<Value*> arguments(call->ArgumentCount() - 1);
     for (int i = 1; i < call->ArgumentCount(); ++i) {
       arguments.Add(call->ArgumentAt(i)->value());
     }
-    TryInlining(closure->function(), &arguments, call);
+    TryInlining(closure->function(), call->argument_names(), &arguments,
+                call);
   }
 
-  void VisitPolymorphicInstanceCall(PolymorphicInstanceCallInstr* instr) {
-    TRACE_INLINING(OS::Print("  PolymorphicInstanceCall\n"));
-    if (instr->with_checks()) {
-      TRACE_INLINING(OS::Print("     Bailout: checks\n"));
+  void InlinePolymorphicInstanceCall(PolymorphicInstanceCallInstr* call) {
+    TRACE_INLINING(OS::Print("%*s  PolymorphicInstanceCall\n",
+                             Indent(), ""));
+    if (call->with_checks()) {
+      if (FLAG_inlining_polymorphic_targets <= 0) {
+        TRACE_INLINING(OS::Print("%*s     Bailout: checks\n", Indent(), ""));
+        return;
+      }
+      InlinePolymorphicTargets(call);
       return;
     }
-    const ICData& ic_data = instr->ic_data();
+    const ICData& ic_data = call->ic_data();
     const Function& target = Function::ZoneHandle(ic_data.GetTargetAt(0));
+    TryInlining(target, call);
+  }
+
+  bool TryInlining(const Function& function,
+                   PolymorphicInstanceCallInstr* call) {
+    GrowableArray<Value*> arguments(call->ArgumentCount());
+    for (int i = 0; i < call->ArgumentCount(); ++i) {
+      arguments.Add(call->ArgumentAt(i)->value());
+    }
+    return TryInlining(function,
+                       call->instance_call()->argument_names(),
+                       &arguments,
+                       call);
+  }
+
+  // Replaces a polymorphic call with tests of the class id of the receiver,
+  // which call the most frequently called targets directly, and inlines the
+  // direct calls where possible.  The remaining receiver classes are left to
+  // a polymorphic call, which deoptimizes if there are none:
+  //
+  //   B:  ... cid <- LoadClassId(receiver); if cid == C1 goto T1 else F1
+  //   T1: r1 <- call target of C1; goto J
+  //   F1: if cid == C2 goto T2 else F2
+  //   ...
+  //   Fn: r <- polymorphic call of the remaining classes; goto J
+  //   J:  phi(r1, ..., r); rest of B
+  void InlinePolymorphicTargets(PolymorphicInstanceCallInstr* call) {
+    const ICData& ic_data = call->ic_data();
+    ASSERT(ic_data.num_args_tested() == 1);
+    const intptr_t num_checks = ic_data.NumberOfChecks();
+
+    // Order the checks by their counts, the most frequent first.
+    GrowableArray<intptr_t> order(num_checks);
+    for (intptr_t i = 0; i < num_checks; ++i) {
+      intptr_t j = order.length();
+      order.Add(i);
+      while ((j > 0) &&
+             (ic_data.GetCountAt(order[j - 1]) < ic_data.GetCountAt(i))) {
+        order[j] = order[j - 1];
+        --j;
+      }
+      order[j] = i;
+    }
+    const intptr_t num_targets =
+        Utils::Minimum(num_checks,
+                       static_cast<intptr_t>(
+                           FLAG_inlining_polymorphic_targets));
+
+    // The checks which are not tested are left to the fallback call.
+    const ICData& remaining_checks = ICData::ZoneHandle(
+        ICData::New(Function::Handle(ic_data.function()),
+                    String::Handle(ic_data.target_name()),
+                    ic_data.deopt_id(),
+                    1));
+    for (intptr_t i = num_targets; i < num_checks; ++i) {
+      remaining_checks.AddReceiverCheck(
+          ic_data.GetReceiverClassIdAt(order[i]),
+          Function::Handle(ic_data.GetTargetAt(order[i])),
+          ic_data.GetCountAt(order[i]));
+    }
 
-    GrowableArray<Value*> arguments(instr->ArgumentCount());
-    for (int i = 0; i < instr->ArgumentCount(); ++i) {
-      arguments.Add(instr->ArgumentAt(i)->value());
+    // Split the block of the call into the tests and the join.
+    BlockEntryInstr* block = call->GetBlock();
+    JoinEntryInstr* join = new JoinEntryInstr(block->try_index());
+    Instruction* rest = call->next();
+    Instruction* last = call->previous();
+    Definition* receiver = call->ArgumentAt(0)->value()->definition();
+    LoadClassIdInstr* cid = new LoadClassIdInstr(new Value(receiver));
+    cid->set_ssa_temp_index(caller_graph_->alloc_ssa_temp_index());
+    last = AppendInstruction(last, cid);
+    intptr_t growth = 1;
+    BlockEntryInstr* fallback_block = block;
+
+    GrowableArray<PolymorphicInstanceCallInstr*> calls(num_targets + 1);
+    GrowableArray<BlockEntryInstr*> call_blocks(num_targets + 1);
+    for (intptr_t i = 0; i < num_targets; ++i) {
+      // Test the class id and call its target directly.
+      const intptr_t class_id = ic_data.GetReceiverClassIdAt(order[i]);
+      ConstantInstr* constant =
+          new ConstantInstr(Smi::ZoneHandle(Smi::New(class_id)));
+      constant->set_ssa_temp_index(caller_graph_->alloc_ssa_temp_index());
+      last = AppendInstruction(last, constant);
+      BranchInstr* branch = new BranchInstr(
+          new StrictCompareInstr(Token::kEQ_STRICT,
+                                 new Value(cid),
+                                 new Value(constant)));
+      AppendInstruction(last, branch);
+      TargetEntryInstr* target = new TargetEntryInstr(block->try_index());
+      TargetEntryInstr* next = new TargetEntryInstr(block->try_index());
+      *branch->true_successor_address() = target;
+      *branch->false_successor_address() = next;
+
+      const ICData& direct_check = ICData::ZoneHandle(
+          ICData::New(Function::Handle(ic_data.function()),
+                      String::Handle(ic_data.target_name()),
+                      ic_data.deopt_id(),
+                      1));
+      direct_check.AddReceiverCheck(
+          class_id,
+          Function::Handle(ic_data.GetTargetAt(order[i])),
+          ic_data.GetCountAt(order[i]));
+      PolymorphicInstanceCallInstr* direct_call =
+          BuildCall(call, target, direct_check, false);
+      AppendInstruction(direct_call, new GotoInstr(join));
+      calls.Add(direct_call);
+      call_blocks.Add(target);
+      last = fallback_block = next;
+      growth += 5 + call->ArgumentCount();
+    }
+    PolymorphicInstanceCallInstr* fallback_call =
+        BuildCall(call, last, remaining_checks, true);
+    AppendInstruction(fallback_call, new GotoInstr(join));
+    calls.Add(fallback_call);
+    call_blocks.Add(fallback_block);
+    growth += 1 + call->ArgumentCount();
+    join->set_next(rest);
+    rest->set_previous(join);
+
+    // The original call and its arguments are replaced.
+    for (intptr_t i = 0; i < call->ArgumentCount(); ++i) {
+      PushArgumentInstr* push = call->ArgumentAt(i);
+      push->ReplaceUsesWith(push->value()->definition());
+      push->RemoveFromGraph();
+    }
+    call->set_previous(NULL);
+    call->set_next(NULL);
+
+    caller_graph_->RecomputeDominators();
+    if (call->HasSSATemp()) {
+      GrowableArray<Definition*> results(calls.length());
+      for (intptr_t i = 0; i < calls.length(); ++i) results.Add(calls[i]);
+      caller_graph_->ReplaceWithPhi(call, join, call_blocks, results);
+      growth += 1;
+    }
+    next_ssa_temp_index_ = caller_graph_->max_virtual_register_number();
+    inlined_ = true;
+    growth_ += growth - (call->ArgumentCount() + 1);
+    TRACE_INLINING(OS::Print("%*s     Tests %"Pd" of %"Pd" receiver classes, "
+                             "caller grew by %"Pd"\n",
+                             Indent(), "", num_targets, num_checks, growth_));
+
+    // Inline the direct calls.
+    for (intptr_t i = 0; i < num_targets; ++i) {
+      TryInlining(Function::ZoneHandle(calls[i]->ic_data().GetTargetAt(0)),
+                  calls[i]);
     }
+  }
 
-    TryInlining(target, &arguments, instr);
+  // Appends a copy of a polymorphic call with the given checks and new
+  // pushed arguments after an instruction.  Returns the new call.
+  PolymorphicInstanceCallInstr* BuildCall(PolymorphicInstanceCallInstr* call,
+                                          Instruction* last,
+                                          const ICData& checks,
+                                          bool with_checks) {
+    ZoneGrowableArray<PushArgumentInstr*>* arguments =
+        new ZoneGrowableArray<PushArgumentInstr*>(call->ArgumentCount());
+    for (intptr_t i = 0; i < call->ArgumentCount(); ++i) {
+      PushArgumentInstr* push = new PushArgumentInstr(
+          new Value(call->ArgumentAt(i)->value()->definition()));
+      last = AppendInstruction(last, push);
+      arguments->Add(push);
+    }
+    PolymorphicInstanceCallInstr* new_call =
+        new PolymorphicInstanceCallInstr(
+            new InstanceCallInstr(call->instance_call(), arguments),
+            checks,
+            with_checks);
+    if (call->HasSSATemp()) {
+      new_call->set_ssa_temp_index(caller_graph_->alloc_ssa_temp_index());
+    } else {
+      new_call->set_use_kind(Definition::kEffect);
+    }
+    call->env()->DeepCopyTo(new_call);
+    AppendInstruction(last, new_call);
+    return new_call;
   }
 
-  void VisitStaticCall(StaticCallInstr* call) {
-    TRACE_INLINING(OS::Print("  StaticCall\n"));
+  void InlineStaticCall(StaticCallInstr* call) {
+    TRACE_INLINING(OS::Print("%*s  StaticCall\n", Indent(), ""));
+    if (call->function().IsConstructor()) {
+      InlineInitializers(call);
+      return;
+    }
     GrowableArray<Value*> arguments(call->ArgumentCount());
     for (int i = 0; i < call->ArgumentCount(); ++i) {
       arguments.Add(call->ArgumentAt(i)->value());
     }
-    TryInlining(call->function(), &arguments, call);
+    TryInlining(call->function(), call->argument_names(), &arguments, call);
   }
 
-  bool inlined() const { return inlined_; }
+  // Generative constructors test the construction phase, which the graph
+  // builder cannot inline.  A constructor whose initializers only store
+  // parameters or literals into fields and which has no body is inlined as
+  // the stores into the allocated object instead.
+  void InlineInitializers(StaticCallInstr* call) {
+    const Function& function = call->function();
+    TRACE_INLINING(OS::Print("%*s  => %s (initializers)\n",
+                             Indent(), "", function.ToCString()));
+    if (FLAG_enable_type_checks ||
+        function.HasOptionalParameters() ||
+        !call->argument_names().IsNull() ||
+        (call->ArgumentCount() != function.num_fixed_parameters())) {
+      TRACE_INLINING(OS::Print("%*s     Bailout: checked mode or arguments\n",
+                               Indent(), ""));
+      return;
+    }
+
+    Isolate* isolate = Isolate::Current();
+    LongJump* base = isolate->long_jump_base();
+    LongJump jump;
+    isolate->set_long_jump_base(&jump);
+    if (setjmp(*jump.Set()) != 0) {
+      isolate->object_store()->clear_sticky_error();
+      isolate->set_long_jump_base(base);
+      TRACE_INLINING(OS::Print("%*s     Bailout: parse error\n",
+                               Indent(), ""));
+      return;
+    }
+    ParsedFunction parsed_function(function);
+    Parser::ParseFunction(&parsed_function);
+    isolate->set_long_jump_base(base);
+
+    GrowableArray<StoreInstanceFieldNode*> stores;
+    if (!MatchInitializers(parsed_function, &stores)) {
+      TRACE_INLINING(OS::Print("%*s     Bailout: not only initializers\n",
+                               Indent(), ""));
+      return;
+    }
+
+    // The parameters are the first variables of the function scope.
+    LocalScope* scope = parsed_function.node_sequence()->scope();
+    Definition* receiver = call->ArgumentAt(0)->value()->definition();
+    Instruction* last = call->previous();
+    for (intptr_t i = 0; i < stores.length(); ++i) {
+      Definition* value = NULL;
+      if (stores[i]->value()->IsLiteralNode()) {
+        ConstantInstr* constant =
+            new ConstantInstr(stores[i]->value()->AsLiteralNode()->literal());
+        constant->set_ssa_temp_index(caller_graph_->alloc_ssa_temp_index());
+        last = AppendInstruction(last, constant);
+        value = constant;
+      } else {
+        const LocalVariable* param =
+            &stores[i]->value()->AsLoadLocalNode()->local();
+        for (intptr_t j = 0; j < function.num_fixed_parameters(); ++j) {
+          if (scope->VariableAt(j) == param) {
+            value = call->ArgumentAt(j)->value()->definition();
+            break;
+          }
+        }
+        ASSERT(value != NULL);
+      }
+      StoreInstanceFieldInstr* store =
+          new StoreInstanceFieldInstr(stores[i]->field(),
+                                      new Value(receiver),
+                                      new Value(value),
+                                      true);  // Emit store barrier.
+      store->set_use_kind(Definition::kEffect);
+      last = AppendInstruction(last, store);
+    }
+    last->set_next(call->next());
+    call->next()->set_previous(last);
+    if (call->HasSSATemp()) {
+      call->ReplaceUsesWith(caller_graph_->graph_entry()->constant_null());
+    }
+    for (intptr_t i = 0; i < call->ArgumentCount(); ++i) {
+      PushArgumentInstr* push = call->ArgumentAt(i);
+      push->ReplaceUsesWith(push->value()->definition());
+      push->RemoveFromGraph();
+    }
+    next_ssa_temp_index_ = caller_graph_->max_virtual_register_number();
+
+    growth_ += stores.length() - (call->ArgumentCount() + 1);
+    TRACE_INLINING(OS::Print("%*s     Success: %"Pd" stores, "
+                             "caller grew by %"Pd"\n",
+                             Indent(), "",
+                             static_cast<intptr_t>(stores.length()),
+                             growth_));
+    inlined_ = true;
+  }
+
+  // Matches the body of a constructor whose initializers are stores of
+  // parameters or literals into fields of the receiver, followed by the
+  // call of the Object constructor:
+  //
+  //   if ((phase & kCtorPhaseInit) != 0) {
+  //     this.f1 = p1; ...; Object(this, phase);
+  //   }
+  //   return null;
+  static bool MatchInitializers(
+      const ParsedFunction& parsed_function,
+      GrowableArray<StoreInstanceFieldNode*>* stores) {
+    SequenceNode* body = parsed_function.node_sequence();
+    if ((body->length() != 2) ||
+        !body->NodeAt(0)->IsIfNode() ||
+        !body->NodeAt(1)->IsReturnNode()) {
+      return false;
+    }
+    IfNode* phase_test = body->NodeAt(0)->AsIfNode();
+    if ((phase_test->false_branch() != NULL) &&
+        (phase_test->false_branch()->length() != 0)) {
+      return false;
+    }
+    ReturnNode* return_node = body->NodeAt(1)->AsReturnNode();
+    if ((return_node->inlined_finally_list_length() != 0) ||
+        !return_node->value()->IsLiteralNode() ||
+        !return_node->value()->AsLiteralNode()->literal().IsNull()) {
+      return false;
+    }
+
+    const Function& function = parsed_function.function();
+    LocalScope* scope = body->scope();
+    const LocalVariable* receiver = scope->VariableAt(0);
+    SequenceNode* initializers = phase_test->true_branch();
+    const intptr_t num_stores = initializers->length() - 1;
+    if (num_stores < 0) return false;
+    StaticCallNode* super_call =
+        initializers->NodeAt(num_stores)->AsStaticCallNode();
+    if ((super_call == NULL) ||
+        (super_call->function().Owner() !=
+         Isolate::Current()->object_store()->object_class())) {
+      return false;
+    }
+    for (intptr_t i = 0; i < num_stores; ++i) {
+      StoreInstanceFieldNode* store =
+          initializers->NodeAt(i)->AsStoreInstanceFieldNode();
+      if ((store == NULL) ||
+          !store->instance()->IsLoadLocalNode() ||
+          (&store->instance()->AsLoadLocalNode()->local() != receiver)) {
+        return false;
+      }
+      if (store->value()->IsLoadLocalNode()) {
+        // A parameter other than the receiver and the construction phase.
+        LoadLocalNode* load = store->value()->AsLoadLocalNode();
+        if (load->HasPseudo() || load->local().is_captured()) return false;
+        bool is_parameter = false;
+        for (intptr_t j = 2; j < function.num_fixed_parameters(); ++j) {
+          if (scope->VariableAt(j) == &load->local()) is_parameter = true;
+        }
+        if (!is_parameter) return false;
+      } else if (!store->value()->IsLiteralNode()) {
+        return false;
+      }
+      stores->Add(store);
+    }
+    return true;
+  }
 
- private:
   FlowGraph* caller_graph_;
+  const intptr_t depth_;
   intptr_t next_ssa_temp_index_;
   bool inlined_;
+  // Number of instructions added to the caller graph.
+  intptr_t growth_;
+  GrowableArray<Definition*> call_sites_;
 };
 
 
@@ -209,10 +717,15 @@ void FlowGraphInliner::Inline() {
   TRACE_INLINING(OS::Print(
       "Inlining calls in %s\n",
       flow_graph_->parsed_function().function().ToCString()));
-  CallSiteInliner inliner(flow_graph_);
-  inliner.VisitBlocks();
+  const intptr_t size_before =
+      FLAG_trace_inlining ? GraphSize(*flow_graph_) : 0;
+  CallSiteInliner inliner(flow_graph_, 0);
+  inliner.InlineCalls();
 
   if (inliner.inlined()) {
+    TRACE_INLINING(OS::Print("Size of %s: %"Pd" -> %"Pd" instructions\n",
+        flow_graph_->parsed_function().function().ToCString(),
+        size_before, GraphSize(*flow_graph_)));
     if (FLAG_trace_inlining && FLAG_print_flow_graph) {
       OS::Print("After Inlining of %s\n", flow_graph_->
                 parsed_function().function().ToFullyQualifiedCString());
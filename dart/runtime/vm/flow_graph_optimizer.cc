@@ -19,7 +19,9 @@ namespace dart {
 DECLARE_FLAG(bool, eliminate_type_checks);
 DECLARE_FLAG(bool, enable_type_checks);
 DEFINE_FLAG(bool, trace_optimization, false, "Print optimization details.");
+DEFINE_FLAG(bool, trace_range_analysis, false, "Trace range analysis.");
 DECLARE_FLAG(bool, trace_type_check_elimination);
+DEFINE_FLAG(bool, unbox_mints, true, "Optimize 64-bit integer arithmetic.");
 DEFINE_FLAG(bool, use_cha, true, "Use class hierarchy analysis.");
 
 void FlowGraphOptimizer::ApplyICData() {
@@ -65,6 +67,20 @@ static Definition* CreateConversion(Representation from,
         deopt_target->DeoptimizationTarget() : Isolate::kNoDeoptId;
     ASSERT((deopt_target != NULL) || (def->GetPropagatedCid() == kDoubleCid));
     return new UnboxDoubleInstr(new Value(def), deopt_id);
+  } else if ((from == kUnboxedMint) && (to == kTagged)) {
+    return new BoxIntegerInstr(new Value(def));
+  } else if ((from == kTagged) && (to == kUnboxedMint)) {
+    const intptr_t deopt_id = (deopt_target != NULL) ?
+        deopt_target->DeoptimizationTarget() : Isolate::kNoDeoptId;
+    ASSERT((deopt_target != NULL) ||
+           (def->GetPropagatedCid() == kSmiCid) ||
+           (def->GetPropagatedCid() == kMintCid));
+    return new UnboxIntegerInstr(new Value(def), deopt_id);
+  } else if ((from == kUnboxedVector) && (to == kTagged)) {
+    return new BoxVectorInstr(new Value(def), def->GetPropagatedCid());
+  } else if ((from == kTagged) && (to == kUnboxedVector)) {
+    // Tagged inputs of vector instructions are guarded by class checks.
+    return new UnboxVectorInstr(new Value(def));
   } else {
     UNREACHABLE();
     return NULL;
@@ -97,8 +113,16 @@ void FlowGraphOptimizer::InsertConversionsFor(Definition* def) {
       deopt_target = instr;
     }
 
-    Definition* converted =
-        CreateConversion(from_rep, to_rep, def, deopt_target);
+    Definition* converted = NULL;
+    if ((from_rep != kTagged) && (to_rep != kTagged)) {
+      // Convert between two unboxed representations through a boxed value.
+      Definition* boxed = CreateConversion(from_rep, kTagged, def, NULL);
+      InsertBefore(instr, boxed, use->instruction()->env(),
+                   Definition::kValue);
+      converted = CreateConversion(kTagged, to_rep, boxed, deopt_target);
+    } else {
+      converted = CreateConversion(from_rep, to_rep, def, deopt_target);
+    }
     InsertBefore(instr, converted, use->instruction()->env(),
                  Definition::kValue);
     use->set_definition(converted);
@@ -106,8 +130,29 @@ void FlowGraphOptimizer::InsertConversionsFor(Definition* def) {
 }
 
 
+// A phi is unboxed as a mint if at least one of its inputs is an unboxed
+// mint and all other inputs are integer constants.  Phis are visited in
+// block order, so inputs flowing along back edges are not yet unboxed when
+// a loop header phi is visited unless they are produced by mint operations.
+static bool CanUnboxPhiAsMint(PhiInstr* phi) {
+  bool has_unboxed_input = false;
+  for (intptr_t i = 0; i < phi->InputCount(); i++) {
+    Definition* input = phi->InputAt(i)->definition();
+    if (input->representation() == kUnboxedMint) {
+      has_unboxed_input = true;
+    } else if (!input->IsConstant() ||
+               !input->AsConstant()->value().IsInteger() ||
+               input->AsConstant()->value().IsBigint()) {
+      return false;
+    }
+  }
+  return has_unboxed_input;
+}
+
+
 void FlowGraphOptimizer::SelectRepresentations() {
-  // Convervatively unbox all phis that were proven to be of type Double.
+  // Convervatively unbox all phis that were proven to be of type Double,
+  // Float32x4 or Int32x4 and phis merging unboxed mints.
   for (intptr_t i = 0; i < block_order_.length(); ++i) {
     JoinEntryInstr* join_entry = block_order_[i]->AsJoinEntry();
     if (join_entry == NULL) continue;
@@ -115,8 +160,14 @@ void FlowGraphOptimizer::SelectRepresentations() {
     if (join_entry->phis() != NULL) {
       for (intptr_t i = 0; i < join_entry->phis()->length(); ++i) {
         PhiInstr* phi = (*join_entry->phis())[i];
-        if ((phi != NULL) && (phi->GetPropagatedCid() == kDoubleCid)) {
+        if (phi == NULL) continue;
+        const intptr_t cid = phi->GetPropagatedCid();
+        if (cid == kDoubleCid) {
           phi->set_representation(kUnboxedDouble);
+        } else if ((cid == kFloat32x4Cid) || (cid == kInt32x4Cid)) {
+          phi->set_representation(kUnboxedVector);
+        } else if (FLAG_unbox_mints && CanUnboxPhiAsMint(phi)) {
+          phi->set_representation(kUnboxedMint);
         }
       }
     }
@@ -327,19 +378,75 @@ void FlowGraphOptimizer::AddCheckClass(InstanceCallInstr* call,
 }
 
 
-static bool ArgIsAlwaysSmi(const ICData& ic_data, intptr_t arg_n) {
+static bool ArgIsAlways(intptr_t cid,
+                        const ICData& ic_data,
+                        intptr_t arg_n) {
   ASSERT(ic_data.num_args_tested() > arg_n);
   if (ic_data.NumberOfChecks() == 0) return false;
   GrowableArray<intptr_t> class_ids;
   Function& target = Function::Handle();
   for (intptr_t i = 0; i < ic_data.NumberOfChecks(); i++) {
     ic_data.GetCheckAt(i, &class_ids, &target);
-    if (class_ids[arg_n] != kSmiCid) return false;
+    if (class_ids[arg_n] != cid) return false;
   }
   return true;
 }
 
 
+static bool ArgIsAlwaysSmi(const ICData& ic_data, intptr_t arg_n) {
+  return ArgIsAlways(kSmiCid, ic_data, arg_n);
+}
+
+
+// Returns true if elements of the typed array with the given class id are
+// accessed directly by LoadIndexed and StoreIndexed.
+static bool IsSupportedTypedArrayCid(intptr_t class_id) {
+  switch (class_id) {
+    case kFloat32ArrayCid:
+    case kFloat64ArrayCid:
+      return true;
+    case kInt32ArrayCid:
+      // Loaded elements are tagged as Smis.
+      return kSmiBits >= 32;
+    default:
+      return false;
+  }
+}
+
+
+void FlowGraphOptimizer::AddCheckDouble(InstanceCallInstr* call,
+                                        Value* value) {
+  const ICData& ic_data = *call->ic_data();
+  const ICData& double_check = ICData::ZoneHandle(
+      ICData::New(Function::Handle(ic_data.function()),
+                  String::Handle(ic_data.target_name()),
+                  ic_data.deopt_id(),
+                  1));
+  double_check.AddReceiverCheck(kDoubleCid,
+                                Function::Handle(ic_data.GetTargetAt(0)));
+  CheckClassInstr* check = new CheckClassInstr(value, call, double_check);
+  InsertBefore(call, check, call->env(), Definition::kEffect);
+}
+
+
+// Inserts a check that the value is an instance of the given class before
+// the instruction, which deoptimizes to the given deopt id.
+void FlowGraphOptimizer::AddCheckClassId(Instruction* instr,
+                                         intptr_t deopt_id,
+                                         const Function& target,
+                                         Value* value,
+                                         intptr_t class_id) {
+  const ICData& unary_checks = ICData::ZoneHandle(
+      ICData::New(flow_graph_->parsed_function().function(),
+                  String::Handle(target.name()),
+                  deopt_id,
+                  1));
+  unary_checks.AddReceiverCheck(class_id, target);
+  CheckClassInstr* check = new CheckClassInstr(value, deopt_id, unary_checks);
+  InsertBefore(instr, check, instr->env(), Definition::kEffect);
+}
+
+
 bool FlowGraphOptimizer::TryReplaceWithArrayOp(InstanceCallInstr* call,
                                                Token::Kind op_kind) {
   // TODO(fschneider): Optimize []= operator in checked mode as well.
@@ -352,6 +459,18 @@ bool FlowGraphOptimizer::TryReplaceWithArrayOp(InstanceCallInstr* call,
       // not for ImmutableArray.
       if (op_kind == Token::kASSIGN_INDEX) return false;
       // Fall through.
+    case kFloat32ArrayCid:
+    case kFloat64ArrayCid:
+    case kInt32ArrayCid:
+      if (!IsSupportedTypedArrayCid(class_id)) return false;
+      if (op_kind == Token::kASSIGN_INDEX) {
+        // The natives reject values of other types, only specialize stores
+        // of the value type seen so far.
+        const intptr_t value_cid =
+            (class_id == kInt32ArrayCid) ? kSmiCid : kDoubleCid;
+        if (!ArgIsAlways(value_cid, *call->ic_data(), 2)) return false;
+      }
+      // Fall through.
     case kArrayCid:
     case kGrowableObjectArrayCid: {
       Value* array = call->ArgumentAt(0)->value();
@@ -386,12 +505,19 @@ bool FlowGraphOptimizer::TryReplaceWithArrayOp(InstanceCallInstr* call,
         InsertBefore(call, elements, NULL, Definition::kValue);
         array = new Value(elements);
       }
+      // Elements of a growable array live in its backing Array.
+      const intptr_t elements_cid =
+          (class_id == kGrowableObjectArrayCid) ?
+          static_cast<intptr_t>(kArrayCid) : class_id;
       Definition* array_op = NULL;
       if (op_kind == Token::kINDEX) {
-        array_op = new LoadIndexedInstr(array, index);
+        array_op = new LoadIndexedInstr(array, index, elements_cid);
       } else {
-        bool needs_store_barrier = true;
-        if (ArgIsAlwaysSmi(*call->ic_data(), 2)) {
+        bool needs_store_barrier = (elements_cid == kArrayCid);
+        if (elements_cid == kFloat32ArrayCid ||
+            elements_cid == kFloat64ArrayCid) {
+          AddCheckDouble(call, call->ArgumentAt(2)->value()->Copy());
+        } else if (ArgIsAlwaysSmi(*call->ic_data(), 2)) {
           InsertBefore(call,
                        new CheckSmiInstr(call->ArgumentAt(2)->value()->Copy(),
                                          call->deopt_id()),
@@ -400,8 +526,11 @@ bool FlowGraphOptimizer::TryReplaceWithArrayOp(InstanceCallInstr* call,
           needs_store_barrier = false;
         }
         Value* value = call->ArgumentAt(2)->value();
-        array_op =
-            new StoreIndexedInstr(array, index, value, needs_store_barrier);
+        array_op = new StoreIndexedInstr(array,
+                                         index,
+                                         value,
+                                         needs_store_barrier,
+                                         elements_cid);
       }
       call->ReplaceWith(array_op, current_iterator());
       RemovePushArguments(call);
@@ -437,17 +566,86 @@ void FlowGraphOptimizer::InsertAfter(Instruction* instr,
 }
 
 
+// Returns the typed array class of the vectors of the operands of the
+// Float32x4 or Int32x4 operator, or kIllegalCid.
+static intptr_t VectorOperandsClassId(const ICData& ic_data,
+                                      Token::Kind op_kind) {
+  if (ic_data.NumberOfChecks() != 1) return kIllegalCid;
+  switch (op_kind) {
+    case Token::kADD:
+    case Token::kSUB:
+      if (ICDataHasReceiverArgumentClassIds(ic_data,
+                                            kInt32x4Cid,
+                                            kInt32x4Cid)) {
+        return kInt32ArrayCid;
+      }
+      // Fall through.
+    case Token::kMUL:
+    case Token::kDIV:
+      if (ICDataHasReceiverArgumentClassIds(ic_data,
+                                            kFloat32x4Cid,
+                                            kFloat32x4Cid)) {
+        return kFloat32ArrayCid;
+      }
+      return kIllegalCid;
+    case Token::kBIT_AND:
+    case Token::kBIT_OR:
+    case Token::kBIT_XOR:
+      if (ICDataHasReceiverArgumentClassIds(ic_data,
+                                            kInt32x4Cid,
+                                            kInt32x4Cid)) {
+        return kInt32ArrayCid;
+      }
+      return kIllegalCid;
+    default:
+      return kIllegalCid;
+  }
+}
+
+
+bool FlowGraphOptimizer::TryReplaceWithVectorBinaryOp(InstanceCallInstr* call,
+                                                      Token::Kind op_kind) {
+  const intptr_t class_id = VectorOperandsClassId(*call->ic_data(), op_kind);
+  if (class_id == kIllegalCid) return false;
+  ASSERT(call->ArgumentCount() == 2);
+  Value* left = call->ArgumentAt(0)->value();
+  Value* right = call->ArgumentAt(1)->value();
+  AddCheckClassId(call,
+                  call->deopt_id(),
+                  Function::Handle(call->ic_data()->GetTargetAt(0)),
+                  left->Copy(),
+                  VectorLoadIndexedInstr::ValueClassId(class_id));
+  AddCheckClassId(call,
+                  call->deopt_id(),
+                  Function::Handle(call->ic_data()->GetTargetAt(0)),
+                  right->Copy(),
+                  VectorLoadIndexedInstr::ValueClassId(class_id));
+  VectorBinaryOpInstr* vector_op =
+      new VectorBinaryOpInstr(op_kind, left, right, class_id);
+  call->ReplaceWith(vector_op, current_iterator());
+  RemovePushArguments(call);
+  return true;
+}
+
+
 bool FlowGraphOptimizer::TryReplaceWithBinaryOp(InstanceCallInstr* call,
                                                 Token::Kind op_kind) {
   intptr_t operands_type = kIllegalCid;
   ASSERT(call->HasICData());
   const ICData& ic_data = *call->ic_data();
+  if (TryReplaceWithVectorBinaryOp(call, op_kind)) {
+    return true;
+  }
   switch (op_kind) {
     case Token::kADD:
     case Token::kSUB:
     case Token::kMUL:
       if (HasOnlyTwoSmi(ic_data)) {
         operands_type = kSmiCid;
+      } else if ((op_kind != Token::kMUL) &&
+                 FLAG_unbox_mints &&
+                 HasTwoMintOrSmi(ic_data)) {
+        operands_type = kMintCid;
       } else if (ShouldSpecializeForDouble(ic_data)) {
         operands_type = kDoubleCid;
       } else {
@@ -465,16 +663,16 @@ bool FlowGraphOptimizer::TryReplaceWithBinaryOp(InstanceCallInstr* call,
       // TODO(vegorov): implement fast path code for modulo.
       return false;
     case Token::kBIT_AND:
+    case Token::kBIT_OR:
+    case Token::kBIT_XOR:
       if (HasOnlyTwoSmi(ic_data)) {
         operands_type = kSmiCid;
-      } else if (HasTwoMintOrSmi(ic_data)) {
+      } else if (FLAG_unbox_mints && HasTwoMintOrSmi(ic_data)) {
         operands_type = kMintCid;
       } else {
         return false;
       }
       break;
-    case Token::kBIT_OR:
-    case Token::kBIT_XOR:
     case Token::kTRUNCDIV:
     case Token::kSHR:
     case Token::kSHL:
@@ -663,10 +861,15 @@ bool FlowGraphOptimizer::TryInlineInstanceGetter(InstanceCallInstr* call) {
   MethodRecognizer::Kind recognized_kind =
       MethodRecognizer::RecognizeKind(target);
 
+  if (TryInlineVectorGetter(call, recognized_kind)) {
+    return true;
+  }
+
   // VM objects length getter.
   if ((recognized_kind == MethodRecognizer::kObjectArrayLength) ||
       (recognized_kind == MethodRecognizer::kImmutableArrayLength) ||
-      (recognized_kind == MethodRecognizer::kGrowableArrayLength)) {
+      (recognized_kind == MethodRecognizer::kGrowableArrayLength) ||
+      (recognized_kind == MethodRecognizer::kByteArrayBaseLength)) {
     if (!HasOneTarget(ic_data)) {
       // TODO(srdjan): Implement for mutiple targets.
       return false;
@@ -682,6 +885,10 @@ bool FlowGraphOptimizer::TryInlineInstanceGetter(InstanceCallInstr* call) {
       case MethodRecognizer::kGrowableArrayLength:
         length_offset = GrowableObjectArray::length_offset();
         break;
+      case MethodRecognizer::kByteArrayBaseLength:
+        length_offset = ByteArray::length_offset();
+        is_immutable = true;
+        break;
       default:
         UNREACHABLE();
     }
@@ -694,6 +901,7 @@ bool FlowGraphOptimizer::TryInlineInstanceGetter(InstanceCallInstr* call) {
         Type::ZoneHandle(Type::SmiType()),
         is_immutable);
     load->set_result_cid(kSmiCid);
+    load->set_recognized_kind(recognized_kind);
     call->ReplaceWith(load, current_iterator());
     RemovePushArguments(call);
     return true;
@@ -716,6 +924,7 @@ bool FlowGraphOptimizer::TryInlineInstanceGetter(InstanceCallInstr* call) {
         Array::length_offset(),
         Type::ZoneHandle(Type::SmiType()));
     length_load->set_result_cid(kSmiCid);
+    length_load->set_recognized_kind(recognized_kind);
 
     call->ReplaceWith(length_load, current_iterator());
     RemovePushArguments(call);
@@ -737,6 +946,7 @@ bool FlowGraphOptimizer::TryInlineInstanceGetter(InstanceCallInstr* call) {
         Type::ZoneHandle(Type::SmiType()),
         is_immutable);
     load->set_result_cid(kSmiCid);
+    load->set_recognized_kind(recognized_kind);
     call->ReplaceWith(load, current_iterator());
     RemovePushArguments(call);
     return true;
@@ -775,10 +985,224 @@ bool FlowGraphOptimizer::TryInlineInstanceMethod(InstanceCallInstr* call) {
     // as a call.
     return true;
   }
+  if (TryInlineVectorMethod(call, recognized_kind)) {
+    return true;
+  }
+  if (TryInlineVectorArrayAccess(call, recognized_kind)) {
+    return true;
+  }
   return false;
 }
 
 
+// Returns the lane read by the Float32x4 or Int32x4 getter.
+static intptr_t VectorGetterLane(MethodRecognizer::Kind recognized_kind) {
+  switch (recognized_kind) {
+    case MethodRecognizer::kFloat32x4GetX:
+    case MethodRecognizer::kInt32x4GetX:
+      return 0;
+    case MethodRecognizer::kFloat32x4GetY:
+    case MethodRecognizer::kInt32x4GetY:
+      return 1;
+    case MethodRecognizer::kFloat32x4GetZ:
+    case MethodRecognizer::kInt32x4GetZ:
+      return 2;
+    case MethodRecognizer::kFloat32x4GetW:
+    case MethodRecognizer::kInt32x4GetW:
+      return 3;
+    default:
+      return -1;
+  }
+}
+
+
+bool FlowGraphOptimizer::TryInlineVectorGetter(
+    InstanceCallInstr* call,
+    MethodRecognizer::Kind recognized_kind) {
+  const intptr_t lane = VectorGetterLane(recognized_kind);
+  if (lane < 0) return false;
+  const intptr_t receiver_cid = ReceiverClassId(call);
+  intptr_t class_id = kIllegalCid;
+  if (receiver_cid == kFloat32x4Cid) {
+    class_id = kFloat32ArrayCid;
+  } else if ((receiver_cid == kInt32x4Cid) && (kSmiBits >= 32)) {
+    class_id = kInt32ArrayCid;
+  } else {
+    return false;
+  }
+  AddCheckClass(call, call->ArgumentAt(0)->value()->Copy());
+  VectorExtractLaneInstr* extract =
+      new VectorExtractLaneInstr(call->ArgumentAt(0)->value(), lane, class_id);
+  call->ReplaceWith(extract, current_iterator());
+  RemovePushArguments(call);
+  return true;
+}
+
+
+// Returns the shuffle mask passed to the call, or -1 if it is not a Smi
+// constant in the range accepted by the natives.
+static intptr_t ConstantShuffleMask(InstanceCallInstr* call) {
+  Value* mask = call->ArgumentAt(1)->value();
+  if (!mask->BindsToConstant() || !mask->BoundConstant().IsSmi()) return -1;
+  const intptr_t value = Smi::Cast(mask->BoundConstant()).Value();
+  return ((value >= 0) && (value <= 0xFF)) ? value : -1;
+}
+
+
+bool FlowGraphOptimizer::TryInlineVectorMethod(
+    InstanceCallInstr* call,
+    MethodRecognizer::Kind recognized_kind) {
+  const intptr_t receiver_cid = ReceiverClassId(call);
+  if ((receiver_cid != kFloat32x4Cid) && (receiver_cid != kInt32x4Cid)) {
+    return false;
+  }
+  const Function& target = Function::Handle(call->ic_data()->GetTargetAt(0));
+  Value* receiver = call->ArgumentAt(0)->value();
+  Definition* vector_op = NULL;
+  switch (recognized_kind) {
+    case MethodRecognizer::kFloat32x4Equal:
+    case MethodRecognizer::kFloat32x4NotEqual:
+    case MethodRecognizer::kFloat32x4LessThan:
+    case MethodRecognizer::kFloat32x4LessThanOrEqual: {
+      Token::Kind kind = Token::kEQ;
+      if (recognized_kind == MethodRecognizer::kFloat32x4NotEqual) {
+        kind = Token::kNE;
+      } else if (recognized_kind == MethodRecognizer::kFloat32x4LessThan) {
+        kind = Token::kLT;
+      } else if (recognized_kind ==
+                 MethodRecognizer::kFloat32x4LessThanOrEqual) {
+        kind = Token::kLTE;
+      }
+      Value* other = call->ArgumentAt(1)->value();
+      AddCheckClass(call, receiver->Copy());
+      AddCheckClassId(call, call->deopt_id(), target,
+                      other->Copy(), kFloat32x4Cid);
+      vector_op = new VectorCompareInstr(kind, receiver, other);
+      break;
+    }
+    case MethodRecognizer::kFloat32x4Scale: {
+      // The natives convert the double scale to single precision.
+      Value* scale = call->ArgumentAt(1)->value();
+      AddCheckClass(call, receiver->Copy());
+      AddCheckClassId(call, call->deopt_id(), target,
+                      scale->Copy(), kDoubleCid);
+      VectorBroadcastInstr* broadcast =
+          new VectorBroadcastInstr(scale, kFloat32ArrayCid, call->deopt_id());
+      InsertBefore(call, broadcast, call->env(), Definition::kValue);
+      vector_op = new VectorBinaryOpInstr(Token::kMUL,
+                                          receiver,
+                                          new Value(broadcast),
+                                          kFloat32ArrayCid);
+      break;
+    }
+    case MethodRecognizer::kFloat32x4Shuffle:
+    case MethodRecognizer::kInt32x4Shuffle: {
+      const intptr_t mask = ConstantShuffleMask(call);
+      if (mask < 0) return false;
+      AddCheckClass(call, receiver->Copy());
+      vector_op = new VectorShuffleInstr(
+          receiver,
+          mask,
+          (receiver_cid == kFloat32x4Cid) ? kFloat32ArrayCid : kInt32ArrayCid);
+      break;
+    }
+    case MethodRecognizer::kInt32x4Select: {
+      Value* true_value = call->ArgumentAt(1)->value();
+      Value* false_value = call->ArgumentAt(2)->value();
+      AddCheckClass(call, receiver->Copy());
+      AddCheckClassId(call, call->deopt_id(), target,
+                      true_value->Copy(), kFloat32x4Cid);
+      AddCheckClassId(call, call->deopt_id(), target,
+                      false_value->Copy(), kFloat32x4Cid);
+      vector_op = new VectorSelectInstr(receiver, true_value, false_value);
+      break;
+    }
+    default:
+      return false;
+  }
+  call->ReplaceWith(vector_op, current_iterator());
+  RemovePushArguments(call);
+  return true;
+}
+
+
+// Inlines the loads and stores of Float32x4 and Int32x4 values from and to
+// the four elements of a typed array starting at the index.
+bool FlowGraphOptimizer::TryInlineVectorArrayAccess(
+    InstanceCallInstr* call,
+    MethodRecognizer::Kind recognized_kind) {
+  intptr_t class_id = kIllegalCid;
+  bool is_store = false;
+  switch (recognized_kind) {
+    case MethodRecognizer::kFloat32ArrayGetFloat32x4:
+      class_id = kFloat32ArrayCid;
+      break;
+    case MethodRecognizer::kFloat32ArraySetFloat32x4:
+      class_id = kFloat32ArrayCid;
+      is_store = true;
+      break;
+    case MethodRecognizer::kInt32ArrayGetInt32x4:
+      class_id = kInt32ArrayCid;
+      break;
+    case MethodRecognizer::kInt32ArraySetInt32x4:
+      class_id = kInt32ArrayCid;
+      is_store = true;
+      break;
+    default:
+      return false;
+  }
+  // The store replaces a call returning null, the result must be unused.
+  if (is_store && call->HasSSATemp()) return false;
+  if (ReceiverClassId(call) != class_id) return false;
+
+  Value* array = call->ArgumentAt(0)->value();
+  Value* index = call->ArgumentAt(1)->value();
+  AddCheckClass(call, array->Copy());
+  InsertBefore(call,
+               new CheckSmiInstr(index->Copy(), call->deopt_id()),
+               call->env(),
+               Definition::kEffect);
+  // Check the bounds of the first and the last accessed element.  The
+  // latter does not overflow once the former is in bounds.
+  InsertBefore(call,
+               new CheckArrayBoundInstr(array->Copy(),
+                                        index->Copy(),
+                                        class_id,
+                                        call),
+               call->env(),
+               Definition::kEffect);
+  ConstantInstr* three = new ConstantInstr(Smi::ZoneHandle(Smi::New(3)));
+  InsertBefore(call, three, NULL, Definition::kValue);
+  BinarySmiOpInstr* last_index = new BinarySmiOpInstr(Token::kADD,
+                                                      call,
+                                                      index->Copy(),
+                                                      new Value(three));
+  InsertBefore(call, last_index, call->env(), Definition::kValue);
+  InsertBefore(call,
+               new CheckArrayBoundInstr(array->Copy(),
+                                        new Value(last_index),
+                                        class_id,
+                                        call),
+               call->env(),
+               Definition::kEffect);
+  Definition* array_op = NULL;
+  if (is_store) {
+    Value* value = call->ArgumentAt(2)->value();
+    AddCheckClassId(call,
+                    call->deopt_id(),
+                    Function::Handle(call->ic_data()->GetTargetAt(0)),
+                    value->Copy(),
+                    VectorLoadIndexedInstr::ValueClassId(class_id));
+    array_op = new VectorStoreIndexedInstr(array, index, value, class_id);
+  } else {
+    array_op = new VectorLoadIndexedInstr(array, index, class_id);
+  }
+  call->ReplaceWith(array_op, current_iterator());
+  RemovePushArguments(call);
+  return true;
+}
+
+
 void FlowGraphOptimizer::VisitInstanceCall(InstanceCallInstr* instr) {
   if (instr->HasICData() && (instr->ic_data()->NumberOfChecks() > 0)) {
     const Token::Kind op_kind = instr->token_kind();
@@ -844,10 +1268,67 @@ void FlowGraphOptimizer::VisitStaticCall(StaticCallInstr* call) {
     MathSqrtInstr* sqrt = new MathSqrtInstr(call->ArgumentAt(0)->value(), call);
     call->ReplaceWith(sqrt, current_iterator());
     RemovePushArguments(call);
+  } else if ((recognized_kind == MethodRecognizer::kFloat32x4Constructor) ||
+             (recognized_kind == MethodRecognizer::kFloat32x4Zero) ||
+             (recognized_kind == MethodRecognizer::kFloat32x4Splat) ||
+             (recognized_kind == MethodRecognizer::kInt32x4Constructor)) {
+    InlineVectorFactory(call, recognized_kind);
   }
 }
 
 
+// The first argument of the factories are the type arguments.  The natives
+// accept only doubles for Float32x4 elements and any integer for Int32x4
+// elements, only Smis are handled inline.
+void FlowGraphOptimizer::InlineVectorFactory(
+    StaticCallInstr* call,
+    MethodRecognizer::Kind recognized_kind) {
+  Definition* vector = NULL;
+  if (recognized_kind == MethodRecognizer::kFloat32x4Zero) {
+    ASSERT(call->ArgumentCount() == 1);
+    ConstantInstr* zero =
+        new ConstantInstr(Double::ZoneHandle(Double::NewCanonical(0.0)));
+    InsertBefore(call, zero, NULL, Definition::kValue);
+    vector = new VectorBroadcastInstr(new Value(zero),
+                                      kFloat32ArrayCid,
+                                      call->deopt_id());
+  } else if (recognized_kind == MethodRecognizer::kFloat32x4Splat) {
+    ASSERT(call->ArgumentCount() == 2);
+    Value* value = call->ArgumentAt(1)->value();
+    AddCheckClassId(call, call->deopt_id(), call->function(),
+                    value->Copy(), kDoubleCid);
+    vector = new VectorBroadcastInstr(value,
+                                      kFloat32ArrayCid,
+                                      call->deopt_id());
+  } else {
+    ASSERT(call->ArgumentCount() == 5);
+    const bool is_float =
+        (recognized_kind == MethodRecognizer::kFloat32x4Constructor);
+    for (intptr_t i = 1; i < 5; i++) {
+      Value* value = call->ArgumentAt(i)->value();
+      if (is_float) {
+        AddCheckClassId(call, call->deopt_id(), call->function(),
+                        value->Copy(), kDoubleCid);
+      } else {
+        InsertBefore(call,
+                     new CheckSmiInstr(value->Copy(), call->deopt_id()),
+                     call->env(),
+                     Definition::kEffect);
+      }
+    }
+    vector = new VectorConstructInstr(call->ArgumentAt(1)->value(),
+                                      call->ArgumentAt(2)->value(),
+                                      call->ArgumentAt(3)->value(),
+                                      call->ArgumentAt(4)->value(),
+                                      is_float ? kFloat32ArrayCid
+                                               : kInt32ArrayCid,
+                                      call->deopt_id());
+  }
+  call->ReplaceWith(vector, current_iterator());
+  RemovePushArguments(call);
+}
+
+
 bool FlowGraphOptimizer::TryInlineInstanceSetter(InstanceCallInstr* instr) {
   if (FLAG_enable_type_checks) {
     // TODO(srdjan): Add assignable check node if --enable_type_checks.
@@ -1499,7 +1980,7 @@ void LICM::TryHoistCheckSmiThroughPhi(ForwardInstructionIterator* it,
 
   // Host CheckSmi instruction and make this phi smi one.
   Hoist(it, pre_header, current);
-  current->SetInputAt(non_smi_input, phi->InputAt(non_smi_input));
+  current->SetInputAt(0, phi->InputAt(non_smi_input)->Copy());
   phi->SetPropagatedCid(kSmiCid);
 }
 
@@ -1588,4 +2069,1223 @@ void DominatorBasedCSE::OptimizeRecursive(
 }
 
 
+// Returns the comparison that holds if the given comparison does not.
+static Token::Kind NegateComparison(Token::Kind kind) {
+  switch (kind) {
+    case Token::kLT: return Token::kGTE;
+    case Token::kGT: return Token::kLTE;
+    case Token::kLTE: return Token::kGT;
+    case Token::kGTE: return Token::kLT;
+    default:
+      UNREACHABLE();
+      return Token::kILLEGAL;
+  }
+}
+
+
+void RangeAnalysis::Analyze() {
+  InsertConstraints();
+  InferRanges();
+  RemoveRedundantChecks();
+  RemoveConstraints();
+}
+
+
+// Returns true if the instruction may change the length of a growable array,
+// that is if it may call Dart code or store into a field. Instructions not
+// known to do neither are assumed to.
+static bool MayChangeLength(Instruction* instr) {
+  if (instr->IsBranch()) {
+    return MayChangeLength(instr->AsBranch()->comparison());
+  }
+  if (instr->IsRelationalOp() || instr->IsEqualityCompare()) {
+    // Only comparisons of Smi or double operands do not call the operator,
+    // they are also the only ones which cannot deoptimize.
+    return instr->CanDeoptimize();
+  }
+  return !(instr->IsParameter() ||
+           instr->IsPushArgument() ||
+           instr->IsReturn() ||
+           instr->IsGoto() ||
+           instr->IsCurrentContext() ||
+           instr->IsStrictCompare() ||
+           instr->IsLoadIndexed() ||
+           instr->IsStoreIndexed() ||
+           instr->IsVectorLoadIndexed() ||
+           instr->IsVectorStoreIndexed() ||
+           instr->IsVectorBinaryOp() ||
+           instr->IsVectorBroadcast() ||
+           instr->IsVectorConstruct() ||
+           instr->IsVectorExtractLane() ||
+           instr->IsVectorShuffle() ||
+           instr->IsVectorCompare() ||
+           instr->IsVectorSelect() ||
+           instr->IsLoadStaticField() ||
+           instr->IsBooleanNegate() ||
+           instr->IsLoadField() ||
+           instr->IsLoadClassId() ||
+           instr->IsBinarySmiOp() ||
+           instr->IsBinaryMintOp() ||
+           instr->IsUnarySmiOp() ||
+           instr->IsCheckStackOverflow() ||
+           instr->IsDoubleToDouble() ||
+           instr->IsSmiToDouble() ||
+           instr->IsCheckClass() ||
+           instr->IsCheckSmi() ||
+           instr->IsConstant() ||
+           instr->IsCheckEitherNonSmi() ||
+           instr->IsUnboxedDoubleBinaryOp() ||
+           instr->IsMathSqrt() ||
+           instr->IsUnboxDouble() ||
+           instr->IsBoxDouble() ||
+           instr->IsUnboxInteger() ||
+           instr->IsBoxInteger() ||
+           instr->IsUnboxVector() ||
+           instr->IsBoxVector() ||
+           instr->IsCheckArrayBound() ||
+           instr->IsConstraint());
+}
+
+
+void RangeAnalysis::InsertConstraints() {
+  // Blocks are visited in reverse postorder: the constraints inserted for a
+  // branch become the operands of the branches it dominates.
+  for (BlockIterator block_it = flow_graph_->reverse_postorder_iterator();
+       !block_it.Done();
+       block_it.Advance()) {
+    BlockEntryInstr* block = block_it.Current();
+    for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+      if (MayChangeLength(it.Current())) {
+        may_change_length_ = true;
+      }
+    }
+    BranchInstr* branch = block->last_instruction()->AsBranch();
+    if (branch == NULL) continue;
+    RelationalOpInstr* comparison = branch->comparison()->AsRelationalOp();
+    if ((comparison == NULL) ||
+        (comparison->operands_class_id() != kSmiCid)) {
+      continue;
+    }
+    Definition* left = comparison->left()->definition();
+    Definition* right = comparison->right()->definition();
+    ConstrainOperands(left,
+                      right,
+                      comparison->kind(),
+                      branch->true_successor());
+    ConstrainOperands(left,
+                      right,
+                      NegateComparison(comparison->kind()),
+                      branch->false_successor());
+  }
+}
+
+
+void RangeAnalysis::ConstrainOperands(Definition* left,
+                                      Definition* right,
+                                      Token::Kind kind,
+                                      TargetEntryInstr* target) {
+  switch (kind) {
+    case Token::kLT:
+      Constrain(left,
+                RangeBoundary::MinSmi(),
+                RangeBoundary::FromDefinition(right, -1),
+                target);
+      Constrain(right,
+                RangeBoundary::FromDefinition(left, 1),
+                RangeBoundary::MaxSmi(),
+                target);
+      break;
+    case Token::kGT:
+      Constrain(left,
+                RangeBoundary::FromDefinition(right, 1),
+                RangeBoundary::MaxSmi(),
+                target);
+      Constrain(right,
+                RangeBoundary::MinSmi(),
+                RangeBoundary::FromDefinition(left, -1),
+                target);
+      break;
+    case Token::kLTE:
+      Constrain(left,
+                RangeBoundary::MinSmi(),
+                RangeBoundary::FromDefinition(right),
+                target);
+      Constrain(right,
+                RangeBoundary::FromDefinition(left),
+                RangeBoundary::MaxSmi(),
+                target);
+      break;
+    case Token::kGTE:
+      Constrain(left,
+                RangeBoundary::FromDefinition(right),
+                RangeBoundary::MaxSmi(),
+                target);
+      Constrain(right,
+                RangeBoundary::MinSmi(),
+                RangeBoundary::FromDefinition(left),
+                target);
+      break;
+    default:
+      UNREACHABLE();
+  }
+}
+
+
+static BlockEntryInstr* BlockOf(Instruction* instr) {
+  while (!instr->IsBlockEntry()) instr = instr->previous();
+  return instr->AsBlockEntry();
+}
+
+
+// Returns true if the use is dominated by the block.  The input of a phi is
+// used at the end of the corresponding predecessor.
+static bool IsDominatedUse(BlockEntryInstr* block, Value* use) {
+  PhiInstr* phi = use->instruction()->AsPhi();
+  if (phi != NULL) {
+    return block->Dominates(phi->block()->PredecessorAt(use->use_index()));
+  }
+  return block->Dominates(BlockOf(use->instruction()));
+}
+
+
+void RangeAnalysis::Constrain(Definition* defn,
+                              const RangeBoundary& min,
+                              const RangeBoundary& max,
+                              TargetEntryInstr* target) {
+  if (defn->IsConstant()) return;
+  ConstraintInstr* constraint =
+      new ConstraintInstr(new Value(defn), new Range(min, max));
+  constraint->set_ssa_temp_index(flow_graph_->alloc_ssa_temp_index());
+
+  // Rename the uses dominated by the target.  Environments keep the
+  // unconstrained definition.
+  Value* use = defn->input_use_list();
+  defn->set_input_use_list(NULL);
+  while (use != NULL) {
+    Value* next = use->next_use();
+    if (IsDominatedUse(target, use)) use->set_definition(constraint);
+    use->AddToInputUseList();
+    use = next;
+  }
+
+  constraint->InsertAfter(target);
+  constraint->value()->set_instruction(constraint);
+  constraint->value()->set_use_index(0);
+  constraint->value()->AddToInputUseList();
+  constraints_.Add(constraint);
+}
+
+
+void RangeAnalysis::InferRanges() {
+  GraphEntryInstr* graph_entry = flow_graph_->graph_entry();
+  graph_entry->constant_null()->InferRange();
+  for (intptr_t i = 0; i < graph_entry->start_env()->Length(); ++i) {
+    graph_entry->start_env()->ValueAt(i)->definition()->InferRange();
+  }
+
+  // The definitions dominating the inputs of a definition are visited first,
+  // except for the inputs of phis on back edges.
+  for (BlockIterator block_it = flow_graph_->reverse_postorder_iterator();
+       !block_it.Done();
+       block_it.Advance()) {
+    BlockEntryInstr* block = block_it.Current();
+    JoinEntryInstr* join = block->AsJoinEntry();
+    if ((join != NULL) && (join->phis() != NULL)) {
+      for (intptr_t i = 0; i < join->phis()->length(); ++i) {
+        PhiInstr* phi = (*join->phis())[i];
+        if ((phi != NULL) && phi->is_alive()) phi->InferRange();
+      }
+    }
+    for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+      Definition* defn = it.Current()->AsDefinition();
+      if ((defn != NULL) && defn->HasSSATemp()) defn->InferRange();
+    }
+  }
+
+  if (FLAG_trace_range_analysis) {
+    OS::Print("After range analysis:\n");
+    FlowGraphPrinter printer(*flow_graph_);
+    printer.PrintBlocks();
+  }
+}
+
+
+bool RangeAnalysis::IsRedundantCheck(CheckArrayBoundInstr* check) const {
+  Range* index_range = check->index()->definition()->range();
+  if ((index_range == NULL) ||
+      (index_range->min().LowerBound().value() < 0)) {
+    return false;
+  }
+  // The index must be below the length of the array: an upper bound of the
+  // index, following the upper bounds of symbols, is the length loaded from
+  // the same array minus a positive constant.
+  const intptr_t kMaxDepth = 8;
+  RangeBoundary max = index_range->max();
+  LoadFieldInstr* length = NULL;
+  for (intptr_t depth = 0; (length == NULL) && (depth < kMaxDepth); ++depth) {
+    if (!max.IsSymbol()) return false;
+    Definition* symbol = max.symbol();
+    while (symbol->IsConstraint()) {
+      symbol = symbol->AsConstraint()->value()->definition();
+    }
+    length = symbol->AsLoadField();
+    if ((length == NULL) ||
+        (length->value()->definition() != check->array()->definition())) {
+      length = NULL;
+      Range* symbol_range = max.symbol()->range();
+      if (symbol_range == NULL) return false;
+      max = symbol_range->max().Add(max.value(), RangeBoundary());
+    }
+  }
+  if ((length == NULL) || (max.value() >= 0)) return false;
+  switch (check->array_type()) {
+    case kArrayCid:
+    case kImmutableArrayCid:
+      return
+          (length->recognized_kind() == MethodRecognizer::kObjectArrayLength) ||
+          (length->recognized_kind() ==
+              MethodRecognizer::kImmutableArrayLength);
+    case kGrowableObjectArrayCid:
+      // The length of a growable array may have changed since it was loaded.
+      return !may_change_length_ &&
+          (length->recognized_kind() ==
+              MethodRecognizer::kGrowableArrayLength);
+    case kFloat32ArrayCid:
+    case kFloat64ArrayCid:
+    case kInt32ArrayCid:
+      return
+          length->recognized_kind() == MethodRecognizer::kByteArrayBaseLength;
+    default:
+      return false;
+  }
+}
+
+
+static bool IsSmiValue(int64_t value) {
+  return (Smi::kMinValue <= value) && (value <= Smi::kMaxValue);
+}
+
+
+// Returns true if the result of an addition or a subtraction of Smi values
+// in the given ranges is known to fit in a Smi.
+static bool CannotOverflow(Token::Kind op_kind, Range* left, Range* right) {
+  const int64_t left_min = left->min().LowerBound().value();
+  const int64_t left_max = left->max().UpperBound().value();
+  const int64_t right_min = right->min().LowerBound().value();
+  const int64_t right_max = right->max().UpperBound().value();
+  if (op_kind == Token::kADD) {
+    return IsSmiValue(left_min + right_min) && IsSmiValue(left_max + right_max);
+  }
+  ASSERT(op_kind == Token::kSUB);
+  return IsSmiValue(left_min - right_max) && IsSmiValue(left_max - right_min);
+}
+
+
+void RangeAnalysis::RemoveRedundantChecks() {
+  for (BlockIterator block_it = flow_graph_->reverse_postorder_iterator();
+       !block_it.Done();
+       block_it.Advance()) {
+    BlockEntryInstr* block = block_it.Current();
+    for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+      CheckArrayBoundInstr* check = it.Current()->AsCheckArrayBound();
+      if ((check != NULL) && IsRedundantCheck(check)) {
+        if (FLAG_trace_range_analysis) {
+          OS::Print("Removing redundant bounds check %"Pd" in B%"Pd"\n",
+                    check->deopt_id(),
+                    block->block_id());
+        }
+        it.RemoveCurrentFromGraph();
+        continue;
+      }
+      BinarySmiOpInstr* op = it.Current()->AsBinarySmiOp();
+      if ((op == NULL) ||
+          ((op->op_kind() != Token::kADD) && (op->op_kind() != Token::kSUB))) {
+        continue;
+      }
+      Range* left_range = op->left()->definition()->range();
+      Range* right_range = op->right()->definition()->range();
+      if ((left_range != NULL) &&
+          (right_range != NULL) &&
+          CannotOverflow(op->op_kind(), left_range, right_range)) {
+        if (FLAG_trace_range_analysis) {
+          OS::Print("Removing overflow check of v%"Pd" in B%"Pd"\n",
+                    op->ssa_temp_index(),
+                    block->block_id());
+        }
+        op->set_overflow(false);
+      }
+    }
+  }
+}
+
+
+void RangeAnalysis::RemoveConstraints() {
+  for (intptr_t i = 0; i < constraints_.length(); ++i) {
+    ConstraintInstr* constraint = constraints_[i];
+    constraint->ReplaceUsesWith(constraint->value()->definition());
+    constraint->RemoveFromGraph();
+  }
+}
+
+
+void LoopVectorizer::Optimize() {
+  GrowableArray<BlockEntryInstr*> loop_headers;
+  flow_graph_->ComputeLoops(&loop_headers);
+
+  for (intptr_t i = 0; i < loop_headers.length(); ++i) {
+    if (IsVectorizable(loop_headers[i])) {
+      if (FLAG_trace_optimization) {
+        OS::Print("Vectorizing loop B%"Pd"\n", header_->block_id());
+      }
+      Vectorize();
+    }
+  }
+}
+
+
+bool LoopVectorizer::IsLoopInvariant(Definition* defn) const {
+  return defn->GetBlock()->Dominates(pre_header_);
+}
+
+
+intptr_t LoopVectorizer::IndexOfScalar(Definition* defn) const {
+  for (intptr_t i = 0; i < scalars_.length(); ++i) {
+    if (scalars_[i] == defn) return i;
+  }
+  return -1;
+}
+
+
+// Matches a loop of the form
+//
+//   for (var i = c; i < n; i++) { ... a[i] ... }
+//
+// where c is a non-negative constant, n is loop invariant and the body is a
+// single block of element loads and stores at index i and arithmetic on the
+// loaded values.
+bool LoopVectorizer::IsVectorizable(BlockEntryInstr* header) {
+  header_ = header;
+  phi_ = NULL;
+  stack_check_ = NULL;
+  class_id_ = kIllegalCid;
+  arrays_.Clear();
+  scalars_.Clear();
+  bits_.Clear();
+  leaves_.Clear();
+
+  JoinEntryInstr* join = header->AsJoinEntry();
+  if ((join == NULL) || (join->PredecessorCount() != 2)) return false;
+  pre_header_ = FindPreHeader(header);
+  if ((pre_header_ == NULL) || !pre_header_->last_instruction()->IsGoto()) {
+    return false;
+  }
+  const intptr_t pre_index = join->IndexOfPredecessor(pre_header_);
+  body_ = join->PredecessorAt(1 - pre_index);
+  if (!body_->IsTargetEntry() ||
+      (body_->PredecessorAt(0) != header) ||
+      !body_->last_instruction()->IsGoto()) {
+    return false;
+  }
+
+  // The header holds only the induction variable and the exit test.
+  if (join->phis() == NULL) return false;
+  for (intptr_t i = 0; i < join->phis()->length(); ++i) {
+    PhiInstr* phi = (*join->phis())[i];
+    if ((phi == NULL) || !phi->is_alive()) continue;
+    if (phi_ != NULL) return false;
+    phi_ = phi;
+  }
+  if (phi_ == NULL) return false;
+  BranchInstr* branch = header->next()->AsBranch();
+  if ((branch == NULL) || (branch->true_successor() != body_)) return false;
+  comparison_ = branch->comparison()->AsRelationalOp();
+  if ((comparison_ == NULL) ||
+      (comparison_->kind() != Token::kLT) ||
+      (comparison_->operands_class_id() != kSmiCid) ||
+      (comparison_->left()->definition() != phi_)) {
+    return false;
+  }
+  limit_ = comparison_->right()->definition();
+  if (!IsLoopInvariant(limit_)) return false;
+
+  ConstantInstr* init = phi_->InputAt(pre_index)->definition()->AsConstant();
+  if ((init == NULL) ||
+      !init->value().IsSmi() ||
+      (Smi::Cast(init->value()).Value() < 0)) {
+    return false;
+  }
+  increment_ = phi_->InputAt(1 - pre_index)->definition()->AsBinarySmiOp();
+  if ((increment_ == NULL) ||
+      (increment_->op_kind() != Token::kADD) ||
+      (increment_->left()->definition() != phi_)) {
+    return false;
+  }
+  ConstantInstr* step = increment_->right()->definition()->AsConstant();
+  if ((step == NULL) ||
+      !step->value().IsSmi() ||
+      (Smi::Cast(step->value()).Value() != 1)) {
+    return false;
+  }
+
+  bool has_store = false;
+  for (ForwardInstructionIterator it(body_); !it.Done(); it.Advance()) {
+    Instruction* current = it.Current();
+    if ((current == increment_) ||
+        current->IsConstant() ||
+        current->IsGoto()) {
+      continue;
+    }
+    if (current->IsCheckStackOverflow()) {
+      if (stack_check_ != NULL) return false;
+      stack_check_ = current->AsCheckStackOverflow();
+    } else if (current->IsCheckArrayBound()) {
+      // Bounds checks are subsumed by the check before the vector loop.
+      CheckArrayBoundInstr* check = current->AsCheckArrayBound();
+      if ((check->index()->definition() != phi_) ||
+          !IsLoopInvariant(check->array()->definition())) {
+        return false;
+      }
+    } else if (current->IsUnboxDouble()) {
+      // Unboxed constants are replicated when used as operands.
+      if (!current->InputAt(0)->definition()->IsConstant()) return false;
+    } else {
+      Definition* defn = current->AsDefinition();
+      if ((defn == NULL) || !AddScalar(defn)) return false;
+      has_store = has_store || defn->IsStoreIndexed();
+    }
+  }
+  if (!has_store) return false;
+
+  // The values computed in the body must not be needed by anything else
+  // than the vectorized instructions and dead phis.
+  for (intptr_t i = 0; i < scalars_.length(); ++i) {
+    for (Value* use = scalars_[i]->input_use_list();
+         use != NULL;
+         use = use->next_use()) {
+      Definition* user = use->instruction()->AsDefinition();
+      if ((user != NULL) && user->IsPhi() && !user->AsPhi()->is_alive()) {
+        continue;
+      }
+      if ((user == NULL) || (IndexOfScalar(user) < 0)) return false;
+    }
+  }
+  return true;
+}
+
+
+bool LoopVectorizer::IsElementAccess(Value* array,
+                                     Value* index,
+                                     intptr_t class_id) {
+  if ((index->definition() != phi_) ||
+      !IsLoopInvariant(array->definition())) {
+    return false;
+  }
+  if (class_id_ == kIllegalCid) {
+    if (!IsSupportedTypedArrayCid(class_id)) return false;
+    class_id_ = class_id;
+  } else if (class_id != class_id_) {
+    return false;
+  }
+  for (intptr_t i = 0; i < arrays_.length(); ++i) {
+    if (arrays_[i] == array->definition()) return true;
+  }
+  arrays_.Add(array->definition());
+  return true;
+}
+
+
+// Loop invariant doubles and Smi constants that fit into 32 bits can be
+// replicated into a vector of the loop's element type.
+bool LoopVectorizer::IsBroadcastable(Definition* defn) const {
+  switch (class_id_) {
+    case kFloat64ArrayCid: {
+      if (IsLoopInvariant(defn)) {
+        return defn->representation() == kUnboxedDouble;
+      }
+      if (!defn->IsUnboxDouble()) return false;
+      ConstantInstr* constant = defn->InputAt(0)->definition()->AsConstant();
+      return (constant != NULL) && constant->value().IsDouble();
+    }
+    case kInt32ArrayCid: {
+      ConstantInstr* constant = defn->AsConstant();
+      if ((constant == NULL) || !constant->value().IsSmi()) return false;
+      const intptr_t value = Smi::Cast(constant->value()).Value();
+      return (value >= kMinInt32) && (value <= kMaxInt32);
+    }
+    default:
+      return false;
+  }
+}
+
+
+bool LoopVectorizer::AddOperand(Definition* operand, intptr_t* bits) {
+  const intptr_t index = IndexOfScalar(operand);
+  if (index >= 0) {
+    *bits = bits_[index];
+    return true;
+  }
+  if (!IsBroadcastable(operand)) return false;
+  for (intptr_t i = 0; i < leaves_.length(); ++i) {
+    if (leaves_[i] == operand) return true;
+  }
+  leaves_.Add(operand);
+  *bits = 32;
+  return true;
+}
+
+
+// Records a load, store or arithmetic operation of the body and computes an
+// upper bound on the number of bits of its Int32 result.  Float32 elements
+// are loaded as doubles; their vectorized sums, differences, products and
+// quotients are rounded the same only if computed directly on loaded
+// values.
+bool LoopVectorizer::AddScalar(Definition* defn) {
+  intptr_t bits = 0;
+  if (defn->IsLoadIndexed()) {
+    LoadIndexedInstr* load = defn->AsLoadIndexed();
+    if (!IsElementAccess(load->array(), load->index(), load->class_id())) {
+      return false;
+    }
+    bits = 32;
+  } else if (defn->IsStoreIndexed()) {
+    StoreIndexedInstr* store = defn->AsStoreIndexed();
+    if (!IsElementAccess(store->array(), store->index(), store->class_id()) ||
+        !AddOperand(store->value()->definition(), &bits)) {
+      return false;
+    }
+    if ((class_id_ == kFloat32ArrayCid) &&
+        (IndexOfScalar(store->value()->definition()) < 0)) {
+      return false;
+    }
+  } else if (defn->IsUnboxedDoubleBinaryOp() ||
+             defn->IsBinarySmiOp()) {
+    Token::Kind op_kind = Token::kILLEGAL;
+    if (defn->IsUnboxedDoubleBinaryOp()) {
+      if ((class_id_ != kFloat32ArrayCid) &&
+          (class_id_ != kFloat64ArrayCid)) {
+        return false;
+      }
+      op_kind = defn->AsUnboxedDoubleBinaryOp()->op_kind();
+    } else {
+      if (class_id_ != kInt32ArrayCid) return false;
+      op_kind = defn->AsBinarySmiOp()->op_kind();
+    }
+    switch (op_kind) {
+      case Token::kADD:
+      case Token::kSUB:
+        break;
+      case Token::kMUL:
+      case Token::kDIV:
+        if (class_id_ == kInt32ArrayCid) return false;
+        break;
+      case Token::kBIT_AND:
+      case Token::kBIT_OR:
+      case Token::kBIT_XOR:
+        if (class_id_ != kInt32ArrayCid) return false;
+        break;
+      default:
+        return false;
+    }
+    Definition* left = defn->InputAt(0)->definition();
+    Definition* right = defn->InputAt(1)->definition();
+    // At least one operand is a vector, so the element type is known.
+    if ((IndexOfScalar(left) < 0) && (IndexOfScalar(right) < 0)) {
+      return false;
+    }
+    intptr_t left_bits = 0;
+    intptr_t right_bits = 0;
+    if (!AddOperand(left, &left_bits) || !AddOperand(right, &right_bits)) {
+      return false;
+    }
+    if ((class_id_ == kFloat32ArrayCid) &&
+        (!left->IsLoadIndexed() || !right->IsLoadIndexed())) {
+      return false;
+    }
+    bits = Utils::Maximum(left_bits, right_bits);
+    if ((op_kind == Token::kADD) || (op_kind == Token::kSUB)) ++bits;
+    // The scalar code stores the low 32 bits of results that fit in a Smi.
+    if (bits >= kSmiBits) return false;
+  } else {
+    return false;
+  }
+  scalars_.Add(defn);
+  bits_.Add(bits);
+  return true;
+}
+
+
+// Reorders the inputs of the phis of a join to match its predecessors
+// after they were rediscovered.
+static void ReorderPhiInputs(JoinEntryInstr* join,
+                             const GrowableArray<BlockEntryInstr*>& blocks) {
+  ASSERT(join->PredecessorCount() == blocks.length());
+  for (intptr_t i = 0; i < join->phis()->length(); ++i) {
+    PhiInstr* phi = (*join->phis())[i];
+    if (phi == NULL) continue;
+    GrowableArray<Value*> inputs(blocks.length());
+    for (intptr_t j = 0; j < blocks.length(); ++j) {
+      inputs.Add(phi->InputAt(j));
+    }
+    for (intptr_t j = 0; j < blocks.length(); ++j) {
+      BlockEntryInstr* pred = join->PredecessorAt(j);
+      intptr_t index = 0;
+      while (blocks[index] != pred) ++index;
+      phi->SetInputAt(j, inputs[index]);
+    }
+  }
+}
+
+
+// Inserts a phi of the given values into a new join entry.  The inputs
+// follow the order of the given predecessor blocks.
+static PhiInstr* InsertPhi(FlowGraph* flow_graph,
+                           JoinEntryInstr* join,
+                           const GrowableArray<BlockEntryInstr*>& blocks,
+                           const GrowableArray<Definition*>& values) {
+  ASSERT(blocks.length() == values.length());
+  for (intptr_t i = 0; i < blocks.length(); ++i) {
+    join->AddPredecessor(blocks[i]);
+  }
+  join->InsertPhi(0, 1);
+  // The predecessors are rediscovered with the blocks of the graph.
+  join->ClearPredecessors();
+  PhiInstr* phi = (*join->phis())[0];
+  phi->set_ssa_temp_index(flow_graph->alloc_ssa_temp_index());
+  phi->mark_alive();
+  phi->SetPropagatedCid(kSmiCid);
+  for (intptr_t i = 0; i < values.length(); ++i) {
+    phi->SetInputAt(i, new Value(values[i]));
+  }
+  return phi;
+}
+
+
+Instruction* LoopVectorizer::Append(Instruction* prev, Instruction* instr) {
+  prev->set_next(instr);
+  instr->set_previous(prev);
+  return instr;
+}
+
+
+Instruction* LoopVectorizer::AppendDefinition(Instruction* prev,
+                                              Definition* defn) {
+  defn->set_ssa_temp_index(flow_graph_->alloc_ssa_temp_index());
+  return Append(prev, defn);
+}
+
+
+Instruction* LoopVectorizer::AppendBroadcast(Instruction* prev,
+                                             Definition* leaf) {
+  Definition* value = leaf;
+  if (!IsLoopInvariant(leaf)) {
+    // Constants used in the body are rematerialized before the vector loop.
+    UnboxDoubleInstr* unbox = leaf->AsUnboxDouble();
+    ConstantInstr* constant = (unbox != NULL)
+        ? unbox->value()->definition()->AsConstant()
+        : leaf->AsConstant();
+    value = new ConstantInstr(constant->value());
+    prev = AppendDefinition(prev, value);
+    if (unbox != NULL) {
+      // Unboxing a double constant does not deoptimize.
+      value = new UnboxDoubleInstr(new Value(value), Isolate::kNoDeoptId);
+      prev = AppendDefinition(prev, value);
+    }
+  }
+  VectorBroadcastInstr* broadcast =
+      new VectorBroadcastInstr(new Value(value),
+                               class_id_,
+                               Isolate::kNoDeoptId);
+  broadcasts_.Add(broadcast);
+  return AppendDefinition(prev, broadcast);
+}
+
+
+Value* LoopVectorizer::VectorOperand(Value* operand) {
+  Definition* defn = operand->definition();
+  const intptr_t index = IndexOfScalar(defn);
+  if (index >= 0) return new Value(vectors_[index]);
+  for (intptr_t i = 0; i < leaves_.length(); ++i) {
+    if (leaves_[i] == defn) return new Value(broadcasts_[i]);
+  }
+  UNREACHABLE();
+  return NULL;
+}
+
+
+// Rewrites
+//
+//   P: goto H
+//   H: i = phi(c, i + 1); if (i < n) goto B else X
+//   B: ...; goto H
+//
+// into
+//
+//   P:  if (n <= a.length) goto P1 else F1
+//       ... (one check per array)
+//   VP: broadcasts; goto VH
+//   VH: vi = phi(c, vi + w); if (vi + w <= n) goto VB else VX
+//   VB: vector operations at vi; goto VH
+//   VX: goto E
+//   F1: goto E
+//   E:  e = phi(vi, c, ...); goto H
+//   H:  i = phi(e, i + 1); if (i < n) goto B else X
+//
+// The vector loop processes w elements per iteration and the scalar loop
+// the remaining elements.  No access in either loop is out of bounds if the
+// limit does not exceed the length of any array, so the vector loop has no
+// bounds checks.
+void LoopVectorizer::Vectorize() {
+  JoinEntryInstr* header = header_->AsJoinEntry();
+  const intptr_t try_index = header->try_index();
+  const intptr_t token_pos = comparison_->token_pos();
+  const intptr_t pre_index = header->IndexOfPredecessor(pre_header_);
+  Definition* init = phi_->InputAt(pre_index)->definition();
+  // An xmm register holds two Float64 or four Float32 or Int32 elements.
+  const intptr_t width = (class_id_ == kFloat64ArrayCid) ? 2 : 4;
+
+  JoinEntryInstr* vector_header = new JoinEntryInstr(try_index);
+  TargetEntryInstr* vector_body = new TargetEntryInstr(try_index);
+  TargetEntryInstr* vector_exit = new TargetEntryInstr(try_index);
+  JoinEntryInstr* scalar_entry = new JoinEntryInstr(try_index);
+
+  GrowableArray<BlockEntryInstr*> scalar_entry_preds;
+  GrowableArray<Definition*> scalar_entry_values;
+
+  // Check the limit against the length of each array.
+  Instruction* last = pre_header_->last_instruction()->previous();
+  for (intptr_t i = 0; i < arrays_.length(); ++i) {
+    LoadFieldInstr* length = new LoadFieldInstr(
+        new Value(arrays_[i]),
+        ByteArray::length_offset(),
+        Type::ZoneHandle(Type::SmiType()),
+        true);  // Immutable.
+    length->set_result_cid(kSmiCid);
+    length->set_recognized_kind(MethodRecognizer::kByteArrayBaseLength);
+    last = AppendDefinition(last, length);
+    RelationalOpInstr* in_bounds = new RelationalOpInstr(token_pos,
+                                                         Token::kLTE,
+                                                         new Value(limit_),
+                                                         new Value(length));
+    in_bounds->set_operands_class_id(kSmiCid);
+    BranchInstr* branch = new BranchInstr(in_bounds);
+    Append(last, branch);
+    TargetEntryInstr* true_target = new TargetEntryInstr(try_index);
+    TargetEntryInstr* false_target = new TargetEntryInstr(try_index);
+    *branch->true_successor_address() = true_target;
+    *branch->false_successor_address() = false_target;
+    Append(false_target, new GotoInstr(scalar_entry));
+    scalar_entry_preds.Add(false_target);
+    scalar_entry_values.Add(init);
+    last = true_target;
+  }
+
+  // Replicate the loop invariant operands into vectors.
+  BlockEntryInstr* vector_pre_header = last->AsBlockEntry();
+  broadcasts_.Clear();
+  for (intptr_t i = 0; i < leaves_.length(); ++i) {
+    last = AppendBroadcast(last, leaves_[i]);
+  }
+  ConstantInstr* step =
+      new ConstantInstr(Smi::ZoneHandle(Smi::New(width)));
+  last = AppendDefinition(last, step);
+  Append(last, new GotoInstr(vector_header));
+
+  GrowableArray<BlockEntryInstr*> vector_header_preds;
+  GrowableArray<Definition*> vector_header_values;
+  vector_header_preds.Add(vector_pre_header);
+  vector_header_values.Add(init);
+  vector_header_preds.Add(vector_body);
+  vector_header_values.Add(init);  // Replaced by the next vector index.
+  PhiInstr* vector_index = InsertPhi(flow_graph_,
+                                     vector_header,
+                                     vector_header_preds,
+                                     vector_header_values);
+
+  // The next vector index does not overflow: it does not exceed the limit
+  // in the body and the limit does not exceed the length of an array.
+  BinarySmiOpInstr* next_index =
+      new BinarySmiOpInstr(Token::kADD,
+                           increment_->instance_call(),
+                           new Value(vector_index),
+                           new Value(step));
+  next_index->set_overflow(false);
+  vector_index->SetInputAt(1, new Value(next_index));
+  last = AppendDefinition(vector_header, next_index);
+  RelationalOpInstr* has_next = new RelationalOpInstr(token_pos,
+                                                      Token::kLTE,
+                                                      new Value(next_index),
+                                                      new Value(limit_));
+  has_next->set_operands_class_id(kSmiCid);
+  BranchInstr* branch = new BranchInstr(has_next);
+  Append(last, branch);
+  *branch->true_successor_address() = vector_body;
+  *branch->false_successor_address() = vector_exit;
+
+  // The body of the vector loop.
+  last = vector_body;
+  if (stack_check_ != NULL) {
+    last = Append(last, new CheckStackOverflowInstr(stack_check_->token_pos(),
+                                                    stack_check_->in_loop()));
+  }
+  vectors_.Clear();
+  for (intptr_t i = 0; i < scalars_.length(); ++i) {
+    Definition* scalar = scalars_[i];
+    Definition* vector = NULL;
+    if (scalar->IsLoadIndexed()) {
+      vector = new VectorLoadIndexedInstr(
+          scalar->AsLoadIndexed()->array()->Copy(),
+          new Value(vector_index),
+          class_id_);
+      last = AppendDefinition(last, vector);
+    } else if (scalar->IsStoreIndexed()) {
+      StoreIndexedInstr* store = scalar->AsStoreIndexed();
+      vector = new VectorStoreIndexedInstr(store->array()->Copy(),
+                                           new Value(vector_index),
+                                           VectorOperand(store->value()),
+                                           class_id_);
+      last = Append(last, vector);
+    } else {
+      const Token::Kind op_kind = scalar->IsBinarySmiOp()
+          ? scalar->AsBinarySmiOp()->op_kind()
+          : scalar->AsUnboxedDoubleBinaryOp()->op_kind();
+      vector = new VectorBinaryOpInstr(op_kind,
+                                       VectorOperand(scalar->InputAt(0)),
+                                       VectorOperand(scalar->InputAt(1)),
+                                       class_id_);
+      last = AppendDefinition(last, vector);
+    }
+    vectors_.Add(vector);
+  }
+  Append(last, new GotoInstr(vector_header));
+
+  // Continue with the scalar loop at the first element not processed.
+  Append(vector_exit, new GotoInstr(scalar_entry));
+  scalar_entry_preds.Add(vector_exit);
+  scalar_entry_values.Add(vector_index);
+  PhiInstr* scalar_index = InsertPhi(flow_graph_,
+                                     scalar_entry,
+                                     scalar_entry_preds,
+                                     scalar_entry_values);
+  Append(scalar_entry, new GotoInstr(header));
+
+  GrowableArray<BlockEntryInstr*> header_preds;
+  header_preds.Add(header->PredecessorAt(0));
+  header_preds.Add(header->PredecessorAt(1));
+  header_preds[pre_index] = scalar_entry;
+  phi_->SetInputAt(pre_index, new Value(scalar_index));
+
+  flow_graph_->RecomputeDominators();
+  ReorderPhiInputs(vector_header, vector_header_preds);
+  ReorderPhiInputs(scalar_entry, scalar_entry_preds);
+  ReorderPhiInputs(header, header_preds);
+  flow_graph_->ComputeUseLists();
+}
+
+
+// Returns the last value stored at the given offset of a sinking candidate.
+// All stores into a candidate precede its other uses in its block.
+static Definition* StoredValueAt(AllocateObjectInstr* alloc,
+                                 intptr_t offset_in_bytes) {
+  Definition* result = NULL;
+  for (Instruction* instr = alloc->next();
+       instr != NULL;
+       instr = instr->next()) {
+    StoreInstanceFieldInstr* store = instr->AsStoreInstanceField();
+    if ((store != NULL) &&
+        (store->instance()->definition() == alloc) &&
+        (store->field().Offset() == offset_in_bytes)) {
+      result = store->value()->definition();
+    }
+  }
+  return result;
+}
+
+
+static bool ChecksClassId(CheckClassInstr* check, intptr_t cid) {
+  const ICData& unary_checks = check->unary_checks();
+  for (intptr_t i = 0; i < unary_checks.NumberOfChecks(); i++) {
+    if (unary_checks.GetReceiverClassIdAt(i) == cid) return true;
+  }
+  return false;
+}
+
+
+static bool IsRemovedFromGraph(Instruction* instr) {
+  return !instr->IsPhi() && (instr->previous() == NULL);
+}
+
+
+// An allocation can be sunk if it is only used by initializing stores into
+// its fields, which precede all other uses in its block, by loads of the
+// stored fields, by class checks that pass, and by environments.
+bool AllocationSinking::IsSinkingCandidate(AllocateObjectInstr* alloc) const {
+  if (alloc->ArgumentCount() != 0) return false;
+  const Class& cls = Class::Handle(alloc->constructor().Owner());
+  if (cls.HasTypeArguments()) return false;
+
+  intptr_t store_count = 0;
+  for (Value* use = alloc->input_use_list();
+       use != NULL;
+       use = use->next_use()) {
+    Instruction* instr = use->instruction();
+    if (instr->IsStoreInstanceField()) {
+      if (use->use_index() != 0) return false;  // Stored into a field.
+      store_count++;
+    } else if (instr->IsLoadField()) {
+      const intptr_t offset = instr->AsLoadField()->offset_in_bytes();
+      if (StoredValueAt(alloc, offset) == NULL) return false;
+    } else if (instr->IsCheckClass()) {
+      if (!ChecksClassId(instr->AsCheckClass(), cls.id())) return false;
+    } else {
+      return false;
+    }
+  }
+
+  // Loads and class checks must not observe a partially initialized object.
+  for (Instruction* instr = alloc->next();
+       (instr != NULL) && (store_count > 0);
+       instr = instr->next()) {
+    for (intptr_t i = 0; i < instr->InputCount(); i++) {
+      if (instr->InputAt(i)->definition() != alloc) continue;
+      if (!instr->IsStoreInstanceField()) return false;
+      store_count--;
+    }
+  }
+  return store_count == 0;
+}
+
+
+void AllocationSinking::ForwardLoads(AllocateObjectInstr* alloc) {
+  for (Value* use = alloc->input_use_list();
+       use != NULL;
+       use = use->next_use()) {
+    Instruction* instr = use->instruction();
+    LoadFieldInstr* load = instr->AsLoadField();
+    if (load != NULL) {
+      Definition* value = StoredValueAt(alloc, load->offset_in_bytes());
+      if (FLAG_trace_optimization) {
+        OS::Print("Replacing load v%"Pd" with v%"Pd"\n",
+                  load->ssa_temp_index(),
+                  value->ssa_temp_index());
+      }
+      load->ReplaceUsesWith(value);
+      load->RemoveFromGraph();
+    } else if (instr->IsCheckClass()) {
+      instr->RemoveFromGraph();
+    }
+  }
+}
+
+
+// Remove the conversions and checks made redundant by the forwarded loads.
+void AllocationSinking::SimplifyUses() {
+  const GrowableArray<BlockEntryInstr*>& block_order =
+      flow_graph_->reverse_postorder();
+  for (intptr_t i = 0; i < block_order.length(); ++i) {
+    for (ForwardInstructionIterator it(block_order[i]);
+         !it.Done();
+         it.Advance()) {
+      Definition* defn = it.Current()->AsDefinition();
+      if (defn == NULL) continue;
+      UnboxDoubleInstr* unbox = defn->AsUnboxDouble();
+      if (unbox != NULL) {
+        BoxDoubleInstr* box = unbox->value()->definition()->AsBoxDouble();
+        if (box != NULL) {
+          unbox->ReplaceUsesWith(box->value()->definition());
+          it.RemoveCurrentFromGraph();
+        }
+        continue;
+      }
+      UnboxIntegerInstr* unbox_int = defn->AsUnboxInteger();
+      if (unbox_int != NULL) {
+        BoxIntegerInstr* box =
+            unbox_int->value()->definition()->AsBoxInteger();
+        if (box != NULL) {
+          unbox_int->ReplaceUsesWith(box->value()->definition());
+          it.RemoveCurrentFromGraph();
+        }
+        continue;
+      }
+      UnboxVectorInstr* unbox_vector = defn->AsUnboxVector();
+      if (unbox_vector != NULL) {
+        BoxVectorInstr* box =
+            unbox_vector->value()->definition()->AsBoxVector();
+        if (box != NULL) {
+          unbox_vector->ReplaceUsesWith(box->value()->definition());
+          it.RemoveCurrentFromGraph();
+        }
+        continue;
+      }
+      if ((defn->IsCheckClass() ||
+           defn->IsCheckSmi() ||
+           defn->IsCheckEitherNonSmi()) &&
+          (defn->Canonicalize() == NULL)) {
+        it.RemoveCurrentFromGraph();
+      }
+    }
+  }
+}
+
+
+// Replaces the uses of the allocation in the environment of the instruction
+// with a description of the object built from the given field values.
+static void MaterializeAt(Instruction* instr,
+                          AllocateObjectInstr* alloc,
+                          const Class& cls,
+                          const ZoneGrowableArray<const Field*>& fields,
+                          const GrowableArray<Definition*>& values) {
+  if (instr->env() == NULL) return;
+  MaterializeObjectInstr* materialization = NULL;
+  for (Environment::DeepIterator it(instr->env()); !it.Done(); it.Advance()) {
+    if (it.CurrentValue()->definition() != alloc) continue;
+    if (materialization == NULL) {
+      ZoneGrowableArray<Value*>* field_values =
+          new ZoneGrowableArray<Value*>(values.length());
+      for (intptr_t i = 0; i < values.length(); i++) {
+        // Double, integer and vector fields are described by their unboxed
+        // values.
+        Definition* value = values[i];
+        if (value->IsBoxDouble()) {
+          value = value->AsBoxDouble()->value()->definition();
+        } else if (value->IsBoxInteger()) {
+          value = value->AsBoxInteger()->value()->definition();
+        } else if (value->IsBoxVector()) {
+          value = value->AsBoxVector()->value()->definition();
+        }
+        field_values->Add(new Value(value));
+      }
+      materialization = new MaterializeObjectInstr(cls, fields, field_values);
+    }
+    it.SetCurrentValue(new Value(materialization));
+  }
+}
+
+
+static intptr_t IndexOfField(const ZoneGrowableArray<const Field*>& fields,
+                             const Field& field) {
+  for (intptr_t i = 0; i < fields.length(); i++) {
+    if (fields[i]->raw() == field.raw()) return i;
+  }
+  return -1;
+}
+
+
+void AllocationSinking::MaterializeInEnvironments(AllocateObjectInstr* alloc) {
+  const Class& cls = Class::ZoneHandle(alloc->constructor().Owner());
+  ZoneGrowableArray<const Field*>* fields =
+      new ZoneGrowableArray<const Field*>();
+  GrowableArray<Definition*> values;
+  for (Instruction* instr = alloc->next();
+       instr != NULL;
+       instr = instr->next()) {
+    StoreInstanceFieldInstr* store = instr->AsStoreInstanceField();
+    if ((store == NULL) || (store->instance()->definition() != alloc)) {
+      continue;
+    }
+    if (IndexOfField(*fields, store->field()) < 0) {
+      fields->Add(&store->field());
+      values.Add(flow_graph_->graph_entry()->constant_null());
+    }
+  }
+
+  // Inside the allocation's block the object holds the values stored so far.
+  for (Instruction* instr = alloc->next();
+       instr != NULL;
+       instr = instr->next()) {
+    StoreInstanceFieldInstr* store = instr->AsStoreInstanceField();
+    if ((store != NULL) && (store->instance()->definition() == alloc)) {
+      values[IndexOfField(*fields, store->field())] =
+          store->value()->definition();
+    } else {
+      MaterializeAt(instr, alloc, cls, *fields, values);
+    }
+  }
+
+  // All other uses are dominated by the allocation's block.
+  const GrowableArray<BlockEntryInstr*>& block_order =
+      flow_graph_->reverse_postorder();
+  for (intptr_t i = 0; i < block_order.length(); ++i) {
+    for (ForwardInstructionIterator it(block_order[i]);
+         !it.Done();
+         it.Advance()) {
+      MaterializeAt(it.Current(), alloc, cls, *fields, values);
+    }
+  }
+}
+
+
+void AllocationSinking::EliminateAllocation(AllocateObjectInstr* alloc) {
+  for (Value* use = alloc->input_use_list();
+       use != NULL;
+       use = use->next_use()) {
+    Instruction* instr = use->instruction();
+    ASSERT(instr->IsStoreInstanceField() || IsRemovedFromGraph(instr));
+    if (!IsRemovedFromGraph(instr)) instr->RemoveFromGraph();
+  }
+  alloc->RemoveFromGraph();
+}
+
+
+// Remove the boxing of the values which were only stored into the
+// eliminated objects.  Environments of instructions which cannot
+// deoptimize are dropped by the register allocator.
+void AllocationSinking::RemoveDeadBoxes() {
+  const GrowableArray<BlockEntryInstr*>& block_order =
+      flow_graph_->reverse_postorder();
+  for (intptr_t i = 0; i < block_order.length(); ++i) {
+    for (ForwardInstructionIterator it(block_order[i]);
+         !it.Done();
+         it.Advance()) {
+      Definition* box = it.Current()->AsDefinition();
+      if ((box == NULL) || !(box->IsBoxDouble() || box->IsBoxVector())) {
+        continue;
+      }
+      bool is_dead = true;
+      for (Value* use = box->input_use_list();
+           is_dead && (use != NULL);
+           use = use->next_use()) {
+        is_dead = IsRemovedFromGraph(use->instruction());
+      }
+      for (Value* use = box->env_use_list();
+           is_dead && (use != NULL);
+           use = use->next_use()) {
+        is_dead = IsRemovedFromGraph(use->instruction()) ||
+            !use->instruction()->CanDeoptimize();
+      }
+      if (is_dead) it.RemoveCurrentFromGraph();
+    }
+  }
+}
+
+
+void AllocationSinking::Optimize() {
+  const GrowableArray<BlockEntryInstr*>& block_order =
+      flow_graph_->reverse_postorder();
+  for (intptr_t i = 0; i < block_order.length(); ++i) {
+    for (ForwardInstructionIterator it(block_order[i]);
+         !it.Done();
+         it.Advance()) {
+      AllocateObjectInstr* alloc = it.Current()->AsAllocateObject();
+      if ((alloc != NULL) && IsSinkingCandidate(alloc)) {
+        if (FLAG_trace_optimization) {
+          OS::Print("Sinking allocation v%"Pd"\n", alloc->ssa_temp_index());
+        }
+        candidates_.Add(alloc);
+      }
+    }
+  }
+  if (candidates_.is_empty()) return;
+
+  for (intptr_t i = 0; i < candidates_.length(); i++) {
+    ForwardLoads(candidates_[i]);
+  }
+  SimplifyUses();
+  for (intptr_t i = 0; i < candidates_.length(); i++) {
+    MaterializeInEnvironments(candidates_[i]);
+    EliminateAllocation(candidates_[i]);
+  }
+  RemoveDeadBoxes();
+}
+
+
 }  // namespace dart
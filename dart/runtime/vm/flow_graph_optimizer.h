@@ -53,7 +53,24 @@ class FlowGraphOptimizer : public FlowGraphVisitor {
 
   bool TryInlineInstanceMethod(InstanceCallInstr* call);
 
+  bool TryReplaceWithVectorBinaryOp(InstanceCallInstr* call,
+                                    Token::Kind op_kind);
+  bool TryInlineVectorGetter(InstanceCallInstr* call,
+                             MethodRecognizer::Kind recognized_kind);
+  bool TryInlineVectorMethod(InstanceCallInstr* call,
+                             MethodRecognizer::Kind recognized_kind);
+  bool TryInlineVectorArrayAccess(InstanceCallInstr* call,
+                                  MethodRecognizer::Kind recognized_kind);
+  void InlineVectorFactory(StaticCallInstr* call,
+                           MethodRecognizer::Kind recognized_kind);
+
   void AddCheckClass(InstanceCallInstr* call, Value* value);
+  void AddCheckDouble(InstanceCallInstr* call, Value* value);
+  void AddCheckClassId(Instruction* instr,
+                       intptr_t deopt_id,
+                       const Function& target,
+                       Value* value,
+                       intptr_t class_id);
 
   void InsertAfter(Instruction* instr,
                    Definition* defn,
@@ -156,6 +173,150 @@ class DominatorBasedCSE : public AllStatic {
 };
 
 
+// Range analysis of Smi values.  Constrains the operands of Smi comparisons
+// in the successors of branches, infers ranges in a single pass over the
+// graph in reverse postorder and removes the bounds checks and the overflow
+// checks the ranges prove redundant.
+class RangeAnalysis : public ValueObject {
+ public:
+  explicit RangeAnalysis(FlowGraph* flow_graph)
+      : flow_graph_(flow_graph),
+        constraints_(),
+        may_change_length_(false) { }
+
+  void Analyze();
+
+ private:
+  void InsertConstraints();
+  void ConstrainOperands(Definition* left,
+                         Definition* right,
+                         Token::Kind kind,
+                         TargetEntryInstr* target);
+  void Constrain(Definition* defn,
+                 const RangeBoundary& min,
+                 const RangeBoundary& max,
+                 TargetEntryInstr* target);
+
+  void InferRanges();
+
+  void RemoveRedundantChecks();
+  bool IsRedundantCheck(CheckArrayBoundInstr* check) const;
+
+  void RemoveConstraints();
+
+  FlowGraph* flow_graph_;
+  GrowableArray<ConstraintInstr*> constraints_;
+
+  // True if the graph contains instructions which may call Dart code or store
+  // into fields, and so change the length of a growable array.
+  bool may_change_length_;
+
+  DISALLOW_COPY_AND_ASSIGN(RangeAnalysis);
+};
+
+
+// Vectorizes counted loops whose body loads, combines and stores elements
+// of typed arrays at the loop index.  The vector loop processes as many
+// elements per iteration as fit into an xmm register and is guarded by a
+// check that all accesses are in bounds.  The original scalar loop runs the
+// remaining iterations.
+class LoopVectorizer : public ValueObject {
+ public:
+  explicit LoopVectorizer(FlowGraph* flow_graph)
+      : flow_graph_(flow_graph),
+        header_(NULL),
+        pre_header_(NULL),
+        body_(NULL),
+        phi_(NULL),
+        limit_(NULL),
+        increment_(NULL),
+        comparison_(NULL),
+        stack_check_(NULL),
+        class_id_(kIllegalCid),
+        arrays_(),
+        scalars_(),
+        bits_(),
+        leaves_(),
+        vectors_(),
+        broadcasts_() { }
+
+  void Optimize();
+
+ private:
+  bool IsVectorizable(BlockEntryInstr* header);
+  bool IsLoopInvariant(Definition* defn) const;
+  bool IsElementAccess(Value* array, Value* index, intptr_t class_id);
+  bool IsBroadcastable(Definition* defn) const;
+  bool AddScalar(Definition* defn);
+  bool AddOperand(Definition* operand, intptr_t* bits);
+  intptr_t IndexOfScalar(Definition* defn) const;
+
+  void Vectorize();
+  Instruction* Append(Instruction* prev, Instruction* instr);
+  Instruction* AppendDefinition(Instruction* prev, Definition* defn);
+  Instruction* AppendBroadcast(Instruction* prev, Definition* leaf);
+  Value* VectorOperand(Value* operand);
+
+  FlowGraph* flow_graph_;
+
+  // The loop being vectorized: the header holds the only phi and the exit
+  // branch, the body is a single block ending in the back edge.
+  BlockEntryInstr* header_;
+  BlockEntryInstr* pre_header_;
+  BlockEntryInstr* body_;
+  PhiInstr* phi_;
+  Definition* limit_;
+  BinarySmiOpInstr* increment_;
+  RelationalOpInstr* comparison_;
+  CheckStackOverflowInstr* stack_check_;
+  intptr_t class_id_;
+
+  // The typed arrays accessed in the loop.
+  GrowableArray<Definition*> arrays_;
+
+  // The loads, operations and stores of the body in order and the number
+  // of significant bits of their Int32 results.
+  GrowableArray<Definition*> scalars_;
+  GrowableArray<intptr_t> bits_;
+
+  // The loop invariant operands replicated into vectors.
+  GrowableArray<Definition*> leaves_;
+
+  // The vector counterparts of the scalars and leaves.
+  GrowableArray<Definition*> vectors_;
+  GrowableArray<Definition*> broadcasts_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoopVectorizer);
+};
+
+
+// Removes allocations of objects which do not escape the function. Loads
+// from such an object are replaced with the values stored into it and the
+// object is rematerialized from these values when the code deoptimizes.
+class AllocationSinking : public ValueObject {
+ public:
+  explicit AllocationSinking(FlowGraph* flow_graph)
+      : flow_graph_(flow_graph),
+        candidates_() { }
+
+  void Optimize();
+
+ private:
+  bool IsSinkingCandidate(AllocateObjectInstr* alloc) const;
+
+  void ForwardLoads(AllocateObjectInstr* alloc);
+  void SimplifyUses();
+  void MaterializeInEnvironments(AllocateObjectInstr* alloc);
+  void EliminateAllocation(AllocateObjectInstr* alloc);
+  void RemoveDeadBoxes();
+
+  FlowGraph* flow_graph_;
+  GrowableArray<AllocateObjectInstr*> candidates_;
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSinking);
+};
+
+
 }  // namespace dart
 
 #endif  // VM_FLOW_GRAPH_OPTIMIZER_H_
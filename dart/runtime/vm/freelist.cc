@@ -7,6 +7,7 @@
 #include "vm/bit_set.h"
 #include "vm/object.h"
 #include "vm/raw_object.h"
+#include "vm/virtual_memory.h"
 
 namespace dart {
 
@@ -86,6 +87,37 @@ uword FreeList::TryAllocate(intptr_t size) {
 }
 
 
+uword FreeList::TryAllocateLarge(intptr_t max_size, intptr_t* size) {
+  ASSERT(max_size >= kMinLargeSize);
+  ASSERT(Utils::IsAligned(max_size, kObjectAlignment));
+  FreeListElement* element = free_lists_[kNumLists];
+  if (element == NULL) {
+    return 0;
+  }
+  free_lists_[kNumLists] = element->next();
+  ASSERT(element->Size() >= kMinLargeSize);
+  *size = Utils::Minimum(element->Size(), max_size);
+  SplitElementAfterAndEnqueue(element, *size);
+  return reinterpret_cast<uword>(element);
+}
+
+
+intptr_t FreeList::ReleaseMemory() {
+  intptr_t released = 0;
+  // The smaller blocks do not cover a whole page.
+  FreeListElement* element = free_lists_[kNumLists];
+  while (element != NULL) {
+    // The header of a large block includes its size.
+    uword start =
+        reinterpret_cast<uword>(element) + sizeof(*element) + kWordSize;
+    uword end = reinterpret_cast<uword>(element) + element->Size();
+    released += VirtualMemory::ReleaseMemory(start, end - start);
+    element = element->next();
+  }
+  return released;
+}
+
+
 void FreeList::Free(uword addr, intptr_t size) {
   intptr_t index = IndexForSize(size);
   FreeListElement* element = FreeListElement::AsElement(addr, size);
@@ -71,10 +71,23 @@ class FreeListElement {
 
 class FreeList {
  public:
+  // Free blocks of at least kMinLargeSize bytes are kept in a single list.
+  static const int kNumLists = 128;
+  static const intptr_t kMinLargeSize = kNumLists * kObjectAlignment;
+
   FreeList();
   ~FreeList();
 
   uword TryAllocate(intptr_t size);
+  // Remove the first block of at least kMinLargeSize bytes without searching
+  // the list. Blocks larger than 'max_size' are split and the remainder is
+  // returned to the freelist. Returns 0 if there is no such block, otherwise
+  // the size of the allocated block is returned in 'size'.
+  uword TryAllocateLarge(intptr_t max_size, intptr_t* size);
+
+  // Return the memory of the large blocks to the OS, except for the headers
+  // of the blocks. Returns the number of bytes released.
+  intptr_t ReleaseMemory();
   void Free(uword addr, intptr_t size);
 
   void Reset();
@@ -84,8 +97,6 @@ class FreeList {
   void Print() const;
 
  private:
-  static const int kNumLists = 128;
-
   static intptr_t IndexForSize(intptr_t size);
 
   void EnqueueElement(FreeListElement* element, intptr_t index);
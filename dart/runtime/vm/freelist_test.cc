@@ -50,4 +50,31 @@ TEST_CASE(FreeList) {
   delete free_list;
 }
 
+
+TEST_CASE(FreeListAllocateLarge) {
+  FreeList* free_list = new FreeList();
+  intptr_t kBlobSize = 1 * MB;
+  intptr_t kMaxSize = 32 * KB;
+  intptr_t kMinLargeSize = FreeList::kMinLargeSize;
+  uword blob = reinterpret_cast<uword>(malloc(kBlobSize));
+  intptr_t size = 0;
+  EXPECT(free_list->TryAllocateLarge(kMaxSize, &size) == 0);
+  free_list->Free(blob, kBlobSize);
+  // The large block is split, the remainder stays in the freelist.
+  uword area = free_list->TryAllocateLarge(kMaxSize, &size);
+  EXPECT_EQ(blob, area);
+  EXPECT_EQ(kMaxSize, size);
+  uword large_object = free_list->TryAllocate(kBlobSize - kMaxSize);
+  EXPECT_EQ(blob + kMaxSize, large_object);
+  // Blocks smaller than the maximum size are taken whole.
+  free_list->Free(large_object, kMinLargeSize);
+  area = free_list->TryAllocateLarge(kMaxSize, &size);
+  EXPECT_EQ(large_object, area);
+  EXPECT_EQ(kMinLargeSize, size);
+  EXPECT(free_list->TryAllocateLarge(kMaxSize, &size) == 0);
+  // Delete the memory associated with the test.
+  free(reinterpret_cast<void*>(blob));
+  delete free_list;
+}
+
 }  // namespace dart
@@ -0,0 +1,414 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/gc_compactor.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "platform/utils.h"
+#include "vm/dart_api_state.h"
+#include "vm/gc_sweeper.h"
+#include "vm/heap.h"
+#include "vm/isolate.h"
+#include "vm/pages.h"
+#include "vm/raw_object.h"
+#include "vm/stack_frame.h"
+#include "vm/store_buffer.h"
+#include "vm/visitor.h"
+
+namespace dart {
+
+// The marked objects starting in the same block are moved together to
+// consecutive addresses. A block only records where its first marked object is
+// moved to and which of its allocation units are occupied by marked objects,
+// one bit per unit, which is enough to compute the new address of any of its
+// marked objects.
+class ForwardingBlock {
+ public:
+  static const intptr_t kBlockSizeLog2 = kObjectAlignmentLog2 + kWordSizeLog2 +
+                                         kBitsPerByteLog2;
+  static const intptr_t kBlockSize = 1 << kBlockSizeLog2;
+
+  ForwardingBlock() : new_address_(0), live_bits_(0) {}
+
+  void set_new_address(uword value) { new_address_ = value; }
+
+  // Record the marked object of 'size' bytes starting at allocation unit
+  // 'unit' of this block. Units beyond the end of the block are not recorded,
+  // no other object starts in them.
+  void RecordLive(intptr_t unit, intptr_t size) {
+    intptr_t end_unit = unit + (size >> kObjectAlignmentLog2);
+    uword bits = ~static_cast<uword>(0) << unit;
+    if (end_unit < kBitsPerWord) {
+      bits &= (static_cast<uword>(1) << end_unit) - 1;
+    }
+    live_bits_ |= bits;
+  }
+
+  uword Lookup(intptr_t unit) const {
+    uword preceding_bits = live_bits_ & ((static_cast<uword>(1) << unit) - 1);
+    return new_address_ +
+        (CountOneBits(preceding_bits) << kObjectAlignmentLog2);
+  }
+
+ private:
+  static intptr_t CountOneBits(uword bits) {
+#if defined(ARCH_IS_64_BIT)
+    return Utils::CountOneBits(static_cast<uint32_t>(bits)) +
+        Utils::CountOneBits(static_cast<uint32_t>(bits >> 32));
+#else
+    return Utils::CountOneBits(bits);
+#endif
+  }
+
+  uword new_address_;
+  uword live_bits_;
+
+  DISALLOW_COPY_AND_ASSIGN(ForwardingBlock);
+};
+
+
+// The forwarding information of a compacted page.
+class ForwardingPage {
+ public:
+  explicit ForwardingPage(HeapPage* page)
+      : page_(page), new_top_(page->first_object_start()) {}
+
+  HeapPage* page() const { return page_; }
+
+  // The end of the objects moved into this page.
+  uword new_top() const { return new_top_; }
+  void set_new_top(uword value) { new_top_ = value; }
+
+  ForwardingBlock* BlockFor(uword addr) {
+    return &blocks_[(addr - page_->start()) >> ForwardingBlock::kBlockSizeLog2];
+  }
+
+  uword BlockEnd(uword addr) const {
+    return Utils::RoundDown(addr, ForwardingBlock::kBlockSize) +
+        ForwardingBlock::kBlockSize;
+  }
+
+  static intptr_t UnitFor(uword addr) {
+    return (addr >> kObjectAlignmentLog2) & (kBitsPerWord - 1);
+  }
+
+  uword Lookup(uword addr) {
+    return BlockFor(addr)->Lookup(UnitFor(addr));
+  }
+
+  static bool CompareStart(ForwardingPage* a, ForwardingPage* b) {
+    return a->page()->start() < b->page()->start();
+  }
+
+ private:
+  static const intptr_t kNumBlocks =
+      PageSpace::kPageSize / ForwardingBlock::kBlockSize;
+
+  HeapPage* page_;
+  uword new_top_;
+  ForwardingBlock blocks_[kNumBlocks];
+
+  DISALLOW_COPY_AND_ASSIGN(ForwardingPage);
+};
+
+
+class CompactorPointerVisitor : public ObjectPointerVisitor {
+ public:
+  CompactorPointerVisitor(Isolate* isolate, GCCompactor* compactor)
+      : ObjectPointerVisitor(isolate),
+        compactor_(compactor),
+        object_delta_(0),
+        record_new_pointers_(false),
+        new_pointers_() {}
+
+  // The slots of an old object holding new objects are recorded at the
+  // address they are moved to, i.e. offset by 'delta'.
+  void set_old_object(intptr_t delta) {
+    object_delta_ = delta;
+    record_new_pointers_ = true;
+  }
+  void clear_old_object() {
+    object_delta_ = 0;
+    record_new_pointers_ = false;
+  }
+
+  const std::vector<uword>& new_pointers() const { return new_pointers_; }
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      RawObject* raw_obj = *current;
+      if (!raw_obj->IsHeapObject()) {
+        continue;
+      }
+      if (raw_obj->IsNewObject()) {
+        if (record_new_pointers_) {
+          new_pointers_.push_back(
+              reinterpret_cast<uword>(current) + object_delta_);
+        }
+      } else {
+        RawObject* new_obj = compactor_->Forward(raw_obj);
+        if (new_obj != raw_obj) {
+          *current = new_obj;
+        }
+      }
+    }
+  }
+
+ private:
+  GCCompactor* compactor_;
+  intptr_t object_delta_;
+  bool record_new_pointers_;
+  std::vector<uword> new_pointers_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompactorPointerVisitor);
+};
+
+
+class CompactorWeakVisitor : public HandleVisitor {
+ public:
+  explicit CompactorWeakVisitor(ObjectPointerVisitor* visitor)
+      : visitor_(visitor) {
+  }
+
+  void VisitHandle(uword addr) {
+    FinalizablePersistentHandle* handle =
+        reinterpret_cast<FinalizablePersistentHandle*>(addr);
+    visitor_->VisitPointer(handle->raw_addr());
+  }
+
+ private:
+  ObjectPointerVisitor* visitor_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompactorWeakVisitor);
+};
+
+
+GCCompactor::GCCompactor(Heap* heap, Isolate* isolate)
+    : heap_(heap),
+      isolate_(isolate),
+      pages_(),
+      sorted_pages_(),
+      swept_pages_(),
+      destination_index_(0),
+      destination_top_(0),
+      store_buffer_pointers_() {
+}
+
+
+GCCompactor::~GCCompactor() {
+  for (size_t i = 0; i < pages_.size(); i++) {
+    delete pages_[i];
+  }
+}
+
+
+ForwardingPage* GCCompactor::FindPage(uword addr) const {
+  uword page_start = addr & ~(PageSpace::kPageAlignment - 1);
+  intptr_t low = 0;
+  intptr_t high = sorted_pages_.size() - 1;
+  while (low <= high) {
+    intptr_t mid = low + ((high - low) / 2);
+    uword mid_start = sorted_pages_[mid]->page()->start();
+    if (mid_start == page_start) {
+      return sorted_pages_[mid];
+    } else if (mid_start < page_start) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return NULL;
+}
+
+
+RawObject* GCCompactor::Forward(RawObject* raw_obj) const {
+  uword addr = RawObject::ToAddr(raw_obj);
+  ForwardingPage* page = FindPage(addr);
+  if ((page == NULL) || !raw_obj->IsMarked()) {
+    return raw_obj;
+  }
+  return RawObject::FromAddr(page->Lookup(addr));
+}
+
+
+bool GCCompactor::ContainsClass(HeapPage* page) {
+  uword current = page->first_object_start();
+  uword top = page->top();
+  while (current < top) {
+    RawObject* raw_obj = RawObject::FromAddr(current);
+    if (raw_obj->IsMarked() && (raw_obj->GetClassId() == kClassCid)) {
+      return true;
+    }
+    current += raw_obj->Size();
+  }
+  return false;
+}
+
+
+void GCCompactor::PlanPage(ForwardingPage* page) {
+  uword current = page->page()->first_object_start();
+  uword top = page->page()->top();
+  while (current < top) {
+    ForwardingBlock* block = page->BlockFor(current);
+    uword block_end = page->BlockEnd(current);
+    intptr_t live_size = 0;
+    while ((current < block_end) && (current < top)) {
+      RawObject* raw_obj = RawObject::FromAddr(current);
+      intptr_t size = raw_obj->Size();
+      if (raw_obj->IsMarked()) {
+        block->RecordLive(ForwardingPage::UnitFor(current), size);
+        live_size += size;
+      }
+      current += size;
+    }
+    if (live_size == 0) {
+      continue;
+    }
+    ForwardingPage* destination = pages_[destination_index_];
+    if ((destination_top_ + live_size) > destination->page()->end()) {
+      // Continue in the next page. The objects of a block always fit into the
+      // remainder of their own page, so the destination never passes them.
+      ASSERT(destination != page);
+      destination->set_new_top(destination_top_);
+      destination_index_++;
+      destination = pages_[destination_index_];
+      destination_top_ = destination->page()->first_object_start();
+    }
+    block->set_new_address(destination_top_);
+    destination_top_ += live_size;
+  }
+}
+
+
+void GCCompactor::UpdatePointers(HeapPage* large_pages) {
+  CompactorPointerVisitor visitor(isolate_, this);
+  // The stack frames are walked using the code objects they refer to, the
+  // roots are visited while the heap has not been changed yet. Every root
+  // must be visited exactly once: An updated pointer may point to the old
+  // location of another marked object.
+  isolate_->VisitObjectPointers(&visitor,
+                                true,
+                                StackFrameIterator::kDontValidateFrames);
+  CompactorWeakVisitor weak_visitor(&visitor);
+  isolate_->VisitWeakPersistentHandles(&weak_visitor, false);
+  heap_->IterateNewPointers(&visitor);
+  heap_->IterateCodePointers(&visitor);
+
+  for (size_t i = 0; i < pages_.size(); i++) {
+    HeapPage* page = pages_[i]->page();
+    uword current = page->first_object_start();
+    uword top = page->top();
+    while (current < top) {
+      RawObject* raw_obj = RawObject::FromAddr(current);
+      if (raw_obj->IsMarked()) {
+        visitor.set_old_object(RawObject::ToAddr(Forward(raw_obj)) - current);
+        current += raw_obj->VisitPointers(&visitor);
+      } else {
+        current += raw_obj->Size();
+      }
+    }
+  }
+  for (size_t i = 0; i < swept_pages_.size(); i++) {
+    HeapPage* page = swept_pages_[i];
+    uword current = page->first_object_start();
+    uword top = page->top();
+    while (current < top) {
+      RawObject* raw_obj = RawObject::FromAddr(current);
+      if (raw_obj->IsMarked()) {
+        visitor.set_old_object(0);
+        current += raw_obj->VisitPointers(&visitor);
+      } else {
+        current += raw_obj->Size();
+      }
+    }
+  }
+  for (HeapPage* page = large_pages; page != NULL; page = page->next()) {
+    visitor.set_old_object(0);
+    page->VisitObjectPointers(&visitor);
+  }
+  store_buffer_pointers_ = visitor.new_pointers();
+}
+
+
+void GCCompactor::MovePage(ForwardingPage* page) {
+  uword current = page->page()->first_object_start();
+  uword top = page->page()->top();
+  while (current < top) {
+    RawObject* raw_obj = RawObject::FromAddr(current);
+    // The objects before this one have only been moved to lower addresses.
+    intptr_t size = raw_obj->Size();
+    if (raw_obj->IsMarked()) {
+      raw_obj->ClearMarkBit();
+      uword new_addr = page->Lookup(current);
+      if (new_addr != current) {
+        memmove(reinterpret_cast<void*>(new_addr),
+                reinterpret_cast<void*>(current),
+                size);
+      }
+    }
+    current += size;
+  }
+}
+
+
+intptr_t GCCompactor::CompactPages(HeapPage* pages,
+                                   HeapPage* large_pages,
+                                   FreeList* freelist) {
+  for (HeapPage* page = pages; page != NULL; page = page->next()) {
+    if (ContainsClass(page)) {
+      swept_pages_.push_back(page);
+    } else {
+      pages_.push_back(new ForwardingPage(page));
+    }
+  }
+  sorted_pages_ = pages_;
+  std::sort(sorted_pages_.begin(), sorted_pages_.end(),
+            ForwardingPage::CompareStart);
+
+  if (!pages_.empty()) {
+    destination_index_ = 0;
+    destination_top_ = pages_[0]->page()->first_object_start();
+    for (size_t i = 0; i < pages_.size(); i++) {
+      PlanPage(pages_[i]);
+    }
+    pages_[destination_index_]->set_new_top(destination_top_);
+  }
+
+  UpdatePointers(large_pages);
+
+  // Objects only move towards the beginning of the page list, moving them in
+  // list order never overwrites an object which has not been moved yet.
+  intptr_t in_use = 0;
+  for (size_t i = 0; i < pages_.size(); i++) {
+    MovePage(pages_[i]);
+  }
+  for (size_t i = 0; i < pages_.size(); i++) {
+    HeapPage* page = pages_[i]->page();
+    page->set_top(pages_[i]->new_top());
+    intptr_t page_in_use = page->top() - page->first_object_start();
+    page->set_used(page_in_use);
+    in_use += page_in_use;
+  }
+  GCSweeper sweeper(heap_);
+  for (size_t i = 0; i < swept_pages_.size(); i++) {
+    HeapPage* page = swept_pages_[i];
+    intptr_t page_in_use = sweeper.SweepPage(page, freelist);
+    page->set_used(page_in_use);
+    in_use += page_in_use;
+  }
+
+  // Rebuild the store buffers, the slots recorded in them have moved.
+  StoreBuffer* store_buffer = isolate_->store_buffer();
+  store_buffer->Reset();
+  isolate_->store_buffer_block()->Reset();
+  for (size_t i = 0; i < store_buffer_pointers_.size(); i++) {
+    store_buffer->AddPointer(store_buffer_pointers_[i]);
+  }
+  return in_use;
+}
+
+}  // namespace dart
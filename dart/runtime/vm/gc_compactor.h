@@ -0,0 +1,89 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_GC_COMPACTOR_H_
+#define VM_GC_COMPACTOR_H_
+
+#include <vector>
+
+#include "vm/globals.h"
+
+namespace dart {
+
+// Forward declarations.
+class ForwardingPage;
+class FreeList;
+class Heap;
+class HeapPage;
+class Isolate;
+class RawObject;
+
+// The class GCCompactor is used after marking to slide the marked objects of
+// the old generation pages towards the beginning of the page list, in place of
+// sweeping the pages. Objects keep their relative order. All pointers to the
+// moved objects are updated and the store buffer is rebuilt, so that the pages
+// emptied at the end of the list can be released.
+//
+// The class table is used to find the size and the pointers of objects while
+// they are moved, so pages containing classes are swept instead of compacted.
+class GCCompactor {
+ public:
+  GCCompactor(Heap* heap, Isolate* isolate);
+  ~GCCompactor();
+
+  // Compact the marked objects of the list of pages while clearing their mark
+  // bits. The top of every compacted page is set to the end of the objects
+  // moved into it, the rest of the page is left for bump allocation. Pages
+  // which are not compacted are swept into the freelist. The used size of all
+  // pages is set to the size of their marked objects, pages which end up
+  // without any objects have a used size of zero.
+  // The objects of the large pages, which must already have been swept, are
+  // not moved but their pointers are updated.
+  // Returns the size of memory used by the marked objects.
+  intptr_t CompactPages(HeapPage* pages,
+                        HeapPage* large_pages,
+                        FreeList* freelist);
+
+  // Returns the object 'raw_obj' is moved to, or 'raw_obj' itself if it is not
+  // a marked object of the compacted pages.
+  RawObject* Forward(RawObject* raw_obj) const;
+
+ private:
+  // Returns true if the page contains a marked class.
+  static bool ContainsClass(HeapPage* page);
+
+  // Assign the new addresses of the marked objects.
+  void PlanPage(ForwardingPage* page);
+  // Update the pointers in the roots and in the live objects.
+  void UpdatePointers(HeapPage* large_pages);
+  // Move the marked objects to their new addresses.
+  void MovePage(ForwardingPage* page);
+
+  ForwardingPage* FindPage(uword addr) const;
+
+  Heap* heap_;
+  Isolate* isolate_;
+
+  // The compacted pages in the order of the page list, which is the order
+  // objects are moved in, and sorted by address for lookups.
+  std::vector<ForwardingPage*> pages_;
+  std::vector<ForwardingPage*> sorted_pages_;
+
+  // The pages which are swept instead of compacted.
+  std::vector<HeapPage*> swept_pages_;
+
+  // The destination of the next block of moved objects.
+  intptr_t destination_index_;
+  uword destination_top_;
+
+  // The slots of the live old objects which contain new objects, at the
+  // address they are moved to.
+  std::vector<uword> store_buffer_pointers_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(GCCompactor);
+};
+
+}  // namespace dart
+
+#endif  // VM_GC_COMPACTOR_H_
@@ -0,0 +1,187 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/gc_events.h"
+
+#include "platform/assert.h"
+#include "platform/json.h"
+#include "vm/dart.h"
+#include "vm/isolate.h"
+#include "vm/os.h"
+#include "vm/thread.h"
+
+namespace dart {
+
+// The log is shared by all isolates, the mutex keeps their lines apart.
+static Mutex* log_mutex = NULL;
+
+static const char* kTypeNames[] = {
+  "Scavenge",
+  "MarkSweep",
+  "MarkingStep",
+};
+
+static const char* kPhaseNames[Dart_GcEvent::kNumPhases] = {
+  "roots",
+  "store_buffer",
+  "scavenge_copy",
+  "mark",
+  "weak_processing",
+  "sweep",
+  "compact",
+};
+
+static const char* kSpaceNames[Dart_GcEvent::kNumSpaces] = {
+  "new",
+  "old",
+  "code",
+};
+
+
+GCEventRecorder::GCEventRecorder() : num_events_(0), current_(NULL) {
+  memset(events_, 0, sizeof(events_));
+}
+
+
+void GCEventRecorder::InitOnce() {
+  ASSERT(log_mutex == NULL);
+  log_mutex = new Mutex();
+}
+
+
+intptr_t GCEventRecorder::GetEvents(Dart_GcEvent* events,
+                                    intptr_t length) const {
+  ASSERT(length >= 0);
+  int64_t first = num_events_ - Utils::Minimum<int64_t>(length, kNumEvents);
+  if (first < 0) {
+    first = 0;
+  }
+  intptr_t count = 0;
+  for (int64_t id = first; id < num_events_; id++) {
+    events[count++] = events_[id % kNumEvents];
+  }
+  return count;
+}
+
+
+void GCEventRecorder::AddEvent(const Dart_GcEvent& event) {
+  ASSERT(event.id == num_events_);
+  events_[num_events_ % kNumEvents] = event;
+  num_events_++;
+}
+
+
+// Isolate names are derived from script URIs, which may contain characters
+// that need to be escaped in JSON strings.
+static void AddJSONString(TextBuffer* buffer, const char* str) {
+  buffer->AddChar('"');
+  for (const char* c = str; *c != '\0'; c++) {
+    if ((*c == '"') || (*c == '\\')) {
+      buffer->AddChar('\\');
+      buffer->AddChar(*c);
+    } else if (static_cast<unsigned char>(*c) < 0x20) {
+      buffer->Printf("\\u%04x", *c);
+    } else {
+      buffer->AddChar(*c);
+    }
+  }
+  buffer->AddChar('"');
+}
+
+
+void GCEventRecorder::LogEvent(Isolate* isolate, const Dart_GcEvent& event) {
+  Dart_FileWriterFunction writer = Dart::gc_events_writer();
+  if (writer == NULL) {
+    return;
+  }
+  TextBuffer buffer(512);
+  buffer.Printf("{\"isolate\":");
+  AddJSONString(&buffer, (isolate->name() != NULL) ? isolate->name() : "");
+  buffer.Printf(",\"id\":%"Pd64",\"type\":\"%s\",\"reason\":\"%s\","
+                "\"start_micros\":%"Pd64",\"duration_micros\":%"Pd64","
+                "\"phase_micros\":{",
+                event.id,
+                kTypeNames[event.type],
+                event.reason,
+                event.start_micros,
+                event.duration_micros);
+  for (intptr_t i = 0; i < Dart_GcEvent::kNumPhases; i++) {
+    buffer.Printf("%s\"%s\":%"Pd64,
+                  (i == 0) ? "" : ",", kPhaseNames[i], event.phase_micros[i]);
+  }
+  buffer.Printf("}");
+  for (intptr_t i = 0; i < Dart_GcEvent::kNumSpaces; i++) {
+    buffer.Printf(",\"%s\":{\"used_before\":%"Pd",\"used_after\":%"Pd","
+                  "\"capacity_after\":%"Pd"}",
+                  kSpaceNames[i],
+                  event.used_before[i],
+                  event.used_after[i],
+                  event.capacity_after[i]);
+  }
+  buffer.Printf(",\"promoted\":%"Pd"}\n", event.promoted);
+  MutexLocker ml(log_mutex);
+  (*writer)(buffer.buf(), buffer.length());
+}
+
+
+GCEventScope::GCEventScope(Heap* heap,
+                           Dart_GcEvent::Type type,
+                           Heap::GCReason reason)
+    : heap_(heap), previous_(heap->gc_events()->current_) {
+  memset(&event_, 0, sizeof(event_));
+  event_.type = type;
+  event_.reason = Heap::GCReasonToString(reason);
+  event_.start_micros = OS::GetCurrentTimeMicros();
+  intptr_t capacity[Dart_GcEvent::kNumSpaces];
+  MeasureSpaces(event_.used_before, capacity);
+  heap->gc_events()->current_ = &event_;
+}
+
+
+GCEventScope::~GCEventScope() {
+  GCEventRecorder* recorder = heap_->gc_events();
+  ASSERT(recorder->current_ == &event_);
+  recorder->current_ = previous_;
+  event_.duration_micros = OS::GetCurrentTimeMicros() - event_.start_micros;
+  MeasureSpaces(event_.used_after, event_.capacity_after);
+  if (event_.type == Dart_GcEvent::kScavenge) {
+    event_.promoted = heap_->PromotedInWords() * kWordSize;
+  }
+  // Nested events are numbered in the order they complete.
+  event_.id = recorder->num_events();
+  recorder->AddEvent(event_);
+  GCEventRecorder::LogEvent(Isolate::Current(), event_);
+}
+
+
+void GCEventScope::MeasureSpaces(intptr_t* used, intptr_t* capacity) const {
+  used[Dart_GcEvent::kNewSpace] = heap_->UsedInWords(Heap::kNew) * kWordSize;
+  used[Dart_GcEvent::kOldSpace] = heap_->UsedInWords(Heap::kOld) * kWordSize;
+  used[Dart_GcEvent::kCodeSpace] = heap_->UsedInWords(Heap::kCode) * kWordSize;
+  capacity[Dart_GcEvent::kNewSpace] =
+      heap_->CapacityInWords(Heap::kNew) * kWordSize;
+  capacity[Dart_GcEvent::kOldSpace] =
+      heap_->CapacityInWords(Heap::kOld) * kWordSize;
+  capacity[Dart_GcEvent::kCodeSpace] =
+      heap_->CapacityInWords(Heap::kCode) * kWordSize;
+}
+
+
+GCPhaseScope::GCPhaseScope(Heap* heap, Dart_GcEvent::Phase phase)
+    : event_(heap->gc_events()->current()),
+      phase_(phase),
+      start_(0) {
+  if (event_ != NULL) {
+    start_ = OS::GetCurrentTimeMicros();
+  }
+}
+
+
+GCPhaseScope::~GCPhaseScope() {
+  if (event_ != NULL) {
+    event_->phase_micros[phase_] += OS::GetCurrentTimeMicros() - start_;
+  }
+}
+
+}  // namespace dart
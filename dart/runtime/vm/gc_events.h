@@ -0,0 +1,91 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_GC_EVENTS_H_
+#define VM_GC_EVENTS_H_
+
+#include "include/dart_api.h"
+#include "vm/allocation.h"
+#include "vm/globals.h"
+#include "vm/heap.h"
+
+namespace dart {
+
+// Forward declarations.
+class Isolate;
+
+// The GCEventRecorder keeps the most recent garbage collection events of a
+// heap in a ring buffer. Each event describes a single pause, it is opened by
+// a GCEventScope and the GCPhaseScopes entered meanwhile add up the time spent
+// in the phases of the collection. If the embedder registered a writer with
+// Dart_InitGcEventsLogging, the events are also written as lines of JSON.
+class GCEventRecorder {
+ public:
+  static const intptr_t kNumEvents = 64;
+
+  GCEventRecorder();
+  ~GCEventRecorder() {}
+
+  static void InitOnce();
+
+  // The event being recorded, NULL outside of a collection.
+  Dart_GcEvent* current() const { return current_; }
+
+  // The number of events recorded so far, including those which have been
+  // overwritten in the ring buffer since.
+  int64_t num_events() const { return num_events_; }
+
+  // Copies the last 'length' events, or less if not as many are kept, oldest
+  // first. Returns the number of events copied.
+  intptr_t GetEvents(Dart_GcEvent* events, intptr_t length) const;
+
+ private:
+  void AddEvent(const Dart_GcEvent& event);
+  static void LogEvent(Isolate* isolate, const Dart_GcEvent& event);
+
+  Dart_GcEvent events_[kNumEvents];
+  int64_t num_events_;
+  Dart_GcEvent* current_;
+
+  friend class GCEventScope;
+  DISALLOW_COPY_AND_ASSIGN(GCEventRecorder);
+};
+
+
+// Records a collection of the heap as an event, from construction to
+// destruction of the scope.
+class GCEventScope : public ValueObject {
+ public:
+  GCEventScope(Heap* heap, Dart_GcEvent::Type type, Heap::GCReason reason);
+  ~GCEventScope();
+
+ private:
+  void MeasureSpaces(intptr_t* used, intptr_t* capacity) const;
+
+  Heap* heap_;
+  Dart_GcEvent event_;
+  // The event of the enclosing scope, if collections are nested.
+  Dart_GcEvent* previous_;
+
+  DISALLOW_COPY_AND_ASSIGN(GCEventScope);
+};
+
+
+// Adds the time spent in the scope to a phase of the event being recorded.
+class GCPhaseScope : public ValueObject {
+ public:
+  GCPhaseScope(Heap* heap, Dart_GcEvent::Phase phase);
+  ~GCPhaseScope();
+
+ private:
+  Dart_GcEvent* event_;
+  Dart_GcEvent::Phase phase_;
+  int64_t start_;
+
+  DISALLOW_COPY_AND_ASSIGN(GCPhaseScope);
+};
+
+}  // namespace dart
+
+#endif  // VM_GC_EVENTS_H_
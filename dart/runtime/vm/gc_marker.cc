@@ -6,116 +6,30 @@
 
 #include <map>
 #include <utility>
+#include <vector>
 
 #include "vm/allocation.h"
+#include "vm/atomic.h"
+#include "vm/dart.h"
 #include "vm/dart_api_state.h"
+#include "vm/gc_events.h"
+#include "vm/heap.h"
 #include "vm/isolate.h"
+#include "vm/marking_stack.h"
+#include "vm/os.h"
 #include "vm/pages.h"
 #include "vm/raw_object.h"
 #include "vm/stack_frame.h"
+#include "vm/store_buffer.h"
+#include "vm/thread.h"
+#include "vm/thread_pool.h"
 #include "vm/visitor.h"
 
 namespace dart {
 
-// A simple chunked marking stack.
-class MarkingStack : public ValueObject {
- public:
-  MarkingStack()
-      : head_(new MarkingStackChunk()),
-        empty_chunks_(NULL),
-        marking_stack_(NULL),
-        top_(0) {
-    marking_stack_ = head_->MarkingStackChunkMemory();
-  }
-
-  ~MarkingStack() {
-    // TODO(iposva): Consider caching a couple emtpy marking stack chunks.
-    ASSERT(IsEmpty());
-    delete head_;
-    MarkingStackChunk* next;
-    while (empty_chunks_ != NULL) {
-      next = empty_chunks_->next();
-      delete empty_chunks_;
-      empty_chunks_ = next;
-    }
-  }
-
-  bool IsEmpty() const {
-    return IsMarkingStackChunkEmpty() && (head_->next() == NULL);
-  }
-
-  void Push(RawObject* value) {
-    ASSERT(!IsMarkingStackChunkFull());
-    marking_stack_[top_] = value;
-    top_++;
-    if (IsMarkingStackChunkFull()) {
-      MarkingStackChunk* new_chunk;
-      if (empty_chunks_ == NULL) {
-        new_chunk = new MarkingStackChunk();
-      } else {
-        new_chunk = empty_chunks_;
-        empty_chunks_ = new_chunk->next();
-      }
-      new_chunk->set_next(head_);
-      head_ = new_chunk;
-      marking_stack_ = head_->MarkingStackChunkMemory();
-      top_ = 0;
-    }
-  }
-
-  RawObject* Pop() {
-    ASSERT(head_ != NULL);
-    ASSERT(!IsEmpty());
-    if (IsMarkingStackChunkEmpty()) {
-      MarkingStackChunk* empty_chunk = head_;
-      head_ = head_->next();
-      empty_chunk->set_next(empty_chunks_);
-      empty_chunks_ = empty_chunk;
-      marking_stack_ = head_->MarkingStackChunkMemory();
-      top_ = MarkingStackChunk::kMarkingStackChunkSize;
-    }
-    top_--;
-    return marking_stack_[top_];
-  }
-
- private:
-  class MarkingStackChunk {
-   public:
-    MarkingStackChunk() : next_(NULL) {}
-    ~MarkingStackChunk() {}
-
-    RawObject** MarkingStackChunkMemory() {
-      return &memory_[0];
-    }
-
-    MarkingStackChunk* next() const { return next_; }
-    void set_next(MarkingStackChunk* value) { next_ = value; }
-
-    static const uint32_t kMarkingStackChunkSize = 1024;
-
-   private:
-    RawObject* memory_[kMarkingStackChunkSize];
-    MarkingStackChunk* next_;
-
-    DISALLOW_COPY_AND_ASSIGN(MarkingStackChunk);
-  };
-
-  bool IsMarkingStackChunkFull() const {
-    return top_ == MarkingStackChunk::kMarkingStackChunkSize;
-  }
-
-  bool IsMarkingStackChunkEmpty() const {
-    return top_ == 0;
-  }
-
-  MarkingStackChunk* head_;
-  MarkingStackChunk* empty_chunks_;
-  RawObject** marking_stack_;
-  uint32_t top_;
-
-  DISALLOW_COPY_AND_ASSIGN(MarkingStack);
-};
-
+DEFINE_FLAG(int, marker_tasks, 0,
+            "The number of tasks to spawn during old gen GC marking "
+            "(0 means perform all marking on the mutator thread).");
 
 class MarkingVisitor : public ObjectPointerVisitor {
  public:
@@ -128,7 +42,8 @@ class MarkingVisitor : public ObjectPointerVisitor {
         vm_heap_(Dart::vm_isolate()->heap()),
         page_space_(page_space),
         marking_stack_(marking_stack),
-        update_store_buffers_(false) {
+        update_store_buffers_(false),
+        is_parallel_(false) {
     ASSERT(heap_ != vm_heap_);
   }
 
@@ -141,6 +56,7 @@ class MarkingVisitor : public ObjectPointerVisitor {
   }
 
   void DelayWeakProperty(RawWeakProperty* raw_weak) {
+    ASSERT(!is_parallel_);
     RawObject* raw_key = raw_weak->ptr()->key_;
     DelaySet::iterator it = delay_set_.find(raw_key);
     if (it != delay_set_.end()) {
@@ -161,6 +77,25 @@ class MarkingVisitor : public ObjectPointerVisitor {
 
   void set_update_store_buffers(bool val) { update_store_buffers_ = val; }
 
+  // A parallel marking visitor may run on a thread other than the isolate's
+  // own. It claims objects with an atomic update of the mark bit, and defers
+  // the work which requires the isolate (store buffer updates and weak
+  // property processing) until all marking tasks have finished.
+  void set_is_parallel(bool val) { is_parallel_ = val; }
+
+  void DeferWeakProperty(RawWeakProperty* raw_weak) {
+    ASSERT(is_parallel_);
+    deferred_weak_properties_.push_back(raw_weak);
+  }
+
+  const std::vector<RawWeakProperty*>& deferred_weak_properties() const {
+    return deferred_weak_properties_;
+  }
+
+  const std::vector<uword>& deferred_store_buffer_pointers() const {
+    return deferred_store_buffer_pointers_;
+  }
+
  private:
   void MarkAndPush(RawObject* raw_obj) {
     ASSERT(raw_obj->IsHeapObject());
@@ -168,9 +103,21 @@ class MarkingVisitor : public ObjectPointerVisitor {
            page_space_->Contains(RawObject::ToAddr(raw_obj)) :
            true);
 
+    RawClass* raw_class = isolate()->class_table()->At(raw_obj->GetClassId());
+    if (is_parallel_) {
+      // Another marking task may have claimed the object in the meantime.
+      // The used bytes are accounted for when the object is visited.
+      if (!raw_obj->TryAcquireMarkBit()) {
+        return;
+      }
+      ASSERT(!raw_obj->IsWatched());
+      marking_stack_->Push(raw_obj);
+      MarkObject(raw_class, NULL);
+      return;
+    }
+
     // Mark the object and push it on the marking stack.
     ASSERT(!raw_obj->IsMarked());
-    RawClass* raw_class = isolate()->class_table()->At(raw_obj->GetClassId());
     raw_obj->SetMarkBit();
     if (raw_obj->IsWatched()) {
       std::pair<DelaySet::iterator, DelaySet::iterator> ret;
@@ -204,7 +151,11 @@ class MarkingVisitor : public ObjectPointerVisitor {
       // TODO(iposva): Add consistency check.
       if (update_store_buffers_) {
         ASSERT(p != NULL);
-        isolate()->store_buffer()->AddPointer(reinterpret_cast<uword>(p));
+        if (is_parallel_) {
+          deferred_store_buffer_pointers_.push_back(reinterpret_cast<uword>(p));
+        } else {
+          isolate()->store_buffer()->AddPointer(reinterpret_cast<uword>(p));
+        }
       }
       return;
     }
@@ -220,6 +171,9 @@ class MarkingVisitor : public ObjectPointerVisitor {
   typedef std::multimap<RawObject*, RawWeakProperty*> DelaySet;
   DelaySet delay_set_;
   bool update_store_buffers_;
+  bool is_parallel_;
+  std::vector<RawWeakProperty*> deferred_weak_properties_;
+  std::vector<uword> deferred_store_buffer_pointers_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(MarkingVisitor);
 };
@@ -258,6 +212,207 @@ class MarkingWeakVisitor : public HandleVisitor {
 };
 
 
+class ParallelMarker;
+
+
+class MarkTask : public ThreadPool::Task {
+ public:
+  MarkTask(ParallelMarker* marker, intptr_t task_index)
+      : marker_(marker), task_index_(task_index) {
+    ASSERT(marker != NULL);
+  }
+
+  void Run();
+
+ private:
+  ParallelMarker* marker_;
+  intptr_t task_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkTask);
+};
+
+
+// The ParallelMarker distributes root scanning and the draining of the marking
+// stacks over a number of marking tasks. Task 0 runs on the mutator thread
+// and is the only task visiting the isolate roots, the remaining tasks run on
+// the VM thread pool. Each task owns a marking stack and shares full chunks of
+// it; a task which runs out of work steals shared chunks from the others.
+class ParallelMarker : public ValueObject {
+ public:
+  ParallelMarker(Isolate* isolate,
+                 Heap* heap,
+                 PageSpace* page_space,
+                 intptr_t num_tasks)
+      : isolate_(isolate),
+        heap_(heap),
+        num_tasks_(num_tasks),
+        stacks_(new MarkingStack*[num_tasks]),
+        visitors_(new MarkingVisitor*[num_tasks]),
+        next_root_slice_(0),
+        num_idle_(0),
+        num_finished_(0) {
+    ASSERT(num_tasks > 1);
+    for (intptr_t i = 0; i < num_tasks_; i++) {
+      stacks_[i] = new MarkingStack();
+      stacks_[i]->set_share_chunks(true);
+      visitors_[i] = new MarkingVisitor(isolate, heap, page_space, stacks_[i]);
+      visitors_[i]->set_is_parallel(true);
+    }
+  }
+
+  ~ParallelMarker() {
+    for (intptr_t i = 0; i < num_tasks_; i++) {
+      delete visitors_[i];
+      delete stacks_[i];
+    }
+    delete[] visitors_;
+    delete[] stacks_;
+  }
+
+  intptr_t num_tasks() const { return num_tasks_; }
+  MarkingVisitor* visitor_at(intptr_t index) const { return visitors_[index]; }
+
+  // Marks everything reachable from the roots, except for what is reachable
+  // through weak properties. Returns once all tasks have finished.
+  void Run(bool visit_prologue_weak_persistent_handles) {
+    for (intptr_t i = 1; i < num_tasks_; i++) {
+      Dart::thread_pool()->Run(new MarkTask(this, i));
+    }
+    isolate_->VisitObjectPointers(visitors_[0],
+                                  visit_prologue_weak_persistent_handles,
+                                  StackFrameIterator::kDontValidateFrames);
+    RunTask(0);
+    MonitorLocker ml(&monitor_);
+    while (num_finished_ < (num_tasks_ - 1)) {
+      ml.Wait();
+    }
+  }
+
+  void RunTask(intptr_t task_index) {
+    MarkingVisitor* visitor = visitors_[task_index];
+    VisitRootSlices(visitor);
+    visitor->set_update_store_buffers(true);
+    do {
+      DrainMarkingStack(visitor);
+    } while (StealWork(task_index) || WaitForWork(task_index));
+    visitor->set_update_store_buffers(false);
+  }
+
+  void TaskFinished() {
+    MonitorLocker ml(&monitor_);
+    num_finished_++;
+    ml.Notify();
+  }
+
+ private:
+  enum RootSlice {
+    kNewSpaceSlice,
+    kCodeSpaceSlice,
+    kNumRootSlices
+  };
+
+  // The isolate roots can only be visited from the mutator thread, the
+  // remaining roots are handed out to whichever task claims them first.
+  void VisitRootSlices(MarkingVisitor* visitor) {
+    while (true) {
+      intptr_t slice =
+          AtomicOperations::FetchAndIncrementBy(&next_root_slice_, 1);
+      switch (slice) {
+        case kNewSpaceSlice:
+          heap_->IterateNewPointers(visitor);
+          break;
+        case kCodeSpaceSlice:
+          heap_->IterateCodePointers(visitor);
+          break;
+        default:
+          return;
+      }
+    }
+  }
+
+  void DrainMarkingStack(MarkingVisitor* visitor) {
+    MarkingStack* marking_stack = visitor->marking_stack();
+    while (!marking_stack->IsEmpty()) {
+      RawObject* raw_obj = marking_stack->Pop();
+      HeapPage* page = PageSpace::PageFor(raw_obj);
+      if (raw_obj->GetClassId() != kWeakPropertyCid) {
+        page->AtomicAddUsed(raw_obj->VisitPointers(visitor));
+      } else {
+        // Weak properties are processed by the mutator once all tasks are
+        // done.
+        visitor->DeferWeakProperty(reinterpret_cast<RawWeakProperty*>(raw_obj));
+        page->AtomicAddUsed(
+            raw_obj->SizeFromTags(isolate_, raw_obj->ptr()->tags_));
+      }
+    }
+  }
+
+  // Takes a shared chunk, preferably one published by the task itself.
+  bool StealWork(intptr_t task_index) {
+    MarkingStack* marking_stack = stacks_[task_index];
+    for (intptr_t i = 0; i < num_tasks_; i++) {
+      intptr_t victim = (task_index + i) % num_tasks_;
+      if (marking_stack->StealFrom(stacks_[victim])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool HasSharedWork() {
+    for (intptr_t i = 0; i < num_tasks_; i++) {
+      if (stacks_[i]->HasSharedChunks()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Waits until either another task shares work, in which case true is
+  // returned, or all tasks are out of work and marking is complete.
+  // A task only becomes idle after it has taken back all of its own shared
+  // chunks, so once every task is idle no shared work can remain.
+  bool WaitForWork(intptr_t task_index) {
+    MonitorLocker ml(&monitor_);
+    num_idle_++;
+    while (true) {
+      if (num_idle_ == num_tasks_) {
+        ml.NotifyAll();
+        return false;
+      }
+      if (HasSharedWork()) {
+        num_idle_--;
+        return true;
+      }
+      ml.Wait(kIdleWaitMillis);
+    }
+  }
+
+  static const int64_t kIdleWaitMillis = 1;
+
+  Isolate* isolate_;
+  Heap* heap_;
+  intptr_t num_tasks_;
+  MarkingStack** stacks_;
+  MarkingVisitor** visitors_;
+  intptr_t next_root_slice_;
+
+  // Protects num_idle_ and num_finished_.
+  Monitor monitor_;
+  intptr_t num_idle_;
+  intptr_t num_finished_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelMarker);
+};
+
+
+void MarkTask::Run() {
+  marker_->RunTask(task_index_);
+  // The marker may be deleted as soon as the last task has finished.
+  marker_->TaskFinished();
+}
+
+
 void GCMarker::Prologue(Isolate* isolate, bool invoke_api_callbacks) {
   if (invoke_api_callbacks) {
     isolate->gc_prologue_callbacks().Invoke();
@@ -366,9 +521,12 @@ void GCMarker::DrainMarkingStack(Isolate* isolate,
 
 void GCMarker::ProcessWeakProperty(RawWeakProperty* raw_weak,
                                    MarkingVisitor* visitor) {
-  // The fate of the weak property is determined by its key.
+  // The fate of the weak property is determined by its key. New objects are
+  // not marked, the marker treats all of them as reachable.
   RawObject* raw_key = raw_weak->ptr()->key_;
-  if (!raw_key->IsMarked()) {
+  if (raw_key->IsHeapObject() &&
+      raw_key->IsOldObject() &&
+      !raw_key->IsMarked()) {
     // Key is white.  Delay the weak property.
     visitor->DelayWeakProperty(raw_weak);
   } else {
@@ -378,14 +536,56 @@ void GCMarker::ProcessWeakProperty(RawWeakProperty* raw_weak,
 }
 
 
+void GCMarker::MarkObjectsInParallel(
+    Isolate* isolate,
+    PageSpace* page_space,
+    MarkingVisitor* visitor,
+    bool visit_prologue_weak_persistent_handles) {
+  ParallelMarker parallel_marker(isolate,
+                                 heap_,
+                                 page_space,
+                                 FLAG_marker_tasks + 1);
+  parallel_marker.Run(visit_prologue_weak_persistent_handles);
+
+  // Finish the work the marking tasks left for the mutator thread.
+  StoreBuffer* store_buffer = isolate->store_buffer();
+  visitor->set_update_store_buffers(true);
+  for (intptr_t i = 0; i < parallel_marker.num_tasks(); i++) {
+    MarkingVisitor* task_visitor = parallel_marker.visitor_at(i);
+    const std::vector<uword>& pointers =
+        task_visitor->deferred_store_buffer_pointers();
+    for (size_t j = 0; j < pointers.size(); j++) {
+      store_buffer->AddPointer(pointers[j]);
+    }
+    const std::vector<RawWeakProperty*>& weak_properties =
+        task_visitor->deferred_weak_properties();
+    for (size_t j = 0; j < weak_properties.size(); j++) {
+      ProcessWeakProperty(weak_properties[j], visitor);
+    }
+  }
+  visitor->set_update_store_buffers(false);
+  DrainMarkingStack(isolate, visitor);
+}
+
+
 void GCMarker::MarkObjects(Isolate* isolate,
                            PageSpace* page_space,
                            bool invoke_api_callbacks) {
   MarkingStack marking_stack;
   Prologue(isolate, invoke_api_callbacks);
   MarkingVisitor mark(isolate, heap_, page_space, &marking_stack);
-  IterateRoots(isolate, &mark, !invoke_api_callbacks);
-  DrainMarkingStack(isolate, &mark);
+  if (FLAG_marker_tasks > 0) {
+    GCPhaseScope phase(heap_, Dart_GcEvent::kMark);
+    MarkObjectsInParallel(isolate, page_space, &mark, !invoke_api_callbacks);
+  } else {
+    {
+      GCPhaseScope phase(heap_, Dart_GcEvent::kRoots);
+      IterateRoots(isolate, &mark, !invoke_api_callbacks);
+    }
+    GCPhaseScope phase(heap_, Dart_GcEvent::kMark);
+    DrainMarkingStack(isolate, &mark);
+  }
+  GCPhaseScope phase(heap_, Dart_GcEvent::kWeakProcessing);
   IterateWeakReferences(isolate, &mark);
   MarkingWeakVisitor mark_weak;
   IterateWeakRoots(isolate, &mark_weak, invoke_api_callbacks);
@@ -393,4 +593,112 @@ void GCMarker::MarkObjects(Isolate* isolate,
   Epilogue(isolate, invoke_api_callbacks);
 }
 
+
+IncrementalMarker::IncrementalMarker(Heap* heap, PageSpace* page_space)
+    : marker_(heap),
+      marking_stack_(new MarkingStack()),
+      visitor_(NULL),
+      write_barrier_active_(false),
+      num_steps_(0),
+      step_micros_(0) {
+  visitor_ = new MarkingVisitor(Isolate::Current(),
+                                heap,
+                                page_space,
+                                marking_stack_);
+}
+
+
+IncrementalMarker::~IncrementalMarker() {
+  // Marking is abandoned if the isolate shuts down while it is in progress.
+  while (!marking_stack_->IsEmpty()) {
+    marking_stack_->Pop();
+  }
+  StopWriteBarrier();
+  delete visitor_;
+  delete marking_stack_;
+}
+
+
+void IncrementalMarker::Start(Isolate* isolate) {
+  ASSERT(!write_barrier_active_);
+  Heap::IncrementMarkingIsolates();
+  write_barrier_active_ = true;
+  // Unlike in MarkObjects the store buffers are kept, the scavenges performed
+  // while marking is in progress depend on them. The prologue weak persistent
+  // handles are treated as weak here and visited again in the final pause if
+  // they turn out to be strong.
+  marker_.IterateRoots(isolate, visitor_, false);
+}
+
+
+bool IncrementalMarker::Step(Isolate* isolate, int64_t budget_micros) {
+  ASSERT(write_barrier_active_);
+  int64_t start = OS::GetCurrentTimeMicros();
+  int64_t deadline = start + budget_micros;
+  // Shade the objects recorded by the write barrier since the last step.
+  isolate->store_buffer_block()->ProcessBuffer(isolate);
+  intptr_t visited = 0;
+  while (!marking_stack_->IsEmpty()) {
+    RawObject* raw_obj = marking_stack_->Pop();
+    if (raw_obj->GetClassId() != kWeakPropertyCid) {
+      raw_obj->VisitPointers(visitor_);
+    } else {
+      RawWeakProperty* raw_weak = reinterpret_cast<RawWeakProperty*>(raw_obj);
+      marker_.ProcessWeakProperty(raw_weak, visitor_);
+    }
+    visited++;
+    if (((visited % kObjectsPerTimeCheck) == 0) &&
+        (OS::GetCurrentTimeMicros() >= deadline)) {
+      break;
+    }
+  }
+  num_steps_++;
+  step_micros_ += OS::GetCurrentTimeMicros() - start;
+  return marking_stack_->IsEmpty();
+}
+
+
+void IncrementalMarker::ShadeObject(RawObject* raw_obj) {
+  ASSERT(write_barrier_active_);
+  ASSERT(raw_obj->IsHeapObject() && raw_obj->IsOldObject());
+  visitor_->VisitPointer(&raw_obj);
+}
+
+
+void IncrementalMarker::Finish(Isolate* isolate, bool invoke_api_callbacks) {
+  if (invoke_api_callbacks) {
+    isolate->gc_prologue_callbacks().Invoke();
+  }
+  // Objects allocated during marking were not marked and may only be
+  // reachable from the roots. Shade the objects recorded by the write barrier
+  // and rescan the roots to find them.
+  Heap* heap = isolate->heap();
+  {
+    GCPhaseScope phase(heap, Dart_GcEvent::kRoots);
+    isolate->store_buffer_block()->ProcessBuffer(isolate);
+    marker_.IterateRoots(isolate, visitor_, !invoke_api_callbacks);
+  }
+  {
+    GCPhaseScope phase(heap, Dart_GcEvent::kMark);
+    marker_.DrainMarkingStack(isolate, visitor_);
+  }
+  GCPhaseScope phase(heap, Dart_GcEvent::kWeakProcessing);
+  marker_.IterateWeakReferences(isolate, visitor_);
+  // Marking is complete, the stores performed by finalizers and callbacks
+  // from here on do not need to be recorded anymore.
+  StopWriteBarrier();
+  MarkingWeakVisitor mark_weak;
+  marker_.IterateWeakRoots(isolate, &mark_weak, invoke_api_callbacks);
+  visitor_->Finalize();
+  marker_.Epilogue(isolate, invoke_api_callbacks);
+}
+
+
+void IncrementalMarker::StopWriteBarrier() {
+  if (write_barrier_active_) {
+    Heap::DecrementMarkingIsolates();
+    write_barrier_active_ = false;
+  }
+}
+
 }  // namespace dart
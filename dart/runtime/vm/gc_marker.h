@@ -13,9 +13,11 @@ namespace dart {
 class HandleVisitor;
 class Heap;
 class Isolate;
+class MarkingStack;
 class MarkingVisitor;
 class ObjectPointerVisitor;
 class PageSpace;
+class RawObject;
 class RawWeakProperty;
 
 // The class GCMarker is used to mark reachable old generation objects as part
@@ -38,15 +40,67 @@ class GCMarker : public ValueObject {
   void IterateWeakRoots(Isolate* isolate,
                         HandleVisitor* visitor,
                         bool visit_prologue_weak_persistent_handles);
+  void MarkObjectsInParallel(Isolate* isolate,
+                             PageSpace* page_space,
+                             MarkingVisitor* visitor,
+                             bool visit_prologue_weak_persistent_handles);
   void IterateWeakReferences(Isolate* isolate, MarkingVisitor* visitor);
   void DrainMarkingStack(Isolate* isolate, MarkingVisitor* visitor);
   void ProcessWeakProperty(RawWeakProperty* raw_weak, MarkingVisitor* visitor);
 
   Heap* heap_;
 
+  friend class IncrementalMarker;
   DISALLOW_IMPLICIT_CONSTRUCTORS(GCMarker);
 };
 
+
+// The class IncrementalMarker performs the marking of a mark-sweep collection
+// in bounded steps, which are interleaved with the execution of the mutator.
+// Objects allocated in the meantime are not marked. While marking is in
+// progress the write barrier records all stores into old objects, and the old
+// objects stored are shaded when the store buffer block gets processed. The
+// roots, the new space and the code space are rescanned in a final pause.
+class IncrementalMarker {
+ public:
+  IncrementalMarker(Heap* heap, PageSpace* page_space);
+  ~IncrementalMarker();
+
+  // Marks the objects directly reachable from the roots.
+  void Start(Isolate* isolate);
+
+  // Marks objects until either the marking stack is empty, in which case true
+  // is returned, or the time budget is used up.
+  bool Step(Isolate* isolate, int64_t budget_micros);
+
+  // Marks an old object which may have been made reachable from an object
+  // already visited by the marker.
+  void ShadeObject(RawObject* raw_obj);
+
+  // Completes the marking in a single pause.
+  void Finish(Isolate* isolate, bool invoke_api_callbacks);
+
+  intptr_t num_steps() const { return num_steps_; }
+  int64_t step_micros() const { return step_micros_; }
+
+ private:
+  // The number of objects visited between checks of the time budget.
+  static const intptr_t kObjectsPerTimeCheck = 64;
+
+  void StopWriteBarrier();
+
+  GCMarker marker_;
+  MarkingStack* marking_stack_;
+  MarkingVisitor* visitor_;
+  bool write_barrier_active_;
+
+  // Statistics.
+  intptr_t num_steps_;
+  int64_t step_micros_;
+
+  DISALLOW_COPY_AND_ASSIGN(IncrementalMarker);
+};
+
 }  // namespace dart
 
 #endif  // VM_GC_MARKER_H_
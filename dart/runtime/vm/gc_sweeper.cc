@@ -6,6 +6,7 @@
 
 #include "vm/freelist.h"
 #include "vm/globals.h"
+#include "vm/heap.h"
 #include "vm/pages.h"
 
 namespace dart {
@@ -17,6 +18,9 @@ intptr_t GCSweeper::SweepPage(HeapPage* page, FreeList* freelist) {
   intptr_t in_use = page->used();
   page->set_used(0);
 
+  // Pending pages are also swept on demand by the helper threads of a parallel
+  // scavenge, which have no current isolate.
+  Isolate* isolate = heap_->isolate();
   uword current = page->first_object_start();
   uword top = page->top();
 
@@ -31,10 +35,11 @@ intptr_t GCSweeper::SweepPage(HeapPage* page, FreeList* freelist) {
     if (raw_obj->IsMarked()) {
       // Found marked object. Clear the mark bit and update swept bytes.
       raw_obj->ClearMarkBit();
-      obj_size = raw_obj->Size();
+      obj_size = raw_obj->SizeFromTags(isolate, raw_obj->ptr()->tags_);
       in_use_swept += obj_size;
     } else {
-      uword free_end = current + raw_obj->Size();
+      uword free_end =
+          current + raw_obj->SizeFromTags(isolate, raw_obj->ptr()->tags_);
       while (free_end < top) {
         RawObject* next_obj = RawObject::FromAddr(free_end);
         if (next_obj->IsMarked()) {
@@ -42,7 +47,7 @@ intptr_t GCSweeper::SweepPage(HeapPage* page, FreeList* freelist) {
           break;
         }
         // Expand the free block by the size of this object.
-        free_end += next_obj->Size();
+        free_end += next_obj->SizeFromTags(isolate, next_obj->ptr()->tags_);
       }
       obj_size = free_end - current;
       if ((current + obj_size) == top) {
@@ -67,7 +72,7 @@ intptr_t GCSweeper::SweepLargePage(HeapPage* page) {
     return 0;
   }
   raw_obj->ClearMarkBit();
-  return raw_obj->Size();
+  return raw_obj->SizeFromTags(heap_->isolate(), raw_obj->ptr()->tags_);
 }
 
 }  // namespace dart
@@ -100,7 +100,11 @@ HandleScope::~HandleScope() {
 
 #if defined(DEBUG)
 NoHandleScope::NoHandleScope(BaseIsolate* isolate) : StackResource(isolate) {
-  isolate->IncrementNoHandleScopeDepth();
+  // A NULL isolate is used by threads which do not own the isolate, e.g. the
+  // helper threads of the parallel marker.
+  if (isolate != NULL) {
+    isolate->IncrementNoHandleScopeDepth();
+  }
 }
 
 
@@ -110,7 +114,9 @@ NoHandleScope::NoHandleScope() : StackResource(Isolate::Current()) {
 
 
 NoHandleScope::~NoHandleScope() {
-  isolate()->DecrementNoHandleScopeDepth();
+  if (isolate() != NULL) {
+    isolate()->DecrementNoHandleScopeDepth();
+  }
 }
 #endif  // defined(DEBUG)
 
@@ -6,8 +6,12 @@
 
 #include "platform/assert.h"
 #include "platform/utils.h"
+#include "vm/allocation_sampler.h"
+#include "vm/atomic.h"
+#include "vm/code_index_table.h"
 #include "vm/compiler_stats.h"
 #include "vm/flags.h"
+#include "vm/gc_events.h"
 #include "vm/heap_profiler.h"
 #include "vm/isolate.h"
 #include "vm/object.h"
@@ -35,13 +39,24 @@ DEFINE_FLAG(int, old_gen_heap_size, Heap::kHeapSizeInMB,
 DEFINE_FLAG(int, code_heap_size, Heap::kCodeHeapSizeInMB,
             "code heap size in MB,"
             "e.g: --code_heap_size=8 allocates a 8MB code heap");
+DEFINE_FLAG(bool, use_huge_pages, false,
+            "Back the new gen heap and the large old gen pages with huge "
+            "pages where the OS supports it");
+DECLARE_FLAG(bool, incremental_marking);
 
-  Heap::Heap() : read_only_(false) {
+intptr_t Heap::marking_isolates_ = 0;
+
+
+  Heap::Heap(Isolate* isolate) : isolate_(isolate), read_only_(false) {
+  // The new space sets its first sampling point when it is created.
+  allocation_sampler_ = new AllocationSampler();
   new_space_ = new Scavenger(this,
                              (FLAG_new_gen_heap_size * MB),
                              kNewObjectAlignmentOffset);
   old_space_ = new PageSpace(this, (FLAG_old_gen_heap_size * MB));
   code_space_ = new PageSpace(this, (FLAG_code_heap_size * MB), true);
+  gc_events_ = new GCEventRecorder();
+  code_index_table_ = new CodeIndexTable();
 }
 
 
@@ -49,6 +64,9 @@ Heap::~Heap() {
   delete new_space_;
   delete old_space_;
   delete code_space_;
+  delete gc_events_;
+  delete allocation_sampler_;
+  delete code_index_table_;
 }
 
 
@@ -69,15 +87,38 @@ uword Heap::AllocateNew(intptr_t size) {
 
 uword Heap::AllocateOld(intptr_t size) {
   ASSERT(Isolate::Current()->no_gc_scope_depth() == 0);
+  if (old_space_->NeedsMarkingStep()) {
+    // Take the step before allocating, as it may complete the collection.
+    old_space_->IncrementalMarkingStep();
+  }
   uword addr = old_space_->TryAllocate(size);
+  if ((addr == 0) &&
+      FLAG_incremental_marking &&
+      !old_space_->marking_in_progress()) {
+    // Instead of collecting right away, let the old space grow while it is
+    // being marked incrementally.
+    old_space_->StartIncrementalMarking();
+    addr = old_space_->TryAllocate(size);
+  }
   if (addr == 0) {
+    bool was_marking = old_space_->marking_in_progress();
     CollectAllGarbage();
     addr = old_space_->TryAllocate(size, PageSpace::kForceGrowth);
+    if ((addr == 0) && was_marking) {
+      // The objects which died while the old space was being marked
+      // incrementally survived the collection completing the marking.
+      CollectAllGarbage();
+      addr = old_space_->TryAllocate(size, PageSpace::kForceGrowth);
+    }
     if (addr == 0) {
       OS::PrintErr("Exhausted heap space, trying to allocate %"Pd" bytes.\n",
                    size);
+      return 0;
     }
   }
+  if (allocation_sampler_->CountOldAllocation(size)) {
+    allocation_sampler_->set_pending_address(addr);
+  }
   return addr;
 }
 
@@ -97,6 +138,12 @@ uword Heap::AllocateCode(PageSpace* space, intptr_t size) {
 }
 
 
+void Heap::FreeOld(uword addr, intptr_t size) {
+  ASSERT(!read_only_);
+  old_space_->Free(addr, size);
+}
+
+
 bool Heap::Contains(uword addr) const {
   return new_space_->Contains(addr) ||
       old_space_->Contains(addr) ||
@@ -178,23 +225,42 @@ void Heap::CollectGarbage(Space space, ApiCallbacks api_callbacks) {
   bool invoke_api_callbacks = (api_callbacks == kInvokeApiCallbacks);
   switch (space) {
     case kNew: {
-      new_space_->Scavenge(invoke_api_callbacks,
-                           GCReasonToString(kNewSpace));
+      {
+        GCEventScope event(this, Dart_GcEvent::kScavenge, kNewSpace);
+        new_space_->Scavenge(invoke_api_callbacks,
+                             GCReasonToString(kNewSpace));
+      }
       if (new_space_->HadPromotionFailure()) {
-        old_space_->MarkSweep(true,
-                              GCReasonToString(kPromotionFailure));
+        if (FLAG_incremental_marking && !old_space_->marking_in_progress()) {
+          // The objects which were not promoted remain in the new space.
+          // Start marking, which lets the old space grow, instead of
+          // collecting it right away.
+          old_space_->StartIncrementalMarking();
+        } else {
+          GCEventScope event(this,
+                             Dart_GcEvent::kMarkSweep,
+                             kPromotionFailure);
+          old_space_->MarkSweep(true,
+                                GCReasonToString(kPromotionFailure));
+        }
+      } else if (old_space_->marking_in_progress()) {
+        old_space_->IncrementalMarkingStep();
       }
       break;
     }
-    case kOld:
+    case kOld: {
+      GCEventScope event(this, Dart_GcEvent::kMarkSweep, kOldSpace);
       old_space_->MarkSweep(invoke_api_callbacks,
                             GCReasonToString(kOldSpace));
       break;
-    case kCode:
+    }
+    case kCode: {
       UNIMPLEMENTED();
+      GCEventScope event(this, Dart_GcEvent::kMarkSweep, kCodeSpace);
       code_space_->MarkSweep(invoke_api_callbacks,
                              GCReasonToString(kCodeSpace));
       break;
+    }
     default:
       UNREACHABLE();
   }
@@ -217,8 +283,14 @@ void Heap::CollectGarbage(Space space) {
 
 void Heap::CollectAllGarbage() {
   const char* gc_reason = GCReasonToString(kFull);
-  new_space_->Scavenge(kInvokeApiCallbacks, gc_reason);
-  old_space_->MarkSweep(kInvokeApiCallbacks, gc_reason);
+  {
+    GCEventScope event(this, Dart_GcEvent::kScavenge, kFull);
+    new_space_->Scavenge(kInvokeApiCallbacks, gc_reason);
+  }
+  {
+    GCEventScope event(this, Dart_GcEvent::kMarkSweep, kFull);
+    old_space_->MarkSweep(kInvokeApiCallbacks, gc_reason);
+  }
   // TODO(iposva): Merge old and code space.
   // code_space_->MarkSweep(kInvokeApiCallbacks, gc_reason);
   if (FLAG_verbose_gc) {
@@ -227,11 +299,94 @@ void Heap::CollectAllGarbage() {
 }
 
 
+void Heap::CompactOldSpace() {
+  const char* gc_reason = GCReasonToString(kCompaction);
+  {
+    GCEventScope event(this, Dart_GcEvent::kScavenge, kCompaction);
+    new_space_->Scavenge(kInvokeApiCallbacks, gc_reason);
+  }
+  {
+    GCEventScope event(this, Dart_GcEvent::kMarkSweep, kCompaction);
+    old_space_->MarkSweep(kInvokeApiCallbacks, gc_reason, true);
+  }
+  if (FLAG_verbose_gc) {
+    PrintSizes();
+  }
+}
+
+
+void Heap::CompleteSweep() {
+  old_space_->CompleteSweep();
+  code_space_->CompleteSweep();
+}
+
+
+void Heap::NotifyIdle() {
+  old_space_->NotifyIdle();
+}
+
+
+bool Heap::MarkingInProgress() const {
+  return old_space_->marking_in_progress();
+}
+
+
+bool Heap::SweepPending() const {
+  return old_space_->sweep_pending() || code_space_->sweep_pending();
+}
+
+
+bool Heap::MarkCard(uword addr) {
+  return old_space_->MarkCard(addr);
+}
+
+
+intptr_t Heap::VisitDirtyCards(ObjectPointerVisitor* visitor) {
+  return old_space_->VisitDirtyCards(visitor);
+}
+
+
+void Heap::ClearCards() {
+  old_space_->ClearCards();
+}
+
+
+void Heap::ShadeObject(RawObject* raw_obj) {
+  old_space_->ShadeObject(raw_obj);
+}
+
+
+void Heap::IncrementMarkingIsolates() {
+  AtomicOperations::FetchAndIncrementBy(&marking_isolates_, 1);
+}
+
+
+void Heap::DecrementMarkingIsolates() {
+  AtomicOperations::FetchAndIncrementBy(&marking_isolates_, -1);
+  ASSERT(marking_isolates_ >= 0);
+}
+
+
 void Heap::EnableGrowthControl() {
   old_space_->EnableGrowthControl();
 }
 
 
+void Heap::SetLimits(intptr_t soft_limit, intptr_t hard_limit) {
+  old_space_->controller()->SetLimits(soft_limit, hard_limit);
+}
+
+
+intptr_t Heap::GrowthBudget() const {
+  return old_space_->GrowthBudget();
+}
+
+
+void Heap::SetGCTimeTarget(int percent) {
+  old_space_->controller()->set_garbage_collection_time_ratio(percent);
+}
+
+
 void Heap::WriteProtect(bool read_only) {
   read_only_ = read_only;
   new_space_->WriteProtect(read_only);
@@ -253,7 +408,7 @@ uword Heap::EndAddress() {
 
 void Heap::Init(Isolate* isolate) {
   ASSERT(isolate->heap() == NULL);
-  Heap* heap = new Heap();
+  Heap* heap = new Heap(isolate);
   isolate->set_heap(heap);
 }
 
@@ -320,6 +475,41 @@ void Heap::PrintSizes() const {
 }
 
 
+intptr_t Heap::UsedInWords(Space space) const {
+  switch (space) {
+    case kNew:
+      return new_space_->in_use() / kWordSize;
+    case kOld:
+      return old_space_->in_use() / kWordSize;
+    case kCode:
+      return code_space_->in_use() / kWordSize;
+    default:
+      UNREACHABLE();
+  }
+  return 0;
+}
+
+
+intptr_t Heap::CapacityInWords(Space space) const {
+  switch (space) {
+    case kNew:
+      return new_space_->capacity() / kWordSize;
+    case kOld:
+      return old_space_->capacity() / kWordSize;
+    case kCode:
+      return code_space_->capacity() / kWordSize;
+    default:
+      UNREACHABLE();
+  }
+  return 0;
+}
+
+
+intptr_t Heap::PromotedInWords() const {
+  return new_space_->promoted() / kWordSize;
+}
+
+
 void Heap::Profile(Dart_HeapProfileWriteCallback callback, void* stream) const {
   HeapProfiler profiler(callback, stream);
 
@@ -355,6 +545,10 @@ const char* Heap::GCReasonToString(GCReason gc_reason) {
       return "debugging";
     case kGCTestCase:
       return "test case";
+    case kIncrementalMarking:
+      return "incremental marking";
+    case kCompaction:
+      return "compaction";
     default:
       UNREACHABLE();
       return "";
@@ -15,6 +15,9 @@
 namespace dart {
 
 // Forward declarations.
+class AllocationSampler;
+class CodeIndexTable;
+class GCEventRecorder;
 class Isolate;
 class ObjectPointerVisitor;
 class ObjectSet;
@@ -24,6 +27,7 @@ DECLARE_FLAG(bool, verbose_gc);
 DECLARE_FLAG(bool, verify_before_gc);
 DECLARE_FLAG(bool, verify_after_gc);
 DECLARE_FLAG(bool, gc_at_alloc);
+DECLARE_FLAG(bool, use_huge_pages);
 
 class Heap {
  public:
@@ -46,6 +50,8 @@ class Heap {
     kFull,
     kGCAtAlloc,
     kGCTestCase,
+    kIncrementalMarking,
+    kCompaction,
   };
 
   // Default allocation sizes in MB for the old gen and code heaps.
@@ -88,6 +94,10 @@ class Heap {
     return 0;
   }
 
+  // Return old space memory obtained from TryAllocate, e.g. the unused part
+  // of a promotion buffer, to the freelist.
+  void FreeOld(uword addr, intptr_t size);
+
   // Heap contains the specified address.
   bool Contains(uword addr) const;
   bool NewContains(uword addr) const;
@@ -125,10 +135,56 @@ class Heap {
   void CollectGarbage(Space space, ApiCallbacks api_callbacks);
   void CollectAllGarbage();
 
+  // Collect all garbage and compact the old space regardless of its
+  // fragmentation, releasing the pages emptied by moving its objects.
+  void CompactOldSpace();
+
+  // Finish sweeping the pages left unswept by the last old space collection.
+  void CompleteSweep();
+
+  // Called when the isolate has no messages left to handle. Returns the free
+  // memory of the old space to the OS.
+  void NotifyIdle();
+
+  // Returns true while the old space is being marked incrementally.
+  bool MarkingInProgress() const;
+
+  // Returns true while pages are left unswept by the last old space
+  // collection, their live objects still carry mark bits.
+  bool SweepPending() const;
+
+  // The slots of the large old objects which contain new objects are
+  // remembered in card tables, see PageSpace::MarkCard.
+  bool MarkCard(uword addr);
+  intptr_t VisitDirtyCards(ObjectPointerVisitor* visitor);
+  void ClearCards();
+
+  // Marks an old object stored while the old space is marked incrementally.
+  void ShadeObject(RawObject* raw_obj);
+
+  // The number of isolates marking their old space incrementally. As long as
+  // it is non-zero, the write barriers of compiled code and of
+  // Object::StorePointer record all stores into old objects in the store
+  // buffer block, not only the stores of new objects.
+  static bool IsAnyIsolateMarking() { return marking_isolates_ != 0; }
+  static uword marking_isolates_address() {
+    return reinterpret_cast<uword>(&marking_isolates_);
+  }
+  static void IncrementMarkingIsolates();
+  static void DecrementMarkingIsolates();
+
   // Enables growth control on the page space heaps.  This should be
   // called before any user code is executed.
   void EnableGrowthControl();
 
+  // Limits on the footprint of the new and old spaces in bytes, 0 for no
+  // limit, see PageSpaceController.
+  void SetLimits(intptr_t soft_limit, intptr_t hard_limit);
+  // The number of bytes the heap may grow by without exceeding its limits.
+  intptr_t GrowthBudget() const;
+  // The percentage of time spent in GC the old space growth is tuned for.
+  void SetGCTimeTarget(int percent);
+
   // Protect access to the heap.
   void WriteProtect(bool read_only);
 
@@ -146,6 +202,12 @@ class Heap {
   // Print heap sizes.
   void PrintSizes() const;
 
+  // Stats collection.
+  intptr_t UsedInWords(Space space) const;
+  intptr_t CapacityInWords(Space space) const;
+  // The size of the objects promoted to the old space by the last scavenge.
+  intptr_t PromotedInWords() const;
+
   // Returns the [lowest, highest) addresses in the heap.
   void StartEndAddress(uword* start, uword* end) const;
 
@@ -156,21 +218,41 @@ class Heap {
 
   static const char* GCReasonToString(GCReason gc_reason);
 
+  // The recorder of the garbage collection events of this heap.
+  GCEventRecorder* gc_events() const { return gc_events_; }
+
+  // The sampler of the allocations of this heap.
+  AllocationSampler* allocation_sampler() const { return allocation_sampler_; }
+
+  // The table mapping program counters to the code of this heap.
+  CodeIndexTable* code_index_table() const { return code_index_table_; }
+
+  // The isolate owning this heap.
+  Isolate* isolate() const { return isolate_; }
+
  private:
-  Heap();
+  explicit Heap(Isolate* isolate);
 
   uword AllocateNew(intptr_t size);
   uword AllocateOld(intptr_t size);
   uword AllocateCode(PageSpace* space, intptr_t size);
 
+  Isolate* isolate_;
+
   // The different spaces used for allocation.
   Scavenger* new_space_;
   PageSpace* old_space_;
   PageSpace* code_space_;
 
+  GCEventRecorder* gc_events_;
+  AllocationSampler* allocation_sampler_;
+  CodeIndexTable* code_index_table_;
+
   // This heap is in read-only mode: No allocation is allowed.
   bool read_only_;
 
+  static intptr_t marking_isolates_;
+
   friend class GCTestHelper;
   DISALLOW_COPY_AND_ASSIGN(Heap);
 };
@@ -3,12 +3,28 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "platform/assert.h"
+#include "vm/dart_api_impl.h"
 #include "vm/globals.h"
 #include "vm/heap.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
+DECLARE_FLAG(bool, adaptive_new_gen);
+DECLARE_FLAG(bool, adaptive_tenuring);
+DECLARE_FLAG(int, compaction_threshold);
+DECLARE_FLAG(int, free_memory_release_delay);
+DECLARE_FLAG(bool, incremental_marking);
+DECLARE_FLAG(bool, lazy_sweep);
+DECLARE_FLAG(int, marking_step_micros);
+DECLARE_FLAG(int, marker_tasks);
+DECLARE_FLAG(int, new_gen_heap_size);
+DECLARE_FLAG(int, new_gen_min_heap_size);
+DECLARE_FLAG(int, new_gen_survival_ratio);
+DECLARE_FLAG(int, new_gen_target_pause_micros);
+DECLARE_FLAG(int, scavenger_tasks);
+DECLARE_FLAG(int, tenuring_threshold);
+
 // Only ia32 and x64 can run execution tests.
 #if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
 TEST_CASE(OldGC) {
@@ -53,5 +69,562 @@ TEST_CASE(LargeSweep) {
   heap->CollectGarbage(Heap::kOld);
 }
 
+
+TEST_CASE(ParallelMarking) {
+  const char* kScriptChars =
+  "main() {\n"
+  "  var list = new List(100000);\n"
+  "  for (int i = 0; i < list.length; i++) {\n"
+  "    list[i] = [i, new Object(), new List(i % 7)];\n"
+  "  }\n"
+  "  return list;\n"
+  "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_EnterScope();
+  Dart_Handle result = Dart_Invoke(lib,
+                                   Dart_NewString("main"),
+                                   0, NULL);
+
+  EXPECT_VALID(result);
+  EXPECT(Dart_IsList(result));
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  // Completing an incremental marking cycle may leave floating garbage.
+  heap->CollectGarbage(Heap::kOld);
+  heap->CollectGarbage(Heap::kOld);
+  intptr_t serial_in_use = heap->UsedInWords(Heap::kOld);
+  const int saved_marker_tasks = FLAG_marker_tasks;
+  const bool saved_verify_after_gc = FLAG_verify_after_gc;
+  FLAG_marker_tasks = 3;
+  FLAG_verify_after_gc = true;
+  heap->CollectGarbage(Heap::kOld);
+  FLAG_marker_tasks = saved_marker_tasks;
+  FLAG_verify_after_gc = saved_verify_after_gc;
+  // Marking in parallel must find exactly the same live objects.
+  EXPECT_EQ(serial_in_use, heap->UsedInWords(Heap::kOld));
+  intptr_t length = 0;
+  EXPECT_VALID(Dart_ListLength(result, &length));
+  EXPECT_EQ(100000, length);
+  Dart_ExitScope();
+}
+
+
+TEST_CASE(LazySweep) {
+  const char* kScriptChars =
+  "var list;\n"
+  "build() {\n"
+  "  list = new List(50000);\n"
+  "  for (int i = 0; i < 100000; i++) {\n"
+  "    var entry = [i, new Object()];\n"
+  "    if ((i % 2) == 0) list[i ~/ 2] = entry;\n"
+  "  }\n"
+  "}\n"
+  "check() {\n"
+  "  for (int i = 0; i < list.length; i++) {\n"
+  "    if (list[i][0] != (2 * i)) return false;\n"
+  "  }\n"
+  "  return true;\n"
+  "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, Dart_NewString("build"), 0, NULL));
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  const bool saved_lazy_sweep = FLAG_lazy_sweep;
+  FLAG_lazy_sweep = true;
+  heap->CollectGarbage(Heap::kOld);
+  // Old space allocation sweeps the pages left unswept by the collection.
+  for (intptr_t i = 0; i < 50000; i++) {
+    Array::New(4, Heap::kOld);
+  }
+  EXPECT(heap->Verify());
+  heap->CollectGarbage(Heap::kOld);
+  FLAG_lazy_sweep = saved_lazy_sweep;
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("check"), 0, NULL);
+  EXPECT_VALID(result);
+  bool value = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &value));
+  EXPECT(value);
+}
+
+
+TEST_CASE(ParallelScavenge) {
+  const char* kScriptChars =
+  "var list;\n"
+  "var expando;\n"
+  "build() {\n"
+  "  expando = new Expando();\n"
+  "  list = new List(4000);\n"
+  "  for (int i = 0; i < list.length; i++) {\n"
+  "    var entry = [i, new Object()];\n"
+  "    list[i] = entry;\n"
+  "    expando[entry] = [i];\n"
+  "    new List(i % 13);\n"
+  "  }\n"
+  "}\n"
+  "check() {\n"
+  "  for (int i = 0; i < list.length; i++) {\n"
+  "    if (list[i][0] != i) return false;\n"
+  "    if (expando[list[i]][0] != i) return false;\n"
+  "  }\n"
+  "  return true;\n"
+  "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, Dart_NewString("build"), 0, NULL));
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  const int saved_scavenger_tasks = FLAG_scavenger_tasks;
+  const bool saved_verify_after_gc = FLAG_verify_after_gc;
+  FLAG_scavenger_tasks = 3;
+  FLAG_verify_after_gc = true;
+  // The first scavenge copies the survivors, the second one promotes them.
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  FLAG_scavenger_tasks = saved_scavenger_tasks;
+  FLAG_verify_after_gc = saved_verify_after_gc;
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("check"), 0, NULL);
+  EXPECT_VALID(result);
+  bool value = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &value));
+  EXPECT(value);
+}
+
+
+TEST_CASE(IncrementalMarking) {
+  const char* kScriptChars =
+  "class Node {\n"
+  "  Node(this.value);\n"
+  "  var value;\n"
+  "  var next;\n"
+  "  var data;\n"
+  "}\n"
+  "var nodes;\n"
+  "var expando;\n"
+  "build() {\n"
+  "  expando = new Expando();\n"
+  "  nodes = new List(4000);\n"
+  "  for (int i = 0; i < nodes.length; i++) {\n"
+  "    nodes[i] = new Node(i);\n"
+  "    expando[nodes[i]] = [i];\n"
+  "  }\n"
+  "}\n"
+  "churn() {\n"
+  "  for (int round = 0; round < 50; round++) {\n"
+  "    for (int i = 0; i < nodes.length; i++) {\n"
+  "      var node = nodes[i];\n"
+  "      node.data = [node.value, new List(64)];\n"
+  "      nodes[(i * 7 + round) % nodes.length].next = node;\n"
+  "    }\n"
+  "  }\n"
+  "}\n"
+  "check() {\n"
+  "  for (int i = 0; i < nodes.length; i++) {\n"
+  "    var node = nodes[i];\n"
+  "    if (node.value != i) return false;\n"
+  "    if (node.data[0] != i) return false;\n"
+  "    if (expando[node][0] != i) return false;\n"
+  "    if (node.next.value is! int) return false;\n"
+  "  }\n"
+  "  return true;\n"
+  "}\n";
+  const bool saved_incremental_marking = FLAG_incremental_marking;
+  const int saved_marking_step_micros = FLAG_marking_step_micros;
+  FLAG_incremental_marking = true;
+  FLAG_marking_step_micros = 10;
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, Dart_NewString("build"), 0, NULL));
+  Heap* heap = Isolate::Current()->heap();
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  // Filling the old space starts marking instead of collecting it.
+  for (intptr_t i = 0; (i < 10000) && !heap->MarkingInProgress(); i++) {
+    Array::New(256, Heap::kOld);
+  }
+  EXPECT(heap->MarkingInProgress());
+  // The stores and promotions of the mutator have to be seen by the marker.
+  EXPECT_VALID(Dart_Invoke(lib, Dart_NewString("churn"), 0, NULL));
+  EXPECT(heap->Verify());
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT(!heap->MarkingInProgress());
+  EXPECT(heap->Verify());
+  FLAG_incremental_marking = saved_incremental_marking;
+  FLAG_marking_step_micros = saved_marking_step_micros;
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("check"), 0, NULL);
+  EXPECT_VALID(result);
+  bool value = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &value));
+  EXPECT(value);
+}
+
+
+TEST_CASE(Compaction) {
+  const char* kScriptChars =
+  "var list;\n"
+  "var survivors;\n"
+  "build() {\n"
+  "  list = new List(40000);\n"
+  "  for (int i = 0; i < list.length; i++) {\n"
+  "    list[i] = [i, new List(8)];\n"
+  "  }\n"
+  "}\n"
+  "thin() {\n"
+  "  survivors = new List(list.length ~/ 16);\n"
+  "  for (int i = 0; i < survivors.length; i++) {\n"
+  "    survivors[i] = list[i * 16];\n"
+  "  }\n"
+  "  list = null;\n"
+  "}\n"
+  "check() {\n"
+  "  for (int i = 0; i < survivors.length; i++) {\n"
+  "    if (survivors[i][0] != (i * 16)) return false;\n"
+  "    if (survivors[i][1].length != 8) return false;\n"
+  "  }\n"
+  "  return true;\n"
+  "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, Dart_NewString("build"), 0, NULL));
+  Heap* heap = Isolate::Current()->heap();
+  // Promote the list and its elements, whatever the tenuring threshold.
+  for (intptr_t i = 0; i <= RawObject::kMaxAge; i++) {
+    heap->CollectGarbage(Heap::kNew);
+  }
+  EXPECT_VALID(Dart_Invoke(lib, Dart_NewString("thin"), 0, NULL));
+  const int saved_compaction_threshold = FLAG_compaction_threshold;
+  FLAG_compaction_threshold = 100;
+  heap->CollectGarbage(Heap::kOld);
+  intptr_t swept_capacity = heap->CapacityInWords(Heap::kOld);
+  FLAG_compaction_threshold = saved_compaction_threshold;
+  heap->CompactOldSpace();
+  // The surviving objects were spread over all the pages of the list.
+  EXPECT(heap->CapacityInWords(Heap::kOld) < swept_capacity);
+  EXPECT(heap->Verify());
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("check"), 0, NULL);
+  EXPECT_VALID(result);
+  bool value = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &value));
+  EXPECT(value);
+}
+
+
+TEST_CASE(CardMarkingWriteBarrier) {
+  const char* kScriptChars =
+  "class Box {\n"
+  "  var value;\n"
+  "  Box(this.value);\n"
+  "}\n"
+  "var large;\n"
+  "alloc() {\n"
+  "  large = new List(70000);\n"
+  "  return large;\n"
+  "}\n"
+  "fill() {\n"
+  "  for (var i = 0; i < large.length; i++) {\n"
+  "    large[i] = ((i % 1000) == 0) ? new Box(i) : null;\n"
+  "  }\n"
+  "}\n"
+  "check() {\n"
+  "  for (var i = 0; i < large.length; i++) {\n"
+  "    if ((i % 1000) == 0) {\n"
+  "      if (large[i].value != i) return false;\n"
+  "    } else if (large[i] != null) {\n"
+  "      return false;\n"
+  "    }\n"
+  "  }\n"
+  "  return true;\n"
+  "}\n";
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, Dart_NewString("alloc"), 0, NULL);
+  EXPECT_VALID(result);
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  // Promote the list into a large page.
+  for (intptr_t i = 0; i <= RawObject::kMaxAge; i++) {
+    heap->CollectGarbage(Heap::kNew);
+  }
+  const Array& large = Array::CheckedHandle(Api::UnwrapHandle(result));
+  EXPECT(large.raw()->IsOldObject());
+  EXPECT(!PageSpace::IsPageAllocatableSize(large.raw()->Size()));
+  EXPECT_VALID(Dart_Invoke(lib, Dart_NewString("fill"), 0, NULL));
+  // The write barrier marked the cards of the stores of new objects into the
+  // list instead of recording them in the store buffer.
+  StoreBufferBlock* block = isolate->store_buffer_block();
+  for (intptr_t i = 0; i < large.Length(); i += 1000) {
+    uword slot =
+        RawObject::ToAddr(large.raw()) + Array::data_offset() + i * kWordSize;
+    EXPECT(!block->Contains(slot));
+  }
+  for (intptr_t i = 0; i <= RawObject::kMaxAge; i++) {
+    heap->CollectGarbage(Heap::kNew);
+    EXPECT(heap->Verify());
+  }
+  result = Dart_Invoke(lib, Dart_NewString("check"), 0, NULL);
+  EXPECT_VALID(result);
+  bool value = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &value));
+  EXPECT(value);
+}
+
 #endif  // defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64).
+
+
+TEST_CASE(TenuringThreshold) {
+  Heap* heap = Isolate::Current()->heap();
+  const int saved_tenuring_threshold = FLAG_tenuring_threshold;
+  const bool saved_adaptive_tenuring = FLAG_adaptive_tenuring;
+  FLAG_tenuring_threshold = 2;
+  FLAG_adaptive_tenuring = false;
+  const Array& array = Array::Handle(Array::New(16, Heap::kNew));
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(array.raw()->IsNewObject());
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(array.raw()->IsNewObject());
+  // The array has survived two scavenges and is promoted by the third one.
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(array.raw()->IsOldObject());
+  EXPECT_LE(Array::InstanceSize(16) / kWordSize, heap->PromotedInWords());
+  EXPECT(heap->Verify());
+  FLAG_tenuring_threshold = saved_tenuring_threshold;
+  FLAG_adaptive_tenuring = saved_adaptive_tenuring;
+}
+
+
+TEST_CASE(NewSpaceResizing) {
+  Heap* heap = Isolate::Current()->heap();
+  const bool saved_adaptive_new_gen = FLAG_adaptive_new_gen;
+  const int saved_target_pause = FLAG_new_gen_target_pause_micros;
+  const int saved_survival_ratio = FLAG_new_gen_survival_ratio;
+  const int saved_min_heap_size = FLAG_new_gen_min_heap_size;
+  const intptr_t max_capacity = (FLAG_new_gen_heap_size * MB) / kWordSize;
+  FLAG_adaptive_new_gen = true;
+  FLAG_new_gen_min_heap_size = 1;
+  // Shrink the semi-spaces after every scavenge.
+  FLAG_new_gen_target_pause_micros = -1;
+  const Array& array = Array::Handle(Array::New(1024));
+  intptr_t capacity = heap->CapacityInWords(Heap::kNew);
+  EXPECT_LE(capacity, max_capacity);
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(heap->CapacityInWords(Heap::kNew) < capacity);
+  // Grow them again, first below the limits on the heap footprint.
+  FLAG_new_gen_target_pause_micros = kMaxInt32;
+  FLAG_new_gen_survival_ratio = -1;
+  capacity = heap->CapacityInWords(Heap::kNew);
+  intptr_t footprint =
+      (capacity + heap->CapacityInWords(Heap::kOld)) * kWordSize;
+  heap->SetLimits(0, footprint);
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT_EQ(capacity, heap->CapacityInWords(Heap::kNew));
+  heap->SetLimits(footprint + 2 * MB, 0);
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(heap->CapacityInWords(Heap::kNew) > capacity);
+  EXPECT_LE((heap->CapacityInWords(Heap::kNew) +
+             heap->CapacityInWords(Heap::kOld)) * kWordSize,
+            footprint + 2 * MB);
+  heap->SetLimits(0, 0);
+  capacity = heap->CapacityInWords(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(heap->CapacityInWords(Heap::kNew) > capacity);
+  EXPECT_LE(heap->CapacityInWords(Heap::kNew), max_capacity);
+  EXPECT(heap->Verify());
+  EXPECT_EQ(1024, array.Length());
+  FLAG_adaptive_new_gen = saved_adaptive_new_gen;
+  FLAG_new_gen_target_pause_micros = saved_target_pause;
+  FLAG_new_gen_survival_ratio = saved_survival_ratio;
+  FLAG_new_gen_min_heap_size = saved_min_heap_size;
+}
+
+
+TEST_CASE(CardMarking) {
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  const intptr_t kLength = 64 * KB;
+  const intptr_t kStride = 1000;
+  const Array& large = Array::Handle(Array::New(kLength, Heap::kOld));
+  const Array& small = Array::Handle(Array::New(16, Heap::kOld));
+  EXPECT(!PageSpace::IsPageAllocatableSize(Array::InstanceSize(kLength)));
+  Array& element = Array::Handle();
+  Smi& value = Smi::Handle();
+  for (intptr_t i = 0; i < kLength; i += kStride) {
+    element = Array::New(1, Heap::kNew);
+    value = Smi::New(i);
+    element.SetAt(0, value);
+    large.SetAt(i, element);
+  }
+  element = Array::New(1, Heap::kNew);
+  small.SetAt(0, element);
+  // Only the store into the small array is recorded in the store buffer, the
+  // stores into the large array are remembered in its card table.
+  const uword large_start = RawObject::ToAddr(large.raw());
+  const uword large_end = large_start + large.raw()->Size();
+  const uword small_slot =
+      RawObject::ToAddr(small.raw()) + Array::data_offset();
+  intptr_t large_slots = 0;
+  bool small_slot_found = false;
+  StoreBuffer* store_buffer = isolate->store_buffer();
+  StoreBuffer::DedupSet* pending = store_buffer->DedupSets();
+  while (pending != NULL) {
+    StoreBuffer::DedupSet* next = pending->next();
+    HashSet* set = pending->set();
+    for (intptr_t i = 0; i < set->Size(); i++) {
+      uword slot = set->At(i);
+      if (slot != 0) {
+        if ((slot >= large_start) && (slot < large_end)) {
+          large_slots++;
+        }
+        small_slot_found = small_slot_found || (slot == small_slot);
+        store_buffer->AddPointer(slot);
+      }
+    }
+    delete pending;
+    pending = next;
+  }
+  EXPECT_EQ(0, large_slots);
+  EXPECT(small_slot_found);
+  // The new objects referenced from the large array survive the scavenges
+  // until they are promoted.
+  for (intptr_t age = 0; age <= RawObject::kMaxAge; age++) {
+    heap->CollectGarbage(Heap::kNew);
+    EXPECT(heap->Verify());
+  }
+  for (intptr_t i = 0; i < kLength; i++) {
+    if ((i % kStride) == 0) {
+      element ^= large.At(i);
+      EXPECT(element.raw()->IsOldObject());
+      value ^= element.At(0);
+      EXPECT_EQ(i, value.Value());
+    } else {
+      EXPECT(large.At(i) == Object::null());
+    }
+  }
+}
+
+
+
+TEST_CASE(OldSpaceAllocationArea) {
+  Heap* heap = Isolate::Current()->heap();
+  const intptr_t kNumArrays = 100;
+  const Array& arrays = Array::Handle(Array::New(kNumArrays, Heap::kOld));
+  Array& array = Array::Handle();
+  intptr_t adjacent = 0;
+  uword previous_end = 0;
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    array = Array::New(i % 8, Heap::kOld);
+    arrays.SetAt(i, array);
+    if (RawObject::ToAddr(array.raw()) == previous_end) {
+      adjacent++;
+    }
+    previous_end = RawObject::ToAddr(array.raw()) + array.raw()->Size();
+  }
+  // Small old objects are bump allocated from the allocation area, only a
+  // refill of the area breaks the sequence.
+  EXPECT_LE(kNumArrays - 5, adjacent);
+  EXPECT(heap->Verify());
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT(heap->Verify());
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    array ^= arrays.At(i);
+    EXPECT_EQ(i % 8, array.Length());
+  }
+}
+
+
+TEST_CASE(NotifyIdle) {
+  Heap* heap = Isolate::Current()->heap();
+  const bool saved_lazy_sweep = FLAG_lazy_sweep;
+  const intptr_t saved_release_delay = FLAG_free_memory_release_delay;
+  const bool saved_verify_before_gc = FLAG_verify_before_gc;
+  const bool saved_verify_after_gc = FLAG_verify_after_gc;
+  const int saved_compaction_threshold = FLAG_compaction_threshold;
+  FLAG_lazy_sweep = true;
+  // Verifying or compacting the heap completes the sweeping.
+  FLAG_verify_before_gc = false;
+  FLAG_verify_after_gc = false;
+  FLAG_compaction_threshold = 100;
+  // Only an idle isolate releases the free memory of a growing heap.
+  FLAG_free_memory_release_delay = kMaxInt32;
+  const intptr_t kNumArrays = 10000;
+  const Array& arrays = Array::Handle(Array::New(kNumArrays, Heap::kOld));
+  Array& array = Array::Handle();
+  for (intptr_t i = 0; i < 2 * kNumArrays; i++) {
+    array = Array::New(i % 8, Heap::kOld);
+    if ((i % 2) == 0) {
+      arrays.SetAt(i / 2, array);
+    }
+  }
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT(heap->SweepPending());
+  heap->NotifyIdle();
+  EXPECT(!heap->SweepPending());
+  EXPECT(heap->Verify());
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    array ^= arrays.At(i);
+    EXPECT_EQ((2 * i) % 8, array.Length());
+  }
+  FLAG_lazy_sweep = saved_lazy_sweep;
+  FLAG_free_memory_release_delay = saved_release_delay;
+  FLAG_verify_before_gc = saved_verify_before_gc;
+  FLAG_verify_after_gc = saved_verify_after_gc;
+  FLAG_compaction_threshold = saved_compaction_threshold;
+}
+
+
+TEST_CASE(ParallelScavengeWithSweepPending) {
+  Heap* heap = Isolate::Current()->heap();
+  const bool saved_lazy_sweep = FLAG_lazy_sweep;
+  const int saved_scavenger_tasks = FLAG_scavenger_tasks;
+  const bool saved_verify_before_gc = FLAG_verify_before_gc;
+  const bool saved_verify_after_gc = FLAG_verify_after_gc;
+  const int saved_compaction_threshold = FLAG_compaction_threshold;
+  FLAG_lazy_sweep = true;
+  // Verifying or compacting the heap completes the sweeping.
+  FLAG_verify_before_gc = false;
+  FLAG_verify_after_gc = false;
+  FLAG_compaction_threshold = 100;
+  // Promote the objects surviving in new space beforehand.
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  // The free blocks between the surviving old arrays are large enough for
+  // the promoted objects.
+  const intptr_t kNumArrays = 2000;
+  const Array& old_arrays = Array::Handle(Array::New(kNumArrays, Heap::kOld));
+  Array& array = Array::Handle();
+  for (intptr_t i = 0; i < 16 * kNumArrays; i++) {
+    array = Array::New(i % 8, Heap::kOld);
+    if ((i % 16) == 0) {
+      old_arrays.SetAt(i / 16, array);
+    }
+  }
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT(heap->SweepPending());
+  // Few enough survivors to be promoted without sweeping all pending pages.
+  const intptr_t kNumNewArrays = 32;
+  const Array& new_arrays = Array::Handle(Array::New(kNumNewArrays));
+  for (intptr_t i = 0; i < kNumNewArrays; i++) {
+    array = Array::New(i % 8);
+    new_arrays.SetAt(i, array);
+  }
+  FLAG_scavenger_tasks = 3;
+  // The helper threads sweep the pending pages they promote into on demand,
+  // a parallel scavenge does not complete the sweeping up front.
+  heap->CollectGarbage(Heap::kNew);
+#if !defined(DEBUG)
+  // Debug builds complete the sweeping to verify the store buffer.
+  EXPECT(heap->SweepPending());
+#endif
+  heap->CollectGarbage(Heap::kNew);
+  FLAG_scavenger_tasks = saved_scavenger_tasks;
+  EXPECT(heap->Verify());
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    array ^= old_arrays.At(i);
+    EXPECT_EQ(0, array.Length());
+  }
+  for (intptr_t i = 0; i < kNumNewArrays; i++) {
+    array ^= new_arrays.At(i);
+    EXPECT_EQ(i % 8, array.Length());
+  }
+  FLAG_lazy_sweep = saved_lazy_sweep;
+  FLAG_verify_before_gc = saved_verify_before_gc;
+  FLAG_verify_after_gc = saved_verify_after_gc;
+  FLAG_compaction_threshold = saved_compaction_threshold;
+}
+
 }
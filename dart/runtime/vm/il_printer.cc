@@ -143,6 +143,14 @@ static void PrintPropagatedType(BufferFormatter* f, const Definition& def) {
 }
 
 
+static void PrintRange(BufferFormatter* f, const Definition& definition) {
+  if (definition.range() != NULL) {
+    f->Print(" ");
+    definition.range()->PrintTo(f);
+  }
+}
+
+
 static void PrintUse(BufferFormatter* f, const Definition& definition) {
   if (definition.is_used()) {
     if (definition.HasSSATemp()) {
@@ -163,6 +171,7 @@ void Definition::PrintTo(BufferFormatter* f) const {
   PrintOperandsTo(f);
   f->Print(")");
   PrintPropagatedType(f, *this);
+  PrintRange(f, *this);
 }
 
 
@@ -425,6 +434,34 @@ void BinaryMintOpInstr::PrintOperandsTo(BufferFormatter* f) const {
 }
 
 
+void VectorBinaryOpInstr::PrintOperandsTo(BufferFormatter* f) const {
+  f->Print("%s, ", Token::Str(op_kind()));
+  left()->PrintTo(f);
+  f->Print(", ");
+  right()->PrintTo(f);
+}
+
+
+void VectorExtractLaneInstr::PrintOperandsTo(BufferFormatter* f) const {
+  value()->PrintTo(f);
+  f->Print(", %"Pd"", lane());
+}
+
+
+void VectorShuffleInstr::PrintOperandsTo(BufferFormatter* f) const {
+  value()->PrintTo(f);
+  f->Print(", 0x%"Px"", mask());
+}
+
+
+void VectorCompareInstr::PrintOperandsTo(BufferFormatter* f) const {
+  f->Print("%s, ", Token::Str(kind()));
+  left()->PrintTo(f);
+  f->Print(", ");
+  right()->PrintTo(f);
+}
+
+
 void UnboxedDoubleBinaryOpInstr::PrintOperandsTo(BufferFormatter* f) const {
   f->Print("%s, ", Token::Str(op_kind()));
   left()->PrintTo(f);
@@ -445,6 +482,53 @@ void CheckClassInstr::PrintOperandsTo(BufferFormatter* f) const {
 }
 
 
+void ConstraintInstr::PrintOperandsTo(BufferFormatter* f) const {
+  value()->PrintTo(f);
+  f->Print(" ^ ");
+  constraint()->PrintTo(f);
+}
+
+
+void MaterializeObjectInstr::PrintOperandsTo(BufferFormatter* f) const {
+  f->Print("%s", String::Handle(cls_.Name()).ToCString());
+  for (intptr_t i = 0; i < InputCount(); i++) {
+    f->Print(", %s: ", String::Handle(FieldAt(i).name()).ToCString());
+    InputAt(i)->PrintTo(f);
+  }
+}
+
+
+void RangeBoundary::PrintTo(BufferFormatter* f) const {
+  switch (kind_) {
+    case kSymbol:
+      f->Print("v%"Pd, symbol()->ssa_temp_index());
+      if (value_ != 0) f->Print(" %+"Pd64"", value_);
+      break;
+    case kConstant:
+      if (value_ == Smi::kMinValue) {
+        f->Print("-inf");
+      } else if (value_ == Smi::kMaxValue) {
+        f->Print("+inf");
+      } else {
+        f->Print("%"Pd64"", value_);
+      }
+      break;
+    case kUnknown:
+      f->Print("_|_");
+      break;
+  }
+}
+
+
+void Range::PrintTo(BufferFormatter* f) const {
+  f->Print("[");
+  min_.PrintTo(f);
+  f->Print(", ");
+  max_.PrintTo(f);
+  f->Print("]");
+}
+
+
 void GraphEntryInstr::PrintTo(BufferFormatter* f) const {
   f->Print("B%"Pd"[graph]", block_id());
   if ((constant_null() != NULL) || (start_env() != NULL)) {
@@ -493,6 +577,7 @@ void PhiInstr::PrintTo(BufferFormatter* f) const {
   }
   f->Print(")");
   PrintPropagatedType(f, *this);
+  PrintRange(f, *this);
 }
 
 
@@ -789,7 +874,11 @@ void Environment::PrintTo(BufferFormatter* f) const {
   f->Print(" env={ ");
   for (intptr_t i = 0; i < values_.length(); ++i) {
     if (i > 0) f->Print(", ");
-    values_[i]->PrintTo(f);
+    if (values_[i]->definition()->IsMaterializeObject()) {
+      values_[i]->definition()->PrintTo(f);
+    } else {
+      values_[i]->PrintTo(f);
+    }
     if ((locations_ != NULL) && !locations_[i].IsInvalid()) {
       f->Print(" [");
       locations_[i].PrintTo(f);
@@ -136,11 +136,16 @@ MethodRecognizer::Kind MethodRecognizer::RecognizeKind(
   const String& recognize_class = String::Handle(function_class.Name());
   String& test_function_name = String::Handle();
   String& test_class_name = String::Handle();
+  // Names of private classes carry the private key of their library.
+  const bool is_one_byte_class = recognize_class.IsOneByteString();
 #define RECOGNIZE_FUNCTION(class_name, function_name, enum_name)               \
   test_function_name = Symbols::New(#function_name);                           \
   test_class_name = Symbols::New(#class_name);                                 \
   if (recognize_name.Equals(test_function_name) &&                             \
-      recognize_class.Equals(test_class_name)) {                               \
+      (recognize_class.Equals(test_class_name) ||                              \
+       (is_one_byte_class && test_class_name.IsOneByteString() &&              \
+        OneByteString::Cast(recognize_class).EqualsIgnoringPrivateKey(         \
+            OneByteString::Cast(test_class_name))))) {                         \
     return k##enum_name;                                                       \
   }
 RECOGNIZED_LIST(RECOGNIZE_FUNCTION)
@@ -907,7 +912,28 @@ RawAbstractType* NativeCallInstr::CompileType() const {
 
 
 RawAbstractType* LoadIndexedInstr::CompileType() const {
-  return Type::DynamicType();
+  switch (class_id_) {
+    case kFloat32ArrayCid:
+    case kFloat64ArrayCid:
+      return Type::Double();
+    case kInt32ArrayCid:
+      return Type::SmiType();
+    default:
+      return Type::DynamicType();
+  }
+}
+
+
+intptr_t LoadIndexedInstr::ResultCid() const {
+  switch (class_id_) {
+    case kFloat32ArrayCid:
+    case kFloat64ArrayCid:
+      return kDoubleCid;
+    case kInt32ArrayCid:
+      return kSmiCid;
+    default:
+      return kDynamicCid;
+  }
 }
 
 
@@ -916,6 +942,51 @@ RawAbstractType* StoreIndexedInstr::CompileType() const {
 }
 
 
+RawAbstractType* VectorLoadIndexedInstr::CompileType() const {
+  return Type::null();
+}
+
+
+RawAbstractType* VectorStoreIndexedInstr::CompileType() const {
+  return AbstractType::null();
+}
+
+
+RawAbstractType* VectorBinaryOpInstr::CompileType() const {
+  return Type::null();
+}
+
+
+RawAbstractType* VectorBroadcastInstr::CompileType() const {
+  return Type::null();
+}
+
+
+RawAbstractType* VectorConstructInstr::CompileType() const {
+  return Type::null();
+}
+
+
+RawAbstractType* VectorExtractLaneInstr::CompileType() const {
+  return (class_id() == kInt32ArrayCid) ? Type::IntType() : Type::Double();
+}
+
+
+RawAbstractType* VectorShuffleInstr::CompileType() const {
+  return Type::null();
+}
+
+
+RawAbstractType* VectorCompareInstr::CompileType() const {
+  return Type::null();
+}
+
+
+RawAbstractType* VectorSelectInstr::CompileType() const {
+  return Type::null();
+}
+
+
 RawAbstractType* StoreInstanceFieldInstr::CompileType() const {
   return value()->CompileType();
 }
@@ -982,6 +1053,11 @@ RawAbstractType* LoadFieldInstr::CompileType() const {
 }
 
 
+RawAbstractType* LoadClassIdInstr::CompileType() const {
+  return Type::SmiType();
+}
+
+
 RawAbstractType* StoreVMFieldInstr::CompileType() const {
   return value()->CompileType();
 }
@@ -1043,6 +1119,9 @@ bool BinarySmiOpInstr::CanDeoptimize() const {
     case Token::kBIT_OR:
     case Token::kBIT_XOR:
       return false;
+    case Token::kADD:
+    case Token::kSUB:
+      return overflow();
     default:
       return true;
   }
@@ -1050,12 +1129,7 @@ bool BinarySmiOpInstr::CanDeoptimize() const {
 
 
 RawAbstractType* BinaryMintOpInstr::CompileType() const {
-  return Type::MintType();
-}
-
-
-intptr_t BinaryMintOpInstr::ResultCid() const {
-  return kMintCid;
+  return Type::IntType();
 }
 
 
@@ -1084,6 +1158,28 @@ RawAbstractType* BoxDoubleInstr::CompileType() const {
 }
 
 
+RawAbstractType* UnboxIntegerInstr::CompileType() const {
+  return Type::null();
+}
+
+
+RawAbstractType* BoxIntegerInstr::CompileType() const {
+  return Type::IntType();
+}
+
+
+RawAbstractType* UnboxVectorInstr::CompileType() const {
+  return Type::null();
+}
+
+
+RawAbstractType* BoxVectorInstr::CompileType() const {
+  const Class& cls =
+      Class::Handle(Isolate::Current()->class_table()->At(class_id()));
+  return Type::NewNonParameterizedType(cls);
+}
+
+
 RawAbstractType* UnarySmiOpInstr::CompileType() const {
   return Type::SmiType();
 }
@@ -1125,6 +1221,16 @@ RawAbstractType* CheckEitherNonSmiInstr::CompileType() const {
 }
 
 
+RawAbstractType* ConstraintInstr::CompileType() const {
+  return Type::SmiType();
+}
+
+
+RawAbstractType* MaterializeObjectInstr::CompileType() const {
+  return Type::NewNonParameterizedType(cls_);
+}
+
+
 // Optimizations that eliminate or simplify individual computations.
 Definition* Definition::Canonicalize() {
   return this;
@@ -1176,6 +1282,341 @@ Definition* CheckEitherNonSmiInstr::Canonicalize() {
 }
 
 
+// Range analysis.
+static bool IsSmiValue(int64_t value) {
+  return (Smi::kMinValue <= value) && (value <= Smi::kMaxValue);
+}
+
+
+RangeBoundary RangeBoundary::FromDefinition(Definition* defn, int64_t offset) {
+  ConstantInstr* constant = defn->AsConstant();
+  if ((constant != NULL) && constant->value().IsSmi()) {
+    // Offsets only move constants out of the Smi range for conditions that
+    // never hold, so clamping the constant is safe.
+    const int64_t value = Smi::Cast(constant->value()).Value() + offset;
+    if (value < Smi::kMinValue) return MinSmi();
+    if (value > Smi::kMaxValue) return MaxSmi();
+    return FromConstant(value);
+  }
+  return RangeBoundary(kSymbol, defn, offset);
+}
+
+
+RangeBoundary RangeBoundary::Add(int64_t offset,
+                                 const RangeBoundary& overflow) const {
+  ASSERT(!IsUnknown());
+  // Both the value and the offset are within the Smi range, their sum can
+  // not overflow.
+  ASSERT(IsSmiValue(offset));
+  const int64_t value = value_ + offset;
+  if (!IsSmiValue(value)) return overflow;
+  return RangeBoundary(kind_, symbol_, value);
+}
+
+
+// Bounds the recursion through the ranges of symbols.
+static const intptr_t kMaxBoundDepth = 8;
+
+
+RangeBoundary RangeBoundary::LowerBound(intptr_t depth) const {
+  if (IsConstant()) return *this;
+  if (IsUnknown() || (depth >= kMaxBoundDepth)) return MinSmi();
+  Range* range = symbol()->range();
+  if (range == NULL) return MinSmi();
+  return range->min().LowerBound(depth + 1).Add(value(), MinSmi());
+}
+
+
+RangeBoundary RangeBoundary::UpperBound(intptr_t depth) const {
+  if (IsConstant()) return *this;
+  if (IsUnknown() || (depth >= kMaxBoundDepth)) return MaxSmi();
+  Range* range = symbol()->range();
+  if (range == NULL) return MaxSmi();
+  return range->max().UpperBound(depth + 1).Add(value(), MaxSmi());
+}
+
+
+bool RangeBoundary::IsLessOrEqual(const RangeBoundary& a,
+                                  const RangeBoundary& b) {
+  if (a.IsUnknown() || b.IsUnknown()) return false;
+  if (a.IsSymbol() && b.IsSymbol() && (a.symbol() == b.symbol())) {
+    return a.value() <= b.value();
+  }
+  return a.UpperBound().value() <= b.LowerBound().value();
+}
+
+
+RangeBoundary RangeBoundary::Min(const RangeBoundary& a,
+                                 const RangeBoundary& b) {
+  if (IsLessOrEqual(a, b)) return a;
+  if (IsLessOrEqual(b, a)) return b;
+  const int64_t a_min = a.LowerBound().value();
+  const int64_t b_min = b.LowerBound().value();
+  return FromConstant((a_min < b_min) ? a_min : b_min);
+}
+
+
+RangeBoundary RangeBoundary::Max(const RangeBoundary& a,
+                                 const RangeBoundary& b) {
+  if (IsLessOrEqual(b, a)) return a;
+  if (IsLessOrEqual(a, b)) return b;
+  const int64_t a_max = a.UpperBound().value();
+  const int64_t b_max = b.UpperBound().value();
+  return FromConstant((a_max > b_max) ? a_max : b_max);
+}
+
+
+bool RangeBoundary::Equals(const RangeBoundary& other) const {
+  return (kind_ == other.kind_) &&
+      (symbol_ == other.symbol_) &&
+      (value_ == other.value_);
+}
+
+
+bool Range::IsWithin(int64_t min, int64_t max) const {
+  return (min_.LowerBound().value() >= min) &&
+      (max_.UpperBound().value() <= max);
+}
+
+
+void Definition::InferRange() {
+  range_ = Range::Unknown();
+}
+
+
+void ConstantInstr::InferRange() {
+  if (value().IsSmi()) {
+    const RangeBoundary constant =
+        RangeBoundary::FromConstant(Smi::Cast(value()).Value());
+    range_ = new Range(constant, constant);
+  } else {
+    range_ = Range::Unknown();
+  }
+}
+
+
+// Returns the step of an induction variable phi, if defn adds a constant to
+// the phi, or to a constraint of the phi, and 0 otherwise.
+static int64_t InductionStep(PhiInstr* phi, Definition* defn) {
+  BinarySmiOpInstr* op = defn->AsBinarySmiOp();
+  if ((op == NULL) || !op->right()->BindsToConstant()) return 0;
+  const Object& constant = op->right()->BoundConstant();
+  if (!constant.IsSmi()) return 0;
+  Definition* left = op->left()->definition();
+  while (left->IsConstraint()) {
+    left = left->AsConstraint()->value()->definition();
+  }
+  if (left != phi) return 0;
+  const int64_t step = Smi::Cast(constant).Value();
+  switch (op->op_kind()) {
+    case Token::kADD: return step;
+    case Token::kSUB: return -step;
+    default: return 0;
+  }
+}
+
+
+// Returns the bound of the initial values of an induction variable in the
+// loop with the given header.  Symbols defined in the loop may change between
+// iterations, they are replaced with their constant bounds.
+static RangeBoundary LoopInvariantBound(const RangeBoundary& bound,
+                                        BlockEntryInstr* header,
+                                        bool upper) {
+  if (bound.IsSymbol() && !bound.symbol()->IsParameter()) {
+    BlockEntryInstr* block = bound.symbol()->GetBlock();
+    if ((block == header) || !block->Dominates(header)) {
+      return upper ? bound.UpperBound() : bound.LowerBound();
+    }
+  }
+  return bound;
+}
+
+
+void PhiInstr::InferRange() {
+  RangeBoundary min;
+  RangeBoundary max;
+  // Ranges are inferred in reverse postorder: the inputs on back edges have
+  // no range yet.  A value only incremented on back edges stays above its
+  // initial values (or the Smi operation deoptimizes), one only decremented
+  // stays below them.
+  bool incremented = false;
+  bool decremented = false;
+  for (intptr_t i = 0; i < InputCount(); ++i) {
+    Definition* input = InputAt(i)->definition();
+    Range* input_range = input->range();
+    if (block()->Dominates(block()->PredecessorAt(i))) {
+      const int64_t step = InductionStep(this, input);
+      if (step > 0) {
+        incremented = true;
+      } else if (step < 0) {
+        decremented = true;
+      } else {
+        range_ = Range::Unknown();
+        return;
+      }
+    } else if (input_range == NULL) {
+      range_ = Range::Unknown();
+      return;
+    } else if (min.IsUnknown()) {
+      min = input_range->min();
+      max = input_range->max();
+    } else {
+      min = RangeBoundary::Min(min, input_range->min());
+      max = RangeBoundary::Max(max, input_range->max());
+    }
+  }
+  if (min.IsUnknown() || (incremented && decremented)) {
+    range_ = Range::Unknown();
+    return;
+  }
+  if (incremented) {
+    min = LoopInvariantBound(min, block(), false);
+    max = RangeBoundary::MaxSmi();
+  } else if (decremented) {
+    min = RangeBoundary::MinSmi();
+    max = LoopInvariantBound(max, block(), true);
+  }
+  range_ = new Range(min, max);
+}
+
+
+void LoadFieldInstr::InferRange() {
+  switch (recognized_kind()) {
+    case MethodRecognizer::kObjectArrayLength:
+    case MethodRecognizer::kImmutableArrayLength:
+    case MethodRecognizer::kGrowableArrayLength:
+    case MethodRecognizer::kGrowableArrayCapacity:
+    case MethodRecognizer::kStringBaseLength:
+    case MethodRecognizer::kByteArrayBaseLength:
+      range_ = new Range(RangeBoundary::FromConstant(0),
+                         RangeBoundary::MaxSmi());
+      break;
+    default:
+      Definition::InferRange();
+  }
+}
+
+
+static RangeBoundary ClampToSmi(int64_t value) {
+  if (value < Smi::kMinValue) return RangeBoundary::MinSmi();
+  if (value > Smi::kMaxValue) return RangeBoundary::MaxSmi();
+  return RangeBoundary::FromConstant(value);
+}
+
+
+// Returns true and the value of a Smi constant that can be used as an offset
+// of a range boundary.
+static bool IsSmiOffset(Value* value, int64_t* offset) {
+  if (!value->BindsToConstant() || !value->BoundConstant().IsSmi()) {
+    return false;
+  }
+  *offset = Smi::Cast(value->BoundConstant()).Value();
+  return true;
+}
+
+
+// Returns the range of the sum of a definition and a constant.  The upper
+// bound is relative to the definition itself: the upper bounds of its range
+// can be followed from there, e.g. to the length of an array.
+static Range* AddConstant(Definition* defn, int64_t offset) {
+  return new Range(
+      defn->range()->min().Add(offset, RangeBoundary::MinSmi()),
+      RangeBoundary::FromDefinition(defn, offset));
+}
+
+
+void BinarySmiOpInstr::InferRange() {
+  // The result of a Smi operation is a Smi, or the operation deoptimizes.
+  Range* left_range = left()->definition()->range();
+  Range* right_range = right()->definition()->range();
+  if ((left_range == NULL) || (right_range == NULL)) {
+    range_ = Range::Unknown();
+    return;
+  }
+  int64_t offset = 0;
+  switch (op_kind()) {
+    case Token::kADD:
+    case Token::kSUB:
+      if (IsSmiOffset(right(), &offset)) {
+        if (op_kind() == Token::kSUB) offset = -offset;
+        if (IsSmiValue(offset)) {
+          range_ = AddConstant(left()->definition(), offset);
+          return;
+        }
+      }
+      if ((op_kind() == Token::kADD) && IsSmiOffset(left(), &offset)) {
+        range_ = AddConstant(right()->definition(), offset);
+        return;
+      }
+      if (op_kind() == Token::kADD) {
+        range_ = new Range(
+            ClampToSmi(left_range->min().LowerBound().value() +
+                       right_range->min().LowerBound().value()),
+            ClampToSmi(left_range->max().UpperBound().value() +
+                       right_range->max().UpperBound().value()));
+      } else {
+        range_ = new Range(
+            ClampToSmi(left_range->min().LowerBound().value() -
+                       right_range->max().UpperBound().value()),
+            ClampToSmi(left_range->max().UpperBound().value() -
+                       right_range->min().LowerBound().value()));
+      }
+      return;
+    case Token::kBIT_AND: {
+      // Masking with a non-negative value gives a value between 0 and the
+      // mask.
+      const bool left_positive = left_range->IsWithin(0, Smi::kMaxValue);
+      const bool right_positive = right_range->IsWithin(0, Smi::kMaxValue);
+      if (left_positive || right_positive) {
+        int64_t max = Smi::kMaxValue;
+        if (left_positive) max = left_range->max().UpperBound().value();
+        if (right_positive) {
+          const int64_t right_max = right_range->max().UpperBound().value();
+          if (right_max < max) max = right_max;
+        }
+        range_ = new Range(RangeBoundary::FromConstant(0),
+                           RangeBoundary::FromConstant(max));
+        return;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  range_ = Range::Unknown();
+}
+
+
+void ConstraintInstr::InferRange() {
+  Range* value_range = value()->definition()->range();
+  if (value_range == NULL) value_range = Range::Unknown();
+  // Intersect the range of the value with the constraint.  If the bounds
+  // cannot be compared, either one is correct: keep the symbolic upper bound
+  // of the constraint and the constant lower bound.
+  const RangeBoundary& value_min = value_range->min();
+  const RangeBoundary& value_max = value_range->max();
+  const RangeBoundary& constraint_min = constraint()->min();
+  const RangeBoundary& constraint_max = constraint()->max();
+  RangeBoundary min;
+  if (RangeBoundary::IsLessOrEqual(value_min, constraint_min)) {
+    min = constraint_min;
+  } else if (RangeBoundary::IsLessOrEqual(constraint_min, value_min)) {
+    min = value_min;
+  } else {
+    min = constraint_min.IsConstant() ? constraint_min : value_min;
+  }
+  RangeBoundary max;
+  if (RangeBoundary::IsLessOrEqual(constraint_max, value_max)) {
+    max = constraint_max;
+  } else if (RangeBoundary::IsLessOrEqual(value_max, constraint_max)) {
+    max = value_max;
+  } else {
+    max = constraint_max.IsSymbol() ? constraint_max : value_max;
+  }
+  range_ = new Range(min, max);
+}
+
+
 // Shared code generation methods (EmitNativeCode, MakeLocationSummary, and
 // PrepareEntry). Only assembly code that can be shared across all architectures
 // can be used. Machine specific register allocation and code generation
@@ -1462,6 +1903,19 @@ void InstanceCallInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   compiler->AddCurrentDescriptor(PcDescriptors::kDeoptBefore,
                                  deopt_id(),
                                  token_pos());
+  if (compiler->is_optimizing() &&
+      HasICData() &&
+      ic_data()->IsMegamorphic() &&
+      (checked_argument_count() == 1)) {
+    compiler->GenerateMegamorphicInstanceCall(*ic_data(),
+                                              function_name(),
+                                              ArgumentCount(),
+                                              argument_names(),
+                                              deopt_id(),
+                                              token_pos(),
+                                              locs());
+    return;
+  }
   compiler->GenerateInstanceCall(deopt_id(),
                                  token_pos(),
                                  function_name(),
@@ -1518,6 +1972,28 @@ void BooleanNegateInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 }
 
 
+LocationSummary* ConstraintInstr::MakeLocationSummary() const {
+  UNREACHABLE();
+  return NULL;
+}
+
+
+void ConstraintInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  UNREACHABLE();
+}
+
+
+LocationSummary* MaterializeObjectInstr::MakeLocationSummary() const {
+  UNREACHABLE();
+  return NULL;
+}
+
+
+void MaterializeObjectInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  UNREACHABLE();
+}
+
+
 LocationSummary* ChainContextInstr::MakeLocationSummary() const {
   return LocationSummary::Make(1,
                                Location::NoLocation(),
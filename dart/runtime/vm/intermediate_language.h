@@ -27,17 +27,40 @@ class Instruction;
 class LocalVariable;
 
 
-// TODO(srdjan): Add _ByteArrayBase, get:length.
-
 #define RECOGNIZED_LIST(V)                                                     \
   V(ObjectArray, get:length, ObjectArrayLength)                                \
   V(ImmutableArray, get:length, ImmutableArrayLength)                          \
   V(GrowableObjectArray, get:length, GrowableArrayLength)                      \
   V(GrowableObjectArray, get:capacity, GrowableArrayCapacity)                  \
   V(StringBase, get:length, StringBaseLength)                                  \
+  V(_ByteArrayBase, get:length, ByteArrayBaseLength)                           \
   V(_IntegerImplementation, toDouble, IntegerToDouble)                         \
   V(_Double, toDouble, DoubleToDouble)                                         \
   V(::, sqrt, MathSqrt)                                                        \
+  V(Float32x4, Float32x4., Float32x4Constructor)                               \
+  V(Float32x4, Float32x4.zero, Float32x4Zero)                                  \
+  V(Float32x4, Float32x4.splat, Float32x4Splat)                                \
+  V(Float32x4, get:x, Float32x4GetX)                                           \
+  V(Float32x4, get:y, Float32x4GetY)                                           \
+  V(Float32x4, get:z, Float32x4GetZ)                                           \
+  V(Float32x4, get:w, Float32x4GetW)                                           \
+  V(Float32x4, equal, Float32x4Equal)                                          \
+  V(Float32x4, notEqual, Float32x4NotEqual)                                    \
+  V(Float32x4, lessThan, Float32x4LessThan)                                    \
+  V(Float32x4, lessThanOrEqual, Float32x4LessThanOrEqual)                      \
+  V(Float32x4, scale, Float32x4Scale)                                          \
+  V(Float32x4, shuffle, Float32x4Shuffle)                                      \
+  V(Int32x4, Int32x4., Int32x4Constructor)                                     \
+  V(Int32x4, get:x, Int32x4GetX)                                               \
+  V(Int32x4, get:y, Int32x4GetY)                                               \
+  V(Int32x4, get:z, Int32x4GetZ)                                               \
+  V(Int32x4, get:w, Int32x4GetW)                                               \
+  V(Int32x4, shuffle, Int32x4Shuffle)                                          \
+  V(Int32x4, select, Int32x4Select)                                            \
+  V(_Float32Array, getFloat32x4, Float32ArrayGetFloat32x4)                     \
+  V(_Float32Array, setFloat32x4, Float32ArraySetFloat32x4)                     \
+  V(_Int32Array, getInt32x4, Int32ArrayGetInt32x4)                             \
+  V(_Int32Array, setInt32x4, Int32ArraySetInt32x4)                             \
 
 // Class that recognizes the name and owner of a function and returns the
 // corresponding enum. See RECOGNIZED_LIST above for list of recognizable
@@ -124,7 +147,7 @@ class Value : public ZoneAllocated {
 
 
 enum Representation {
-  kTagged, kUnboxedDouble
+  kTagged, kUnboxedDouble, kUnboxedMint, kUnboxedVector
 };
 
 
@@ -214,6 +237,15 @@ class EmbeddedArray<T, 0> {
   M(NativeCall)                                                                \
   M(LoadIndexed)                                                               \
   M(StoreIndexed)                                                              \
+  M(VectorLoadIndexed)                                                         \
+  M(VectorStoreIndexed)                                                        \
+  M(VectorBinaryOp)                                                            \
+  M(VectorBroadcast)                                                           \
+  M(VectorConstruct)                                                           \
+  M(VectorExtractLane)                                                         \
+  M(VectorShuffle)                                                             \
+  M(VectorCompare)                                                             \
+  M(VectorSelect)                                                              \
   M(StoreInstanceField)                                                        \
   M(LoadStaticField)                                                           \
   M(StoreStaticField)                                                          \
@@ -224,6 +256,7 @@ class EmbeddedArray<T, 0> {
   M(AllocateObject)                                                            \
   M(AllocateObjectWithBoundsCheck)                                             \
   M(LoadField)                                                                 \
+  M(LoadClassId)                                                               \
   M(StoreVMField)                                                              \
   M(InstantiateTypeArguments)                                                  \
   M(ExtractConstructorTypeArguments)                                           \
@@ -247,7 +280,13 @@ class EmbeddedArray<T, 0> {
   M(MathSqrt)                                                                  \
   M(UnboxDouble)                                                               \
   M(BoxDouble)                                                                 \
+  M(UnboxInteger)                                                              \
+  M(BoxInteger)                                                                \
+  M(UnboxVector)                                                               \
+  M(BoxVector)                                                                 \
   M(CheckArrayBound)                                                           \
+  M(Constraint)                                                                \
+  M(MaterializeObject)                                                         \
 
 
 #define FORWARD_DECLARATION(type) class type##Instr;
@@ -444,9 +483,14 @@ FOR_EACH_INSTRUCTION(INSTRUCTION_TYPE_CHECK)
   friend class Definition;  // Needed for InsertBefore, InsertAfter.
 
   // Classes that set deopt_id_.
+  friend class InstanceCallInstr;
   friend class UnboxDoubleInstr;
   friend class UnboxedDoubleBinaryOpInstr;
+  friend class UnboxIntegerInstr;
+  friend class BinaryMintOpInstr;
   friend class MathSqrtInstr;
+  friend class VectorBroadcastInstr;
+  friend class VectorConstructInstr;
   friend class CheckClassInstr;
   friend class CheckSmiInstr;
   friend class CheckArrayBoundInstr;
@@ -592,6 +636,8 @@ class BlockEntryInstr : public Instruction {
   virtual intptr_t PredecessorCount() const = 0;
   virtual BlockEntryInstr* PredecessorAt(intptr_t index) const = 0;
   virtual void AddPredecessor(BlockEntryInstr* predecessor) = 0;
+  // Used to discover the blocks of a graph again after it was modified.
+  virtual void ClearPredecessors() = 0;
   virtual void PrepareEntry(FlowGraphCompiler* compiler) = 0;
 
   intptr_t preorder_number() const { return preorder_number_; }
@@ -618,6 +664,7 @@ class BlockEntryInstr : public Instruction {
   void AddDominatedBlock(BlockEntryInstr* block) {
     dominated_blocks_.Add(block);
   }
+  void ClearDominatedBlocks() { dominated_blocks_.Clear(); }
 
   bool Dominates(BlockEntryInstr* other) const;
 
@@ -768,6 +815,7 @@ class GraphEntryInstr : public BlockEntryInstr {
     return NULL;
   }
   virtual void AddPredecessor(BlockEntryInstr* predecessor) { UNREACHABLE(); }
+  virtual void ClearPredecessors() { }
 
   virtual intptr_t SuccessorCount() const;
   virtual BlockEntryInstr* SuccessorAt(intptr_t index) const;
@@ -798,6 +846,7 @@ class GraphEntryInstr : public BlockEntryInstr {
   }
 
   TargetEntryInstr* normal_entry() const { return normal_entry_; }
+  void set_normal_entry(TargetEntryInstr* entry) { normal_entry_ = entry; }
 
   virtual void PrintTo(BufferFormatter* f) const;
   virtual void PrintToVisualizer(BufferFormatter* f) const;
@@ -830,6 +879,7 @@ class JoinEntryInstr : public BlockEntryInstr {
   virtual void AddPredecessor(BlockEntryInstr* predecessor) {
     predecessors_.Add(predecessor);
   }
+  virtual void ClearPredecessors() { predecessors_.Clear(); }
 
   // Returns -1 if pred is not in the list.
   intptr_t IndexOfPredecessor(BlockEntryInstr* pred) const;
@@ -881,6 +931,7 @@ class TargetEntryInstr : public BlockEntryInstr {
     ASSERT(predecessor_ == NULL);
     predecessor_ = predecessor;
   }
+  virtual void ClearPredecessors() { predecessor_ = NULL; }
 
   // Returns true if this Block is an entry of a catch handler.
   bool IsCatchEntry() const {
@@ -907,6 +958,91 @@ class TargetEntryInstr : public BlockEntryInstr {
 };
 
 
+// A bound of the range of a Smi value: a constant, or the value of a Smi
+// definition plus a constant offset.
+class RangeBoundary : public ValueObject {
+ public:
+  enum Kind { kUnknown, kSymbol, kConstant };
+
+  RangeBoundary() : kind_(kUnknown), symbol_(NULL), value_(0) { }
+
+  static RangeBoundary FromConstant(int64_t value) {
+    return RangeBoundary(kConstant, NULL, value);
+  }
+
+  static RangeBoundary FromDefinition(Definition* defn, int64_t offset = 0);
+
+  static RangeBoundary MinSmi() { return FromConstant(Smi::kMinValue); }
+  static RangeBoundary MaxSmi() { return FromConstant(Smi::kMaxValue); }
+
+  bool IsUnknown() const { return kind_ == kUnknown; }
+  bool IsConstant() const { return kind_ == kConstant; }
+  bool IsSymbol() const { return kind_ == kSymbol; }
+
+  // The constant of a constant boundary, or the offset of a symbol.
+  int64_t value() const { return value_; }
+  Definition* symbol() const {
+    ASSERT(IsSymbol());
+    return symbol_;
+  }
+
+  // The boundary shifted by a constant, or overflow if the result may leave
+  // the Smi range.
+  RangeBoundary Add(int64_t offset, const RangeBoundary& overflow) const;
+
+  // Constant boundaries below or above the boundary, using the range of the
+  // symbol.  The range of a symbol without range is the Smi range.
+  RangeBoundary LowerBound() const { return LowerBound(0); }
+  RangeBoundary UpperBound() const { return UpperBound(0); }
+
+  // Returns true if a is known to be less than or equal to b.
+  static bool IsLessOrEqual(const RangeBoundary& a, const RangeBoundary& b);
+
+  // The lower and the higher of two boundaries.  If they cannot be compared,
+  // a constant boundary below, respectively above, both of them.
+  static RangeBoundary Min(const RangeBoundary& a, const RangeBoundary& b);
+  static RangeBoundary Max(const RangeBoundary& a, const RangeBoundary& b);
+
+  bool Equals(const RangeBoundary& other) const;
+
+  void PrintTo(BufferFormatter* f) const;
+
+ private:
+  RangeBoundary(Kind kind, Definition* symbol, int64_t value)
+      : kind_(kind), symbol_(symbol), value_(value) { }
+
+  RangeBoundary LowerBound(intptr_t depth) const;
+  RangeBoundary UpperBound(intptr_t depth) const;
+
+  Kind kind_;
+  Definition* symbol_;
+  int64_t value_;
+};
+
+
+// The range [min, max] of the values of a Smi definition.
+class Range : public ZoneAllocated {
+ public:
+  Range(RangeBoundary min, RangeBoundary max) : min_(min), max_(max) { }
+
+  static Range* Unknown() {
+    return new Range(RangeBoundary::MinSmi(), RangeBoundary::MaxSmi());
+  }
+
+  const RangeBoundary& min() const { return min_; }
+  const RangeBoundary& max() const { return max_; }
+
+  // Returns true if all values of the range are within [min, max].
+  bool IsWithin(int64_t min, int64_t max) const;
+
+  void PrintTo(BufferFormatter* f) const;
+
+ private:
+  RangeBoundary min_;
+  RangeBoundary max_;
+};
+
+
 // Abstract super-class of all instructions that define a value (Bind, Phi).
 class Definition : public Instruction {
  public:
@@ -919,7 +1055,8 @@ class Definition : public Instruction {
         propagated_cid_(kIllegalCid),
         input_use_list_(NULL),
         env_use_list_(NULL),
-        use_kind_(kValue) {  // Phis and parameters rely on this default.
+        use_kind_(kValue),  // Phis and parameters rely on this default.
+        range_(NULL) {
   }
 
   virtual Definition* AsDefinition() { return this; }
@@ -985,6 +1122,13 @@ class Definition : public Instruction {
   // instead of returning the safe default (true).
   virtual bool AffectedBySideEffect() const { return true; }
 
+  // Range of the values of a Smi definition, computed by range analysis.
+  // NULL if not computed.
+  Range* range() const { return range_; }
+
+  // Computes the range of the definition from the ranges of its inputs.
+  virtual void InferRange();
+
   Value* input_use_list() { return input_use_list_; }
   void set_input_use_list(Value* head) { input_use_list_ = head; }
 
@@ -1053,6 +1197,10 @@ class Definition : public Instruction {
   Value* env_use_list_;
   UseKind use_kind_;
 
+ protected:
+  Range* range_;
+
+ private:
   DISALLOW_COPY_AND_ASSIGN(Definition);
 };
 
@@ -1086,6 +1234,8 @@ class PhiInstr : public Definition {
 
   virtual bool CanDeoptimize() const { return false; }
 
+  virtual void InferRange();
+
   // TODO(regis): This helper will be removed once we support type sets.
   RawAbstractType* LeastSpecificInputType() const;
 
@@ -1472,6 +1622,8 @@ class ConstantInstr : public TemplateDefinition<0> {
 
   virtual bool AttributesEqual(Definition* other) const;
 
+  virtual void InferRange();
+
  private:
   const Object& value_;
 
@@ -1698,6 +1850,21 @@ class InstanceCallInstr : public TemplateDefinition<0> {
            token_kind == Token::kILLEGAL);
   }
 
+  // A copy of the call passing the given arguments.  The copy has the
+  // deoptimization id and the IC data of the call.
+  InstanceCallInstr(const InstanceCallInstr* call,
+                    ZoneGrowableArray<PushArgumentInstr*>* arguments)
+      : ic_data_(call->ic_data_),
+        token_pos_(call->token_pos_),
+        function_name_(call->function_name_),
+        token_kind_(call->token_kind_),
+        arguments_(arguments),
+        argument_names_(call->argument_names_),
+        checked_argument_count_(call->checked_argument_count_) {
+    ASSERT(arguments->length() == call->ArgumentCount());
+    deopt_id_ = call->deopt_id();
+  }
+
   DECLARE_INSTRUCTION(InstanceCall)
   virtual RawAbstractType* CompileType() const;
 
@@ -2220,9 +2387,13 @@ class StoreStaticFieldInstr : public TemplateDefinition<1> {
 };
 
 
+// Loads an element of an array whose class id is known.  Elements of
+// float arrays are loaded as unboxed doubles, elements of Int32 arrays as
+// Smis.
 class LoadIndexedInstr : public TemplateDefinition<2> {
  public:
-  LoadIndexedInstr(Value* array, Value* index) {
+  LoadIndexedInstr(Value* array, Value* index, intptr_t class_id)
+      : class_id_(class_id) {
     ASSERT(array != NULL);
     ASSERT(index != NULL);
     inputs_[0] = array;
@@ -2234,11 +2405,22 @@ class LoadIndexedInstr : public TemplateDefinition<2> {
 
   Value* array() const { return inputs_[0]; }
   Value* index() const { return inputs_[1]; }
+  intptr_t class_id() const { return class_id_; }
 
   virtual bool CanDeoptimize() const { return false; }
-  virtual intptr_t ResultCid() const { return kDynamicCid; }
+  virtual intptr_t ResultCid() const;
+
+  virtual Representation representation() const {
+    return IsFloatArrayClassId(class_id()) ? kUnboxedDouble : kTagged;
+  }
+
+  static bool IsFloatArrayClassId(intptr_t class_id) {
+    return (class_id == kFloat32ArrayCid) || (class_id == kFloat64ArrayCid);
+  }
 
  private:
+  const intptr_t class_id_;
+
   DISALLOW_COPY_AND_ASSIGN(LoadIndexedInstr);
 };
 
@@ -2248,8 +2430,10 @@ class StoreIndexedInstr : public TemplateDefinition<3> {
   StoreIndexedInstr(Value* array,
                     Value* index,
                     Value* value,
-                    bool emit_store_barrier)
-      : emit_store_barrier_(emit_store_barrier) {
+                    bool emit_store_barrier,
+                    intptr_t class_id)
+      : emit_store_barrier_(emit_store_barrier),
+        class_id_(class_id) {
     ASSERT(array != NULL);
     ASSERT(index != NULL);
     ASSERT(value != NULL);
@@ -2264,6 +2448,7 @@ class StoreIndexedInstr : public TemplateDefinition<3> {
   Value* array() const { return inputs_[0]; }
   Value* index() const { return inputs_[1]; }
   Value* value() const { return inputs_[2]; }
+  intptr_t class_id() const { return class_id_; }
 
   bool ShouldEmitStoreBarrier() const {
     return value()->NeedsStoreBuffer() && emit_store_barrier_;
@@ -2272,205 +2457,654 @@ class StoreIndexedInstr : public TemplateDefinition<3> {
   virtual bool CanDeoptimize() const { return false; }
   virtual intptr_t ResultCid() const { return kDynamicCid; }
 
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    if ((idx == 2) && LoadIndexedInstr::IsFloatArrayClassId(class_id())) {
+      return kUnboxedDouble;
+    }
+    return kTagged;
+  }
+
  private:
   const bool emit_store_barrier_;
+  const intptr_t class_id_;
 
   DISALLOW_COPY_AND_ASSIGN(StoreIndexedInstr);
 };
 
 
-// Note overrideable, built-in: value? false : true.
-class BooleanNegateInstr : public TemplateDefinition<1> {
+// Vector instructions operate on all elements of a typed array that fit
+// into an xmm register: two Float64, four Float32 or four Int32 elements.
+// They are created by the loop vectorizer and for the operations of the
+// Float32x4 and Int32x4 classes, which box Float32 and Int32 vectors.
+class VectorLoadIndexedInstr : public TemplateDefinition<2> {
  public:
-  explicit BooleanNegateInstr(Value* value) {
-    ASSERT(value != NULL);
-    inputs_[0] = value;
+  VectorLoadIndexedInstr(Value* array, Value* index, intptr_t class_id)
+      : class_id_(class_id) {
+    ASSERT(array != NULL);
+    ASSERT(index != NULL);
+    inputs_[0] = array;
+    inputs_[1] = index;
   }
 
-  DECLARE_INSTRUCTION(BooleanNegate)
+  DECLARE_INSTRUCTION(VectorLoadIndexed)
   virtual RawAbstractType* CompileType() const;
 
-  Value* value() const { return inputs_[0]; }
+  Value* array() const { return inputs_[0]; }
+  Value* index() const { return inputs_[1]; }
+  intptr_t class_id() const { return class_id_; }
 
   virtual bool CanDeoptimize() const { return false; }
-  virtual intptr_t ResultCid() const { return kBoolCid; }
+  virtual intptr_t ResultCid() const { return ValueClassId(class_id()); }
+
+  virtual Representation representation() const {
+    return kUnboxedVector;
+  }
+
+  // The class of the boxed vectors of the given typed array class, or
+  // kDynamicCid if these vectors are never boxed.
+  static intptr_t ValueClassId(intptr_t class_id) {
+    switch (class_id) {
+      case kFloat32ArrayCid: return kFloat32x4Cid;
+      case kInt32ArrayCid: return kInt32x4Cid;
+      default: return kDynamicCid;
+    }
+  }
 
  private:
-  DISALLOW_COPY_AND_ASSIGN(BooleanNegateInstr);
+  const intptr_t class_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(VectorLoadIndexedInstr);
 };
 
 
-class InstanceOfInstr : public TemplateDefinition<3> {
+class VectorStoreIndexedInstr : public TemplateDefinition<3> {
  public:
-  InstanceOfInstr(intptr_t token_pos,
-                  Value* value,
-                  Value* instantiator,
-                  Value* instantiator_type_arguments,
-                  const AbstractType& type,
-                  bool negate_result)
-      : token_pos_(token_pos),
-        type_(type),
-        negate_result_(negate_result) {
+  VectorStoreIndexedInstr(Value* array,
+                          Value* index,
+                          Value* value,
+                          intptr_t class_id)
+      : class_id_(class_id) {
+    ASSERT(array != NULL);
+    ASSERT(index != NULL);
     ASSERT(value != NULL);
-    ASSERT(instantiator != NULL);
-    ASSERT(instantiator_type_arguments != NULL);
-    ASSERT(!type.IsNull());
-    inputs_[0] = value;
-    inputs_[1] = instantiator;
-    inputs_[2] = instantiator_type_arguments;
+    inputs_[0] = array;
+    inputs_[1] = index;
+    inputs_[2] = value;
   }
 
-  DECLARE_INSTRUCTION(InstanceOf)
+  DECLARE_INSTRUCTION(VectorStoreIndexed)
   virtual RawAbstractType* CompileType() const;
 
-  Value* value() const { return inputs_[0]; }
-  Value* instantiator() const { return inputs_[1]; }
-  Value* instantiator_type_arguments() const { return inputs_[2]; }
-
-  bool negate_result() const { return negate_result_; }
-  const AbstractType& type() const { return type_; }
-  intptr_t token_pos() const { return token_pos_; }
-
-  virtual void PrintOperandsTo(BufferFormatter* f) const;
+  Value* array() const { return inputs_[0]; }
+  Value* index() const { return inputs_[1]; }
+  Value* value() const { return inputs_[2]; }
+  intptr_t class_id() const { return class_id_; }
 
   virtual bool CanDeoptimize() const { return false; }
-  virtual intptr_t ResultCid() const { return kBoolCid; }
+  virtual intptr_t ResultCid() const { return kDynamicCid; }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    return (idx == 2) ? kUnboxedVector : kTagged;
+  }
 
  private:
-  const intptr_t token_pos_;
-  Value* value_;
-  Value* instantiator_;
-  Value* type_arguments_;
-  const AbstractType& type_;
-  const bool negate_result_;
+  const intptr_t class_id_;
 
-  DISALLOW_COPY_AND_ASSIGN(InstanceOfInstr);
+  DISALLOW_COPY_AND_ASSIGN(VectorStoreIndexedInstr);
 };
 
 
-class AllocateObjectInstr : public TemplateDefinition<0> {
+// Element-wise operation on vectors of the given typed array class.
+class VectorBinaryOpInstr : public TemplateDefinition<2> {
  public:
-  AllocateObjectInstr(ConstructorCallNode* node,
-                      ZoneGrowableArray<PushArgumentInstr*>* arguments)
-      : ast_node_(*node), arguments_(arguments) {
-    // Either no arguments or one type-argument and one instantiator.
-    ASSERT(arguments->is_empty() || (arguments->length() == 2));
+  VectorBinaryOpInstr(Token::Kind op_kind,
+                      Value* left,
+                      Value* right,
+                      intptr_t class_id)
+      : op_kind_(op_kind), class_id_(class_id) {
+    ASSERT(left != NULL);
+    ASSERT(right != NULL);
+    inputs_[0] = left;
+    inputs_[1] = right;
   }
 
-  DECLARE_INSTRUCTION(AllocateObject)
-  virtual RawAbstractType* CompileType() const;
-
-  virtual intptr_t ArgumentCount() const { return arguments_->length(); }
-  PushArgumentInstr* ArgumentAt(intptr_t index) const {
-    return (*arguments_)[index];
-  }
+  Value* left() const { return inputs_[0]; }
+  Value* right() const { return inputs_[1]; }
 
-  const Function& constructor() const { return ast_node_.constructor(); }
-  intptr_t token_pos() const { return ast_node_.token_pos(); }
+  Token::Kind op_kind() const { return op_kind_; }
+  intptr_t class_id() const { return class_id_; }
 
   virtual void PrintOperandsTo(BufferFormatter* f) const;
 
   virtual bool CanDeoptimize() const { return false; }
-  virtual intptr_t ResultCid() const { return kDynamicCid; }
+  virtual bool AffectedBySideEffect() const { return false; }
 
- private:
-  const ConstructorCallNode& ast_node_;
-  ZoneGrowableArray<PushArgumentInstr*>* const arguments_;
+  virtual bool AttributesEqual(Definition* other) const {
+    VectorBinaryOpInstr* other_op = other->AsVectorBinaryOp();
+    return (op_kind() == other_op->op_kind()) &&
+        (class_id() == other_op->class_id());
+  }
 
-  DISALLOW_COPY_AND_ASSIGN(AllocateObjectInstr);
-};
+  virtual intptr_t ResultCid() const {
+    return VectorLoadIndexedInstr::ValueClassId(class_id());
+  }
 
+  virtual Representation representation() const {
+    return kUnboxedVector;
+  }
 
-class AllocateObjectWithBoundsCheckInstr : public TemplateDefinition<2> {
- public:
-  AllocateObjectWithBoundsCheckInstr(ConstructorCallNode* node,
-                                     Value* type_arguments,
-                                     Value* instantiator)
-      : ast_node_(*node) {
-    ASSERT(type_arguments != NULL);
-    ASSERT(instantiator != NULL);
-    inputs_[0] = type_arguments;
-    inputs_[1] = instantiator;
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT((idx == 0) || (idx == 1));
+    return kUnboxedVector;
   }
 
-  DECLARE_INSTRUCTION(AllocateObjectWithBoundsCheck)
+  DECLARE_INSTRUCTION(VectorBinaryOp)
   virtual RawAbstractType* CompileType() const;
 
-  const Function& constructor() const { return ast_node_.constructor(); }
-  intptr_t token_pos() const { return ast_node_.token_pos(); }
-
-  virtual void PrintOperandsTo(BufferFormatter* f) const;
-
-  virtual bool CanDeoptimize() const { return false; }
-  virtual intptr_t ResultCid() const { return kDynamicCid; }
-
  private:
-  const ConstructorCallNode& ast_node_;
+  const Token::Kind op_kind_;
+  const intptr_t class_id_;
 
-  DISALLOW_COPY_AND_ASSIGN(AllocateObjectWithBoundsCheckInstr);
+  DISALLOW_COPY_AND_ASSIGN(VectorBinaryOpInstr);
 };
 
 
-class CreateArrayInstr : public TemplateDefinition<1> {
+// Replicates a value into all elements of a vector: an unboxed double for
+// Float64 and Float32 vectors and a Smi for Int32 vectors.  The deopt id is
+// the one of the call the instruction replaces, if any, and is the target of
+// the unboxing of its input.
+class VectorBroadcastInstr : public TemplateDefinition<1> {
  public:
-  CreateArrayInstr(intptr_t token_pos,
-                   ZoneGrowableArray<PushArgumentInstr*>* arguments,
-                   const AbstractType& type,
-                   Value* element_type)
-      : token_pos_(token_pos),
-        arguments_(arguments),
-        type_(type) {
-#if defined(DEBUG)
-    for (int i = 0; i < ArgumentCount(); ++i) {
-      ASSERT(ArgumentAt(i) != NULL);
-    }
-    ASSERT(element_type != NULL);
-    ASSERT(type_.IsZoneHandle());
-    ASSERT(!type_.IsNull());
-    ASSERT(type_.IsFinalized());
-#endif
-    inputs_[0] = element_type;
+  VectorBroadcastInstr(Value* value, intptr_t class_id, intptr_t deopt_id)
+      : class_id_(class_id) {
+    ASSERT(value != NULL);
+    ASSERT((class_id == kFloat64ArrayCid) ||
+           (class_id == kFloat32ArrayCid) ||
+           (class_id == kInt32ArrayCid));
+    inputs_[0] = value;
+    deopt_id_ = deopt_id;
   }
 
-  DECLARE_INSTRUCTION(CreateArray)
-  virtual RawAbstractType* CompileType() const;
+  Value* value() const { return inputs_[0]; }
+  intptr_t class_id() const { return class_id_; }
 
-  virtual intptr_t ArgumentCount() const { return arguments_->length(); }
+  virtual bool CanDeoptimize() const { return false; }
+  virtual bool AffectedBySideEffect() const { return false; }
 
-  intptr_t token_pos() const { return token_pos_; }
-  PushArgumentInstr* ArgumentAt(intptr_t i) const { return (*arguments_)[i]; }
-  const AbstractType& type() const { return type_; }
-  Value* element_type() const { return inputs_[0]; }
+  virtual bool AttributesEqual(Definition* other) const {
+    return class_id() == other->AsVectorBroadcast()->class_id();
+  }
 
-  virtual void PrintOperandsTo(BufferFormatter* f) const;
+  virtual intptr_t ResultCid() const {
+    return VectorLoadIndexedInstr::ValueClassId(class_id());
+  }
 
-  virtual bool CanDeoptimize() const { return false; }
-  virtual intptr_t ResultCid() const { return kDynamicCid; }
+  virtual Representation representation() const {
+    return kUnboxedVector;
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT(idx == 0);
+    return (class_id() == kInt32ArrayCid) ? kTagged : kUnboxedDouble;
+  }
+
+  virtual intptr_t DeoptimizationTarget() const {
+    // Direct access since this instruction cannot deoptimize.
+    return deopt_id_;
+  }
+
+  DECLARE_INSTRUCTION(VectorBroadcast)
+  virtual RawAbstractType* CompileType() const;
 
  private:
-  const intptr_t token_pos_;
-  ZoneGrowableArray<PushArgumentInstr*>* const arguments_;
-  const AbstractType& type_;
+  const intptr_t class_id_;
 
-  DISALLOW_COPY_AND_ASSIGN(CreateArrayInstr);
+  DISALLOW_COPY_AND_ASSIGN(VectorBroadcastInstr);
 };
 
 
-class CreateClosureInstr : public TemplateDefinition<0> {
+// Builds a Float32 vector from four unboxed doubles or an Int32 vector from
+// the low 32 bits of four Smis.
+class VectorConstructInstr : public TemplateDefinition<4> {
  public:
-  CreateClosureInstr(ClosureNode* node,
-                     ZoneGrowableArray<PushArgumentInstr*>* arguments)
-      : ast_node_(*node),
-        arguments_(arguments) { }
+  VectorConstructInstr(Value* x,
+                       Value* y,
+                       Value* z,
+                       Value* w,
+                       intptr_t class_id,
+                       intptr_t deopt_id)
+      : class_id_(class_id) {
+    ASSERT((class_id == kFloat32ArrayCid) || (class_id == kInt32ArrayCid));
+    ASSERT((x != NULL) && (y != NULL) && (z != NULL) && (w != NULL));
+    inputs_[0] = x;
+    inputs_[1] = y;
+    inputs_[2] = z;
+    inputs_[3] = w;
+    deopt_id_ = deopt_id;
+  }
 
-  DECLARE_INSTRUCTION(CreateClosure)
-  virtual RawAbstractType* CompileType() const;
+  intptr_t class_id() const { return class_id_; }
 
-  intptr_t token_pos() const { return ast_node_.token_pos(); }
-  const Function& function() const { return ast_node_.function(); }
+  virtual bool CanDeoptimize() const { return false; }
+  virtual bool AffectedBySideEffect() const { return false; }
 
-  virtual intptr_t ArgumentCount() const { return arguments_->length(); }
-  PushArgumentInstr* ArgumentAt(intptr_t index) const {
+  virtual bool AttributesEqual(Definition* other) const {
+    return class_id() == other->AsVectorConstruct()->class_id();
+  }
+
+  virtual intptr_t ResultCid() const {
+    return VectorLoadIndexedInstr::ValueClassId(class_id());
+  }
+
+  virtual Representation representation() const {
+    return kUnboxedVector;
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT((idx >= 0) && (idx < 4));
+    return (class_id() == kInt32ArrayCid) ? kTagged : kUnboxedDouble;
+  }
+
+  virtual intptr_t DeoptimizationTarget() const {
+    // Direct access since this instruction cannot deoptimize.
+    return deopt_id_;
+  }
+
+  DECLARE_INSTRUCTION(VectorConstruct)
+  virtual RawAbstractType* CompileType() const;
+
+ private:
+  const intptr_t class_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(VectorConstructInstr);
+};
+
+
+// Extracts one element of a Float32 vector as an unboxed double or of an
+// Int32 vector as a Smi.  The latter requires Smis of at least 32 bits.
+class VectorExtractLaneInstr : public TemplateDefinition<1> {
+ public:
+  VectorExtractLaneInstr(Value* value, intptr_t lane, intptr_t class_id)
+      : lane_(lane), class_id_(class_id) {
+    ASSERT(value != NULL);
+    ASSERT((lane >= 0) && (lane < 4));
+    ASSERT((class_id == kFloat32ArrayCid) ||
+           ((class_id == kInt32ArrayCid) && (kSmiBits >= 32)));
+    inputs_[0] = value;
+  }
+
+  Value* value() const { return inputs_[0]; }
+  intptr_t lane() const { return lane_; }
+  intptr_t class_id() const { return class_id_; }
+
+  virtual void PrintOperandsTo(BufferFormatter* f) const;
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual bool AffectedBySideEffect() const { return false; }
+
+  virtual bool AttributesEqual(Definition* other) const {
+    VectorExtractLaneInstr* other_extract = other->AsVectorExtractLane();
+    return (lane() == other_extract->lane()) &&
+        (class_id() == other_extract->class_id());
+  }
+
+  virtual intptr_t ResultCid() const {
+    return (class_id() == kInt32ArrayCid) ? kSmiCid : kDoubleCid;
+  }
+
+  virtual Representation representation() const {
+    return (class_id() == kInt32ArrayCid) ? kTagged : kUnboxedDouble;
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT(idx == 0);
+    return kUnboxedVector;
+  }
+
+  DECLARE_INSTRUCTION(VectorExtractLane)
+  virtual RawAbstractType* CompileType() const;
+
+ private:
+  const intptr_t lane_;
+  const intptr_t class_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(VectorExtractLaneInstr);
+};
+
+
+// Element i of the result is the element of the value selected by bits 2i
+// and 2i+1 of the mask.
+class VectorShuffleInstr : public TemplateDefinition<1> {
+ public:
+  VectorShuffleInstr(Value* value, intptr_t mask, intptr_t class_id)
+      : mask_(mask), class_id_(class_id) {
+    ASSERT(value != NULL);
+    ASSERT((mask >= 0) && (mask <= 0xFF));
+    ASSERT((class_id == kFloat32ArrayCid) || (class_id == kInt32ArrayCid));
+    inputs_[0] = value;
+  }
+
+  Value* value() const { return inputs_[0]; }
+  intptr_t mask() const { return mask_; }
+  intptr_t class_id() const { return class_id_; }
+
+  virtual void PrintOperandsTo(BufferFormatter* f) const;
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual bool AffectedBySideEffect() const { return false; }
+
+  virtual bool AttributesEqual(Definition* other) const {
+    VectorShuffleInstr* other_shuffle = other->AsVectorShuffle();
+    return (mask() == other_shuffle->mask()) &&
+        (class_id() == other_shuffle->class_id());
+  }
+
+  virtual intptr_t ResultCid() const {
+    return VectorLoadIndexedInstr::ValueClassId(class_id());
+  }
+
+  virtual Representation representation() const {
+    return kUnboxedVector;
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT(idx == 0);
+    return kUnboxedVector;
+  }
+
+  DECLARE_INSTRUCTION(VectorShuffle)
+  virtual RawAbstractType* CompileType() const;
+
+ private:
+  const intptr_t mask_;
+  const intptr_t class_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(VectorShuffleInstr);
+};
+
+
+// Compares the elements of two Float32 vectors.  Each element of the
+// resulting Int32 vector is all ones if the comparison holds, zero
+// otherwise.  Comparisons involving NaN only hold for kNE.
+class VectorCompareInstr : public TemplateDefinition<2> {
+ public:
+  VectorCompareInstr(Token::Kind kind, Value* left, Value* right)
+      : kind_(kind) {
+    ASSERT((kind == Token::kEQ) || (kind == Token::kNE) ||
+           (kind == Token::kLT) || (kind == Token::kLTE));
+    ASSERT(left != NULL);
+    ASSERT(right != NULL);
+    inputs_[0] = left;
+    inputs_[1] = right;
+  }
+
+  Value* left() const { return inputs_[0]; }
+  Value* right() const { return inputs_[1]; }
+  Token::Kind kind() const { return kind_; }
+
+  virtual void PrintOperandsTo(BufferFormatter* f) const;
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual bool AffectedBySideEffect() const { return false; }
+
+  virtual bool AttributesEqual(Definition* other) const {
+    return kind() == other->AsVectorCompare()->kind();
+  }
+
+  virtual intptr_t ResultCid() const { return kInt32x4Cid; }
+
+  virtual Representation representation() const {
+    return kUnboxedVector;
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT((idx == 0) || (idx == 1));
+    return kUnboxedVector;
+  }
+
+  DECLARE_INSTRUCTION(VectorCompare)
+  virtual RawAbstractType* CompileType() const;
+
+ private:
+  const Token::Kind kind_;
+
+  DISALLOW_COPY_AND_ASSIGN(VectorCompareInstr);
+};
+
+
+// Merges two Float32 vectors bitwise: a bit of the result is taken from the
+// true value where the bit of the Int32 mask is set, from the false value
+// otherwise.
+class VectorSelectInstr : public TemplateDefinition<3> {
+ public:
+  VectorSelectInstr(Value* mask, Value* true_value, Value* false_value) {
+    ASSERT(mask != NULL);
+    ASSERT(true_value != NULL);
+    ASSERT(false_value != NULL);
+    inputs_[0] = mask;
+    inputs_[1] = true_value;
+    inputs_[2] = false_value;
+  }
+
+  Value* mask() const { return inputs_[0]; }
+  Value* true_value() const { return inputs_[1]; }
+  Value* false_value() const { return inputs_[2]; }
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual bool AffectedBySideEffect() const { return false; }
+  virtual bool AttributesEqual(Definition* other) const { return true; }
+
+  virtual intptr_t ResultCid() const { return kFloat32x4Cid; }
+
+  virtual Representation representation() const {
+    return kUnboxedVector;
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT((idx >= 0) && (idx < 3));
+    return kUnboxedVector;
+  }
+
+  DECLARE_INSTRUCTION(VectorSelect)
+  virtual RawAbstractType* CompileType() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(VectorSelectInstr);
+};
+
+
+// Note overrideable, built-in: value? false : true.
+class BooleanNegateInstr : public TemplateDefinition<1> {
+ public:
+  explicit BooleanNegateInstr(Value* value) {
+    ASSERT(value != NULL);
+    inputs_[0] = value;
+  }
+
+  DECLARE_INSTRUCTION(BooleanNegate)
+  virtual RawAbstractType* CompileType() const;
+
+  Value* value() const { return inputs_[0]; }
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual intptr_t ResultCid() const { return kBoolCid; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BooleanNegateInstr);
+};
+
+
+class InstanceOfInstr : public TemplateDefinition<3> {
+ public:
+  InstanceOfInstr(intptr_t token_pos,
+                  Value* value,
+                  Value* instantiator,
+                  Value* instantiator_type_arguments,
+                  const AbstractType& type,
+                  bool negate_result)
+      : token_pos_(token_pos),
+        type_(type),
+        negate_result_(negate_result) {
+    ASSERT(value != NULL);
+    ASSERT(instantiator != NULL);
+    ASSERT(instantiator_type_arguments != NULL);
+    ASSERT(!type.IsNull());
+    inputs_[0] = value;
+    inputs_[1] = instantiator;
+    inputs_[2] = instantiator_type_arguments;
+  }
+
+  DECLARE_INSTRUCTION(InstanceOf)
+  virtual RawAbstractType* CompileType() const;
+
+  Value* value() const { return inputs_[0]; }
+  Value* instantiator() const { return inputs_[1]; }
+  Value* instantiator_type_arguments() const { return inputs_[2]; }
+
+  bool negate_result() const { return negate_result_; }
+  const AbstractType& type() const { return type_; }
+  intptr_t token_pos() const { return token_pos_; }
+
+  virtual void PrintOperandsTo(BufferFormatter* f) const;
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual intptr_t ResultCid() const { return kBoolCid; }
+
+ private:
+  const intptr_t token_pos_;
+  Value* value_;
+  Value* instantiator_;
+  Value* type_arguments_;
+  const AbstractType& type_;
+  const bool negate_result_;
+
+  DISALLOW_COPY_AND_ASSIGN(InstanceOfInstr);
+};
+
+
+class AllocateObjectInstr : public TemplateDefinition<0> {
+ public:
+  AllocateObjectInstr(ConstructorCallNode* node,
+                      ZoneGrowableArray<PushArgumentInstr*>* arguments)
+      : ast_node_(*node), arguments_(arguments) {
+    // Either no arguments or one type-argument and one instantiator.
+    ASSERT(arguments->is_empty() || (arguments->length() == 2));
+  }
+
+  DECLARE_INSTRUCTION(AllocateObject)
+  virtual RawAbstractType* CompileType() const;
+
+  virtual intptr_t ArgumentCount() const { return arguments_->length(); }
+  PushArgumentInstr* ArgumentAt(intptr_t index) const {
+    return (*arguments_)[index];
+  }
+
+  const Function& constructor() const { return ast_node_.constructor(); }
+  intptr_t token_pos() const { return ast_node_.token_pos(); }
+
+  virtual void PrintOperandsTo(BufferFormatter* f) const;
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual intptr_t ResultCid() const { return kDynamicCid; }
+
+ private:
+  const ConstructorCallNode& ast_node_;
+  ZoneGrowableArray<PushArgumentInstr*>* const arguments_;
+
+  DISALLOW_COPY_AND_ASSIGN(AllocateObjectInstr);
+};
+
+
+class AllocateObjectWithBoundsCheckInstr : public TemplateDefinition<2> {
+ public:
+  AllocateObjectWithBoundsCheckInstr(ConstructorCallNode* node,
+                                     Value* type_arguments,
+                                     Value* instantiator)
+      : ast_node_(*node) {
+    ASSERT(type_arguments != NULL);
+    ASSERT(instantiator != NULL);
+    inputs_[0] = type_arguments;
+    inputs_[1] = instantiator;
+  }
+
+  DECLARE_INSTRUCTION(AllocateObjectWithBoundsCheck)
+  virtual RawAbstractType* CompileType() const;
+
+  const Function& constructor() const { return ast_node_.constructor(); }
+  intptr_t token_pos() const { return ast_node_.token_pos(); }
+
+  virtual void PrintOperandsTo(BufferFormatter* f) const;
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual intptr_t ResultCid() const { return kDynamicCid; }
+
+ private:
+  const ConstructorCallNode& ast_node_;
+
+  DISALLOW_COPY_AND_ASSIGN(AllocateObjectWithBoundsCheckInstr);
+};
+
+
+class CreateArrayInstr : public TemplateDefinition<1> {
+ public:
+  CreateArrayInstr(intptr_t token_pos,
+                   ZoneGrowableArray<PushArgumentInstr*>* arguments,
+                   const AbstractType& type,
+                   Value* element_type)
+      : token_pos_(token_pos),
+        arguments_(arguments),
+        type_(type) {
+#if defined(DEBUG)
+    for (int i = 0; i < ArgumentCount(); ++i) {
+      ASSERT(ArgumentAt(i) != NULL);
+    }
+    ASSERT(element_type != NULL);
+    ASSERT(type_.IsZoneHandle());
+    ASSERT(!type_.IsNull());
+    ASSERT(type_.IsFinalized());
+#endif
+    inputs_[0] = element_type;
+  }
+
+  DECLARE_INSTRUCTION(CreateArray)
+  virtual RawAbstractType* CompileType() const;
+
+  virtual intptr_t ArgumentCount() const { return arguments_->length(); }
+
+  intptr_t token_pos() const { return token_pos_; }
+  PushArgumentInstr* ArgumentAt(intptr_t i) const { return (*arguments_)[i]; }
+  const AbstractType& type() const { return type_; }
+  Value* element_type() const { return inputs_[0]; }
+
+  virtual void PrintOperandsTo(BufferFormatter* f) const;
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual intptr_t ResultCid() const { return kDynamicCid; }
+
+ private:
+  const intptr_t token_pos_;
+  ZoneGrowableArray<PushArgumentInstr*>* const arguments_;
+  const AbstractType& type_;
+
+  DISALLOW_COPY_AND_ASSIGN(CreateArrayInstr);
+};
+
+
+class CreateClosureInstr : public TemplateDefinition<0> {
+ public:
+  CreateClosureInstr(ClosureNode* node,
+                     ZoneGrowableArray<PushArgumentInstr*>* arguments)
+      : ast_node_(*node),
+        arguments_(arguments) { }
+
+  DECLARE_INSTRUCTION(CreateClosure)
+  virtual RawAbstractType* CompileType() const;
+
+  intptr_t token_pos() const { return ast_node_.token_pos(); }
+  const Function& function() const { return ast_node_.function(); }
+
+  virtual intptr_t ArgumentCount() const { return arguments_->length(); }
+  PushArgumentInstr* ArgumentAt(intptr_t index) const {
     return (*arguments_)[index];
   }
 
@@ -2496,7 +3130,8 @@ class LoadFieldInstr : public TemplateDefinition<1> {
       : offset_in_bytes_(offset_in_bytes),
         type_(type),
         result_cid_(kDynamicCid),
-        immutable_(immutable) {
+        immutable_(immutable),
+        recognized_kind_(MethodRecognizer::kUnknown) {
     ASSERT(value != NULL);
     ASSERT(type.IsZoneHandle());  // May be null if field is not an instance.
     inputs_[0] = value;
@@ -2519,16 +3154,51 @@ class LoadFieldInstr : public TemplateDefinition<1> {
 
   virtual bool AffectedBySideEffect() const { return !immutable_; }
 
+  // The recognized getter the load implements, e.g. a length getter.
+  void set_recognized_kind(MethodRecognizer::Kind kind) {
+    recognized_kind_ = kind;
+  }
+  MethodRecognizer::Kind recognized_kind() const { return recognized_kind_; }
+
+  virtual void InferRange();
+
  private:
   const intptr_t offset_in_bytes_;
   const AbstractType& type_;
   intptr_t result_cid_;
   const bool immutable_;
+  MethodRecognizer::Kind recognized_kind_;
 
   DISALLOW_COPY_AND_ASSIGN(LoadFieldInstr);
 };
 
 
+// Loads the class id of an object as a Smi.  The class id of a Smi is
+// kSmiCid.
+class LoadClassIdInstr : public TemplateDefinition<1> {
+ public:
+  explicit LoadClassIdInstr(Value* object) {
+    ASSERT(object != NULL);
+    inputs_[0] = object;
+  }
+
+  DECLARE_INSTRUCTION(LoadClassId)
+  virtual RawAbstractType* CompileType() const;
+
+  Value* object() const { return inputs_[0]; }
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual intptr_t ResultCid() const { return kSmiCid; }
+
+  virtual bool AttributesEqual(Definition* other) const { return true; }
+
+  virtual bool AffectedBySideEffect() const { return false; }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(LoadClassIdInstr);
+};
+
+
 class StoreVMFieldInstr : public TemplateDefinition<2> {
  public:
   StoreVMFieldInstr(Value* dest,
@@ -2854,6 +3524,132 @@ class UnboxDoubleInstr : public TemplateDefinition<1> {
 };
 
 
+class BoxIntegerInstr : public TemplateDefinition<1> {
+ public:
+  explicit BoxIntegerInstr(Value* value) {
+    ASSERT(value != NULL);
+    inputs_[0] = value;
+  }
+
+  Value* value() const { return inputs_[0]; }
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual bool AffectedBySideEffect() const { return false; }
+  virtual bool AttributesEqual(Definition* other) const { return true; }
+
+  // The result is a Smi if the value fits, a Mint otherwise.
+  virtual intptr_t ResultCid() const { return kDynamicCid; }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT(idx == 0);
+    return kUnboxedMint;
+  }
+
+  DECLARE_INSTRUCTION(BoxInteger)
+  virtual RawAbstractType* CompileType() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BoxIntegerInstr);
+};
+
+
+class UnboxIntegerInstr : public TemplateDefinition<1> {
+ public:
+  UnboxIntegerInstr(Value* value, intptr_t deopt_id) {
+    ASSERT(value != NULL);
+    inputs_[0] = value;
+    deopt_id_ = deopt_id;
+  }
+
+  Value* value() const { return inputs_[0]; }
+
+  virtual bool CanDeoptimize() const {
+    return (value()->ResultCid() != kSmiCid) &&
+           (value()->ResultCid() != kMintCid);
+  }
+
+  virtual intptr_t ResultCid() const { return kDynamicCid; }
+
+  virtual Representation representation() const {
+    return kUnboxedMint;
+  }
+
+  virtual bool AffectedBySideEffect() const { return false; }
+  virtual bool AttributesEqual(Definition* other) const { return true; }
+
+  DECLARE_INSTRUCTION(UnboxInteger)
+  virtual RawAbstractType* CompileType() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(UnboxIntegerInstr);
+};
+
+
+// Boxes a Float32 or Int32 vector as a Float32x4 or Int32x4 instance.
+class BoxVectorInstr : public TemplateDefinition<1> {
+ public:
+  BoxVectorInstr(Value* value, intptr_t class_id)
+      : class_id_(class_id) {
+    ASSERT(value != NULL);
+    ASSERT((class_id == kFloat32x4Cid) || (class_id == kInt32x4Cid));
+    inputs_[0] = value;
+  }
+
+  Value* value() const { return inputs_[0]; }
+  intptr_t class_id() const { return class_id_; }
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual bool AffectedBySideEffect() const { return false; }
+
+  virtual bool AttributesEqual(Definition* other) const {
+    return class_id() == other->AsBoxVector()->class_id();
+  }
+
+  virtual intptr_t ResultCid() const { return class_id(); }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT(idx == 0);
+    return kUnboxedVector;
+  }
+
+  DECLARE_INSTRUCTION(BoxVector)
+  virtual RawAbstractType* CompileType() const;
+
+ private:
+  const intptr_t class_id_;
+
+  DISALLOW_COPY_AND_ASSIGN(BoxVectorInstr);
+};
+
+
+// Unboxes a Float32x4 or Int32x4 instance.  The value is not checked: the
+// optimizer guards every tagged input of a vector instruction with a class
+// check, so the instruction must not be moved above that check.
+class UnboxVectorInstr : public TemplateDefinition<1> {
+ public:
+  explicit UnboxVectorInstr(Value* value) {
+    ASSERT(value != NULL);
+    inputs_[0] = value;
+  }
+
+  Value* value() const { return inputs_[0]; }
+
+  virtual bool CanDeoptimize() const { return false; }
+
+  virtual intptr_t ResultCid() const { return value()->ResultCid(); }
+
+  virtual Representation representation() const {
+    return kUnboxedVector;
+  }
+
+  DECLARE_INSTRUCTION(UnboxVector)
+  virtual RawAbstractType* CompileType() const;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(UnboxVectorInstr);
+};
+
+
 class MathSqrtInstr : public TemplateDefinition<1> {
  public:
   MathSqrtInstr(Value* value, StaticCallInstr* instance_call) {
@@ -2960,7 +3756,8 @@ class BinarySmiOpInstr : public TemplateDefinition<2> {
                    Value* left,
                    Value* right)
       : op_kind_(op_kind),
-        instance_call_(instance_call) {
+        instance_call_(instance_call),
+        overflow_(true) {
     ASSERT(left != NULL);
     ASSERT(right != NULL);
     inputs_[0] = left;
@@ -2976,6 +3773,11 @@ class BinarySmiOpInstr : public TemplateDefinition<2> {
 
   const ICData* ic_data() const { return instance_call()->ic_data(); }
 
+  // False if the result is known to fit in a Smi, so that additions and
+  // subtractions need no overflow check.
+  bool overflow() const { return overflow_; }
+  void set_overflow(bool overflow) { overflow_ = overflow; }
+
   virtual void PrintOperandsTo(BufferFormatter* f) const;
 
   DECLARE_INSTRUCTION(BinarySmiOp)
@@ -2985,26 +3787,31 @@ class BinarySmiOpInstr : public TemplateDefinition<2> {
 
   virtual intptr_t ResultCid() const;
 
+  virtual void InferRange();
+
  private:
   const Token::Kind op_kind_;
   InstanceCallInstr* instance_call_;
+  bool overflow_;
 
   DISALLOW_COPY_AND_ASSIGN(BinarySmiOpInstr);
 };
 
 
+// Operates on unboxed 64-bit integers.  Additions and subtractions
+// deoptimize when the result does not fit in 64 bits.
 class BinaryMintOpInstr : public TemplateDefinition<2> {
  public:
   BinaryMintOpInstr(Token::Kind op_kind,
                     InstanceCallInstr* instance_call,
                     Value* left,
                     Value* right)
-      : op_kind_(op_kind),
-        instance_call_(instance_call) {
+      : op_kind_(op_kind) {
     ASSERT(left != NULL);
     ASSERT(right != NULL);
     inputs_[0] = left;
     inputs_[1] = right;
+    deopt_id_ = instance_call->deopt_id();
   }
 
   Value* left() const { return inputs_[0]; }
@@ -3012,21 +3819,40 @@ class BinaryMintOpInstr : public TemplateDefinition<2> {
 
   Token::Kind op_kind() const { return op_kind_; }
 
-  InstanceCallInstr* instance_call() const { return instance_call_; }
-
-  const ICData* ic_data() const { return instance_call()->ic_data(); }
-
   virtual void PrintOperandsTo(BufferFormatter* f) const;
 
   DECLARE_INSTRUCTION(BinaryMintOp)
   virtual RawAbstractType* CompileType() const;
 
-  virtual bool CanDeoptimize() const { return true; }
-  virtual intptr_t ResultCid() const;
+  virtual bool CanDeoptimize() const {
+    return (op_kind() == Token::kADD) || (op_kind() == Token::kSUB);
+  }
+
+  virtual bool AffectedBySideEffect() const { return false; }
+
+  virtual bool AttributesEqual(Definition* other) const {
+    return op_kind() == other->AsBinaryMintOp()->op_kind();
+  }
+
+  // The result is a Smi if the value fits, a Mint otherwise.
+  virtual intptr_t ResultCid() const { return kDynamicCid; }
+
+  virtual Representation representation() const {
+    return kUnboxedMint;
+  }
+
+  virtual Representation RequiredInputRepresentation(intptr_t idx) const {
+    ASSERT((idx == 0) || (idx == 1));
+    return kUnboxedMint;
+  }
+
+  virtual intptr_t DeoptimizationTarget() const {
+    // Direct access since this instruction may not deoptimize itself.
+    return deopt_id_;
+  }
 
  private:
   const Token::Kind op_kind_;
-  InstanceCallInstr* instance_call_;
 
   DISALLOW_COPY_AND_ASSIGN(BinaryMintOpInstr);
 };
@@ -3095,11 +3921,19 @@ class NumberNegateInstr : public TemplateDefinition<1> {
 
 class CheckStackOverflowInstr : public TemplateDefinition<0> {
  public:
-  explicit CheckStackOverflowInstr(intptr_t token_pos)
-      : token_pos_(token_pos) {}
+  CheckStackOverflowInstr(intptr_t token_pos, bool in_loop)
+      : token_pos_(token_pos), in_loop_(in_loop) {}
 
   intptr_t token_pos() const { return token_pos_; }
 
+  // True for the checks at the head of loop bodies, which count the
+  // iterations of the loop in unoptimized code.
+  bool in_loop() const { return in_loop_; }
+
+  // Optimized code entered at this check in the frame of unoptimized code
+  // (on-stack replacement) is compiled for this id.
+  intptr_t osr_id() const { return GetDeoptId(); }
+
   DECLARE_INSTRUCTION(CheckStackOverflow)
   virtual RawAbstractType* CompileType() const;
 
@@ -3108,6 +3942,7 @@ class CheckStackOverflowInstr : public TemplateDefinition<0> {
 
  private:
   const intptr_t token_pos_;
+  const bool in_loop_;
 
   DISALLOW_COPY_AND_ASSIGN(CheckStackOverflowInstr);
 };
@@ -3171,6 +4006,16 @@ class CheckClassInstr : public TemplateDefinition<1> {
     deopt_id_ = instance_call->deopt_id();
   }
 
+  CheckClassInstr(Value* value,
+                  intptr_t deopt_id,
+                  const ICData& unary_checks)
+      : unary_checks_(unary_checks) {
+    ASSERT(value != NULL);
+    ASSERT(deopt_id != Isolate::kNoDeoptId);
+    inputs_[0] = value;
+    deopt_id_ = deopt_id;
+  }
+
   DECLARE_INSTRUCTION(CheckClass)
   virtual RawAbstractType* CompileType() const;
 
@@ -3260,6 +4105,87 @@ class CheckArrayBoundInstr : public TemplateDefinition<2> {
 };
 
 
+// Constrains the range of a Smi value in the blocks dominated by the
+// instruction, e.g. by the condition of a branch in its successor.  Only
+// used during range analysis, which removes the constraints afterwards.
+class ConstraintInstr : public TemplateDefinition<1> {
+ public:
+  ConstraintInstr(Value* value, Range* constraint)
+      : constraint_(constraint) {
+    ASSERT(value != NULL);
+    inputs_[0] = value;
+  }
+
+  DECLARE_INSTRUCTION(Constraint)
+  virtual RawAbstractType* CompileType() const;
+
+  Value* value() const { return inputs_[0]; }
+  Range* constraint() const { return constraint_; }
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual intptr_t ResultCid() const { return kSmiCid; }
+
+  virtual void PrintOperandsTo(BufferFormatter* f) const;
+
+  virtual void InferRange();
+
+ private:
+  Range* constraint_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConstraintInstr);
+};
+
+
+// Materializes an allocation removed by allocation sinking when the code
+// deoptimizes.  Only appears in environments, in place of the allocation,
+// with the values of the initialized fields of the object at the
+// deoptimization point as inputs.
+class MaterializeObjectInstr : public Definition {
+ public:
+  MaterializeObjectInstr(const Class& cls,
+                         const ZoneGrowableArray<const Field*>& fields,
+                         ZoneGrowableArray<Value*>* values)
+      : cls_(cls), fields_(fields), values_(values), locations_(NULL) {
+    ASSERT(fields_.length() == values_->length());
+    for (intptr_t i = 0; i < values_->length(); ++i) {
+      (*values_)[i]->set_instruction(this);
+      (*values_)[i]->set_use_index(i);
+    }
+  }
+
+  DECLARE_INSTRUCTION(MaterializeObject)
+  virtual RawAbstractType* CompileType() const;
+
+  const Class& cls() const { return cls_; }
+  const Field& FieldAt(intptr_t i) const { return *fields_[i]; }
+
+  virtual intptr_t InputCount() const { return values_->length(); }
+  virtual Value* InputAt(intptr_t i) const { return (*values_)[i]; }
+  virtual void SetInputAt(intptr_t i, Value* value) { (*values_)[i] = value; }
+
+  // The locations of the inputs, assigned by the register allocator.
+  void set_locations(Location* locations) { locations_ = locations; }
+  bool HasLocations() const { return locations_ != NULL; }
+  Location LocationAt(intptr_t i) const {
+    ASSERT(HasLocations());
+    return locations_[i];
+  }
+
+  virtual bool CanDeoptimize() const { return false; }
+  virtual intptr_t ResultCid() const { return cls_.id(); }
+
+  virtual void PrintOperandsTo(BufferFormatter* f) const;
+
+ private:
+  const Class& cls_;
+  const ZoneGrowableArray<const Field*>& fields_;
+  ZoneGrowableArray<Value*>* values_;
+  Location* locations_;
+
+  DISALLOW_COPY_AND_ASSIGN(MaterializeObjectInstr);
+};
+
+
 #undef DECLARE_INSTRUCTION
 
 class Environment : public ZoneAllocated {
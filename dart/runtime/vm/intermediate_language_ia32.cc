@@ -864,11 +864,13 @@ void NativeCallInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 }
 
 
-static bool CanBeImmediateIndex(Value* index) {
+static bool CanBeImmediateIndex(Value* index, intptr_t class_id) {
   if (!index->definition()->IsConstant()) return false;
   const Object& constant = index->definition()->AsConstant()->value();
   const Smi& smi_const = Smi::Cast(constant);
-  int64_t disp = smi_const.AsInt64Value() * kWordSize + sizeof(RawArray);
+  const intptr_t scale = FlowGraphCompiler::ElementSizeFor(class_id);
+  const intptr_t data_offset = FlowGraphCompiler::DataOffsetFor(class_id);
+  const int64_t disp = smi_const.AsInt64Value() * scale + data_offset;
   return Utils::IsInt(32, disp);
 }
 
@@ -879,28 +881,46 @@ LocationSummary* LoadIndexedInstr::MakeLocationSummary() const {
   LocationSummary* locs =
       new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
   locs->set_in(0, Location::RequiresRegister());
-  locs->set_in(1, CanBeImmediateIndex(index())
+  locs->set_in(1, CanBeImmediateIndex(index(), class_id())
                     ? Location::RegisterOrConstant(index())
                     : Location::RequiresRegister());
-  locs->set_out(Location::RequiresRegister());
+  if (representation() == kUnboxedDouble) {
+    locs->set_out(Location::RequiresXmmRegister());
+  } else {
+    locs->set_out(Location::RequiresRegister());
+  }
   return locs;
 }
 
 
 void LoadIndexedInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   Register array = locs()->in(0).reg();
-  Register result = locs()->out().reg();
   Location index = locs()->in(1);
-  if (index.IsRegister()) {
-    // Note that index is Smi, i.e, times 2.
-    ASSERT(kSmiTagShift == 1);
-    __ movl(result,
-            FieldAddress(array, index.reg(), TIMES_2, sizeof(RawArray)));
-  } else {
-    const int32_t disp =
-        Smi::Cast(index.constant()).Value() * kWordSize + sizeof(RawArray);
-    __ movl(result, FieldAddress(array, disp));
+
+  FieldAddress element_address = index.IsRegister()
+      ? FlowGraphCompiler::ElementAddressForRegIndex(
+          class_id(), array, index.reg())
+      : FlowGraphCompiler::ElementAddressForIntIndex(
+          class_id(), array, Smi::Cast(index.constant()).Value());
+
+  if (representation() == kUnboxedDouble) {
+    XmmRegister result = locs()->out().xmm_reg();
+    if (class_id() == kFloat32ArrayCid) {
+      // Load single precision float and promote it to double.
+      __ movss(result, element_address);
+      __ cvtss2sd(result, result);
+    } else {
+      ASSERT(class_id() == kFloat64ArrayCid);
+      __ movsd(result, element_address);
+    }
+    return;
   }
+
+  // Int32 elements do not always fit into a Smi on ia32, the optimizer
+  // does not specialize loads from Int32 arrays.
+  ASSERT(class_id() == kArrayCid || class_id() == kImmutableArrayCid);
+  Register result = locs()->out().reg();
+  __ movl(result, element_address);
 }
 
 
@@ -910,40 +930,340 @@ LocationSummary* StoreIndexedInstr::MakeLocationSummary() const {
   LocationSummary* locs =
       new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
   locs->set_in(0, Location::RequiresRegister());
-  locs->set_in(1, CanBeImmediateIndex(index())
+  locs->set_in(1, CanBeImmediateIndex(index(), class_id())
                     ? Location::RegisterOrConstant(index())
                     : Location::RequiresRegister());
-  locs->set_in(2, ShouldEmitStoreBarrier()
-                    ? Location::WritableRegister()
-                    : Location::RegisterOrConstant(value()));
+  switch (class_id()) {
+    case kArrayCid:
+      locs->set_in(2, ShouldEmitStoreBarrier()
+                        ? Location::WritableRegister()
+                        : Location::RegisterOrConstant(value()));
+      break;
+    case kInt32ArrayCid:
+      // The value is untagged in place.
+      locs->set_in(2, Location::WritableRegister());
+      break;
+    case kFloat32ArrayCid:
+    case kFloat64ArrayCid:
+      locs->set_in(2, Location::RequiresXmmRegister());
+      break;
+    default:
+      UNREACHABLE();
+  }
   return locs;
 }
 
 
 void StoreIndexedInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   Register array = locs()->in(0).reg();
-
-  // Note that index is Smi, i.e, times 2.
-  ASSERT(kSmiTagShift == 1);
   Location index = locs()->in(1);
-  FieldAddress field_address = index.IsConstant()
-      ? FieldAddress(
-          array,
-          Smi::Cast(index.constant()).Value() * kWordSize + sizeof(RawArray))
-      : FieldAddress(array, index.reg(), TIMES_2, sizeof(RawArray));
 
-  if (ShouldEmitStoreBarrier()) {
-    Register value = locs()->in(2).reg();
-    __ StoreIntoObject(array, field_address, value);
+  FieldAddress element_address = index.IsRegister()
+      ? FlowGraphCompiler::ElementAddressForRegIndex(
+          class_id(), array, index.reg())
+      : FlowGraphCompiler::ElementAddressForIntIndex(
+          class_id(), array, Smi::Cast(index.constant()).Value());
+
+  switch (class_id()) {
+    case kArrayCid:
+      if (ShouldEmitStoreBarrier()) {
+        Register value = locs()->in(2).reg();
+        __ StoreIntoObject(array, element_address, value);
+      } else if (locs()->in(2).IsConstant()) {
+        const Object& constant = locs()->in(2).constant();
+        __ StoreIntoObjectNoBarrier(array, element_address, constant);
+      } else {
+        Register value = locs()->in(2).reg();
+        __ StoreIntoObjectNoBarrier(array, element_address, value);
+      }
+      break;
+    case kInt32ArrayCid: {
+      Register value = locs()->in(2).reg();
+      __ SmiUntag(value);
+      __ movl(element_address, value);
+      break;
+    }
+    case kFloat32ArrayCid:
+      // Convert to single precision, XMM0 is scratch.
+      __ cvtsd2ss(XMM0, locs()->in(2).xmm_reg());
+      __ movss(element_address, XMM0);
+      break;
+    case kFloat64ArrayCid:
+      __ movsd(element_address, locs()->in(2).xmm_reg());
+      break;
+    default:
+      UNREACHABLE();
+  }
+}
+
+
+LocationSummary* VectorLoadIndexedInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 2;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* locs =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  locs->set_in(0, Location::RequiresRegister());
+  locs->set_in(1, Location::RequiresRegister());
+  locs->set_out(Location::RequiresXmmRegister());
+  return locs;
+}
+
+
+void VectorLoadIndexedInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  Register array = locs()->in(0).reg();
+  Register index = locs()->in(1).reg();
+  __ movups(locs()->out().xmm_reg(),
+            FlowGraphCompiler::ElementAddressForRegIndex(
+                class_id(), array, index));
+}
+
+
+LocationSummary* VectorStoreIndexedInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 3;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* locs =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  locs->set_in(0, Location::RequiresRegister());
+  locs->set_in(1, Location::RequiresRegister());
+  locs->set_in(2, Location::RequiresXmmRegister());
+  return locs;
+}
+
+
+void VectorStoreIndexedInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  Register array = locs()->in(0).reg();
+  Register index = locs()->in(1).reg();
+  __ movups(FlowGraphCompiler::ElementAddressForRegIndex(
+                class_id(), array, index),
+            locs()->in(2).xmm_reg());
+}
+
+
+LocationSummary* VectorBinaryOpInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 2;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresXmmRegister());
+  summary->set_in(1, Location::RequiresXmmRegister());
+  summary->set_out(Location::SameAsFirstInput());
+  return summary;
+}
+
+
+void VectorBinaryOpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  XmmRegister left = locs()->in(0).xmm_reg();
+  XmmRegister right = locs()->in(1).xmm_reg();
+
+  ASSERT(locs()->out().xmm_reg() == left);
+
+  switch (class_id()) {
+    case kFloat64ArrayCid:
+      switch (op_kind()) {
+        case Token::kADD: __ addpd(left, right); break;
+        case Token::kSUB: __ subpd(left, right); break;
+        case Token::kMUL: __ mulpd(left, right); break;
+        case Token::kDIV: __ divpd(left, right); break;
+        default: UNREACHABLE();
+      }
+      break;
+    case kFloat32ArrayCid:
+      switch (op_kind()) {
+        case Token::kADD: __ addps(left, right); break;
+        case Token::kSUB: __ subps(left, right); break;
+        case Token::kMUL: __ mulps(left, right); break;
+        case Token::kDIV: __ divps(left, right); break;
+        default: UNREACHABLE();
+      }
+      break;
+    case kInt32ArrayCid:
+      switch (op_kind()) {
+        case Token::kADD: __ paddd(left, right); break;
+        case Token::kSUB: __ psubd(left, right); break;
+        case Token::kBIT_AND: __ pand(left, right); break;
+        case Token::kBIT_OR: __ por(left, right); break;
+        case Token::kBIT_XOR: __ pxor(left, right); break;
+        default: UNREACHABLE();
+      }
+      break;
+    default:
+      UNREACHABLE();
+  }
+}
+
+
+LocationSummary* VectorBroadcastInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  if (class_id() == kInt32ArrayCid) {
+    // The Smi is untagged in place.
+    summary->set_in(0, Location::WritableRegister());
+    summary->set_out(Location::RequiresXmmRegister());
   } else {
-    if (locs()->in(2).IsConstant()) {
-      const Object& constant = locs()->in(2).constant();
-      __ StoreIntoObjectNoBarrier(array, field_address, constant);
+    summary->set_in(0, Location::RequiresXmmRegister());
+    summary->set_out(Location::SameAsFirstInput());
+  }
+  return summary;
+}
+
+
+void VectorBroadcastInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  XmmRegister result = locs()->out().xmm_reg();
+  switch (class_id()) {
+    case kFloat64ArrayCid:
+      ASSERT(locs()->in(0).xmm_reg() == result);
+      __ unpcklpd(result, result);
+      break;
+    case kFloat32ArrayCid:
+      ASSERT(locs()->in(0).xmm_reg() == result);
+      __ cvtsd2ss(result, result);
+      __ pshufd(result, result, Immediate(0));
+      break;
+    case kInt32ArrayCid: {
+      Register value = locs()->in(0).reg();
+      __ SmiUntag(value);
+      __ movd(result, value);
+      __ pshufd(result, result, Immediate(0));
+      break;
+    }
+    default:
+      UNREACHABLE();
+  }
+}
+
+
+LocationSummary* VectorConstructInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 4;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  for (intptr_t i = 0; i < kNumInputs; i++) {
+    // Smis are untagged in place.
+    summary->set_in(i, (class_id() == kInt32ArrayCid)
+                           ? Location::WritableRegister()
+                           : Location::RequiresXmmRegister());
+  }
+  summary->set_out(Location::RequiresXmmRegister());
+  return summary;
+}
+
+
+void VectorConstructInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  // Assemble the elements below the stack pointer, XMM0 is scratch.
+  const intptr_t kElementSize = kQuadSize / 4;
+  __ subl(ESP, Immediate(kQuadSize));
+  for (intptr_t i = 0; i < 4; i++) {
+    const Address element_address(ESP, i * kElementSize);
+    if (class_id() == kInt32ArrayCid) {
+      Register value = locs()->in(i).reg();
+      __ SmiUntag(value);
+      __ movl(element_address, value);
     } else {
-      Register value = locs()->in(2).reg();
-      __ StoreIntoObjectNoBarrier(array, field_address, value);
+      __ cvtsd2ss(XMM0, locs()->in(i).xmm_reg());
+      __ movss(element_address, XMM0);
     }
   }
+  __ movups(locs()->out().xmm_reg(), Address(ESP, 0));
+  __ addl(ESP, Immediate(kQuadSize));
+}
+
+
+LocationSummary* VectorExtractLaneInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresXmmRegister());
+  summary->set_out(Location::RequiresXmmRegister());
+  return summary;
+}
+
+
+void VectorExtractLaneInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  // Move the lane into the lowest element of XMM0, which is scratch.
+  __ pshufd(XMM0, locs()->in(0).xmm_reg(), Immediate(lane()));
+  // Int32 elements do not fit into a Smi.
+  ASSERT(class_id() == kFloat32ArrayCid);
+  __ cvtss2sd(locs()->out().xmm_reg(), XMM0);
+}
+
+
+LocationSummary* VectorShuffleInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresXmmRegister());
+  summary->set_out(Location::RequiresXmmRegister());
+  return summary;
+}
+
+
+void VectorShuffleInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  __ pshufd(locs()->out().xmm_reg(),
+            locs()->in(0).xmm_reg(),
+            Immediate(mask()));
+}
+
+
+LocationSummary* VectorCompareInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 2;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresXmmRegister());
+  summary->set_in(1, Location::RequiresXmmRegister());
+  summary->set_out(Location::SameAsFirstInput());
+  return summary;
+}
+
+
+// Returns the cmpps predicate of the comparison.
+static intptr_t PackedComparePredicate(Token::Kind kind) {
+  switch (kind) {
+    case Token::kEQ: return 0;
+    case Token::kLT: return 1;
+    case Token::kLTE: return 2;
+    case Token::kNE: return 4;
+    default:
+      UNREACHABLE();
+      return -1;
+  }
+}
+
+
+void VectorCompareInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  XmmRegister left = locs()->in(0).xmm_reg();
+  ASSERT(locs()->out().xmm_reg() == left);
+  __ cmpps(left,
+           locs()->in(1).xmm_reg(),
+           Immediate(PackedComparePredicate(kind())));
+}
+
+
+LocationSummary* VectorSelectInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 3;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresXmmRegister());
+  summary->set_in(1, Location::RequiresXmmRegister());
+  summary->set_in(2, Location::RequiresXmmRegister());
+  summary->set_out(Location::SameAsFirstInput());
+  return summary;
+}
+
+
+void VectorSelectInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  XmmRegister mask = locs()->in(0).xmm_reg();
+  ASSERT(locs()->out().xmm_reg() == mask);
+  // XMM0 is scratch: result = (mask & true_value) | (~mask & false_value).
+  __ movaps(XMM0, mask);
+  __ pand(mask, locs()->in(1).xmm_reg());
+  __ pandn(XMM0, locs()->in(2).xmm_reg());
+  __ por(mask, XMM0);
 }
 
 
@@ -1123,6 +1443,32 @@ void LoadFieldInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 }
 
 
+LocationSummary* LoadClassIdInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* locs =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  locs->set_in(0, Location::RequiresRegister());
+  locs->set_out(Location::RequiresRegister());
+  return locs;
+}
+
+
+void LoadClassIdInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  Register object = locs()->in(0).reg();
+  Register result = locs()->out().reg();
+  Label load, done;
+  __ testl(object, Immediate(kSmiTagMask));
+  __ j(NOT_ZERO, &load, Assembler::kNearJump);
+  __ movl(result, Immediate(Smi::RawValue(kSmiCid)));
+  __ jmp(&done, Assembler::kNearJump);
+  __ Bind(&load);
+  __ LoadClassId(result, object);
+  __ SmiTag(result);
+  __ Bind(&done);
+}
+
+
 LocationSummary* InstantiateTypeArgumentsInstr::MakeLocationSummary() const {
   const intptr_t kNumInputs = 1;
   const intptr_t kNumTemps = 1;
@@ -1388,11 +1734,15 @@ void CatchEntryInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 
 LocationSummary* CheckStackOverflowInstr::MakeLocationSummary() const {
   const intptr_t kNumInputs = 0;
-  const intptr_t kNumTemps = 0;
+  // Loops count their iterations in a temp.
+  const intptr_t kNumTemps = in_loop() ? 1 : 0;
   LocationSummary* summary =
       new LocationSummary(kNumInputs,
                           kNumTemps,
                           LocationSummary::kCallOnSlowPath);
+  if (in_loop()) {
+    summary->set_temp(0, Location::RequiresRegister());
+  }
   return summary;
 }
 
@@ -1408,6 +1758,12 @@ class CheckStackOverflowSlowPath : public SlowPathCode {
     compiler->GenerateCallRuntime(instruction_->token_pos(),
                                   kStackOverflowRuntimeEntry,
                                   instruction_->locs());
+    if (instruction_->in_loop() && compiler->CanOsrFunction()) {
+      // The runtime may continue the loop in optimized code from here.
+      compiler->AddCurrentDescriptor(PcDescriptors::kOsrEntry,
+                                     instruction_->osr_id(),
+                                     instruction_->token_pos());
+    }
     compiler->RestoreLiveRegisters(instruction_->locs());
     __ jmp(exit_label());
   }
@@ -1424,6 +1780,21 @@ void CheckStackOverflowInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   __ cmpl(ESP,
           Address::Absolute(Isolate::Current()->stack_limit_address()));
   __ j(BELOW_EQUAL, slow_path->entry_label());
+  if (in_loop() && compiler->CanOsrFunction()) {
+    // Count the iterations of the loop. As in the IC stubs, the usage counter
+    // does not exceed the optimization threshold minus one in the middle of
+    // the function. Once it is reached, the runtime is called at each
+    // iteration until it continues the loop in optimized code or resets the
+    // counter.
+    Register temp = locs()->temp(0).reg();
+    const Function& function =
+        Function::ZoneHandle(compiler->parsed_function().function().raw());
+    __ LoadObject(temp, function);
+    __ cmpl(FieldAddress(temp, Function::usage_counter_offset()),
+            Immediate(FLAG_optimization_counter_threshold - 1));
+    __ j(GREATER_EQUAL, slow_path->entry_label());
+    __ incl(FieldAddress(temp, Function::usage_counter_offset()));
+  }
   __ Bind(slow_path->exit_label());
 }
 
@@ -1478,15 +1849,12 @@ void BinarySmiOpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   Register result = locs()->out().reg();
   ASSERT(left == result);
   Label* deopt = NULL;
-  switch (op_kind()) {
-    case Token::kBIT_AND:
-    case Token::kBIT_OR:
-    case Token::kBIT_XOR:
-      // Can't deoptimize. Arguments are already checked for smi.
-      break;
-    default:
-      deopt  = compiler->AddDeoptStub(instance_call()->deopt_id(),
-                                      kDeoptBinarySmiOp);
+  if (CanDeoptimize()) {
+    // Bitwise operations can't deoptimize, their arguments are already
+    // checked for smi.  Neither can additions and subtractions whose result
+    // is known to fit in a smi.
+    deopt = compiler->AddDeoptStub(instance_call()->deopt_id(),
+                                   kDeoptBinarySmiOp);
   }
 
   if (locs()->in(1).IsConstant()) {
@@ -1497,11 +1865,11 @@ void BinarySmiOpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
     switch (op_kind()) {
       case Token::kADD:
         __ addl(left, Immediate(imm));
-        __ j(OVERFLOW, deopt);
+        if (deopt != NULL) __ j(OVERFLOW, deopt);
         break;
       case Token::kSUB: {
         __ subl(left, Immediate(imm));
-        __ j(OVERFLOW, deopt);
+        if (deopt != NULL) __ j(OVERFLOW, deopt);
         break;
       }
       case Token::kMUL: {
@@ -1559,12 +1927,12 @@ void BinarySmiOpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   switch (op_kind()) {
     case Token::kADD: {
       __ addl(left, right);
-      __ j(OVERFLOW, deopt);
+      if (deopt != NULL) __ j(OVERFLOW, deopt);
       break;
     }
     case Token::kSUB: {
       __ subl(left, right);
-      __ j(OVERFLOW, deopt);
+      if (deopt != NULL) __ j(OVERFLOW, deopt);
       break;
     }
     case Token::kMUL: {
@@ -1696,105 +2064,80 @@ void BinarySmiOpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 
 LocationSummary* BinaryMintOpInstr::MakeLocationSummary() const {
   const intptr_t kNumInputs = 2;
-  ASSERT(op_kind() == Token::kBIT_AND);
-  const intptr_t kNumTemps = 1;
+  const intptr_t kNumTemps = 3;
   LocationSummary* summary =
-      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kCall);
-  summary->set_in(0, Location::RegisterLocation(EAX));
-  summary->set_in(1, Location::RegisterLocation(ECX));
-  summary->set_temp(0, Location::RegisterLocation(EDX));
-  summary->set_out(Location::RegisterLocation(EAX));
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresXmmRegister());
+  summary->set_in(1, Location::RequiresXmmRegister());
+  summary->set_temp(0, Location::RequiresRegister());
+  summary->set_temp(1, Location::RequiresRegister());
+  summary->set_temp(2, Location::RequiresRegister());
+  summary->set_out(Location::SameAsFirstInput());
   return summary;
 }
 
 
-void BinaryMintOpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
-  // TODO(regis): For now, we only support Token::kBIT_AND for a Mint or Smi
-  // receiver and a Mint or Smi argument. We fall back to the run time call if
-  // both receiver and argument are Mint or if one of them is Mint and the other
-  // is a negative Smi.
-  Register left = locs()->in(0).reg();
-  Register right = locs()->in(1).reg();
-  Register result = locs()->out().reg();
-  Register temp = locs()->temp(0).reg();
-  ASSERT(left == result);
-  ASSERT(op_kind() == Token::kBIT_AND);
-  Label* deopt = compiler->AddDeoptStub(instance_call()->deopt_id(),
-                                        kDeoptBinaryMintOp);
-  Label mint_static_call, smi_static_call, non_smi, smi_smi, done;
-  __ testl(left, Immediate(kSmiTagMask));  // Is receiver Smi?
-  __ j(NOT_ZERO, &non_smi);
-  __ testl(right, Immediate(kSmiTagMask));  // Is argument Smi?
-  __ j(ZERO, &smi_smi);
-  __ CompareClassId(right, kMintCid, temp);  // Is argument Mint?
-  __ j(NOT_EQUAL, deopt);  // Argument neither Smi nor Mint.
-  __ cmpl(left, Immediate(0));
-  __ j(LESS, &smi_static_call);  // Negative Smi receiver, Mint argument.
-
-  // Positive Smi receiver, Mint argument.
-  // Load lower argument Mint word, convert to Smi. It is OK to loose bits.
-  __ movl(right, FieldAddress(right, Mint::value_offset()));
-  __ SmiTag(right);
-  __ andl(result, right);
-  __ jmp(&done);
-
-  __ Bind(&non_smi);  // Receiver is non-Smi.
-  __ CompareClassId(left, kMintCid, temp);  // Is receiver Mint?
-  __ j(NOT_EQUAL, deopt);  // Receiver neither Smi nor Mint.
-  __ testl(right, Immediate(kSmiTagMask));  // Is argument Smi?
-  __ j(NOT_ZERO, &mint_static_call);  // Mint receiver, non-Smi argument.
-  __ cmpl(right, Immediate(0));
-  __ j(LESS, &mint_static_call);  // Mint receiver, negative Smi argument.
-
-  // Mint receiver, positive Smi argument.
-  // Load lower receiver Mint word, convert to Smi. It is OK to loose bits.
-  __ movl(result, FieldAddress(left, Mint::value_offset()));
-  __ SmiTag(result);
-  __ Bind(&smi_smi);
-  __ andl(result, right);
-  __ jmp(&done);
+// Unboxed integers are kept in XMM registers, the operations are performed
+// on their low and high words in a pair of CPU registers.  XMM0 is scratch.
+static void LoadHighWord(Assembler* assembler,
+                         Register dst,
+                         XmmRegister src) {
+  assembler->movsd(XMM0, src);
+  assembler->psrlq(XMM0, Immediate(32));
+  assembler->movd(dst, XMM0);
+}
 
-  __ Bind(&smi_static_call);
-  {
-    Function& target = Function::ZoneHandle(
-        ic_data()->GetTargetForReceiverClassId(kSmiCid));
-    if (target.IsNull()) {
-      __ jmp(deopt);
-    } else {
-      __ pushl(left);
-      __ pushl(right);
-      compiler->GenerateStaticCall(
-          instance_call()->deopt_id(),
-          instance_call()->token_pos(),
-          target,
-          instance_call()->ArgumentCount(),
-          instance_call()->argument_names(),
-          locs());
-      ASSERT(result == EAX);
-      __ jmp(&done);
-    }
-  }
 
-  __ Bind(&mint_static_call);
-  {
-    Function& target = Function::ZoneHandle(
-        ic_data()->GetTargetForReceiverClassId(kMintCid));
-    if (target.IsNull()) {
-      __ jmp(deopt);
-    } else {
-      __ pushl(left);
-      __ pushl(right);
-      compiler->GenerateStaticCall(
-          instance_call()->deopt_id(),
-          instance_call()->token_pos(),
-          target,
-          instance_call()->ArgumentCount(),
-          instance_call()->argument_names(),
-          locs());
-      ASSERT(result == EAX);
+void BinaryMintOpInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  XmmRegister left = locs()->in(0).xmm_reg();
+  XmmRegister right = locs()->in(1).xmm_reg();
+  ASSERT(locs()->out().xmm_reg() == left);
+  Register lo = locs()->temp(0).reg();
+  Register hi = locs()->temp(1).reg();
+  Register temp = locs()->temp(2).reg();
+  __ movd(lo, left);
+  LoadHighWord(compiler->assembler(), hi, left);
+  // The XMM moves do not affect the flags: the carry of the low words is
+  // still available when the high words are combined.
+  __ movd(temp, right);
+  switch (op_kind()) {
+    case Token::kBIT_AND:
+      __ andl(lo, temp);
+      LoadHighWord(compiler->assembler(), temp, right);
+      __ andl(hi, temp);
+      break;
+    case Token::kBIT_OR:
+      __ orl(lo, temp);
+      LoadHighWord(compiler->assembler(), temp, right);
+      __ orl(hi, temp);
+      break;
+    case Token::kBIT_XOR:
+      __ xorl(lo, temp);
+      LoadHighWord(compiler->assembler(), temp, right);
+      __ xorl(hi, temp);
+      break;
+    case Token::kADD:
+    case Token::kSUB: {
+      Label* deopt = compiler->AddDeoptStub(deopt_id(), kDeoptBinaryMintOp);
+      if (op_kind() == Token::kADD) {
+        __ addl(lo, temp);
+        LoadHighWord(compiler->assembler(), temp, right);
+        __ adcl(hi, temp);
+      } else {
+        __ subl(lo, temp);
+        LoadHighWord(compiler->assembler(), temp, right);
+        __ sbbl(hi, temp);
+      }
+      // The result needs a Bigint.
+      __ j(OVERFLOW, deopt);
+      break;
     }
+    default:
+      UNREACHABLE();
   }
-  __ Bind(&done);
+  __ movd(left, lo);
+  __ movd(XMM0, hi);
+  __ punpckldq(left, XMM0);
 }
 
 
@@ -1914,6 +2257,224 @@ void UnboxDoubleInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
 }
 
 
+LocationSummary* UnboxIntegerInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 1;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_temp(0, Location::RequiresRegister());
+  summary->set_out(Location::RequiresXmmRegister());
+  return summary;
+}
+
+
+// Sign extends the untagged Smi in 'temp' to 64 bits in 'result'.
+static void LoadSmiToInt64(Assembler* assembler,
+                           XmmRegister result,
+                           Register value,
+                           Register temp) {
+  assembler->movl(temp, value);
+  assembler->SmiUntag(temp);
+  assembler->movd(result, temp);
+  assembler->sarl(temp, Immediate(31));
+  assembler->movd(XMM0, temp);
+  assembler->punpckldq(result, XMM0);
+}
+
+
+void UnboxIntegerInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  const intptr_t v_cid = value()->ResultCid();
+
+  const Register value = locs()->in(0).reg();
+  const Register temp = locs()->temp(0).reg();
+  const XmmRegister result = locs()->out().xmm_reg();
+  if (v_cid == kMintCid) {
+    __ movsd(result, FieldAddress(value, Mint::value_offset()));
+  } else if (v_cid == kSmiCid) {
+    LoadSmiToInt64(compiler->assembler(), result, value, temp);
+  } else {
+    Label* deopt = compiler->AddDeoptStub(deopt_id_, kDeoptUnboxInteger);
+    Label is_smi, done;
+    __ testl(value, Immediate(kSmiTagMask));
+    __ j(ZERO, &is_smi);
+    __ CompareClassId(value, kMintCid, temp);
+    __ j(NOT_EQUAL, deopt);
+    __ movsd(result, FieldAddress(value, Mint::value_offset()));
+    __ jmp(&done);
+    __ Bind(&is_smi);
+    LoadSmiToInt64(compiler->assembler(), result, value, temp);
+    __ Bind(&done);
+  }
+}
+
+
+LocationSummary* BoxIntegerInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 2;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs,
+                          kNumTemps,
+                          LocationSummary::kCallOnSlowPath);
+  summary->set_in(0, Location::RequiresXmmRegister());
+  summary->set_temp(0, Location::RequiresRegister());
+  summary->set_temp(1, Location::RequiresRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+class BoxIntegerSlowPath : public SlowPathCode {
+ public:
+  explicit BoxIntegerSlowPath(BoxIntegerInstr* instruction)
+      : instruction_(instruction) { }
+
+  virtual void EmitNativeCode(FlowGraphCompiler* compiler) {
+    __ Bind(entry_label());
+    const Class& mint_class = compiler->mint_class();
+    const Code& stub =
+        Code::Handle(StubCode::GetAllocationStubForClass(mint_class));
+    const ExternalLabel label(mint_class.ToCString(), stub.EntryPoint());
+
+    LocationSummary* locs = instruction_->locs();
+    locs->live_registers()->Remove(locs->out());
+
+    compiler->SaveLiveRegisters(locs);
+    compiler->GenerateCall(0,  // No token position.
+                           &label,
+                           PcDescriptors::kOther,
+                           locs);
+    if (EAX != locs->out().reg()) __ movl(locs->out().reg(), EAX);
+    compiler->RestoreLiveRegisters(locs);
+
+    __ jmp(exit_label());
+  }
+
+ private:
+  BoxIntegerInstr* instruction_;
+};
+
+
+void BoxIntegerInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  BoxIntegerSlowPath* slow_path = new BoxIntegerSlowPath(this);
+  compiler->AddSlowPathCode(slow_path);
+
+  Register out_reg = locs()->out().reg();
+  XmmRegister value = locs()->in(0).xmm_reg();
+  Register hi = locs()->temp(0).reg();
+  Register temp = locs()->temp(1).reg();
+
+  // The value is a Smi if its high word is the sign extension of the low
+  // word and the low word can be tagged.
+  Label not_smi, done;
+  __ movd(out_reg, value);
+  LoadHighWord(compiler->assembler(), hi, value);
+  __ movl(temp, out_reg);
+  __ sarl(temp, Immediate(31));
+  __ cmpl(temp, hi);
+  __ j(NOT_EQUAL, &not_smi);
+  __ SmiTag(out_reg);
+  __ j(NO_OVERFLOW, &done);
+  __ Bind(&not_smi);
+  AssemblerMacros::TryAllocate(compiler->assembler(),
+                               compiler->mint_class(),
+                               slow_path->entry_label(),
+                               Assembler::kFarJump,
+                               out_reg);
+  __ Bind(slow_path->exit_label());
+  __ movsd(FieldAddress(out_reg, Mint::value_offset()), value);
+  __ Bind(&done);
+}
+
+
+LocationSummary* BoxVectorInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs,
+                          kNumTemps,
+                          LocationSummary::kCallOnSlowPath);
+  summary->set_in(0, Location::RequiresXmmRegister());
+  summary->set_out(Location::RequiresRegister());
+  return summary;
+}
+
+
+static const Class& VectorClass(FlowGraphCompiler* compiler,
+                                intptr_t class_id) {
+  ASSERT((class_id == kFloat32x4Cid) || (class_id == kInt32x4Cid));
+  return (class_id == kFloat32x4Cid) ? compiler->float32x4_class()
+                                     : compiler->int32x4_class();
+}
+
+
+class BoxVectorSlowPath : public SlowPathCode {
+ public:
+  explicit BoxVectorSlowPath(BoxVectorInstr* instruction)
+      : instruction_(instruction) { }
+
+  virtual void EmitNativeCode(FlowGraphCompiler* compiler) {
+    __ Bind(entry_label());
+    const Class& cls = VectorClass(compiler, instruction_->class_id());
+    const Code& stub =
+        Code::Handle(StubCode::GetAllocationStubForClass(cls));
+    const ExternalLabel label(cls.ToCString(), stub.EntryPoint());
+
+    LocationSummary* locs = instruction_->locs();
+    locs->live_registers()->Remove(locs->out());
+
+    compiler->SaveLiveRegisters(locs);
+    compiler->GenerateCall(0,  // No token position.
+                           &label,
+                           PcDescriptors::kOther,
+                           locs);
+    if (EAX != locs->out().reg()) __ movl(locs->out().reg(), EAX);
+    compiler->RestoreLiveRegisters(locs);
+
+    __ jmp(exit_label());
+  }
+
+ private:
+  BoxVectorInstr* instruction_;
+};
+
+
+void BoxVectorInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  BoxVectorSlowPath* slow_path = new BoxVectorSlowPath(this);
+  compiler->AddSlowPathCode(slow_path);
+
+  Register out_reg = locs()->out().reg();
+  XmmRegister value = locs()->in(0).xmm_reg();
+
+  AssemblerMacros::TryAllocate(compiler->assembler(),
+                               VectorClass(compiler, class_id()),
+                               slow_path->entry_label(),
+                               Assembler::kFarJump,
+                               out_reg);
+  __ Bind(slow_path->exit_label());
+  // Float32x4 and Int32x4 share the layout of their value.
+  __ movups(FieldAddress(out_reg, Float32x4::value_offset()), value);
+}
+
+
+LocationSummary* UnboxVectorInstr::MakeLocationSummary() const {
+  const intptr_t kNumInputs = 1;
+  const intptr_t kNumTemps = 0;
+  LocationSummary* summary =
+      new LocationSummary(kNumInputs, kNumTemps, LocationSummary::kNoCall);
+  summary->set_in(0, Location::RequiresRegister());
+  summary->set_out(Location::RequiresXmmRegister());
+  return summary;
+}
+
+
+void UnboxVectorInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  ASSERT(Float32x4::value_offset() == Int32x4::value_offset());
+  __ movups(locs()->out().xmm_reg(),
+            FieldAddress(locs()->in(0).reg(), Float32x4::value_offset()));
+}
+
+
 LocationSummary* UnboxedDoubleBinaryOpInstr::MakeLocationSummary() const {
   const intptr_t kNumInputs = 2;
   const intptr_t kNumTemps = 0;
@@ -2249,12 +2810,23 @@ void CheckArrayBoundInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
       kDeoptLoadIndexedGrowableArray : kDeoptLoadIndexedFixedArray;
   Label* deopt = compiler->AddDeoptStub(deopt_id(),
                                         deopt_reason);
-  ASSERT(array_type() == kArrayCid ||
-         array_type() == kImmutableArrayCid ||
-         array_type() == kGrowableObjectArrayCid);
-  intptr_t length_offset = (array_type() == kGrowableObjectArrayCid)
-      ? GrowableObjectArray::length_offset()
-      : Array::length_offset();
+  intptr_t length_offset = -1;
+  switch (array_type()) {
+    case kArrayCid:
+    case kImmutableArrayCid:
+      length_offset = Array::length_offset();
+      break;
+    case kGrowableObjectArrayCid:
+      length_offset = GrowableObjectArray::length_offset();
+      break;
+    case kFloat32ArrayCid:
+    case kFloat64ArrayCid:
+    case kInt32ArrayCid:
+      length_offset = ByteArray::length_offset();
+      break;
+    default:
+      UNREACHABLE();
+  }
   // This case should not have created a bound check instruction.
   ASSERT(!(locs()->in(0).IsConstant() && locs()->in(1).IsConstant()));
 
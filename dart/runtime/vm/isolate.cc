@@ -15,6 +15,7 @@
 #include "vm/heap.h"
 #include "vm/message_handler.h"
 #include "vm/object_store.h"
+#include "vm/optimization_queue.h"
 #include "vm/parser.h"
 #include "vm/port.h"
 #include "vm/random.h"
@@ -42,6 +43,7 @@ class IsolateMessageHandler : public MessageHandler {
   const char* name() const;
   void MessageNotify(Message::Priority priority);
   bool HandleMessage(Message* message);
+  void NotifyIdle();
 
 #if defined(DEBUG)
   // Check that it is safe to access this handler.
@@ -120,6 +122,12 @@ bool IsolateMessageHandler::HandleMessage(Message* message) {
 }
 
 
+void IsolateMessageHandler::NotifyIdle() {
+  StartIsolateScope start_scope(isolate_);
+  isolate_->heap()->NotifyIdle();
+}
+
+
 #if defined(DEBUG)
 void IsolateMessageHandler::CheckAccess() {
   ASSERT(IsCurrentIsolate());
@@ -156,10 +164,12 @@ Isolate::Isolate()
       api_state_(NULL),
       stub_code_(NULL),
       debugger_(NULL),
+      optimization_queue_(NULL),
       long_jump_base_(NULL),
       timer_list_(),
       deopt_id_(0),
       ic_data_array_(Array::null()),
+      megamorphic_cache_table_(GrowableObjectArray::null()),
       mutex_(new Mutex()),
       stack_limit_(0),
       saved_stack_limit_(0),
@@ -171,7 +181,10 @@ Isolate::Isolate()
       deopt_xmm_registers_copy_(NULL),
       deopt_frame_copy_(NULL),
       deopt_frame_copy_size_(0),
-      deferred_doubles_(NULL) {
+      deferred_doubles_(NULL),
+      deferred_mints_(NULL),
+      deferred_simd128s_(NULL),
+      deferred_objects_(NULL) {
 }
 
 
@@ -236,6 +249,7 @@ Isolate* Isolate::Init(const char* name_prefix) {
 
   result->debugger_ = new Debugger();
   result->debugger_->Initialize(result);
+  result->optimization_queue_ = new OptimizationQueue(result);
   if (FLAG_trace_isolates) {
     if (name_prefix == NULL || strcmp(name_prefix, "vm-isolate") != 0) {
       OS::Print("[+] Starting isolate:\n"
@@ -411,6 +425,10 @@ void Isolate::Shutdown() {
     debugger_->Shutdown();
   }
 
+  // Stop pacing the optimization of queued functions.
+  delete optimization_queue_;
+  optimization_queue_ = NULL;
+
   // Close all the ports owned by this isolate.
   PortMap::ClosePorts(message_handler());
 
@@ -485,8 +503,17 @@ void Isolate::VisitObjectPointers(ObjectPointerVisitor* visitor,
   // Visit the currently active IC data array.
   visitor->VisitPointer(reinterpret_cast<RawObject**>(&ic_data_array_));
 
+  // Visit the megamorphic caches.
+  visitor->VisitPointer(
+      reinterpret_cast<RawObject**>(&megamorphic_cache_table_));
+
   // Visit objects in the debugger.
   debugger()->VisitObjectPointers(visitor);
+
+  // Visit the functions queued for optimization.
+  if (optimization_queue() != NULL) {
+    optimization_queue()->VisitObjectPointers(visitor);
+  }
 }
 
 
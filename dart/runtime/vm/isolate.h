@@ -29,10 +29,15 @@ class MessageHandler;
 class Mutex;
 class ObjectPointerVisitor;
 class ObjectStore;
+class OptimizationQueue;
 class RawArray;
 class RawContext;
 class RawDouble;
 class RawError;
+class RawGrowableObjectArray;
+class RawInstance;
+class RawMint;
+class RawObject;
 class StackResource;
 class StubCode;
 class Zone;
@@ -59,6 +64,142 @@ class DeferredDouble {
 };
 
 
+// Used by the deoptimization infrastructure to defer allocation of Mint
+// objects until frame is fully rewritten and GC is safe.
+// See callers of Isolate::DeferMintMaterialization.
+class DeferredMint {
+ public:
+  DeferredMint(int64_t value, RawMint** slot, DeferredMint* next)
+      : value_(value), slot_(slot), next_(next) { }
+
+  int64_t value() const { return value_; }
+  RawMint** slot() const { return slot_; }
+  DeferredMint* next() const { return next_; }
+
+ private:
+  const int64_t value_;
+  RawMint** const slot_;
+  DeferredMint* const next_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeferredMint);
+};
+
+
+// Used by the deoptimization infrastructure to defer allocation of Float32x4
+// and Int32x4 objects until frame is fully rewritten and GC is safe.
+// See callers of Isolate::DeferSimd128Materialization.
+class DeferredSimd128 {
+ public:
+  DeferredSimd128(simd128_value_t value,
+                  intptr_t class_id,
+                  RawInstance** slot,
+                  DeferredSimd128* next)
+      : value_(value), class_id_(class_id), slot_(slot), next_(next) { }
+
+  simd128_value_t value() const { return value_; }
+  intptr_t class_id() const { return class_id_; }
+  RawInstance** slot() const { return slot_; }
+  DeferredSimd128* next() const { return next_; }
+
+ private:
+  const simd128_value_t value_;
+  const intptr_t class_id_;
+  RawInstance** const slot_;
+  DeferredSimd128* const next_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeferredSimd128);
+};
+
+
+// Used by the deoptimization infrastructure to defer allocation of objects
+// whose allocation was sunk in optimized code until frame is fully
+// rewritten and GC is safe.  The values of the fields are copied from the
+// optimized frame, unboxed doubles, integers and vectors are boxed when the
+// object is allocated.
+// See callers of Isolate::DeferObjectMaterialization.
+class DeferredObject {
+ public:
+  DeferredObject(RawArray* descriptor,
+                 RawInstance** slot,
+                 intptr_t field_count,
+                 DeferredObject* next)
+      : descriptor_(descriptor),
+        slot_(slot),
+        field_count_(field_count),
+        fields_(new FieldValue[field_count]),
+        next_(next) { }
+  ~DeferredObject() { delete[] fields_; }
+
+  // The class of the object followed by a description of each field, see
+  // DeoptInfoBuilder::AddMaterialization.
+  RawArray* descriptor() const { return descriptor_; }
+  RawInstance** slot() const { return slot_; }
+  intptr_t field_count() const { return field_count_; }
+  DeferredObject* next() const { return next_; }
+
+  bool IsDoubleFieldAt(intptr_t i) const { return fields_[i].is_double; }
+  bool IsMintFieldAt(intptr_t i) const { return fields_[i].is_mint; }
+  bool IsSimd128FieldAt(intptr_t i) const { return fields_[i].is_simd128; }
+  RawObject* FieldAt(intptr_t i) const { return fields_[i].raw; }
+  double DoubleFieldAt(intptr_t i) const { return fields_[i].value; }
+  int64_t MintFieldAt(intptr_t i) const { return fields_[i].mint_value; }
+  simd128_value_t Simd128FieldAt(intptr_t i) const {
+    return fields_[i].simd128_value;
+  }
+  intptr_t Simd128FieldClassIdAt(intptr_t i) const {
+    return fields_[i].simd128_class_id;
+  }
+
+  void SetFieldAt(intptr_t i, RawObject* raw) {
+    fields_[i].raw = raw;
+    fields_[i].is_double = false;
+    fields_[i].is_mint = false;
+    fields_[i].is_simd128 = false;
+  }
+  void SetDoubleFieldAt(intptr_t i, double value) {
+    fields_[i].value = value;
+    fields_[i].is_double = true;
+    fields_[i].is_mint = false;
+    fields_[i].is_simd128 = false;
+  }
+  void SetMintFieldAt(intptr_t i, int64_t value) {
+    fields_[i].mint_value = value;
+    fields_[i].is_double = false;
+    fields_[i].is_mint = true;
+    fields_[i].is_simd128 = false;
+  }
+  void SetSimd128FieldAt(intptr_t i,
+                         simd128_value_t value,
+                         intptr_t class_id) {
+    fields_[i].simd128_value = value;
+    fields_[i].simd128_class_id = class_id;
+    fields_[i].is_double = false;
+    fields_[i].is_mint = false;
+    fields_[i].is_simd128 = true;
+  }
+
+ private:
+  struct FieldValue {
+    RawObject* raw;
+    double value;
+    int64_t mint_value;
+    simd128_value_t simd128_value;
+    intptr_t simd128_class_id;
+    bool is_double;
+    bool is_mint;
+    bool is_simd128;
+  };
+
+  RawArray* const descriptor_;
+  RawInstance** const slot_;
+  const intptr_t field_count_;
+  FieldValue* const fields_;
+  DeferredObject* const next_;
+
+  DISALLOW_COPY_AND_ASSIGN(DeferredObject);
+};
+
+
 class Isolate : public BaseIsolate {
  public:
   ~Isolate();
@@ -181,11 +322,13 @@ class Isolate : public BaseIsolate {
     kApiInterrupt = 0x1,      // An interrupt from Dart_InterruptIsolate.
     kMessageInterrupt = 0x2,  // An interrupt to process an out of band message.
     kStoreBufferInterrupt = 0x4,  // An interrupt to process the store buffer.
+    kOptimizeInterrupt = 0x8,  // An interrupt to optimize a queued function.
 
     kInterruptsMask =
         kApiInterrupt |
         kMessageInterrupt |
-        kStoreBufferInterrupt,
+        kStoreBufferInterrupt |
+        kOptimizeInterrupt,
   };
 
   void ScheduleInterrupts(uword interrupt_bits);
@@ -212,8 +355,18 @@ class Isolate : public BaseIsolate {
   void set_ic_data_array(RawArray* value) { ic_data_array_ = value; }
   ICData* GetICDataForDeoptId(intptr_t deopt_id) const;
 
+  // The megamorphic caches of all selectors, see MegamorphicCache.
+  RawGrowableObjectArray* megamorphic_cache_table() const {
+    return megamorphic_cache_table_;
+  }
+  void set_megamorphic_cache_table(RawGrowableObjectArray* value) {
+    megamorphic_cache_table_ = value;
+  }
+
   Debugger* debugger() const { return debugger_; }
 
+  OptimizationQueue* optimization_queue() const { return optimization_queue_; }
+
   GcPrologueCallbacks& gc_prologue_callbacks() {
     return gc_prologue_callbacks_;
   }
@@ -250,10 +403,10 @@ class Isolate : public BaseIsolate {
     ASSERT((value == NULL) || (deopt_cpu_registers_copy_ == NULL));
     deopt_cpu_registers_copy_ = value;
   }
-  double* deopt_xmm_registers_copy() const {
+  simd128_value_t* deopt_xmm_registers_copy() const {
     return deopt_xmm_registers_copy_;
   }
-  void set_deopt_xmm_registers_copy(double* value) {
+  void set_deopt_xmm_registers_copy(simd128_value_t* value) {
     ASSERT((value == NULL) || (deopt_xmm_registers_copy_ == NULL));
     deopt_xmm_registers_copy_ = value;
   }
@@ -277,6 +430,43 @@ class Isolate : public BaseIsolate {
     return list;
   }
 
+  void DeferMintMaterialization(int64_t value, RawMint** slot) {
+    deferred_mints_ = new DeferredMint(value, slot, deferred_mints_);
+  }
+
+  DeferredMint* DetachDeferredMints() {
+    DeferredMint* list = deferred_mints_;
+    deferred_mints_ = NULL;
+    return list;
+  }
+
+  void DeferSimd128Materialization(simd128_value_t value,
+                                   intptr_t class_id,
+                                   RawInstance** slot) {
+    deferred_simd128s_ = new DeferredSimd128(
+        value, class_id, slot, deferred_simd128s_);
+  }
+
+  DeferredSimd128* DetachDeferredSimd128s() {
+    DeferredSimd128* list = deferred_simd128s_;
+    deferred_simd128s_ = NULL;
+    return list;
+  }
+
+  DeferredObject* DeferObjectMaterialization(RawArray* descriptor,
+                                             RawInstance** slot,
+                                             intptr_t field_count) {
+    deferred_objects_ = new DeferredObject(
+        descriptor, slot, field_count, deferred_objects_);
+    return deferred_objects_;
+  }
+
+  DeferredObject* DetachDeferredObjects() {
+    DeferredObject* list = deferred_objects_;
+    deferred_objects_ = NULL;
+    return list;
+  }
+
  private:
   Isolate();
 
@@ -304,10 +494,12 @@ class Isolate : public BaseIsolate {
   ApiState* api_state_;
   StubCode* stub_code_;
   Debugger* debugger_;
+  OptimizationQueue* optimization_queue_;
   LongJump* long_jump_base_;
   TimerList timer_list_;
   intptr_t deopt_id_;
   RawArray* ic_data_array_;
+  RawGrowableObjectArray* megamorphic_cache_table_;
   Mutex* mutex_;  // protects stack_limit_ and saved_stack_limit_.
   uword stack_limit_;
   uword saved_stack_limit_;
@@ -317,10 +509,13 @@ class Isolate : public BaseIsolate {
   GcEpilogueCallbacks gc_epilogue_callbacks_;
   // Deoptimization support.
   intptr_t* deopt_cpu_registers_copy_;
-  double* deopt_xmm_registers_copy_;
+  simd128_value_t* deopt_xmm_registers_copy_;
   intptr_t* deopt_frame_copy_;
   intptr_t deopt_frame_copy_size_;
   DeferredDouble* deferred_doubles_;
+  DeferredMint* deferred_mints_;
+  DeferredSimd128* deferred_simd128s_;
+  DeferredObject* deferred_objects_;
 
   static Dart_IsolateCreateCallback create_callback_;
   static Dart_IsolateInterruptCallback interrupt_callback_;
@@ -68,6 +68,7 @@ const char* Location::Name() const {
     case kXmmRegister: return Assembler::XmmRegisterName(xmm_reg());
     case kStackSlot: return "S";
     case kDoubleStackSlot: return "DS";
+    case kQuadStackSlot: return "QS";
     case kUnallocated:
       switch (policy()) {
         case kAny:
@@ -97,6 +98,8 @@ void Location::PrintTo(BufferFormatter* f) const {
     f->Print("S%+"Pd"", stack_index());
   } else if (kind() == kDoubleStackSlot) {
     f->Print("DS%+"Pd"", stack_index());
+  } else if (kind() == kQuadStackSlot) {
+    f->Print("QS%+"Pd"", stack_index());
   } else {
     f->Print("%s", Name());
   }
@@ -19,7 +19,7 @@ class Value;
 // LocationSummary object which specifies expected location for every input
 // and output.
 // Each location is encoded as a single word: for non-constant locations
-// low 3 bits denote location kind, rest is kind specific location payload
+// low 4 bits denote location kind, rest is kind specific location payload
 // e.g. for REGISTER kind payload is register code (value of the Register
 // enumeration), constant locations contain a tagged (low 2 bits are set to 01)
 // Object handle
@@ -27,7 +27,7 @@ class Location : public ValueObject {
  private:
   enum {
     // Number of bits required to encode Kind value.
-    kBitsForKind = 3,
+    kBitsForKind = 4,
     kBitsForPayload = kWordSize * kBitsPerByte - kBitsForKind,
   };
 
@@ -60,6 +60,8 @@ class Location : public ValueObject {
     // a spill index.
     kStackSlot = 3,
     kDoubleStackSlot = 4,
+    // Spill slot holding all 128 bits of an xmm register.
+    kQuadStackSlot = 8,
 
     // Register location represents a fixed register.  Payload contains
     // register code.
@@ -227,9 +229,23 @@ class Location : public ValueObject {
     return kind() == kDoubleStackSlot;
   }
 
+  static Location QuadStackSlot(intptr_t stack_index) {
+    ASSERT((-kStackIndexBias <= stack_index) &&
+           (stack_index < kStackIndexBias));
+    Location loc(kQuadStackSlot,
+                 static_cast<uword>(kStackIndexBias + stack_index));
+    // Ensure that sign is preserved.
+    ASSERT(loc.stack_index() == stack_index);
+    return loc;
+  }
+
+  bool IsQuadStackSlot() const {
+    return kind() == kQuadStackSlot;
+  }
+
 
   intptr_t stack_index() const {
-    ASSERT(IsStackSlot() || IsDoubleStackSlot());
+    ASSERT(IsStackSlot() || IsDoubleStackSlot() || IsQuadStackSlot());
     // Decode stack index manually to preserve sign.
     return payload() - kStackIndexBias;
   }
@@ -0,0 +1,176 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_MARKING_STACK_H_
+#define VM_MARKING_STACK_H_
+
+#include "platform/assert.h"
+#include "vm/globals.h"
+#include "vm/thread.h"
+
+namespace dart {
+
+// Forward declarations.
+class RawObject;
+
+class MarkingStackChunk {
+ public:
+  MarkingStackChunk() : next_(NULL) {}
+  ~MarkingStackChunk() {}
+
+  RawObject** MarkingStackChunkMemory() {
+    return &memory_[0];
+  }
+
+  MarkingStackChunk* next() const { return next_; }
+  void set_next(MarkingStackChunk* value) { next_ = value; }
+
+  static const uint32_t kMarkingStackChunkSize = 1024;
+
+ private:
+  RawObject* memory_[kMarkingStackChunkSize];
+  MarkingStackChunk* next_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkingStackChunk);
+};
+
+
+// A simple chunked stack of objects which still need to be visited.
+// When used by the parallel marker or scavenger, full chunks are published to
+// a list of shared chunks, from which the owning task and other idle tasks
+// can take work.
+class MarkingStack {
+ public:
+  MarkingStack()
+      : head_(new MarkingStackChunk()),
+        empty_chunks_(NULL),
+        marking_stack_(NULL),
+        top_(0),
+        share_chunks_(false),
+        shared_chunks_(NULL) {
+    marking_stack_ = head_->MarkingStackChunkMemory();
+  }
+
+  ~MarkingStack() {
+    // TODO(iposva): Consider caching a couple emtpy marking stack chunks.
+    ASSERT(IsEmpty());
+    ASSERT(shared_chunks_ == NULL);
+    delete head_;
+    MarkingStackChunk* next;
+    while (empty_chunks_ != NULL) {
+      next = empty_chunks_->next();
+      delete empty_chunks_;
+      empty_chunks_ = next;
+    }
+  }
+
+  bool IsEmpty() const {
+    return IsMarkingStackChunkEmpty() && (head_->next() == NULL);
+  }
+
+  void Push(RawObject* value) {
+    ASSERT(!IsMarkingStackChunkFull());
+    marking_stack_[top_] = value;
+    top_++;
+    if (IsMarkingStackChunkFull()) {
+      MarkingStackChunk* new_chunk;
+      if (empty_chunks_ == NULL) {
+        new_chunk = new MarkingStackChunk();
+      } else {
+        new_chunk = empty_chunks_;
+        empty_chunks_ = new_chunk->next();
+      }
+      if (share_chunks_) {
+        // Make the full chunk available to other marking tasks.
+        MarkingStackChunk* full_chunk = head_;
+        new_chunk->set_next(full_chunk->next());
+        PublishChunk(full_chunk);
+      } else {
+        new_chunk->set_next(head_);
+      }
+      head_ = new_chunk;
+      marking_stack_ = head_->MarkingStackChunkMemory();
+      top_ = 0;
+    }
+  }
+
+  RawObject* Pop() {
+    ASSERT(head_ != NULL);
+    ASSERT(!IsEmpty());
+    if (IsMarkingStackChunkEmpty()) {
+      MarkingStackChunk* empty_chunk = head_;
+      head_ = head_->next();
+      empty_chunk->set_next(empty_chunks_);
+      empty_chunks_ = empty_chunk;
+      marking_stack_ = head_->MarkingStackChunkMemory();
+      top_ = MarkingStackChunk::kMarkingStackChunkSize;
+    }
+    top_--;
+    return marking_stack_[top_];
+  }
+
+  void set_share_chunks(bool value) { share_chunks_ = value; }
+
+  bool HasSharedChunks() {
+    MutexLocker ml(&shared_mutex_);
+    return shared_chunks_ != NULL;
+  }
+
+  // Moves one of the shared chunks of 'victim' onto this empty stack.
+  // 'victim' may be this stack. Returns false if there was nothing to take.
+  bool StealFrom(MarkingStack* victim) {
+    ASSERT(IsEmpty());
+    MarkingStackChunk* chunk = victim->TakeSharedChunk();
+    if (chunk == NULL) {
+      return false;
+    }
+    head_->set_next(empty_chunks_);
+    empty_chunks_ = head_;
+    chunk->set_next(NULL);
+    head_ = chunk;
+    marking_stack_ = head_->MarkingStackChunkMemory();
+    top_ = MarkingStackChunk::kMarkingStackChunkSize;
+    return true;
+  }
+
+ private:
+  bool IsMarkingStackChunkFull() const {
+    return top_ == MarkingStackChunk::kMarkingStackChunkSize;
+  }
+
+  bool IsMarkingStackChunkEmpty() const {
+    return top_ == 0;
+  }
+
+  void PublishChunk(MarkingStackChunk* chunk) {
+    MutexLocker ml(&shared_mutex_);
+    chunk->set_next(shared_chunks_);
+    shared_chunks_ = chunk;
+  }
+
+  MarkingStackChunk* TakeSharedChunk() {
+    MutexLocker ml(&shared_mutex_);
+    MarkingStackChunk* chunk = shared_chunks_;
+    if (chunk != NULL) {
+      shared_chunks_ = chunk->next();
+    }
+    return chunk;
+  }
+
+  MarkingStackChunk* head_;
+  MarkingStackChunk* empty_chunks_;
+  RawObject** marking_stack_;
+  uint32_t top_;
+
+  // Full chunks available to all marking tasks, protected by shared_mutex_.
+  bool share_chunks_;
+  Mutex shared_mutex_;
+  MarkingStackChunk* shared_chunks_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkingStack);
+};
+
+}  // namespace dart
+
+#endif  // VM_MARKING_STACK_H_
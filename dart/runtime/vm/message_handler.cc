@@ -209,6 +209,15 @@ void MessageHandler::TaskCallback() {
     // Handle any pending messages for this message handler.
     if (ok) {
       ok = HandleMessages(true, true);
+      if (ok && HasLivePorts()) {
+        // The handler is idle.  Messages posted while it is notified are
+        // handled before the task ends.
+        monitor_.Exit();
+        NotifyIdle();
+        ASSERT(Isolate::Current() == NULL);
+        monitor_.Enter();
+        ok = HandleMessages(true, true);
+      }
     }
     task_ = NULL;  // No task in queue.
 
@@ -93,6 +93,10 @@ class MessageHandler {
   // Custom message notification.  Optionally provided by subclass.
   virtual void MessageNotify(Message::Priority priority);
 
+  // Called when the handler has run out of messages to handle, before its
+  // task ends.  Optionally provided by subclass.
+  virtual void NotifyIdle() {}
+
   // Handles a single message.  Provided by subclass.
   //
   // Returns true on success.
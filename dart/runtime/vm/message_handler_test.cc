@@ -35,6 +35,7 @@ class TestMessageHandler : public MessageHandler {
       : port_buffer_(strdup("")),
         notify_count_(0),
         message_count_(0),
+        idle_count_(0),
         result_(true) {
   }
 
@@ -64,6 +65,10 @@ class TestMessageHandler : public MessageHandler {
     return result_;
   }
 
+  void NotifyIdle() {
+    idle_count_++;
+  }
+
 
   bool Start() {
     intptr_t len =
@@ -89,6 +94,7 @@ class TestMessageHandler : public MessageHandler {
   const char* port_buffer() const { return port_buffer_; }
   int notify_count() const { return notify_count_; }
   int message_count() const { return message_count_; }
+  int idle_count() const { return idle_count_; }
 
   void set_result(bool result) { result_ = result; }
 
@@ -96,6 +102,7 @@ class TestMessageHandler : public MessageHandler {
   char* port_buffer_;
   int notify_count_;
   int message_count_;
+  int idle_count_;
   bool result_;
 
   DISALLOW_COPY_AND_ASSIGN(TestMessageHandler);
@@ -254,6 +261,13 @@ UNIT_TEST_CASE(MessageHandler_Run) {
   }
   EXPECT_STREQ(" start 100", handler.port_buffer());
 
+  // The handler is notified once it has run out of messages.
+  while (sleep < kMaxSleep && handler.idle_count() < 1) {
+    OS::Sleep(10);
+    sleep += 10;
+  }
+  EXPECT_LE(1, handler.idle_count());
+
   // Start a thread which sends more messages.
   ThreadStartInfo info;
   info.handler = &handler;
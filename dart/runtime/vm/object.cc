@@ -6,11 +6,13 @@
 
 #include "include/dart_api.h"
 #include "platform/assert.h"
+#include "vm/allocation_sampler.h"
 #include "vm/assembler.h"
 #include "vm/bigint_operations.h"
 #include "vm/bootstrap.h"
 #include "vm/class_finalizer.h"
 #include "vm/code_generator.h"
+#include "vm/code_index_table.h"
 #include "vm/code_patcher.h"
 #include "vm/compiler.h"
 #include "vm/compiler_stats.h"
@@ -43,6 +45,8 @@ DEFINE_FLAG(bool, reject_named_argument_as_positional, false,
 DEFINE_FLAG(bool, show_internal_names, false,
     "Show names of internal classes (e.g. \"OneByteString\") in error messages "
     "instead of showing the corresponding interface names (e.g. \"String\")");
+DEFINE_FLAG(bool, verify_code_index_table, false,
+    "Verify the lookups of code by pc against a walk of the code space");
 DECLARE_FLAG(bool, trace_compiler);
 DECLARE_FLAG(bool, enable_type_checks);
 
@@ -98,6 +102,8 @@ RawClass* Object::deopt_info_class_ = reinterpret_cast<RawClass*>(RAW_NULL);
 RawClass* Object::context_class_ = reinterpret_cast<RawClass*>(RAW_NULL);
 RawClass* Object::context_scope_class_ = reinterpret_cast<RawClass*>(RAW_NULL);
 RawClass* Object::icdata_class_ = reinterpret_cast<RawClass*>(RAW_NULL);
+RawClass* Object::megamorphic_cache_class_ =
+    reinterpret_cast<RawClass*>(RAW_NULL);
 RawClass* Object::subtypetestcache_class_ =
     reinterpret_cast<RawClass*>(RAW_NULL);
 RawClass* Object::api_error_class_ = reinterpret_cast<RawClass*>(RAW_NULL);
@@ -383,6 +389,9 @@ void Object::InitOnce() {
   cls = Class::New<ICData>();
   icdata_class_ = cls.raw();
 
+  cls = Class::New<MegamorphicCache>();
+  megamorphic_cache_class_ = cls.raw();
+
   cls = Class::New<SubtypeTestCache>();
   subtypetestcache_class_ = cls.raw();
 
@@ -456,6 +465,7 @@ void Object::RegisterSingletonClassNames() {
   SET_CLASS_NAME(context, Context);
   SET_CLASS_NAME(context_scope, ContextScope);
   SET_CLASS_NAME(icdata, ICData);
+  SET_CLASS_NAME(megamorphic_cache, MegamorphicCache);
   SET_CLASS_NAME(subtypetestcache, SubtypeTestCache);
   SET_CLASS_NAME(api_error, ApiError);
   SET_CLASS_NAME(language_error, LanguageError);
@@ -786,6 +796,16 @@ RawError* Object::Init(Isolate* isolate) {
   name = Symbols::_ExternalFloat64Array();
   RegisterPrivateClass(cls, name, core_lib);
 
+  cls = Class::New<Float32x4>();
+  object_store->set_float32x4_class(cls);
+  name = Symbols::Float32x4();
+  RegisterClass(cls, name, core_lib);
+
+  cls = Class::New<Int32x4>();
+  object_store->set_int32x4_class(cls);
+  name = Symbols::Int32x4();
+  RegisterClass(cls, name, core_lib);
+
   cls = Class::New<WeakProperty>();
   object_store->set_weak_property_class(cls);
   name = Symbols::_WeakProperty();
@@ -1087,6 +1107,12 @@ void Object::InitFromSnapshot(Isolate* isolate) {
   cls = Class::New<DartFunction>();
   cls = Class::New<Number>();
 
+  cls = Class::New<Float32x4>();
+  object_store->set_float32x4_class(cls);
+
+  cls = Class::New<Int32x4>();
+  object_store->set_int32x4_class(cls);
+
   cls = Class::New<WeakProperty>();
   object_store->set_weak_property_class(cls);
 
@@ -1142,6 +1168,10 @@ RawObject* Object::Allocate(intptr_t cls_id,
   InitializeObject(address, cls_id, size);
   RawObject* raw_obj = reinterpret_cast<RawObject*>(address + kHeapObjectTag);
   ASSERT(cls_id == RawObject::ClassIdTag::decode(raw_obj->ptr()->tags_));
+  AllocationSampler* sampler = heap->allocation_sampler();
+  if (sampler->pending_address() == address) {
+    sampler->RecordSample(cls_id, size);
+  }
   return raw_obj;
 }
 
@@ -7048,6 +7078,7 @@ const char* PcDescriptors::KindAsStr(intptr_t index) const {
     case PcDescriptors::kIcCall:        return "ic-call      ";
     case PcDescriptors::kFuncCall:      return "fn-call      ";
     case PcDescriptors::kReturn:        return "return       ";
+    case PcDescriptors::kOsrEntry:      return "osr-entry    ";
     case PcDescriptors::kOther:         return "other        ";
   }
   UNREACHABLE();
@@ -7639,6 +7670,7 @@ RawCode* Code::FinalizeCode(const char* name, Assembler* assembler) {
     instrs.set_code(code.raw());
     code.set_instructions(instrs.raw());
   }
+  Isolate::Current()->heap()->code_index_table()->Add(instrs);
   return code.raw();
 }
 
@@ -7661,12 +7693,18 @@ bool Code::FindRawCodeVisitor::FindObject(RawObject* obj) {
 }
 
 
+RawInstructions* Code::LookupCodeInCodeSpace(Isolate* isolate, uword pc) {
+  FindRawCodeVisitor visitor(pc);
+  return isolate->heap()->FindObjectInCodeSpace(&visitor);
+}
+
+
 RawCode* Code::LookupCode(uword pc) {
   Isolate* isolate = Isolate::Current();
   NoGCScope no_gc;
-  FindRawCodeVisitor visitor(pc);
-  RawInstructions* instr;
-  instr = isolate->heap()->FindObjectInCodeSpace(&visitor);
+  RawInstructions* instr = isolate->heap()->code_index_table()->Lookup(pc);
+  ASSERT(!FLAG_verify_code_index_table ||
+         (instr == LookupCodeInCodeSpace(isolate, pc)));
   if (instr != Instructions::null()) {
     return instr->ptr()->code_;
   }
@@ -7713,6 +7751,19 @@ uword Code::GetDeoptAfterPcAtDeoptId(intptr_t deopt_id) const {
 }
 
 
+intptr_t Code::GetOsrIdAtPc(uword pc) const {
+  ASSERT(!is_optimized());
+  const PcDescriptors& descriptors = PcDescriptors::Handle(pc_descriptors());
+  for (intptr_t i = 0; i < descriptors.Length(); i++) {
+    if ((descriptors.PC(i) == pc) &&
+        (descriptors.DescriptorKind(i) == PcDescriptors::kOsrEntry)) {
+      return descriptors.DeoptId(i);
+    }
+  }
+  return Isolate::kNoDeoptId;
+}
+
+
 const char* Code::ToCString() const {
   const char* kFormat = "Code entry:0x%d";
   intptr_t len = OS::SNPrint(NULL, 0, kFormat, EntryPoint()) + 1;
@@ -7949,8 +8000,19 @@ void ICData::set_ic_data(const Array& value) const {
 }
 
 
+void ICData::set_megamorphic_cache(const MegamorphicCache& value) const {
+  ASSERT(num_args_tested() == 1);
+  StorePointer(&raw_ptr()->megamorphic_cache_, value.raw());
+}
+
+
+bool ICData::IsMegamorphic() const {
+  return megamorphic_cache() != MegamorphicCache::null();
+}
+
+
 intptr_t ICData::TestEntryLength() const {
-  return num_args_tested() + 1 /* target function*/;
+  return num_args_tested() + 2 /* target function, count */;
 }
 
 
@@ -7986,12 +8048,14 @@ void ICData::AddCheck(const GrowableArray<intptr_t>& class_ids,
     data.SetAt(data_pos++, Smi::Handle(Smi::New(class_ids[i])));
   }
   ASSERT(!target.IsNull());
-  data.SetAt(data_pos, target);
+  data.SetAt(data_pos++, target);
+  data.SetAt(data_pos, Smi::Handle(Smi::New(0)));
 }
 
 
 void ICData::AddReceiverCheck(intptr_t receiver_class_id,
-                              const Function& target) const {
+                              const Function& target,
+                              intptr_t count) const {
   ASSERT(num_args_tested() == 1);  // Otherwise use 'AddCheck'.
   ASSERT(receiver_class_id != kIllegalCid);
   ASSERT(!target.IsNull());
@@ -8008,13 +8072,17 @@ void ICData::AddReceiverCheck(intptr_t receiver_class_id,
     const intptr_t zero_class_id = GetReceiverClassIdAt(0);
     ASSERT(zero_class_id != kSmiCid);  // Simple duplicate entry check.
     const Function& zero_target = Function::Handle(GetTargetAt(0));
+    const intptr_t zero_count = GetCountAt(0);
     data.SetAt(0, Smi::Handle(Smi::New(receiver_class_id)));
     data.SetAt(1, target);
+    data.SetAt(2, Smi::Handle(Smi::New(count)));
     data.SetAt(data_pos, Smi::Handle(Smi::New(zero_class_id)));
     data.SetAt(data_pos + 1, zero_target);
+    data.SetAt(data_pos + 2, Smi::Handle(Smi::New(zero_count)));
   } else {
     data.SetAt(data_pos, Smi::Handle(Smi::New(receiver_class_id)));
     data.SetAt(data_pos + 1, target);
+    data.SetAt(data_pos + 2, Smi::Handle(Smi::New(count)));
   }
 }
 
@@ -8069,6 +8137,17 @@ RawFunction* ICData::GetTargetAt(intptr_t index) const {
 }
 
 
+intptr_t ICData::GetCountAt(intptr_t index) const {
+  ASSERT(index < NumberOfChecks());
+  const Array& data = Array::Handle(ic_data());
+  const intptr_t data_pos =
+      index * TestEntryLength() + num_args_tested() + 1;
+  Smi& smi = Smi::Handle();
+  smi ^= data.At(data_pos);
+  return smi.Value();
+}
+
+
 RawFunction* ICData::GetTargetForReceiverClassId(intptr_t class_id) const {
   for (intptr_t i = 0; i < NumberOfChecks(); i++) {
     if (GetReceiverClassIdAt(i) == class_id) {
@@ -8101,9 +8180,16 @@ RawICData* ICData::AsUnaryClassChecks() const {
     if (duplicate_class_id >= 0) {
       ASSERT(result.GetTargetAt(duplicate_class_id) == GetTargetAt(i));
     } else {
+      intptr_t count = GetCountAt(i);
+      for (intptr_t k = i + 1; k < NumberOfChecks(); k++) {
+        if (class_id == GetReceiverClassIdAt(k)) {
+          count = Utils::Minimum(count + GetCountAt(k), Smi::kMaxValue);
+        }
+      }
       // This will make sure that Smi is first if it exists.
       result.AddReceiverCheck(class_id,
-                              Function::Handle(GetTargetAt(i)));
+                              Function::Handle(GetTargetAt(i)),
+                              count);
     }
   }
   return result.raw();
@@ -8159,7 +8245,7 @@ RawICData* ICData::New(const Function& function,
   result.set_target_name(target_name);
   result.set_deopt_id(deopt_id);
   result.set_num_args_tested(num_args_tested);
-  // Number of array elements in one test entry (num_args_tested + 1)
+  // Number of array elements in one test entry (num_args_tested + 2)
   intptr_t len = result.TestEntryLength();
   // IC data array must be null terminated (sentinel entry).
   const Array& ic_data = Array::Handle(Array::New(len, Heap::kOld));
@@ -8169,6 +8255,151 @@ RawICData* ICData::New(const Function& function,
 }
 
 
+RawMegamorphicCache* MegamorphicCache::New(const String& target_name,
+                                           const Array& arguments_descriptor) {
+  ASSERT(Object::megamorphic_cache_class() != Class::null());
+  MegamorphicCache& result = MegamorphicCache::Handle();
+  {
+    // Megamorphic caches are long living objects, allocate them in the old
+    // generation.
+    RawObject* raw = Object::Allocate(MegamorphicCache::kClassId,
+                                      MegamorphicCache::InstanceSize(),
+                                      Heap::kOld);
+    NoGCScope no_gc;
+    result ^= raw;
+  }
+  result.set_target_name(target_name);
+  result.set_arguments_descriptor(arguments_descriptor);
+  result.set_buckets(Array::Handle(NewBuckets(kInitialCapacity)));
+  result.set_mask(kInitialCapacity - 1);
+  result.set_filled_entry_count(0);
+  return result.raw();
+}
+
+
+RawArray* MegamorphicCache::NewBuckets(intptr_t capacity) {
+  ASSERT(Utils::IsPowerOfTwo(capacity));
+  const Array& buckets =
+      Array::Handle(Array::New(capacity * kEntryLength, Heap::kOld));
+  // The illegal class id marks the empty buckets, which end the probing.
+  const Smi& empty = Smi::Handle(Smi::New(kIllegalCid));
+  for (intptr_t i = 0; i < capacity; i++) {
+    buckets.SetAt((i * kEntryLength) + kClassIdIndex, empty);
+  }
+  return buckets.raw();
+}
+
+
+void MegamorphicCache::SetEntry(const Array& buckets,
+                                intptr_t mask,
+                                intptr_t class_id,
+                                const Function& target) {
+  // Probe the buckets in the same order as the megamorphic lookup stub.
+  intptr_t index = class_id & mask;
+  Smi& probe = Smi::Handle();
+  probe ^= buckets.At((index * kEntryLength) + kClassIdIndex);
+  while (probe.Value() != kIllegalCid) {
+    ASSERT(probe.Value() != class_id);
+    index = (index + 1) & mask;
+    probe ^= buckets.At((index * kEntryLength) + kClassIdIndex);
+  }
+  buckets.SetAt((index * kEntryLength) + kClassIdIndex,
+                Smi::Handle(Smi::New(class_id)));
+  buckets.SetAt((index * kEntryLength) + kTargetFunctionIndex, target);
+}
+
+
+void MegamorphicCache::Insert(intptr_t class_id,
+                              const Function& target) const {
+  ASSERT(class_id != kIllegalCid);
+  ASSERT(Lookup(class_id) == Function::null());
+  const intptr_t count = filled_entry_count() + 1;
+  if ((count * 100) > (capacity() * kLoadFactorPercent)) {
+    // Rehash into twice as many buckets.  The load factor keeps some
+    // buckets empty, which terminates the probing.
+    const Array& old_buckets = Array::Handle(buckets());
+    const intptr_t old_capacity = capacity();
+    const intptr_t new_capacity = old_capacity * 2;
+    const Array& new_buckets = Array::Handle(NewBuckets(new_capacity));
+    Smi& entry_class_id = Smi::Handle();
+    Function& entry_target = Function::Handle();
+    for (intptr_t i = 0; i < old_capacity; i++) {
+      entry_class_id ^= old_buckets.At((i * kEntryLength) + kClassIdIndex);
+      if (entry_class_id.Value() != kIllegalCid) {
+        entry_target ^=
+            old_buckets.At((i * kEntryLength) + kTargetFunctionIndex);
+        SetEntry(new_buckets,
+                 new_capacity - 1,
+                 entry_class_id.Value(),
+                 entry_target);
+      }
+    }
+    set_buckets(new_buckets);
+    set_mask(new_capacity - 1);
+  }
+  SetEntry(Array::Handle(buckets()), mask(), class_id, target);
+  set_filled_entry_count(count);
+}
+
+
+RawFunction* MegamorphicCache::Lookup(intptr_t class_id) const {
+  const Array& data = Array::Handle(buckets());
+  intptr_t index = class_id & mask();
+  Smi& probe = Smi::Handle();
+  probe ^= data.At((index * kEntryLength) + kClassIdIndex);
+  while (probe.Value() != kIllegalCid) {
+    if (probe.Value() == class_id) {
+      Function& target = Function::Handle();
+      target ^= data.At((index * kEntryLength) + kTargetFunctionIndex);
+      return target.raw();
+    }
+    index = (index + 1) & mask();
+    probe ^= data.At((index * kEntryLength) + kClassIdIndex);
+  }
+  return Function::null();
+}
+
+
+intptr_t MegamorphicCache::mask() const {
+  return Smi::Value(raw_ptr()->mask_);
+}
+
+
+void MegamorphicCache::set_buckets(const Array& value) const {
+  StorePointer(&raw_ptr()->buckets_, value.raw());
+}
+
+
+void MegamorphicCache::set_mask(intptr_t value) const {
+  raw_ptr()->mask_ = Smi::New(value);
+}
+
+
+void MegamorphicCache::set_target_name(const String& value) const {
+  StorePointer(&raw_ptr()->target_name_, value.raw());
+}
+
+
+void MegamorphicCache::set_arguments_descriptor(const Array& value) const {
+  StorePointer(&raw_ptr()->arguments_descriptor_, value.raw());
+}
+
+
+void MegamorphicCache::set_filled_entry_count(intptr_t value) const {
+  raw_ptr()->filled_entry_count_ = value;
+}
+
+
+const char* MegamorphicCache::ToCString() const {
+  const char* kFormat = "MegamorphicCache target:%s";
+  const String& name = String::Handle(target_name());
+  intptr_t len = OS::SNPrint(NULL, 0, kFormat, name.ToCString()) + 1;
+  char* chars = Isolate::Current()->current_zone()->Alloc<char>(len);
+  OS::SNPrint(chars, len, kFormat, name.ToCString());
+  return chars;
+}
+
+
 RawSubtypeTestCache* SubtypeTestCache::New() {
   ASSERT(Object::subtypetestcache_class() != Class::null());
   SubtypeTestCache& result = SubtypeTestCache::Handle();
@@ -11305,6 +11536,103 @@ const char* ExternalFloat64Array::ToCString() const {
 
 
 
+RawFloat32x4* Float32x4::New(float x, float y, float z, float w,
+                             Heap::Space space) {
+  simd128_value_t value;
+  value.float_storage[0] = x;
+  value.float_storage[1] = y;
+  value.float_storage[2] = z;
+  value.float_storage[3] = w;
+  return New(value, space);
+}
+
+
+RawFloat32x4* Float32x4::New(simd128_value_t value, Heap::Space space) {
+  ASSERT(Isolate::Current()->object_store()->float32x4_class() !=
+         Class::null());
+  Float32x4& result = Float32x4::Handle();
+  {
+    RawObject* raw = Object::Allocate(Float32x4::kClassId,
+                                      Float32x4::InstanceSize(),
+                                      space);
+    NoGCScope no_gc;
+    result ^= raw;
+  }
+  result.set_value(value);
+  return result.raw();
+}
+
+
+simd128_value_t Float32x4::value() const {
+  simd128_value_t value;
+  memmove(&value, &raw_ptr()->value_, sizeof(value));
+  return value;
+}
+
+
+void Float32x4::set_value(simd128_value_t value) const {
+  memmove(&raw_ptr()->value_, &value, sizeof(value));
+}
+
+
+const char* Float32x4::ToCString() const {
+  const char* format = "[%f, %f, %f, %f]";
+  intptr_t len = OS::SNPrint(NULL, 0, format, x(), y(), z(), w()) + 1;
+  char* chars = Isolate::Current()->current_zone()->Alloc<char>(len);
+  OS::SNPrint(chars, len, format, x(), y(), z(), w());
+  return chars;
+}
+
+
+RawInt32x4* Int32x4::New(int32_t x, int32_t y, int32_t z, int32_t w,
+                         Heap::Space space) {
+  simd128_value_t value;
+  value.int_storage[0] = x;
+  value.int_storage[1] = y;
+  value.int_storage[2] = z;
+  value.int_storage[3] = w;
+  return New(value, space);
+}
+
+
+RawInt32x4* Int32x4::New(simd128_value_t value, Heap::Space space) {
+  ASSERT(Isolate::Current()->object_store()->int32x4_class() !=
+         Class::null());
+  Int32x4& result = Int32x4::Handle();
+  {
+    RawObject* raw = Object::Allocate(Int32x4::kClassId,
+                                      Int32x4::InstanceSize(),
+                                      space);
+    NoGCScope no_gc;
+    result ^= raw;
+  }
+  result.set_value(value);
+  return result.raw();
+}
+
+
+simd128_value_t Int32x4::value() const {
+  simd128_value_t value;
+  memmove(&value, &raw_ptr()->value_, sizeof(value));
+  return value;
+}
+
+
+void Int32x4::set_value(simd128_value_t value) const {
+  memmove(&raw_ptr()->value_, &value, sizeof(value));
+}
+
+
+const char* Int32x4::ToCString() const {
+  const char* format = "[%08x, %08x, %08x, %08x]";
+  intptr_t len = OS::SNPrint(NULL, 0, format, x(), y(), z(), w()) + 1;
+  char* chars = Isolate::Current()->current_zone()->Alloc<char>(len);
+  OS::SNPrint(chars, len, format, x(), y(), z(), w());
+  return chars;
+}
+
+
+
 RawClosure* Closure::New(const Function& function,
                          const Context& context,
                          Heap::Space space) {
@@ -283,6 +283,9 @@ CLASS_LIST_NO_OBJECT(DEFINE_CLASS_TESTER);
   }
   static RawClass* unwind_error_class() { return unwind_error_class_; }
   static RawClass* icdata_class() { return icdata_class_; }
+  static RawClass* megamorphic_cache_class() {
+    return megamorphic_cache_class_;
+  }
   static RawClass* subtypetestcache_class() { return subtypetestcache_class_; }
 
   static RawError* Init(Isolate* isolate);
@@ -343,7 +346,11 @@ CLASS_LIST_NO_OBJECT(DEFINE_CLASS_TESTER);
     if (!value->IsHeapObject()) return;
     if (value->IsNewObject() && raw()->IsOldObject()) {
       uword ptr = reinterpret_cast<uword>(addr);
-      Isolate::Current()->store_buffer()->AddPointer(ptr);
+      Isolate::Current()->store_buffer()->AddPointer(raw(), ptr);
+    } else if (Heap::IsAnyIsolateMarking() && raw()->IsOldObject()) {
+      // Record the store for the incremental marker.
+      uword ptr = reinterpret_cast<uword>(addr);
+      Isolate::Current()->store_buffer_block()->AddPointer(ptr);
     }
   }
 
@@ -406,6 +413,7 @@ CLASS_LIST_NO_OBJECT(DEFINE_CLASS_TESTER);
   static RawClass* context_class_;  // Class of the Context vm object.
   static RawClass* context_scope_class_;  // Class of ContextScope vm object.
   static RawClass* icdata_class_;  // Class of ICData.
+  static RawClass* megamorphic_cache_class_;  // Class of MegamorphicCache.
   static RawClass* subtypetestcache_class_;  // Class of SubtypeTestCache.
   static RawClass* api_error_class_;  // Class of ApiError.
   static RawClass* language_error_class_;  // Class of LanguageError.
@@ -2323,6 +2331,7 @@ class PcDescriptors : public Object {
     kIcCall,           // IC call.
     kFuncCall,         // Call to known target, e.g. static call, closure call.
     kReturn,           // Return from function.
+    kOsrEntry,         // Call at a loop stack check to enter optimized code.
     kOther
   };
 
@@ -2710,6 +2719,10 @@ class Code : public Object {
   uword GetDeoptBeforePcAtDeoptId(intptr_t deopt_id) const;
   uword GetDeoptAfterPcAtDeoptId(intptr_t deopt_id) const;
 
+  // Returns the id of the loop whose stack check called the runtime at 'pc'
+  // in unoptimized code, or Isolate::kNoDeoptId.
+  intptr_t GetOsrIdAtPc(uword pc) const;
+
   // Returns true if there is an object in the code between 'start_offset'
   // (inclusive) and 'end_offset' (exclusive).
   bool ObjectExistsInArea(intptr_t start_offest, intptr_t end_offset) const;
@@ -2737,6 +2750,9 @@ class Code : public Object {
     DISALLOW_COPY_AND_ASSIGN(FindRawCodeVisitor);
   };
 
+  // Finds the instructions containing 'pc' by walking the code space.
+  static RawInstructions* LookupCodeInCodeSpace(Isolate* isolate, uword pc);
+
   static const intptr_t kEntrySize = sizeof(int32_t);  // NOLINT
 
   void set_instructions(RawInstructions* instructions) {
@@ -2940,6 +2956,18 @@ class ICData : public Object {
     return OFFSET_OF(RawICData, function_);
   }
 
+  static intptr_t megamorphic_cache_offset() {
+    return OFFSET_OF(RawICData, megamorphic_cache_);
+  }
+
+  // The call site of a megamorphic IC calls the megamorphic lookup stub,
+  // which probes the cache instead of the checks.
+  RawMegamorphicCache* megamorphic_cache() const {
+    return raw_ptr()->megamorphic_cache_;
+  }
+  void set_megamorphic_cache(const MegamorphicCache& value) const;
+  bool IsMegamorphic() const;
+
   // Adds one more class test to ICData. Length of 'classes' must be equal to
   // the number of arguments tested. Use only for num_args_tested > 1.
   void AddCheck(const GrowableArray<intptr_t>& class_ids,
@@ -2947,7 +2975,8 @@ class ICData : public Object {
   // Adds sorted so that Smi is the first class-id. Use only for
   // num_args_tested == 1.
   void AddReceiverCheck(intptr_t receiver_class_id,
-                        const Function& target) const;
+                        const Function& target,
+                        intptr_t count = 0) const;
   void GetCheckAt(intptr_t index,
                   GrowableArray<intptr_t>* class_ids,
                   Function* target) const;
@@ -2956,10 +2985,13 @@ class ICData : public Object {
 
   intptr_t GetReceiverClassIdAt(intptr_t index) const;
   RawFunction* GetTargetAt(intptr_t index) const;
+  // Number of calls which found the check in the inline cache stub.
+  intptr_t GetCountAt(intptr_t index) const;
   RawFunction* GetTargetForReceiverClassId(intptr_t class_id) const;
 
   // Returns this->raw() if num_args_tested == 1, otherwise returns a new
-  // ICData object containing only unique arg0 checks.
+  // ICData object containing only unique arg0 checks, with the counts of the
+  // merged checks summed.
   RawICData* AsUnaryClassChecks() const;
 
   bool AllTargetsHaveSameOwner(intptr_t owner_cid) const;
@@ -2989,6 +3021,83 @@ class ICData : public Object {
 };
 
 
+// Hash table from the receiver class ids of the instance calls of one
+// selector, i.e. target name and arguments descriptor, to their target
+// functions.  It is shared by the megamorphic call sites of the selector and
+// probed linearly by the megamorphic lookup stub.
+class MegamorphicCache : public Object {
+ public:
+  enum EntryType {
+    kClassIdIndex = 0,
+    kTargetFunctionIndex = 1,
+    kEntryLength = 2,
+  };
+
+  static const intptr_t kInitialCapacity = 16;
+  static const intptr_t kLoadFactorPercent = 75;
+
+  RawString* target_name() const {
+    return raw_ptr()->target_name_;
+  }
+
+  RawArray* arguments_descriptor() const {
+    return raw_ptr()->arguments_descriptor_;
+  }
+
+  intptr_t filled_entry_count() const {
+    return raw_ptr()->filled_entry_count_;
+  }
+
+  // Number of buckets, a power of two.
+  intptr_t capacity() const {
+    return mask() + 1;
+  }
+
+  // Adds an entry for a class id not yet in the cache, growing it if needed.
+  void Insert(intptr_t class_id, const Function& target) const;
+
+  // Returns null if the class id is not in the cache.
+  RawFunction* Lookup(intptr_t class_id) const;
+
+  static RawMegamorphicCache* New(const String& target_name,
+                                  const Array& arguments_descriptor);
+
+  static intptr_t InstanceSize() {
+    return RoundedAllocationSize(sizeof(RawMegamorphicCache));
+  }
+
+  static intptr_t buckets_offset() {
+    return OFFSET_OF(RawMegamorphicCache, buckets_);
+  }
+
+  static intptr_t mask_offset() {
+    return OFFSET_OF(RawMegamorphicCache, mask_);
+  }
+
+ private:
+  RawArray* buckets() const {
+    return raw_ptr()->buckets_;
+  }
+
+  intptr_t mask() const;
+
+  void set_buckets(const Array& value) const;
+  void set_mask(intptr_t value) const;
+  void set_target_name(const String& value) const;
+  void set_arguments_descriptor(const Array& value) const;
+  void set_filled_entry_count(intptr_t value) const;
+
+  static RawArray* NewBuckets(intptr_t capacity);
+  static void SetEntry(const Array& buckets,
+                       intptr_t mask,
+                       intptr_t class_id,
+                       const Function& target);
+
+  HEAP_OBJECT_IMPLEMENTATION(MegamorphicCache, Object);
+  friend class Class;
+};
+
+
 class SubtypeTestCache : public Object {
  public:
   enum Entries {
@@ -5376,6 +5485,63 @@ class Closure : public Instance {
 };
 
 
+// SIMD value of four single precision floats, lanes x, y, z and w.
+class Float32x4 : public Instance {
+ public:
+  static RawFloat32x4* New(float x, float y, float z, float w,
+                           Heap::Space space = Heap::kNew);
+  static RawFloat32x4* New(simd128_value_t value,
+                           Heap::Space space = Heap::kNew);
+
+  float x() const { return raw_ptr()->value_[0]; }
+  float y() const { return raw_ptr()->value_[1]; }
+  float z() const { return raw_ptr()->value_[2]; }
+  float w() const { return raw_ptr()->value_[3]; }
+
+  simd128_value_t value() const;
+  void set_value(simd128_value_t value) const;
+
+  static intptr_t InstanceSize() {
+    return RoundedAllocationSize(sizeof(RawFloat32x4));
+  }
+
+  static intptr_t value_offset() { return OFFSET_OF(RawFloat32x4, value_); }
+
+ private:
+  HEAP_OBJECT_IMPLEMENTATION(Float32x4, Instance);
+  friend class Class;
+};
+
+
+// SIMD value of four 32-bit integers, lanes x, y, z and w.  Comparisons of
+// Float32x4 values produce masks with all bits of a lane set or cleared.
+class Int32x4 : public Instance {
+ public:
+  static RawInt32x4* New(int32_t x, int32_t y, int32_t z, int32_t w,
+                         Heap::Space space = Heap::kNew);
+  static RawInt32x4* New(simd128_value_t value,
+                         Heap::Space space = Heap::kNew);
+
+  int32_t x() const { return raw_ptr()->value_[0]; }
+  int32_t y() const { return raw_ptr()->value_[1]; }
+  int32_t z() const { return raw_ptr()->value_[2]; }
+  int32_t w() const { return raw_ptr()->value_[3]; }
+
+  simd128_value_t value() const;
+  void set_value(simd128_value_t value) const;
+
+  static intptr_t InstanceSize() {
+    return RoundedAllocationSize(sizeof(RawInt32x4));
+  }
+
+  static intptr_t value_offset() { return OFFSET_OF(RawInt32x4, value_); }
+
+ private:
+  HEAP_OBJECT_IMPLEMENTATION(Int32x4, Instance);
+  friend class Class;
+};
+
+
 // Internal stacktrace object used in exceptions for printing stack traces.
 class Stacktrace : public Instance {
  public:
@@ -56,6 +56,8 @@ ObjectStore::ObjectStore()
     external_uint64_array_class_(Class::null()),
     external_float32_array_class_(Class::null()),
     external_float64_array_class_(Class::null()),
+    float32x4_class_(Class::null()),
+    int32x4_class_(Class::null()),
     stacktrace_class_(Class::null()),
     jsregexp_class_(Class::null()),
     weak_property_class_(Class::null()),
@@ -312,6 +312,20 @@ class ObjectStore {
     external_float64_array_class_ = value.raw();
   }
 
+  RawClass* float32x4_class() const {
+    return float32x4_class_;
+  }
+  void set_float32x4_class(const Class& value) {
+    float32x4_class_ = value.raw();
+  }
+
+  RawClass* int32x4_class() const {
+    return int32x4_class_;
+  }
+  void set_int32x4_class(const Class& value) {
+    int32x4_class_ = value.raw();
+  }
+
   RawClass* stacktrace_class() const {
     return stacktrace_class_;
   }
@@ -506,6 +520,8 @@ class ObjectStore {
   RawClass* external_uint64_array_class_;
   RawClass* external_float32_array_class_;
   RawClass* external_float64_array_class_;
+  RawClass* float32x4_class_;
+  RawClass* int32x4_class_;
   RawClass* stacktrace_class_;
   RawClass* jsregexp_class_;
   RawClass* weak_property_class_;
@@ -5,6 +5,7 @@
 #include "platform/assert.h"
 #include "vm/assembler.h"
 #include "vm/bigint_operations.h"
+#include "vm/dart_entry.h"
 #include "vm/isolate.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
@@ -2654,6 +2655,39 @@ TEST_CASE(ICData) {
 }
 
 
+TEST_CASE(MegamorphicCache) {
+  const String& target_name = String::Handle(String::New("Thun"));
+  const Array& arguments_descriptor =
+      DartEntry::ArgumentsDescriptor(1, Array::Handle());
+  const MegamorphicCache& cache = MegamorphicCache::Handle(
+      MegamorphicCache::New(target_name, arguments_descriptor));
+  EXPECT_EQ(target_name.raw(), cache.target_name());
+  EXPECT_EQ(arguments_descriptor.raw(), cache.arguments_descriptor());
+  EXPECT_EQ(0, cache.filled_entry_count());
+  const intptr_t kInitialCapacity = MegamorphicCache::kInitialCapacity;
+  EXPECT_EQ(kInitialCapacity, cache.capacity());
+  EXPECT_EQ(Function::null(), cache.Lookup(kSmiCid));
+
+  // Fill the cache past its load factor, the class ids collide modulo the
+  // initial capacity.
+  const intptr_t kNumClasses = 20;
+  Function& target = Function::Handle();
+  for (intptr_t i = 0; i < kNumClasses; i++) {
+    target = GetDummyTarget("Bern");
+    cache.Insert(kNumPredefinedCids + (i * 8), target);
+    EXPECT_EQ(i + 1, cache.filled_entry_count());
+    EXPECT_EQ(target.raw(), cache.Lookup(kNumPredefinedCids + (i * 8)));
+  }
+  EXPECT_EQ(2 * kInitialCapacity, cache.capacity());
+  for (intptr_t i = 0; i < kNumClasses; i++) {
+    target = cache.Lookup(kNumPredefinedCids + (i * 8));
+    EXPECT(!target.IsNull());
+    EXPECT_EQ(Function::null(),
+              cache.Lookup(kNumPredefinedCids + (i * 8) + 1));
+  }
+}
+
+
 TEST_CASE(SubtypeTestCache) {
   String& class_name = String::Handle(Symbols::New("EmptyClass"));
   Script& script = Script::Handle();
@@ -0,0 +1,202 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/optimization_queue.h"
+
+#include "platform/assert.h"
+#include "vm/compiler.h"
+#include "vm/dart.h"
+#include "vm/debugger.h"
+#include "vm/exceptions.h"
+#include "vm/growable_array.h"
+#include "vm/isolate.h"
+#include "vm/object.h"
+#include "vm/os.h"
+#include "vm/thread_pool.h"
+#include "vm/visitor.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, deferred_optimization, false,
+            "Queue the functions reaching the optimization threshold and "
+            "optimize them one at a time at later safe points of the "
+            "mutator, running their unoptimized code in the meantime");
+DEFINE_FLAG(int, deferred_optimization_delay, 5,
+            "Milliseconds between two optimizations of queued functions");
+DECLARE_FLAG(bool, trace_failed_optimization_attempts);
+
+
+class OptimizationQueue::TimerTask : public ThreadPool::Task {
+ public:
+  explicit TimerTask(OptimizationQueue* queue) : queue_(queue) {}
+
+  virtual void Run() {
+    queue_->RunTimer();
+  }
+
+ private:
+  OptimizationQueue* queue_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimerTask);
+};
+
+
+OptimizationQueue::OptimizationQueue(Isolate* isolate)
+    : isolate_(isolate),
+      queue_(GrowableObjectArray::null()),
+      head_(0),
+      monitor_(),
+      timer_running_(false),
+      timer_armed_(false),
+      shutting_down_(false) {
+}
+
+
+OptimizationQueue::~OptimizationQueue() {
+  MonitorLocker ml(&monitor_);
+  shutting_down_ = true;
+  ml.Notify();
+  while (timer_running_) {
+    ml.Wait();
+  }
+}
+
+
+intptr_t OptimizationQueue::NumberOfChecks(const Function& function) {
+  const Code& code = Code::Handle(function.unoptimized_code());
+  GrowableArray<intptr_t> deopt_ids;
+  const GrowableObjectArray& ic_data_objs =
+      GrowableObjectArray::Handle(GrowableObjectArray::New());
+  code.ExtractIcDataArraysAtCalls(&deopt_ids, ic_data_objs);
+  ICData& ic_data = ICData::Handle();
+  intptr_t num_checks = 0;
+  for (intptr_t i = 0; i < ic_data_objs.Length(); i++) {
+    ic_data ^= ic_data_objs.At(i);
+    num_checks += ic_data.NumberOfChecks();
+  }
+  return num_checks;
+}
+
+
+bool OptimizationQueue::Add(const Function& function) {
+  ASSERT(!function.HasOptimizedCode());
+  if (queue_ == GrowableObjectArray::null()) {
+    queue_ = GrowableObjectArray::New(kEntrySize, Heap::kOld);
+  }
+  const GrowableObjectArray& queue = GrowableObjectArray::Handle(queue_);
+  for (intptr_t i = head_; i < queue.Length(); i += kEntrySize) {
+    if (queue.At(i + kFunctionIndex) == function.raw()) {
+      // The interrupt may have been lost when the isolate was reentered.
+      ArmTimer();
+      return false;
+    }
+  }
+  queue.Add(function, Heap::kOld);
+  queue.Add(Smi::Handle(Smi::New(NumberOfChecks(function))), Heap::kOld);
+  queue.Add(Smi::Handle(Smi::New(isolate_->class_table()->NumCids())),
+            Heap::kOld);
+  ArmTimer();
+  return true;
+}
+
+
+void OptimizationQueue::OptimizeNext() {
+  if (Length() == 0) {
+    return;
+  }
+  const GrowableObjectArray& queue = GrowableObjectArray::Handle(queue_);
+  Function& function = Function::Handle();
+  function ^= queue.At(head_ + kFunctionIndex);
+  Smi& value = Smi::Handle();
+  value ^= queue.At(head_ + kNumChecksIndex);
+  const intptr_t num_checks = value.Value();
+  value ^= queue.At(head_ + kNumCidsIndex);
+  const intptr_t num_cids = value.Value();
+  for (intptr_t i = 0; i < kEntrySize; i++) {
+    queue.SetAt(head_ + i, Object::Handle());
+  }
+  head_ += kEntrySize;
+  if (head_ == queue.Length()) {
+    queue.SetLength(0);
+    head_ = 0;
+  } else {
+    ArmTimer();
+  }
+
+  if (function.HasOptimizedCode() || !function.is_optimizable()) {
+    return;
+  }
+  if (isolate_->debugger()->IsActive()) {
+    // We cannot set breakpoints in optimized code.
+    function.set_usage_counter(0);
+    return;
+  }
+  if ((num_checks != NumberOfChecks(function)) ||
+      (num_cids != isolate_->class_table()->NumCids())) {
+    // The function is queued again once it reaches the optimization
+    // threshold with the new type feedback.
+    if (FLAG_trace_failed_optimization_attempts) {
+      OS::Print("Discarded optimization of '%s': type feedback changed\n",
+                function.ToFullyQualifiedCString());
+    }
+    function.set_usage_counter(0);
+    return;
+  }
+  const Error& error =
+      Error::Handle(Compiler::CompileOptimizedFunction(function));
+  if (!error.IsNull()) {
+    Exceptions::PropagateError(error);
+  }
+  function.set_usage_counter(0);
+}
+
+
+intptr_t OptimizationQueue::Length() const {
+  if (queue_ == GrowableObjectArray::null()) {
+    return 0;
+  }
+  const GrowableObjectArray& queue = GrowableObjectArray::Handle(queue_);
+  return (queue.Length() - head_) / kEntrySize;
+}
+
+
+void OptimizationQueue::VisitObjectPointers(ObjectPointerVisitor* visitor) {
+  visitor->VisitPointer(reinterpret_cast<RawObject**>(&queue_));
+}
+
+
+void OptimizationQueue::ArmTimer() {
+  MonitorLocker ml(&monitor_);
+  if (timer_armed_) {
+    return;
+  }
+  // A task only runs while the timer is armed, it ends once it has
+  // requested the interrupt.
+  ASSERT(!timer_running_);
+  timer_armed_ = true;
+  timer_running_ = true;
+  Dart::thread_pool()->Run(new TimerTask(this));
+}
+
+
+void OptimizationQueue::RunTimer() {
+  MonitorLocker ml(&monitor_);
+  ASSERT(timer_armed_ && timer_running_);
+  const int64_t deadline =
+      OS::GetCurrentTimeMillis() + FLAG_deferred_optimization_delay;
+  int64_t now = OS::GetCurrentTimeMillis();
+  while (!shutting_down_ && (now < deadline)) {
+    ml.Wait(deadline - now);
+    now = OS::GetCurrentTimeMillis();
+  }
+  if (!shutting_down_) {
+    timer_armed_ = false;
+    isolate_->ScheduleInterrupts(Isolate::kOptimizeInterrupt);
+  }
+  // The queue may be deleted as soon as the monitor is released.
+  timer_running_ = false;
+  ml.Notify();
+}
+
+}  // namespace dart
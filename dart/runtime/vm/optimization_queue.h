@@ -0,0 +1,86 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_OPTIMIZATION_QUEUE_H_
+#define VM_OPTIMIZATION_QUEUE_H_
+
+#include "vm/allocation.h"
+#include "vm/flags.h"
+#include "vm/globals.h"
+#include "vm/thread.h"
+
+namespace dart {
+
+// Forward declarations.
+class Function;
+class Isolate;
+class ObjectPointerVisitor;
+class RawGrowableObjectArray;
+
+DECLARE_FLAG(bool, deferred_optimization);
+
+// The OptimizationQueue holds the functions of an isolate which reached the
+// optimization threshold, so that they keep running their unoptimized code
+// instead of being optimized on the spot by OptimizeInvokedFunction.
+//
+// The optimizing compiler allocates in the heap and the zone of the isolate,
+// so it can only run on the thread of the mutator. Timer tasks on the thread
+// pool pace the optimizations instead: while the queue is not empty, a task
+// waits --deferred_optimization_delay milliseconds, interrupts the mutator
+// and ends, and the mutator optimizes the function at the head of the queue
+// at the stack overflow check handling the interrupt. No thread is held while
+// the queue is empty. The optimized code is not installed if the type
+// feedback of the function or the set of classes of the isolate changed since
+// the function was queued, as the feedback is then not stable yet.
+class OptimizationQueue {
+ public:
+  explicit OptimizationQueue(Isolate* isolate);
+  // Stops the pending timer task.
+  ~OptimizationQueue();
+
+  // Queues 'function' for optimization. Returns false if it was already
+  // queued.
+  bool Add(const Function& function);
+
+  // Optimizes the function at the head of the queue. Called at a safe point.
+  void OptimizeNext();
+
+  intptr_t Length() const;
+
+  void VisitObjectPointers(ObjectPointerVisitor* visitor);
+
+ private:
+  class TimerTask;
+
+  // Each queued function is followed by the number of checks of its IC data
+  // and the number of classes of the isolate when it was queued.
+  enum {
+    kFunctionIndex = 0,
+    kNumChecksIndex,
+    kNumCidsIndex,
+    kEntrySize,
+  };
+
+  static intptr_t NumberOfChecks(const Function& function);
+
+  // Starts a task requesting an interrupt of the mutator after the delay,
+  // unless one is pending.
+  void ArmTimer();
+  void RunTimer();
+
+  Isolate* isolate_;
+  RawGrowableObjectArray* queue_;
+  intptr_t head_;
+
+  Monitor monitor_;
+  bool timer_running_;
+  bool timer_armed_;
+  bool shutting_down_;
+
+  DISALLOW_COPY_AND_ASSIGN(OptimizationQueue);
+};
+
+}  // namespace dart
+
+#endif  // VM_OPTIMIZATION_QUEUE_H_
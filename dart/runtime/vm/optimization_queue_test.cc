@@ -0,0 +1,103 @@
+// Copyright (c) 2012, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/assert.h"
+#include "vm/dart.h"
+#include "vm/isolate.h"
+#include "vm/object.h"
+#include "vm/optimization_queue.h"
+#include "vm/symbols.h"
+#include "vm/thread_pool.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+DECLARE_FLAG(int, deferred_optimization_delay);
+
+// Compiler only implemented on IA32 and x64 now.
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
+
+static RawFunction* GetStaticFunction(const char* class_name,
+                                      const char* function_name) {
+  const String& url = String::Handle(String::New(TestCase::url()));
+  const Library& lib = Library::Handle(Library::LookupLibrary(url));
+  const Class& cls = Class::Handle(
+      lib.LookupClass(String::Handle(Symbols::New(class_name))));
+  EXPECT(!cls.IsNull());
+  return cls.LookupStaticFunction(String::Handle(Symbols::New(function_name)));
+}
+
+
+TEST_CASE(OptimizationQueue) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  static foo(x) => x + 1;\n"
+      "  static bar(x) => x - 1;\n"
+      "}\n"
+      "main() {\n"
+      "  var sum = 0;\n"
+      "  for (var i = 0; i < 1000000; i++) {\n"
+      "    sum = A.foo(sum);\n"
+      "  }\n"
+      "  return A.bar(sum);\n"
+      "}\n";
+  const bool saved_deferred_optimization = FLAG_deferred_optimization;
+  const intptr_t saved_delay = FLAG_deferred_optimization_delay;
+  FLAG_deferred_optimization = true;
+  FLAG_deferred_optimization_delay = 0;
+  const uint64_t workers_running = Dart::thread_pool()->workers_running();
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, Dart_NewString("main"), 0, NULL));
+
+  // The hot function was optimized at a safe point while main was running.
+  Function& function = Function::Handle(GetStaticFunction("A", "foo"));
+  EXPECT(function.HasOptimizedCode());
+
+  // The timer tasks end once they have interrupted the mutator, they do not
+  // hold a thread of the pool while no optimization is pending.
+  const int kMaxSleep = 20 * 1000;  // 20 seconds.
+  int sleep = 0;
+  while ((sleep < kMaxSleep) &&
+         (Dart::thread_pool()->workers_running() > workers_running)) {
+    OS::Sleep(10);
+    sleep += 10;
+  }
+  EXPECT_EQ(workers_running, Dart::thread_pool()->workers_running());
+
+  // The optimization of a function is discarded when a class is added while
+  // it is queued.
+  OptimizationQueue* queue = Isolate::Current()->optimization_queue();
+  FLAG_deferred_optimization_delay = 60 * 1000;
+  // Main was queued when it returned.
+  while (queue->Length() > 0) {
+    queue->OptimizeNext();
+  }
+  function = GetStaticFunction("A", "bar");
+  EXPECT(function.HasCode());
+  EXPECT(!function.HasOptimizedCode());
+  EXPECT(queue->Add(function));
+  EXPECT(!queue->Add(function));
+  EXPECT_EQ(1, queue->Length());
+  const Class& cls = Class::Handle(
+      Class::New(String::Handle(Symbols::New("B")),
+                 Script::Handle(),
+                 Scanner::kDummyTokenIndex));
+  EXPECT(!cls.IsNull());
+  queue->OptimizeNext();
+  EXPECT_EQ(0, queue->Length());
+  EXPECT(!function.HasOptimizedCode());
+
+  // Otherwise it is installed.
+  EXPECT(queue->Add(function));
+  queue->OptimizeNext();
+  EXPECT_EQ(0, queue->Length());
+  EXPECT(function.HasOptimizedCode());
+
+  FLAG_deferred_optimization = saved_deferred_optimization;
+  FLAG_deferred_optimization_delay = saved_delay;
+}
+
+#endif  // TARGET_ARCH_IA32 || TARGET_ARCH_X64
+
+}  // namespace dart
@@ -4,10 +4,17 @@
 
 #include "vm/pages.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "platform/assert.h"
+#include "vm/code_index_table.h"
+#include "vm/gc_compactor.h"
+#include "vm/gc_events.h"
 #include "vm/gc_marker.h"
 #include "vm/gc_sweeper.h"
 #include "vm/object.h"
+#include "vm/store_buffer.h"
 #include "vm/virtual_memory.h"
 
 namespace dart {
@@ -22,28 +29,68 @@ DEFINE_FLAG(bool, print_free_list_before_gc, false,
             "Print free list statistics before a GC");
 DEFINE_FLAG(bool, print_free_list_after_gc, false,
             "Print free list statistics after a GC");
+DEFINE_FLAG(bool, lazy_sweep, true,
+            "Sweep old space pages on demand after marking instead of "
+            "during the GC pause");
+DEFINE_FLAG(bool, incremental_marking, false,
+            "Mark the old space in steps interleaved with the execution of "
+            "the program instead of in a single pause");
+DEFINE_FLAG(int, marking_step_micros, 1000,
+            "The maximum duration of an incremental marking step in "
+            "microseconds");
+DEFINE_FLAG(int, compaction_threshold, 50,
+            "Compact the old space after marking when at least this "
+            "percentage of the pages keeping live objects is free. 0 compacts "
+            "on every collection, 100 disables compaction");
+DEFINE_FLAG(int, free_memory_release_delay, 1000,
+            "Return the free memory of the old gen pages to the OS after a "
+            "mark-sweep once the old gen has not grown for this many "
+            "milliseconds, or when the isolate becomes idle. A negative "
+            "value disables the release");
+
+// Huge pages can only back 2MB aligned memory, the regular pages are too
+// small to use them.
+static bool UseHugePages(intptr_t size, bool is_executable) {
+  return FLAG_use_huge_pages &&
+      !is_executable &&
+      (size >= VirtualMemory::kHugePageSize);
+}
 
 HeapPage* HeapPage::Initialize(VirtualMemory* memory, bool is_executable) {
   ASSERT(memory->size() > VirtualMemory::PageSize());
-  memory->Commit(is_executable);
+  if (!memory->Commit(is_executable)) {
+    delete memory;
+    return NULL;
+  }
+  if (UseHugePages(memory->size(), is_executable)) {
+    memory->AdviseHugePages();
+  }
 
   HeapPage* result = reinterpret_cast<HeapPage*>(memory->address());
   result->memory_ = memory;
   result->next_ = NULL;
   result->used_ = 0;
   result->top_ = result->first_object_start();
+  result->card_table_ = NULL;
+  result->num_cards_ = 0;
+  ASSERT(Utils::IsAligned(result->first_object_start(), kObjectAlignment));
   return result;
 }
 
 
 HeapPage* HeapPage::Allocate(intptr_t size, bool is_executable) {
-  VirtualMemory* memory =
-      VirtualMemory::ReserveAligned(size, PageSpace::kPageAlignment);
+  intptr_t alignment = UseHugePages(size, is_executable) ?
+      VirtualMemory::kHugePageSize : PageSpace::kPageAlignment;
+  VirtualMemory* memory = VirtualMemory::ReserveAligned(size, alignment);
+  if (memory == NULL) {
+    return NULL;
+  }
   return Initialize(memory, is_executable);
 }
 
 
 void HeapPage::Deallocate() {
+  delete[] card_table_;
   // The memory for this object will become unavailable after the delete below.
   delete memory_;
 }
@@ -93,16 +140,113 @@ void HeapPage::WriteProtect(bool read_only) {
 }
 
 
+void HeapPage::AllocateCardTable() {
+  ASSERT(card_table_ == NULL);
+  num_cards_ = memory_->size() >> kCardSizeLog2;
+  card_table_ = new uint8_t[num_cards_];
+  memset(card_table_, 0, num_cards_);
+}
+
+
+void HeapPage::MarkCard(uword addr) {
+  ASSERT(Contains(addr));
+  ASSERT(card_table_ != NULL);
+  card_table_[(addr - start()) >> kCardSizeLog2] = 1;
+}
+
+
+bool HeapPage::TryMarkCard(RawObject* raw_obj, uword addr) {
+  ASSERT(raw_obj->IsOldObject());
+  HeapPage* page = PageSpace::PageFor(raw_obj);
+  if (page->card_table_ == NULL) {
+    return false;
+  }
+  page->MarkCard(addr);
+  return true;
+}
+
+
+// Restricts the pointer ranges visited to the dirty cards of a card table.
+class DirtyCardVisitor : public ObjectPointerVisitor {
+ public:
+  DirtyCardVisitor(ObjectPointerVisitor* visitor,
+                   uword page_start,
+                   uint8_t* card_table)
+      : ObjectPointerVisitor(visitor->isolate()),
+        visitor_(visitor),
+        page_start_(page_start),
+        card_table_(card_table),
+        num_dirty_cards_(0) {}
+
+  intptr_t num_dirty_cards() const { return num_dirty_cards_; }
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    uword first_addr = reinterpret_cast<uword>(first);
+    uword last_addr = reinterpret_cast<uword>(last);
+    intptr_t first_card = (first_addr - page_start_) >> HeapPage::kCardSizeLog2;
+    intptr_t last_card = (last_addr - page_start_) >> HeapPage::kCardSizeLog2;
+    for (intptr_t i = first_card; i <= last_card; i++) {
+      if (card_table_[i] == 0) {
+        continue;
+      }
+      // The slots still containing new objects after the visit mark their
+      // card again.
+      card_table_[i] = 0;
+      num_dirty_cards_++;
+      uword card_start = page_start_ + (i << HeapPage::kCardSizeLog2);
+      uword card_last = card_start + HeapPage::kCardSize - kWordSize;
+      visitor_->VisitPointers(
+          reinterpret_cast<RawObject**>(Utils::Maximum(first_addr, card_start)),
+          reinterpret_cast<RawObject**>(Utils::Minimum(last_addr, card_last)));
+    }
+  }
+
+ private:
+  ObjectPointerVisitor* visitor_;
+  uword page_start_;
+  uint8_t* card_table_;
+  intptr_t num_dirty_cards_;
+
+  DISALLOW_COPY_AND_ASSIGN(DirtyCardVisitor);
+};
+
+
+intptr_t HeapPage::VisitDirtyCards(ObjectPointerVisitor* visitor) {
+  if (card_table_ == NULL) {
+    return 0;
+  }
+  DirtyCardVisitor card_visitor(visitor, start(), card_table_);
+  RawObject::FromAddr(first_object_start())->VisitPointers(&card_visitor);
+  return card_visitor.num_dirty_cards();
+}
+
+
+void HeapPage::ClearCards() {
+  if (card_table_ != NULL) {
+    memset(card_table_, 0, num_cards_);
+  }
+}
+
+
 PageSpace::PageSpace(Heap* heap, intptr_t max_capacity, bool is_executable)
     : freelist_(),
       heap_(heap),
       pages_(NULL),
       pages_tail_(NULL),
       large_pages_(NULL),
+      sorted_large_pages_(),
       bump_page_(NULL),
+      area_top_(0),
+      area_end_(0),
+      sweep_page_(NULL),
+      incremental_marker_(NULL),
+      marking_capacity_limit_(0),
+      marking_step_in_use_(0),
       max_capacity_(max_capacity),
       capacity_(0),
       in_use_(0),
+      last_growth_time_(0),
+      free_memory_released_(false),
       count_(0),
       is_executable_(is_executable),
       sweeping_(false),
@@ -113,6 +257,7 @@ PageSpace::PageSpace(Heap* heap, intptr_t max_capacity, bool is_executable)
 
 
 PageSpace::~PageSpace() {
+  delete incremental_marker_;
   FreePages(pages_);
   FreePages(large_pages_);
 }
@@ -125,8 +270,11 @@ intptr_t PageSpace::LargePageSizeFor(intptr_t size) {
 }
 
 
-void PageSpace::AllocatePage() {
+bool PageSpace::AllocatePage() {
   HeapPage* page = HeapPage::Allocate(kPageSize, is_executable_);
+  if (page == NULL) {
+    return false;
+  }
   if (pages_ == NULL) {
     pages_ = page;
   } else {
@@ -135,15 +283,29 @@ void PageSpace::AllocatePage() {
   pages_tail_ = page;
   bump_page_ = NULL;  // Reenable scanning of pages for bump allocation.
   capacity_ += kPageSize;
+  last_growth_time_ = OS::GetCurrentTimeMillis();
+  return true;
 }
 
 
 HeapPage* PageSpace::AllocateLargePage(intptr_t size) {
   intptr_t page_size = LargePageSizeFor(size);
   HeapPage* page = HeapPage::Allocate(page_size, is_executable_);
+  if (page == NULL) {
+    return NULL;
+  }
+  if (!is_executable_) {
+    page->AllocateCardTable();
+  }
   page->set_next(large_pages_);
   large_pages_ = page;
+  sorted_large_pages_.insert(
+      std::upper_bound(sorted_large_pages_.begin(),
+                       sorted_large_pages_.end(),
+                       page),
+      page);
   capacity_ += page_size;
+  last_growth_time_ = OS::GetCurrentTimeMillis();
   return page;
 }
 
@@ -172,6 +334,12 @@ void PageSpace::FreeLargePage(HeapPage* page, HeapPage* previous_page) {
   } else {
     large_pages_ = page->next();
   }
+  std::vector<HeapPage*>::iterator it =
+      std::lower_bound(sorted_large_pages_.begin(),
+                       sorted_large_pages_.end(),
+                       page);
+  ASSERT((it != sorted_large_pages_.end()) && (*it == page));
+  sorted_large_pages_.erase(it);
   page->Deallocate();
 }
 
@@ -187,6 +355,9 @@ void PageSpace::FreePages(HeapPage* pages) {
 
 
 uword PageSpace::TryBumpAllocate(intptr_t size) {
+  // Objects bump allocated into an unswept page would be reclaimed when the
+  // page gets swept.
+  ASSERT(!sweep_pending());
   if (pages_tail_ == NULL) {
     return 0;
   }
@@ -212,6 +383,71 @@ uword PageSpace::TryBumpAllocate(intptr_t size) {
 }
 
 
+bool PageSpace::RefillAllocationArea() {
+  // Code pages may be write protected.
+  if (is_executable_) {
+    return false;
+  }
+  ReleaseAllocationArea();
+  // The freelist is not searched and pages are neither swept nor allocated
+  // to find a new area, a failed refill is cheap. The regular allocation
+  // path does this, allowing the next refill to succeed. Larger blocks are
+  // split, their remainder stays available to large allocations.
+  intptr_t area_size = 0;
+  uword area = freelist_.TryAllocateLarge(kAllocationAreaSize, &area_size);
+  if ((area == 0) && !sweep_pending()) {
+    area_size = kAllocationAreaSize;
+    area = TryBumpAllocate(area_size);
+  }
+  if (area == 0) {
+    return false;
+  }
+  area_top_ = area;
+  area_end_ = area + area_size;
+  return true;
+}
+
+
+void PageSpace::ReleaseAllocationArea() {
+  if (area_top_ < area_end_) {
+    freelist_.Free(area_top_, area_end_ - area_top_);
+  }
+  area_top_ = 0;
+  area_end_ = 0;
+}
+
+
+bool PageSpace::SweepNextPage() {
+  HeapPage* page = sweep_page_;
+  if (page == NULL) {
+    return false;
+  }
+  sweep_page_ = page->next();
+  GCSweeper sweeper(heap_);
+  intptr_t page_in_use = sweeper.SweepPage(page, &freelist_);
+  // Pages without live objects were released by MarkSweep.
+  ASSERT(page_in_use > 0);
+  if (!sweep_pending()) {
+    ReleaseFreeMemory(false);
+  }
+  return true;
+}
+
+
+void PageSpace::CompleteSweep() {
+  while (SweepNextPage()) {
+    // Sweep remaining pages.
+  }
+  ASSERT(!sweep_pending());
+}
+
+
+void PageSpace::NotifyIdle() {
+  CompleteSweep();
+  ReleaseFreeMemory(true);
+}
+
+
 uword PageSpace::TryAllocate(intptr_t size) {
   return TryAllocate(size, kControlGrowth);
 }
@@ -222,16 +458,30 @@ uword PageSpace::TryAllocate(intptr_t size, GrowthPolicy growth_policy) {
   ASSERT(Utils::IsAligned(size, kObjectAlignment));
   uword result = 0;
   if (size < kAllocatablePageSize) {
-    result = freelist_.TryAllocate(size);
+    result = TryAllocateInArea(size);
+    if ((result == 0) &&
+        (size <= FreeList::kMinLargeSize) &&
+        RefillAllocationArea()) {
+      result = TryAllocateInArea(size);
+      ASSERT(result != 0);
+    }
+    if (result == 0) {
+      result = freelist_.TryAllocate(size);
+      while ((result == 0) && SweepNextPage()) {
+        result = freelist_.TryAllocate(size);
+      }
+    }
     if (result == 0) {
       result = TryBumpAllocate(size);
       if ((result == 0) &&
-          (page_space_controller_.CanGrowPageSpace(size) ||
-           growth_policy == kForceGrowth) &&
+          (page_space_controller_.CanGrowPageSpace(size, Footprint()) ||
+           growth_policy == kForceGrowth ||
+           CanGrowWhileMarking()) &&
           CanIncreaseCapacity(kPageSize)) {
-        AllocatePage();
-        result = TryBumpAllocate(size);
-        ASSERT(result != 0);
+        if (AllocatePage()) {
+          result = TryBumpAllocate(size);
+          ASSERT(result != 0);
+        }
       }
     }
   } else {
@@ -256,6 +506,23 @@ uword PageSpace::TryAllocate(intptr_t size, GrowthPolicy growth_policy) {
 }
 
 
+intptr_t PageSpace::Footprint() const {
+  // Spaces created on their own in tests have no heap.
+  if (heap_ == NULL) {
+    return capacity_;
+  }
+  return capacity_ + (heap_->CapacityInWords(Heap::kNew) * kWordSize);
+}
+
+
+void PageSpace::Free(uword addr, intptr_t size) {
+  ASSERT(size >= kObjectAlignment);
+  ASSERT(size < kAllocatablePageSize);
+  freelist_.Free(addr, size);
+  in_use_ -= size;
+}
+
+
 bool PageSpace::Contains(uword addr) const {
   HeapPage* page = pages_;
   while (page != NULL) {
@@ -276,6 +543,53 @@ bool PageSpace::Contains(uword addr) const {
 }
 
 
+static bool StartsAfter(uword addr, HeapPage* page) {
+  return addr < page->start();
+}
+
+
+bool PageSpace::MarkCard(uword addr) {
+  if (sorted_large_pages_.empty() ||
+      (addr < sorted_large_pages_.front()->start()) ||
+      (addr >= sorted_large_pages_.back()->end())) {
+    return false;
+  }
+  // Find the last large page starting at or below the address.
+  std::vector<HeapPage*>::const_iterator it =
+      std::upper_bound(sorted_large_pages_.begin(),
+                       sorted_large_pages_.end(),
+                       addr,
+                       StartsAfter);
+  if (it == sorted_large_pages_.begin()) {
+    return false;
+  }
+  HeapPage* page = *(it - 1);
+  if (!page->Contains(addr)) {
+    return false;
+  }
+  page->MarkCard(addr);
+  return true;
+}
+
+
+intptr_t PageSpace::VisitDirtyCards(ObjectPointerVisitor* visitor) {
+  // Large pages allocated for objects promoted by the visitor are added to
+  // the front of the list, they do not have any dirty cards.
+  intptr_t num_dirty_cards = 0;
+  for (HeapPage* page = large_pages_; page != NULL; page = page->next()) {
+    num_dirty_cards += page->VisitDirtyCards(visitor);
+  }
+  return num_dirty_cards;
+}
+
+
+void PageSpace::ClearCards() {
+  for (HeapPage* page = large_pages_; page != NULL; page = page->next()) {
+    page->ClearCards();
+  }
+}
+
+
 void PageSpace::StartEndAddress(uword* start, uword* end) const {
   ASSERT(pages_ != NULL || large_pages_ != NULL);
   *start = static_cast<uword>(~0);
@@ -293,7 +607,9 @@ void PageSpace::StartEndAddress(uword* start, uword* end) const {
 }
 
 
-void PageSpace::VisitObjects(ObjectVisitor* visitor) const {
+void PageSpace::VisitObjects(ObjectVisitor* visitor) {
+  CompleteSweep();
+  ReleaseAllocationArea();
   HeapPage* page = pages_;
   while (page != NULL) {
     page->VisitObjects(visitor);
@@ -308,7 +624,9 @@ void PageSpace::VisitObjects(ObjectVisitor* visitor) const {
 }
 
 
-void PageSpace::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
+void PageSpace::VisitObjectPointers(ObjectPointerVisitor* visitor) {
+  CompleteSweep();
+  ReleaseAllocationArea();
   HeapPage* page = pages_;
   while (page != NULL) {
     page->VisitObjectPointers(visitor);
@@ -323,8 +641,10 @@ void PageSpace::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
 }
 
 
-RawObject* PageSpace::FindObject(FindObjectVisitor* visitor) const {
+RawObject* PageSpace::FindObject(FindObjectVisitor* visitor) {
   ASSERT(Isolate::Current()->no_gc_scope_depth() != 0);
+  CompleteSweep();
+  ReleaseAllocationArea();
   HeapPage* page = pages_;
   while (page != NULL) {
     RawObject* obj = page->FindObject(visitor);
@@ -347,6 +667,10 @@ RawObject* PageSpace::FindObject(FindObjectVisitor* visitor) const {
 
 
 void PageSpace::WriteProtect(bool read_only) {
+  if (read_only) {
+    // The freelist is written to when the area is released.
+    ReleaseAllocationArea();
+  }
   HeapPage* page = pages_;
   while (page != NULL) {
     page->WriteProtect(read_only);
@@ -360,13 +684,175 @@ void PageSpace::WriteProtect(bool read_only) {
 }
 
 
-void PageSpace::MarkSweep(bool invoke_api_callbacks, const char* gc_reason) {
+void PageSpace::StartIncrementalMarking() {
+  ASSERT(!marking_in_progress());
+  ASSERT(!is_executable_);
+  Isolate* isolate = Isolate::Current();
+  NoHandleScope no_handles(isolate);
+
+  // Unswept pages still carry the mark bits of the previous collection.
+  CompleteSweep();
+
+  if (FLAG_verbose_gc) {
+    OS::PrintErr("Start incremental marking\n");
+  }
+  marking_capacity_limit_ = 2 * capacity_;
+  marking_step_in_use_ = in_use_;
+  GCEventScope event(heap_,
+                     Dart_GcEvent::kMarkingStep,
+                     Heap::kIncrementalMarking);
+  GCPhaseScope phase(heap_, Dart_GcEvent::kRoots);
+  incremental_marker_ = new IncrementalMarker(heap_, this);
+  incremental_marker_->Start(isolate);
+}
+
+
+void PageSpace::IncrementalMarkingStep() {
+  ASSERT(marking_in_progress());
+  ASSERT(!sweeping_);
+  Isolate* isolate = Isolate::Current();
+  NoHandleScope no_handles(isolate);
+  marking_step_in_use_ = in_use_;
+  bool done = false;
+  {
+    GCEventScope event(heap_,
+                       Dart_GcEvent::kMarkingStep,
+                       Heap::kIncrementalMarking);
+    GCPhaseScope phase(heap_, Dart_GcEvent::kMark);
+    done = incremental_marker_->Step(isolate, FLAG_marking_step_micros);
+  }
+  if (done) {
+    // The marker has run out of work, finish the collection.
+    GCEventScope event(heap_,
+                       Dart_GcEvent::kMarkSweep,
+                       Heap::kIncrementalMarking);
+    MarkSweep(true, Heap::GCReasonToString(Heap::kIncrementalMarking));
+  }
+}
+
+
+void PageSpace::ShadeObject(RawObject* raw_obj) {
+  if (incremental_marker_ != NULL) {
+    incremental_marker_->ShadeObject(raw_obj);
+  }
+}
+
+
+void PageSpace::FilterStoreBuffer(Isolate* isolate) {
+  isolate->store_buffer_block()->ProcessBuffer(isolate);
+  std::vector<uword> pointers;
+  StoreBuffer::DedupSet* pending = isolate->store_buffer()->DedupSets();
+  while (pending != NULL) {
+    StoreBuffer::DedupSet* next = pending->next();
+    HashSet* set = pending->set();
+    for (intptr_t i = 0; i < set->Size(); i++) {
+      if (set->At(i) != 0) {
+        pointers.push_back(set->At(i));
+      }
+    }
+    delete pending;
+    pending = next;
+  }
+  std::sort(pointers.begin(), pointers.end());
+  // The entries are looked up by binary search, so the dropped ones are
+  // flagged separately instead of being cleared.
+  std::vector<bool> dropped(pointers.size(), false);
+
+  // Walk the objects of the pages containing entries in address order to
+  // find the object each entry is located in.
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    size_t i = std::lower_bound(pointers.begin(),
+                                pointers.end(),
+                                page->first_object_start()) - pointers.begin();
+    uword obj_addr = page->first_object_start();
+    RawObject* raw_obj = NULL;
+    uword obj_end = obj_addr;
+    for (; (i < pointers.size()) && (pointers[i] < page->top()); i++) {
+      while (obj_end <= pointers[i]) {
+        obj_addr = obj_end;
+        raw_obj = RawObject::FromAddr(obj_addr);
+        obj_end = obj_addr + raw_obj->Size();
+      }
+      if (!raw_obj->IsMarked()) {
+        dropped[i] = true;
+      }
+    }
+  }
+  for (HeapPage* page = large_pages_; page != NULL; page = page->next()) {
+    RawObject* raw_obj = RawObject::FromAddr(page->first_object_start());
+    if (raw_obj->IsMarked()) {
+      continue;
+    }
+    size_t i = std::lower_bound(pointers.begin(),
+                                pointers.end(),
+                                page->first_object_start()) - pointers.begin();
+    for (; (i < pointers.size()) && (pointers[i] < page->top()); i++) {
+      dropped[i] = true;
+    }
+  }
+
+  StoreBuffer* store_buffer = isolate->store_buffer();
+  for (size_t i = 0; i < pointers.size(); i++) {
+    if (!dropped[i]) {
+      store_buffer->AddPointer(pointers[i]);
+    }
+  }
+}
+
+
+void PageSpace::ReleaseFreeMemory(bool idle) {
+  if (is_executable_ || free_memory_released_ || sweep_pending() ||
+      (FLAG_free_memory_release_delay < 0)) {
+    return;
+  }
+  // An idle isolate is not about to reuse the memory, and above the soft
+  // limit memory is released without delay.
+  if (!idle &&
+      !page_space_controller_.ExceedsSoftLimit(Footprint()) &&
+      ((OS::GetCurrentTimeMillis() - last_growth_time_) <
+       FLAG_free_memory_release_delay)) {
+    return;
+  }
+  // The unused ends of the pages may have been used before a compaction.
+  intptr_t released = freelist_.ReleaseMemory();
+  for (HeapPage* page = pages_; page != NULL; page = page->next()) {
+    released += VirtualMemory::ReleaseMemory(page->top(),
+                                             page->end() - page->top());
+  }
+  if (FLAG_verbose_gc) {
+    OS::PrintErr("Released %"Pd"K of free memory\n", released / KB);
+  }
+  free_memory_released_ = true;
+}
+
+
+bool PageSpace::NeedsCompaction(intptr_t free_in_pages,
+                                intptr_t fragmentation) const {
+  if (FLAG_compaction_threshold == 0) {
+    return true;
+  }
+  // Only compact if at least a page can be released.
+  return (fragmentation >= FLAG_compaction_threshold) &&
+      (free_in_pages >= kAllocatablePageSize);
+}
+
+
+void PageSpace::MarkSweep(bool invoke_api_callbacks,
+                          const char* gc_reason,
+                          bool compact) {
   // MarkSweep is not reentrant. Make sure that is the case.
   ASSERT(!sweeping_);
   sweeping_ = true;
   Isolate* isolate = Isolate::Current();
   NoHandleScope no_handles(isolate);
 
+  // The unused end of the allocation area is reclaimed by the sweeper.
+  ReleaseAllocationArea();
+
+  // Pages left over from the previous collection still have their mark bits
+  // set and need to be swept before marking can start.
+  CompleteSweep();
+
   if (FLAG_print_free_list_before_gc) {
     freelist_.Print();
   }
@@ -384,9 +870,33 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks, const char* gc_reason) {
   timer.Start();
   int64_t start = OS::GetCurrentTimeMillis();
 
-  // Mark all reachable old-gen objects.
-  GCMarker marker(heap_);
-  marker.MarkObjects(isolate, this, invoke_api_callbacks);
+  // Mark all reachable old-gen objects, or complete the incremental marking
+  // in progress.
+  if (incremental_marker_ != NULL) {
+    incremental_marker_->Finish(isolate, invoke_api_callbacks);
+    // Unlike the marker of MarkObjects, the incremental marker does not
+    // rebuild the store buffer. Drop its entries in objects about to be freed,
+    // their memory may be reused for objects which are not scanned for
+    // pointers.
+    {
+      GCPhaseScope phase(heap_, Dart_GcEvent::kStoreBuffer);
+      FilterStoreBuffer(isolate);
+    }
+    if (FLAG_verbose_gc) {
+      OS::PrintErr("Incremental marking: %"Pd" steps, %"Pd64"us\n",
+                   incremental_marker_->num_steps(),
+                   incremental_marker_->step_micros());
+    }
+    delete incremental_marker_;
+    incremental_marker_ = NULL;
+  } else {
+    GCMarker marker(heap_);
+    marker.MarkObjects(isolate, this, invoke_api_callbacks);
+  }
+  if (is_executable_) {
+    // The instructions about to be swept must not be found by a lookup.
+    heap_->code_index_table()->RemoveUnmarked();
+  }
 
   // Reset the bump allocation page to unused.
   bump_page_ = NULL;
@@ -396,33 +906,99 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks, const char* gc_reason) {
   intptr_t in_use = 0;
 
   HeapPage* prev_page = NULL;
-  HeapPage* page = pages_;
-  while (page != NULL) {
-    intptr_t page_in_use = sweeper.SweepPage(page, &freelist_);
-    HeapPage* next_page = page->next();
-    if (page_in_use == 0) {
-      FreePage(page, prev_page);
-    } else {
-      in_use += page_in_use;
-      prev_page = page;
+  HeapPage* page = large_pages_;
+  {
+    GCPhaseScope phase(heap_, Dart_GcEvent::kSweep);
+    while (page != NULL) {
+      intptr_t page_in_use = sweeper.SweepLargePage(page);
+      HeapPage* next_page = page->next();
+      if (page_in_use == 0) {
+        FreeLargePage(page, prev_page);
+      } else {
+        in_use += page_in_use;
+        prev_page = page;
+      }
+      // Advance to the next page.
+      page = next_page;
     }
-    // Advance to the next page.
-    page = next_page;
   }
 
-  prev_page = NULL;
-  page = large_pages_;
-  while (page != NULL) {
-    intptr_t page_in_use = sweeper.SweepLargePage(page);
-    HeapPage* next_page = page->next();
-    if (page_in_use == 0) {
-      FreeLargePage(page, prev_page);
-    } else {
-      in_use += page_in_use;
-      prev_page = page;
+  // The marker has computed the live bytes of every page.
+  intptr_t pages_with_live_objects = 0;
+  intptr_t free_in_pages = 0;
+  for (page = pages_; page != NULL; page = page->next()) {
+    if (page->used() > 0) {
+      pages_with_live_objects++;
+      free_in_pages += kAllocatablePageSize - page->used();
     }
-    // Advance to the next page.
-    page = next_page;
+  }
+  intptr_t fragmentation = (pages_with_live_objects == 0) ? 0 :
+      (free_in_pages * 100) / (pages_with_live_objects * kAllocatablePageSize);
+  if (FLAG_verbose_gc && !is_executable_) {
+    OS::PrintErr("Fragmentation: %"Pd"%% (%"Pd"K free in %"Pd" pages)\n",
+                 fragmentation,
+                 free_in_pages / KB,
+                 pages_with_live_objects);
+  }
+
+  // Code cannot be moved.
+  if (!is_executable_ &&
+      (compact || NeedsCompaction(free_in_pages, fragmentation))) {
+    GCPhaseScope phase(heap_, Dart_GcEvent::kCompact);
+    int64_t compaction_start = OS::GetCurrentTimeMicros();
+    intptr_t capacity_before = capacity_;
+    GCCompactor compactor(heap_, isolate);
+    in_use += compactor.CompactPages(pages_, large_pages_, &freelist_);
+    // Release the pages emptied by the compaction and reset the used bytes of
+    // the others for the next marking.
+    prev_page = NULL;
+    page = pages_;
+    while (page != NULL) {
+      HeapPage* next_page = page->next();
+      if (page->used() == 0) {
+        FreePage(page, prev_page);
+      } else {
+        page->set_used(0);
+        prev_page = page;
+      }
+      page = next_page;
+    }
+    if (FLAG_verbose_gc) {
+      OS::PrintErr("Compaction: %"Pd"K reclaimed, %"Pd64"us\n",
+                   (capacity_before - capacity_) / KB,
+                   OS::GetCurrentTimeMicros() - compaction_start);
+    }
+  } else {
+    // Code pages are always swept eagerly. Otherwise only pages without any
+    // live objects are released here, using the per page used bytes computed
+    // by the marker, and the others are swept on demand by TryAllocate.
+    const bool lazy_sweep = FLAG_lazy_sweep && !is_executable_;
+    GCPhaseScope phase(heap_, Dart_GcEvent::kSweep);
+
+    prev_page = NULL;
+    page = pages_;
+    while (page != NULL) {
+      intptr_t page_in_use = lazy_sweep ?
+          page->used() : sweeper.SweepPage(page, &freelist_);
+      HeapPage* next_page = page->next();
+      if (page_in_use == 0) {
+        FreePage(page, prev_page);
+      } else {
+        in_use += page_in_use;
+        prev_page = page;
+      }
+      // Advance to the next page.
+      page = next_page;
+    }
+    if (lazy_sweep) {
+      sweep_page_ = pages_;
+    }
+  }
+  // The free memory left by this collection is released once it has been
+  // swept, or when the isolate becomes idle.
+  free_memory_released_ = false;
+  if (!sweep_pending()) {
+    ReleaseFreeMemory(false);
   }
 
   // Record data and print if requested.
@@ -471,16 +1047,39 @@ PageSpaceController::PageSpaceController(int heap_growth_ratio,
       heap_growth_ratio_(heap_growth_ratio),
       desired_utilization_((100.0 - heap_growth_ratio) / 100.0),
       heap_growth_rate_(heap_growth_rate),
-      garbage_collection_time_ratio_(garbage_collection_time_ratio) {
+      garbage_collection_time_ratio_(garbage_collection_time_ratio),
+      soft_limit_(0),
+      hard_limit_(0) {
+}
+
+
+intptr_t PageSpaceController::GrowthBudget(intptr_t footprint) const {
+  intptr_t limit = soft_limit_;
+  if ((limit == 0) || ((hard_limit_ != 0) && (hard_limit_ < limit))) {
+    limit = hard_limit_;
+  }
+  if (limit == 0) {
+    return kIntptrMax;
+  }
+  return Utils::Maximum(limit - footprint, static_cast<intptr_t>(0));
 }
 
 
+const double PageSpaceController::kMinUtilization = 0.5;
+const double PageSpaceController::kUtilizationStep = 0.05;
+
+
 PageSpaceController::~PageSpaceController() {}
 
 
-bool PageSpaceController::CanGrowPageSpace(intptr_t size_in_bytes) {
+bool PageSpaceController::CanGrowPageSpace(intptr_t size_in_bytes,
+                                           intptr_t footprint) {
   size_in_bytes = Utils::RoundUp(size_in_bytes, PageSpace::kPageSize);
   intptr_t size_in_pages =  size_in_bytes / PageSpace::kPageSize;
+  if (ExceedsSoftLimit(footprint + size_in_bytes)) {
+    // Collect garbage before growing beyond the soft limit.
+    return false;
+  }
   if (!is_enabled_) {
     return true;
   }
@@ -510,6 +1109,7 @@ void PageSpaceController::EvaluateGarbageCollection(
       history_.GarbageCollectionTimeFraction();
   bool enough_free_time =
       (garbage_collection_time_fraction <= garbage_collection_time_ratio_);
+  TuneUtilization(garbage_collection_time_fraction);
   if (enough_free_space && enough_free_time) {
     grow_heap_ = 0;
   } else {
@@ -530,7 +1130,7 @@ void PageSpaceController::EvaluateGarbageCollection(
       }
       OS::PrintErr("\n");
     }
-    if (!enough_free_space) {
+    if (!enough_free_space || !enough_free_time) {
       intptr_t growth_target = static_cast<intptr_t>(in_use_after /
                                                      desired_utilization_);
       intptr_t growth_in_bytes = Utils::RoundUp(growth_target - in_use_after,
@@ -544,6 +1144,30 @@ void PageSpaceController::EvaluateGarbageCollection(
 }
 
 
+void PageSpaceController::TuneUtilization(
+    int garbage_collection_time_fraction) {
+  double max_utilization = (100.0 - heap_growth_ratio_) / 100.0;
+  double utilization = desired_utilization_;
+  if (garbage_collection_time_fraction > garbage_collection_time_ratio_) {
+    // Trade memory for time: a heap with more free space is collected less
+    // often.
+    utilization = Utils::Maximum(utilization - kUtilizationStep,
+                                 kMinUtilization);
+  } else if ((2 * garbage_collection_time_fraction) <
+             garbage_collection_time_ratio_) {
+    // Well below the target, give the memory back.
+    utilization = Utils::Minimum(utilization + kUtilizationStep,
+                                 max_utilization);
+  }
+  if ((utilization != desired_utilization_) && FLAG_verbose_gc) {
+    OS::PrintErr("PageSpaceController: desired utilization %d%% -> %d%%\n",
+                 static_cast<int>(desired_utilization_ * 100),
+                 static_cast<int>(utilization * 100));
+  }
+  desired_utilization_ = utilization;
+}
+
+
 PageSpaceGarbageCollectionHistory::PageSpaceGarbageCollectionHistory()
     : index_(0) {
   for (intptr_t i = 0; i < kHistoryLength; i++) {
@@ -5,6 +5,9 @@
 #ifndef VM_PAGES_H_
 #define VM_PAGES_H_
 
+#include <vector>
+
+#include "vm/atomic.h"
 #include "vm/freelist.h"
 #include "vm/globals.h"
 #include "vm/virtual_memory.h"
@@ -13,12 +16,25 @@ namespace dart {
 
 // Forward declarations.
 class Heap;
+class IncrementalMarker;
+class Isolate;
 class ObjectPointerVisitor;
 
 // An aligned page containing old generation objects. Alignment is used to be
 // able to get to a HeapPage header quickly based on a pointer to an object.
 class HeapPage {
  public:
+  // The slots of the object of a large page are remembered in a card table
+  // instead of the store buffer. A card is dirty if any of the slots it covers
+  // was recorded since the last scavenge. The write barrier finds the card
+  // table in the header of the page of the object stored into.
+  static const intptr_t kCardSizeLog2 = 9;
+  static const intptr_t kCardSize = 1 << kCardSizeLog2;
+
+  static intptr_t card_table_offset() {
+    return OFFSET_OF(HeapPage, card_table_);
+  }
+
   HeapPage* next() const { return next_; }
   void set_next(HeapPage* next) { next_ = next; }
 
@@ -41,6 +57,11 @@ class HeapPage {
   void AddUsed(uword size) {
     used_ += size;
   }
+  // Used by the parallel marker, which updates pages from several threads.
+  void AtomicAddUsed(uword size) {
+    AtomicOperations::FetchAndIncrementBy(reinterpret_cast<intptr_t*>(&used_),
+                                          size);
+  }
 
   uword TryBumpAllocate(intptr_t size) {
     uword result = top();
@@ -59,10 +80,21 @@ class HeapPage {
 
   void WriteProtect(bool read_only);
 
+  void MarkCard(uword addr);
+  // Mark the card of the slot 'addr' of the old object 'raw_obj' if the
+  // object is located in a page with a card table.
+  static bool TryMarkCard(RawObject* raw_obj, uword addr);
+  // Visit the pointers of the object located in the dirty cards. The cards
+  // are cleared before they are visited. Returns the number of dirty cards.
+  intptr_t VisitDirtyCards(ObjectPointerVisitor* visitor);
+  void ClearCards();
+
  private:
   static HeapPage* Initialize(VirtualMemory* memory, bool is_executable);
   static HeapPage* Allocate(intptr_t size, bool is_executable);
 
+  void AllocateCardTable();
+
   // Deallocate the virtual memory backing this page. The page pointer to this
   // page becomes immediately inaccessible.
   void Deallocate();
@@ -71,6 +103,9 @@ class HeapPage {
   HeapPage* next_;
   uword used_;
   uword top_;
+  // Only the large pages of the data page space have a card table.
+  uint8_t* card_table_;
+  intptr_t num_cards_;
 
   friend class PageSpace;
 
@@ -105,6 +140,15 @@ class PageSpaceGarbageCollectionHistory {
 // and if the relative GC time is below a given threshold,
 // then the heap is not grown when the next GC decision is made.
 // PageSpaceController controls the heap size.
+//
+// The relative GC time is a target the controller tunes the heap size
+// against: the heap is allowed to hold more free space while collections
+// take more time than the target, and less once they take much less.
+//
+// The footprint of the heap can also be limited. Above the soft limit the
+// heap is only grown after a collection failed to free enough memory. The
+// hard limit is never exceeded, allocations failing because of it throw an
+// out of memory exception.
 class PageSpaceController {
  public:
   PageSpaceController(int heap_growth_ratio,
@@ -112,7 +156,36 @@ class PageSpaceController {
                       int garbage_collection_time_ratio);
   ~PageSpaceController();
 
-  bool CanGrowPageSpace(intptr_t size_in_bytes);
+  // Returns true if the heap may grow by 'size_in_bytes' without collecting
+  // garbage first. 'footprint' is the current footprint of the heap.
+  bool CanGrowPageSpace(intptr_t size_in_bytes, intptr_t footprint);
+
+  // Limits on the footprint of the heap in bytes, 0 for no limit.
+  void SetLimits(intptr_t soft_limit, intptr_t hard_limit) {
+    ASSERT((soft_limit >= 0) && (hard_limit >= 0));
+    soft_limit_ = soft_limit;
+    hard_limit_ = hard_limit;
+  }
+  intptr_t soft_limit() const { return soft_limit_; }
+  intptr_t hard_limit() const { return hard_limit_; }
+  bool ExceedsSoftLimit(intptr_t footprint) const {
+    return (soft_limit_ != 0) && (footprint > soft_limit_);
+  }
+  bool ExceedsHardLimit(intptr_t footprint) const {
+    return (hard_limit_ != 0) && (footprint > hard_limit_);
+  }
+  // The number of bytes a heap with the given footprint may grow by without
+  // exceeding either limit.
+  intptr_t GrowthBudget(intptr_t footprint) const;
+
+  // The desired maximum percentage of time spent in GC.
+  int garbage_collection_time_ratio() const {
+    return garbage_collection_time_ratio_;
+  }
+  void set_garbage_collection_time_ratio(int value) {
+    ASSERT((value > 0) && (value <= 100));
+    garbage_collection_time_ratio_ = value;
+  }
 
   // A garbage collection is considered as successful if more than
   // heap_growth_ratio % of memory got deallocated by the garbage collector.
@@ -126,6 +199,13 @@ class PageSpaceController {
   }
 
  private:
+  // The bounds of the desired utilization tuned against the GC time target.
+  static const double kMinUtilization;
+  static const double kUtilizationStep;
+
+  // Adjust the desired utilization to the relative GC time.
+  void TuneUtilization(int garbage_collection_time_fraction);
+
   bool is_enabled_;
 
   // Heap growth control variable.
@@ -135,8 +215,9 @@ class PageSpaceController {
   // memory, then the heap is grown. Otherwise garbage collection is performed.
   int heap_growth_ratio_;
 
-  // The desired percent of heap in-use after a garbage collection.
-  // Equivalent to \frac{100-heap_growth_ratio_}{100}.
+  // The desired percent of heap in-use after a garbage collection. Starts at
+  // \frac{100-heap_growth_ratio_}{100} and is lowered while the relative GC
+  // time exceeds its target.
   double desired_utilization_;
 
   // Number of pages we grow.
@@ -146,6 +227,10 @@ class PageSpaceController {
   // garbage collection can be performed.
   int garbage_collection_time_ratio_;
 
+  // Limits on the footprint of the heap, 0 if there is no limit.
+  intptr_t soft_limit_;
+  intptr_t hard_limit_;
+
   PageSpaceGarbageCollectionHistory history_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(PageSpaceController);
@@ -169,6 +254,10 @@ class PageSpace {
   uword TryAllocate(intptr_t size);
   uword TryAllocate(intptr_t size, GrowthPolicy growth_policy);
 
+  // Return a block, or the unused end of a block, allocated with TryAllocate
+  // to the freelist.
+  void Free(uword addr, intptr_t size);
+
   intptr_t in_use() const { return in_use_; }
   intptr_t capacity() const { return capacity_; }
 
@@ -180,13 +269,40 @@ class PageSpace {
     return size <= kAllocatablePageSize;
   }
 
-  void VisitObjects(ObjectVisitor* visitor) const;
-  void VisitObjectPointers(ObjectPointerVisitor* visitor) const;
-
-  RawObject* FindObject(FindObjectVisitor* visitor) const;
-
-  // Collect the garbage in the page space using mark-sweep.
-  void MarkSweep(bool invoke_api_callbacks, const char* gc_reason);
+  // Visiting objects first completes any pending sweeping, as unswept pages
+  // may still contain dead objects with stale pointers, and releases the
+  // allocation area.
+  void VisitObjects(ObjectVisitor* visitor);
+  void VisitObjectPointers(ObjectPointerVisitor* visitor);
+
+  RawObject* FindObject(FindObjectVisitor* visitor);
+
+  // Collect the garbage in the page space using mark-sweep. The live objects
+  // are compacted instead of swept if 'compact' is true or if the pages are
+  // fragmented beyond --compaction_threshold.
+  void MarkSweep(bool invoke_api_callbacks,
+                 const char* gc_reason,
+                 bool compact = false);
+
+  // Sweep all pages left unswept by the last MarkSweep.
+  void CompleteSweep();
+  bool sweep_pending() const { return sweep_page_ != NULL; }
+
+  // Called while the isolate is idle. Completes the sweeping and returns the
+  // free memory to the OS without waiting for --free_memory_release_delay.
+  void NotifyIdle();
+
+  // Incremental marking, see IncrementalMarker. It is started by the heap in
+  // place of a MarkSweep and advanced by steps taken on old space allocation
+  // and after scavenges. A MarkSweep completes any marking in progress.
+  void StartIncrementalMarking();
+  bool marking_in_progress() const { return incremental_marker_ != NULL; }
+  bool NeedsMarkingStep() const {
+    return marking_in_progress() &&
+        ((in_use_ - marking_step_in_use_) >= kMarkingStepAllocation);
+  }
+  void IncrementalMarkingStep();
+  void ShadeObject(RawObject* raw_obj);
 
   static HeapPage* PageFor(RawObject* raw_obj) {
     return reinterpret_cast<HeapPage*>(
@@ -195,17 +311,42 @@ class PageSpace {
 
   void StartEndAddress(uword* start, uword* end) const;
 
+  // Mark the card of the slot 'addr' if it is located in a large page.
+  // Returns false if the slot is located in a regular page, in which case it
+  // has to be remembered in the store buffer.
+  bool MarkCard(uword addr);
+  // Visit the pointers in the dirty cards of the large pages, see
+  // HeapPage::VisitDirtyCards. Returns the number of dirty cards.
+  intptr_t VisitDirtyCards(ObjectPointerVisitor* visitor);
+  void ClearCards();
+
   void EnableGrowthControl() {
     page_space_controller_.Enable();
   }
 
+  PageSpaceController* controller() { return &page_space_controller_; }
+
+  // The number of bytes the footprint of the heap may grow by without
+  // exceeding the limits of the controller.
+  intptr_t GrowthBudget() const {
+    return page_space_controller_.GrowthBudget(Footprint());
+  }
+
   void WriteProtect(bool read_only);
 
  private:
   static const intptr_t kAllocatablePageSize = kPageSize - sizeof(HeapPage);
 
-  void AllocatePage();
+  // The number of bytes allocated between marking steps.
+  static const intptr_t kMarkingStepAllocation = kPageSize;
+
+  // The size of the allocation areas carved out of the end of a page.
+  static const intptr_t kAllocationAreaSize = 32 * KB;
+
+  // Returns false if the OS is out of memory.
+  bool AllocatePage();
   void FreePage(HeapPage* page, HeapPage* previous_page);
+  // Returns NULL if the OS is out of memory.
   HeapPage* AllocateLargePage(intptr_t size);
   void FreeLargePage(HeapPage* page, HeapPage* previous_page);
   void FreePages(HeapPage* pages);
@@ -214,11 +355,49 @@ class PageSpace {
 
   bool CanIncreaseCapacity(intptr_t increase) {
     ASSERT(capacity_ <= max_capacity_);
-    return increase <= (max_capacity_ - capacity_);
+    return (increase <= (max_capacity_ - capacity_)) &&
+        !page_space_controller_.ExceedsHardLimit(Footprint() + increase);
   }
+  // The footprint of the heap the limits of the controller apply to.
+  intptr_t Footprint() const;
 
   uword TryBumpAllocate(intptr_t size);
 
+  // Small objects are bump allocated from a linear allocation area, carved
+  // out of a large free block or out of the unused end of a page.
+  uword TryAllocateInArea(intptr_t size) {
+    uword result = area_top_;
+    if ((area_end_ - result) < static_cast<uword>(size)) {
+      return 0;
+    }
+    area_top_ = result + size;
+    return result;
+  }
+  bool RefillAllocationArea();
+  // Return the unused end of the allocation area to the freelist, which
+  // leaves the pages iterable.
+  void ReleaseAllocationArea();
+
+  // Sweep the next page waiting to be swept, adding its free blocks to the
+  // freelist. Returns false if there are no such pages left.
+  bool SweepNextPage();
+
+  // Remove the store buffer entries located in objects which are not marked.
+  void FilterStoreBuffer(Isolate* isolate);
+
+  // Return the memory of the free blocks and of the unused ends of the pages
+  // to the OS once sweeping has completed. Unless 'idle' is true, nothing is
+  // released if the space has grown within the last
+  // --free_memory_release_delay milliseconds.
+  void ReleaseFreeMemory(bool idle);
+
+  // Decide whether the marked pages are fragmented enough to be compacted.
+  bool NeedsCompaction(intptr_t free_in_pages, intptr_t fragmentation) const;
+
+  bool CanGrowWhileMarking() const {
+    return marking_in_progress() && (capacity_ < marking_capacity_limit_);
+  }
+
   FreeList freelist_;
 
   Heap* heap_;
@@ -227,6 +406,9 @@ class PageSpace {
   HeapPage* pages_tail_;
   HeapPage* large_pages_;
 
+  // The large pages sorted by address, to find the page of a card.
+  std::vector<HeapPage*> sorted_large_pages_;
+
   // Page being used for bump allocation.
   // The value has different meanings:
   // NULL: Still bump allocating from last allocated fresh page.
@@ -234,11 +416,32 @@ class PageSpace {
   // tail page, we give up bump allocating.
   HeapPage* bump_page_;
 
+  // Linear allocation area, empty if area_top_ == area_end_. The memory
+  // between the two is not accounted as in use.
+  uword area_top_;
+  uword area_end_;
+
+  // First page that has not been swept since the last MarkSweep. All pages
+  // from here to the end of pages_ still carry mark bits and are only swept
+  // on demand when the freelist runs dry. NULL if sweeping is complete.
+  HeapPage* sweep_page_;
+
+  // Marker of the incremental marking in progress, NULL if there is none.
+  // While marking the space is allowed to grow up to marking_capacity_limit_.
+  IncrementalMarker* incremental_marker_;
+  intptr_t marking_capacity_limit_;
+  intptr_t marking_step_in_use_;
+
   // Various sizes being tracked for this generation.
   intptr_t max_capacity_;
   intptr_t capacity_;
   intptr_t in_use_;
 
+  // Time in milliseconds at which the last page was allocated.
+  int64_t last_growth_time_;
+  // Whether the free memory left by the last MarkSweep has been released.
+  bool free_memory_released_;
+
   // Old-gen GC cycle count.
   int count_;
 
@@ -47,9 +47,18 @@ intptr_t RawObject::SizeFromClass() const {
   // Only reasonable to be called on heap objects.
   ASSERT(IsHeapObject());
 
-  RawClass* raw_class = isolate->class_table()->At(GetClassId());
+  intptr_t instance_size = SizeFromClass(isolate, GetClassId());
+  uword tags = ptr()->tags_;
+  ASSERT((instance_size == SizeTag::decode(tags)) ||
+         (SizeTag::decode(tags) == 0));
+  return instance_size;
+}
+
+
+intptr_t RawObject::SizeFromClass(Isolate* isolate, intptr_t class_id) const {
+  RawClass* raw_class = isolate->class_table()->At(class_id);
   intptr_t instance_size = raw_class->ptr()->instance_size_;
-  intptr_t class_id = raw_class->ptr()->id_;
+  ASSERT(class_id == raw_class->ptr()->id_);
 
   if (instance_size == 0) {
     switch (class_id) {
@@ -234,7 +243,6 @@ intptr_t RawObject::SizeFromClass() const {
         break;
       }
       case kFreeListElement: {
-        ASSERT(FreeBit::decode(ptr()->tags_));
         uword addr = RawObject::ToAddr(const_cast<RawObject*>(this));
         FreeListElement* element = reinterpret_cast<FreeListElement*>(addr);
         instance_size = element->Size();
@@ -246,16 +254,19 @@ intptr_t RawObject::SizeFromClass() const {
     }
   }
   ASSERT(instance_size != 0);
-  uword tags = ptr()->tags_;
-  ASSERT((instance_size == SizeTag::decode(tags)) ||
-         (SizeTag::decode(tags) == 0));
   return instance_size;
 }
 
 
 intptr_t RawObject::VisitPointers(ObjectPointerVisitor* visitor) {
   intptr_t size = 0;
-  NoHandleScope no_handles(visitor->isolate());
+#if defined(DEBUG)
+  // Marking helper threads visit objects on behalf of the isolate without
+  // owning it and must leave its handle scope bookkeeping alone.
+  Isolate* isolate = visitor->isolate();
+  const bool is_isolate_thread = (isolate == Isolate::Current());
+  NoHandleScope no_handles(is_isolate_thread ? isolate : NULL);
+#endif  // defined(DEBUG)
 
   // Only reasonable to be called on heap objects.
   ASSERT(IsHeapObject());
@@ -297,7 +308,7 @@ intptr_t RawObject::VisitPointers(ObjectPointerVisitor* visitor) {
   }
 
   ASSERT(size != 0);
-  ASSERT(size == Size());
+  DEBUG_ASSERT(size == SizeFromTags(isolate, ptr()->tags_));
   return size;
 }
 
@@ -543,6 +554,14 @@ intptr_t RawICData::VisitICDataPointers(RawICData* raw_obj,
 }
 
 
+intptr_t RawMegamorphicCache::VisitMegamorphicCachePointers(
+    RawMegamorphicCache* raw_obj, ObjectPointerVisitor* visitor) {
+  // Make sure that we got here with the tagged pointer as this.
+  visitor->VisitPointers(raw_obj->from(), raw_obj->to());
+  return MegamorphicCache::InstanceSize();
+}
+
+
 intptr_t RawSubtypeTestCache::VisitSubtypeTestCachePointers(
     RawSubtypeTestCache* raw_obj, ObjectPointerVisitor* visitor) {
   // Make sure that we got here with the tagged pointer as this.
@@ -959,6 +978,22 @@ intptr_t RawClosure::VisitClosurePointers(RawClosure* raw_obj,
 }
 
 
+intptr_t RawFloat32x4::VisitFloat32x4Pointers(
+    RawFloat32x4* raw_obj, ObjectPointerVisitor* visitor) {
+  // Make sure that we got here with the tagged pointer as this.
+  ASSERT(raw_obj->IsHeapObject());
+  return Float32x4::InstanceSize();
+}
+
+
+intptr_t RawInt32x4::VisitInt32x4Pointers(RawInt32x4* raw_obj,
+                                          ObjectPointerVisitor* visitor) {
+  // Make sure that we got here with the tagged pointer as this.
+  ASSERT(raw_obj->IsHeapObject());
+  return Int32x4::InstanceSize();
+}
+
+
 intptr_t RawStacktrace::VisitStacktracePointers(RawStacktrace* raw_obj,
                                                 ObjectPointerVisitor* visitor) {
   // Make sure that we got here with the tagged pointer as this.
@@ -6,6 +6,7 @@
 #define VM_RAW_OBJECT_H_
 
 #include "platform/assert.h"
+#include "vm/atomic.h"
 #include "vm/globals.h"
 #include "vm/token.h"
 #include "vm/snapshot.h"
@@ -41,6 +42,7 @@ namespace dart {
   V(Context)                                                                   \
   V(ContextScope)                                                              \
   V(ICData)                                                                    \
+  V(MegamorphicCache)                                                          \
   V(SubtypeTestCache)                                                          \
   V(Error)                                                                     \
     V(ApiError)                                                                \
@@ -86,6 +88,8 @@ namespace dart {
       V(ExternalUint64Array)                                                   \
       V(ExternalFloat32Array)                                                  \
       V(ExternalFloat64Array)                                                  \
+    V(Float32x4)                                                               \
+    V(Int32x4)                                                                 \
     V(Stacktrace)                                                              \
     V(JSRegExp)                                                                \
     V(WeakProperty)                                                            \
@@ -192,8 +196,10 @@ class RawObject {
     kCanonicalBit = 2,
     kFromSnapshotBit = 3,
     kWatchedBit = 4,
-    kReservedTagBit = 5,  // kReservedBit{10K,100K,1M,10M}
-    kReservedTagSize = 3,
+    kAgeTagBit = 5,
+    kAgeTagSize = 2,
+    kReservedTagBit = 7,  // kReservedBit{10K,100K,1M,10M}
+    kReservedTagSize = 1,
     kSizeTagBit = 8,
     kSizeTagSize = 8,
     kClassIdTagBit = kSizeTagBit + kSizeTagSize,
@@ -235,6 +241,11 @@ class RawObject {
                                      kClassIdTagBit,
                                      kClassIdTagSize> {};  // NOLINT
 
+  // The number of scavenges a new object has survived. Old objects have an
+  // age of zero.
+  class AgeTag : public BitField<intptr_t, kAgeTagBit, kAgeTagSize> {};
+  static const intptr_t kMaxAge = (1 << kAgeTagSize) - 1;
+
   bool IsHeapObject() const {
     uword value = reinterpret_cast<uword>(this);
     return (value & kSmiTagMask) == kHeapObjectTag;
@@ -258,6 +269,20 @@ class RawObject {
     uword tags = ptr()->tags_;
     ptr()->tags_ = MarkBit::update(true, tags);
   }
+  // Atomically sets the mark bit. Returns true if this call set the bit and
+  // false if the object had already been marked, possibly by another thread.
+  bool TryAcquireMarkBit() {
+    uword tags = ptr()->tags_;
+    while (!MarkBit::decode(tags)) {
+      uword old_tags = AtomicOperations::CompareAndSwapWord(
+          &ptr()->tags_, tags, MarkBit::update(true, tags));
+      if (old_tags == tags) {
+        return true;
+      }
+      tags = old_tags;
+    }
+    return false;
+  }
   void ClearMarkBit() {
     ASSERT(IsMarked());
     uword tags = ptr()->tags_;
@@ -307,6 +332,18 @@ class RawObject {
     return result;
   }
 
+  // Returns the size of this object as described by the header word 'tags'.
+  // Unlike Size() this neither rereads the header, which may be concurrently
+  // replaced by a forwarding pointer during a parallel scavenge, nor relies on
+  // the current isolate, so it can be used on GC helper threads.
+  intptr_t SizeFromTags(Isolate* isolate, uword tags) const {
+    intptr_t result = SizeTag::decode(tags);
+    if (result != 0) {
+      return result;
+    }
+    return SizeFromClass(isolate, ClassIdTag::decode(tags));
+  }
+
   void Validate(Isolate* isolate) const;
   intptr_t VisitPointers(ObjectPointerVisitor* visitor);
   bool FindObject(FindObjectVisitor* visitor);
@@ -365,6 +402,7 @@ class RawObject {
   }
 
   intptr_t SizeFromClass() const;
+  intptr_t SizeFromClass(Isolate* isolate, intptr_t class_id) const;
 
   intptr_t GetClassId() const {
     uword tags = ptr()->tags_;
@@ -374,12 +412,17 @@ class RawObject {
   friend class Api;
   friend class Array;
   friend class FreeListElement;
+  friend class GCCompactor;
   friend class GCMarker;
+  friend class GCSweeper;
   friend class Heap;
   friend class HeapProfiler;
   friend class HeapProfilerRootVisitor;
+  friend class IncrementalMarker;
   friend class MarkingVisitor;
   friend class Object;
+  friend class ParallelMarker;
+  friend class ParallelScavenger;
   friend class RawInstructions;
   friend class RawInstance;
   friend class Scavenger;
@@ -942,15 +985,35 @@ class RawICData : public RawObject {
   }
   RawFunction* function_;     // Parent/calling function of this IC.
   RawString* target_name_;    // Name of target function.
-  RawArray* ic_data_;         // Contains test class-ids and target functions.
+  RawArray* ic_data_;         // Contains test class-ids, target functions
+                              // and hit counts.
+  RawMegamorphicCache* megamorphic_cache_;  // Cache probed once the call
+                                            // site has seen too many classes.
   RawObject** to() {
-    return reinterpret_cast<RawObject**>(&ptr()->ic_data_);
+    return reinterpret_cast<RawObject**>(&ptr()->megamorphic_cache_);
   }
   intptr_t deopt_id_;         // Deoptimization id corresponding to this IC.
   intptr_t num_args_tested_;  // Number of arguments tested in IC.
 };
 
 
+class RawMegamorphicCache : public RawObject {
+  RAW_HEAP_OBJECT_IMPLEMENTATION(MegamorphicCache);
+
+  RawObject** from() {
+    return reinterpret_cast<RawObject**>(&ptr()->buckets_);
+  }
+  RawArray* buckets_;               // Pairs of class id and target function.
+  RawSmi* mask_;                    // Number of buckets minus one.
+  RawString* target_name_;          // Name of the target functions.
+  RawArray* arguments_descriptor_;  // Arguments of the calls.
+  RawObject** to() {
+    return reinterpret_cast<RawObject**>(&ptr()->arguments_descriptor_);
+  }
+  intptr_t filled_entry_count_;
+};
+
+
 class RawSubtypeTestCache : public RawObject {
   RAW_HEAP_OBJECT_IMPLEMENTATION(SubtypeTestCache);
   RawArray* cache_;
@@ -1430,6 +1493,27 @@ class RawClosure : public RawInstance {
 };
 
 
+// SIMD values of four single precision floats or four 32-bit integers.  The
+// lanes are stored in order x, y, z, w so that a value can be moved to and
+// from an xmm register with a single unaligned load or store.
+class RawFloat32x4 : public RawInstance {
+  RAW_HEAP_OBJECT_IMPLEMENTATION(Float32x4);
+
+  float value_[4];
+
+  friend class SnapshotReader;
+};
+
+
+class RawInt32x4 : public RawInstance {
+  RAW_HEAP_OBJECT_IMPLEMENTATION(Int32x4);
+
+  int32_t value_[4];
+
+  friend class SnapshotReader;
+};
+
+
 // VM type for capturing stacktraces when exceptions are thrown,
 // Currently we don't have any interface that this object is supposed
 // to implement so we just support the 'toString' method which
@@ -1604,7 +1688,7 @@ inline bool RawObject::IsByteArrayClassId(intptr_t index) {
          kExternalUint64ArrayCid == kByteArrayCid + 18 &&
          kExternalFloat32ArrayCid == kByteArrayCid + 19 &&
          kExternalFloat64ArrayCid == kByteArrayCid + 20 &&
-         kStacktraceCid == kByteArrayCid + 21);
+         kFloat32x4Cid == kByteArrayCid + 21);
   return (index >= kByteArrayCid && index <= kExternalFloat64ArrayCid);
 }
 
@@ -1181,6 +1181,22 @@ void RawICData::WriteTo(SnapshotWriter* writer,
 }
 
 
+RawMegamorphicCache* MegamorphicCache::ReadFrom(SnapshotReader* reader,
+                                                intptr_t object_id,
+                                                intptr_t tags,
+                                                Snapshot::Kind kind) {
+  UNREACHABLE();
+  return NULL;
+}
+
+
+void RawMegamorphicCache::WriteTo(SnapshotWriter* writer,
+                                  intptr_t object_id,
+                                  Snapshot::Kind kind) {
+  UNREACHABLE();
+}
+
+
 RawSubtypeTestCache* SubtypeTestCache::ReadFrom(SnapshotReader* reader,
                                                 intptr_t object_id,
                                                 intptr_t tags,
@@ -2195,6 +2211,90 @@ void RawJSRegExp::WriteTo(SnapshotWriter* writer,
 }
 
 
+RawFloat32x4* Float32x4::ReadFrom(SnapshotReader* reader,
+                                  intptr_t object_id,
+                                  intptr_t tags,
+                                  Snapshot::Kind kind) {
+  ASSERT(reader != NULL);
+  // Read the bits of the lanes.
+  simd128_value_t value;
+  for (intptr_t i = 0; i < 4; i++) {
+    value.int_storage[i] = reader->Read<int32_t>();
+  }
+
+  // Create the Float32x4 object.
+  Float32x4& simd = Float32x4::ZoneHandle(
+      reader->isolate(), Float32x4::New(value, HEAP_SPACE(kind)));
+  reader->AddBackRef(object_id, &simd, kIsDeserialized);
+
+  // Set the object tags.
+  simd.set_tags(tags);
+
+  return simd.raw();
+}
+
+
+void RawFloat32x4::WriteTo(SnapshotWriter* writer,
+                           intptr_t object_id,
+                           Snapshot::Kind kind) {
+  ASSERT(writer != NULL);
+
+  // Write out the serialization header value for this object.
+  writer->WriteInlinedObjectHeader(object_id);
+
+  // Write out the class and tags information.
+  writer->WriteIndexedObject(kFloat32x4Cid);
+  writer->WriteIntptrValue(writer->GetObjectTags(this));
+
+  // Write out the bits of the lanes.
+  for (intptr_t i = 0; i < 4; i++) {
+    writer->Write<int32_t>(bit_cast<int32_t>(ptr()->value_[i]));
+  }
+}
+
+
+RawInt32x4* Int32x4::ReadFrom(SnapshotReader* reader,
+                              intptr_t object_id,
+                              intptr_t tags,
+                              Snapshot::Kind kind) {
+  ASSERT(reader != NULL);
+  // Read the bits of the lanes.
+  simd128_value_t value;
+  for (intptr_t i = 0; i < 4; i++) {
+    value.int_storage[i] = reader->Read<int32_t>();
+  }
+
+  // Create the Int32x4 object.
+  Int32x4& simd = Int32x4::ZoneHandle(reader->isolate(),
+                                      Int32x4::New(value, HEAP_SPACE(kind)));
+  reader->AddBackRef(object_id, &simd, kIsDeserialized);
+
+  // Set the object tags.
+  simd.set_tags(tags);
+
+  return simd.raw();
+}
+
+
+void RawInt32x4::WriteTo(SnapshotWriter* writer,
+                         intptr_t object_id,
+                         Snapshot::Kind kind) {
+  ASSERT(writer != NULL);
+
+  // Write out the serialization header value for this object.
+  writer->WriteInlinedObjectHeader(object_id);
+
+  // Write out the class and tags information.
+  writer->WriteIndexedObject(kInt32x4Cid);
+  writer->WriteIntptrValue(writer->GetObjectTags(this));
+
+  // Write out the bits of the lanes.
+  for (intptr_t i = 0; i < 4; i++) {
+    writer->Write<int32_t>(bit_cast<int32_t>(ptr()->value_[i]));
+  }
+}
+
+
 RawWeakProperty* WeakProperty::ReadFrom(SnapshotReader* reader,
                                         intptr_t object_id,
                                         intptr_t tags,
@@ -6,18 +6,52 @@
 
 #include <map>
 #include <utility>
+#include <vector>
 
+#include "vm/allocation_sampler.h"
+#include "vm/atomic.h"
 #include "vm/dart.h"
 #include "vm/dart_api_state.h"
+#include "vm/freelist.h"
+#include "vm/gc_events.h"
 #include "vm/isolate.h"
+#include "vm/marking_stack.h"
 #include "vm/object.h"
 #include "vm/stack_frame.h"
 #include "vm/store_buffer.h"
+#include "vm/thread.h"
+#include "vm/thread_pool.h"
 #include "vm/verifier.h"
 #include "vm/visitor.h"
 
 namespace dart {
 
+DEFINE_FLAG(int, scavenger_tasks, 0,
+            "The number of tasks to spawn during new gen GC "
+            "(0 means perform the scavenge on the mutator thread).");
+DEFINE_FLAG(int, tenuring_threshold, 1,
+            "The number of scavenges a new object has to survive before it is "
+            "promoted to old space (at most 3).");
+DEFINE_FLAG(bool, adaptive_tenuring, false,
+            "Raise the tenuring threshold when scavenges promote many objects "
+            "and lower it when the survivors fill the new space.");
+DEFINE_FLAG(bool, adaptive_new_gen, false,
+            "Resize the new gen heap between --new_gen_min_heap_size and "
+            "--new_gen_heap_size after scavenges.");
+DEFINE_FLAG(int, new_gen_min_heap_size, 2,
+            "Minimum size of the new gen heap in MB when it is resized "
+            "adaptively.");
+DEFINE_FLAG(int, new_gen_target_pause_micros, 2000,
+            "Shrink the new gen heap when a scavenge takes longer than this "
+            "many microseconds, and only grow it while scavenges take less "
+            "than half of it.");
+DEFINE_FLAG(int, new_gen_time_ratio, 5,
+            "Grow the new gen heap when scavenges take more than this "
+            "percentage of the time.");
+DEFINE_FLAG(int, new_gen_survival_ratio, 50,
+            "Grow the new gen heap when more than this percentage of a "
+            "semi-space survives a scavenge.");
+
 // Scavenger uses RawObject::kFreeBit to distinguish forwaded and non-forwarded
 // objects because scavenger can never encounter free list element during
 // evacuation and thus all objects scavenger encounters have
@@ -49,6 +83,28 @@ static inline void ForwardTo(uword orignal, uword target) {
 }
 
 
+// The age of objects is limited by the size of the age tag.
+static intptr_t TenuringThresholdFlag() {
+  if (FLAG_tenuring_threshold < 0) {
+    return 0;
+  }
+  return Utils::Minimum(static_cast<intptr_t>(FLAG_tenuring_threshold),
+                        RawObject::kMaxAge);
+}
+
+
+// Returns the header of the copy of an object. An object copied within the
+// new space has survived one more scavenge, promoted objects have no age.
+static inline uword CopiedHeader(uword header, bool promoted) {
+  intptr_t age = 0;
+  if (!promoted) {
+    age = Utils::Minimum(RawObject::AgeTag::decode(header) + 1,
+                         RawObject::kMaxAge);
+  }
+  return RawObject::AgeTag::update(age, header);
+}
+
+
 class ScavengerVisitor : public ObjectPointerVisitor {
  public:
   explicit ScavengerVisitor(Isolate* isolate, Scavenger* scavenger)
@@ -133,23 +189,22 @@ class ScavengerVisitor : public ObjectPointerVisitor {
         raw_obj->ClearWatchedBit();
       }
       intptr_t size = raw_obj->Size();
+      bool promoted = false;
       // Check whether object should be promoted.
-      if (scavenger_->survivor_end_ <= raw_addr) {
-        // Not a survivor of a previous scavenge. Just copy the object into the
-        // to space.
+      if (!scavenger_->ShouldPromote(header)) {
+        // Not old enough to be promoted. Just copy the object into the to
+        // space.
         new_addr = scavenger_->TryAllocate(size);
       } else {
-        // TODO(iposva): Experiment with less aggressive promotion. For example
-        // a coin toss determines if an object is promoted or whether it should
-        // survive in this generation.
-        //
-        // This object is a survivor of a previous scavenge. Attempt to promote
-        // the object.
+        // This object has survived enough scavenges. Attempt to promote the
+        // object.
         new_addr = heap_->TryAllocate(size, Heap::kOld);
         if (new_addr != 0) {
           // If promotion succeeded then we need to remember it so that it can
           // be traversed later.
           scavenger_->PushToPromotedStack(new_addr);
+          scavenger_->promoted_ += size;
+          promoted = true;
         } else {
           // Promotion did not succeed. Copy into the to space instead.
           scavenger_->had_promotion_failure_ = true;
@@ -163,6 +218,8 @@ class ScavengerVisitor : public ObjectPointerVisitor {
       memmove(reinterpret_cast<void*>(new_addr),
               reinterpret_cast<void*>(raw_addr),
               size);
+      uword* new_header = reinterpret_cast<uword*>(new_addr);
+      *new_header = CopiedHeader(*new_header, promoted);
       // Remember forwarding address.
       ForwardTo(raw_addr, new_addr);
     }
@@ -231,8 +288,541 @@ class VerifyStoreBufferPointerVisitor : public ObjectPointerVisitor {
 };
 
 
+class ParallelScavenger;
+
+
+// Visitor used by the tasks of a parallel scavenge. Each task copies objects
+// into its own to space and promotion buffers, which are carved out of the
+// shared spaces, and claims an object by atomically installing the forwarding
+// pointer into the header of the original. A task which loses the race for an
+// object discards its copy. Copied objects are pushed onto the task's work
+// stack to have their pointers scavenged.
+// As in the parallel marker, the work which requires the isolate (store
+// buffer updates and weak property processing) is deferred until all tasks
+// have finished.
+class ParallelScavengerVisitor : public ObjectPointerVisitor {
+ public:
+  ParallelScavengerVisitor(Isolate* isolate,
+                           ParallelScavenger* scavenger,
+                           MarkingStack* work_stack)
+      : ObjectPointerVisitor(isolate),
+        scavenger_(scavenger),
+        work_stack_(work_stack),
+        to_top_(0),
+        to_end_(0),
+        promotion_top_(0),
+        promotion_end_(0),
+        promoted_(0),
+        visiting_old_pointers_(false) {}
+
+  void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      ScavengePointer(current);
+    }
+  }
+
+  void VisitingOldPointers(bool value) { visiting_old_pointers_ = value; }
+
+  MarkingStack* work_stack() const { return work_stack_; }
+
+  void DeferWeakProperty(RawWeakProperty* raw_weak) {
+    deferred_weak_properties_.push_back(raw_weak);
+  }
+
+  const std::vector<RawWeakProperty*>& deferred_weak_properties() const {
+    return deferred_weak_properties_;
+  }
+
+  const std::vector<uword>& deferred_store_buffer_pointers() const {
+    return deferred_store_buffer_pointers_;
+  }
+
+  // Objects promoted while the old space is marked incrementally.
+  const std::vector<RawObject*>& promoted_objects() const {
+    return promoted_objects_;
+  }
+
+  // The size of the objects promoted by this task.
+  intptr_t promoted() const { return promoted_; }
+
+  // Gives back the unused parts of the allocation buffers.
+  void ReleaseBuffers();
+
+ private:
+  // Objects larger than this fraction of a buffer are allocated directly in
+  // the shared space, which bounds the space wasted when retiring a buffer.
+  static const intptr_t kBufferFraction = 16;
+  static const intptr_t kToSpaceBufferSize = 32 * KB;
+  static const intptr_t kPromotionBufferSize = 16 * KB;
+
+  void ScavengePointer(RawObject** p);
+  uword CopyObject(RawObject* raw_obj, uword header);
+  uword AllocateInToSpace(intptr_t size);
+  uword TryPromote(intptr_t size);
+  void ReleaseToSpaceBuffer();
+  void ReleasePromotionBuffer();
+
+  ParallelScavenger* scavenger_;
+  MarkingStack* work_stack_;
+
+  // Private to space allocation buffer.
+  uword to_top_;
+  uword to_end_;
+
+  // Private promotion buffer.
+  uword promotion_top_;
+  uword promotion_end_;
+  intptr_t promoted_;
+
+  bool visiting_old_pointers_;
+  std::vector<RawWeakProperty*> deferred_weak_properties_;
+  std::vector<uword> deferred_store_buffer_pointers_;
+  std::vector<RawObject*> promoted_objects_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelScavengerVisitor);
+};
+
+
+class ScavengeTask : public ThreadPool::Task {
+ public:
+  ScavengeTask(ParallelScavenger* scavenger, intptr_t task_index)
+      : scavenger_(scavenger), task_index_(task_index) {
+    ASSERT(scavenger != NULL);
+  }
+
+  void Run();
+
+ private:
+  ParallelScavenger* scavenger_;
+  intptr_t task_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScavengeTask);
+};
+
+
+// The ParallelScavenger distributes the roots of a scavenge and the scanning
+// of the copied objects over a number of tasks. Task 0 runs on the mutator
+// thread and is the only task visiting the isolate roots. The store buffer is
+// split up into slices which are claimed by whichever task gets to them
+// first. Idle tasks steal work from the shared work stack chunks of the others.
+class ParallelScavenger : public ValueObject {
+ public:
+  ParallelScavenger(Isolate* isolate, Scavenger* scavenger, intptr_t num_tasks)
+      : isolate_(isolate),
+        scavenger_(scavenger),
+        heap_(scavenger->heap_),
+        num_tasks_(num_tasks),
+        stacks_(new MarkingStack*[num_tasks]),
+        visitors_(new ParallelScavengerVisitor*[num_tasks]),
+        dedup_sets_(),
+        next_root_slice_(0),
+        num_idle_(0),
+        num_finished_(0),
+        shade_promoted_objects_(heap_->MarkingInProgress()) {
+    ASSERT(num_tasks > 1);
+    for (intptr_t i = 0; i < num_tasks_; i++) {
+      stacks_[i] = new MarkingStack();
+      stacks_[i]->set_share_chunks(true);
+      visitors_[i] = new ParallelScavengerVisitor(isolate, this, stacks_[i]);
+    }
+    // Grab the deduplication sets out of the store buffer.
+    StoreBuffer::DedupSet* pending = isolate->store_buffer()->DedupSets();
+    while (pending != NULL) {
+      dedup_sets_.push_back(pending);
+      pending = pending->next();
+    }
+  }
+
+  ~ParallelScavenger() {
+    for (intptr_t i = 0; i < num_tasks_; i++) {
+      delete visitors_[i];
+      delete stacks_[i];
+    }
+    delete[] visitors_;
+    delete[] stacks_;
+    for (size_t i = 0; i < dedup_sets_.size(); i++) {
+      delete dedup_sets_[i];
+    }
+  }
+
+  intptr_t num_tasks() const { return num_tasks_; }
+  ParallelScavengerVisitor* visitor_at(intptr_t index) const {
+    return visitors_[index];
+  }
+
+  // Copies everything reachable from the roots, except for what is only
+  // reachable through weak properties located in the to space. Returns once
+  // all tasks have finished.
+  void Run(bool visit_prologue_weak_persistent_handles) {
+    // The dirty cards are visited before the tasks are started, promotion
+    // may add large pages to the old space.
+    visitors_[0]->VisitingOldPointers(true);
+    heap_->VisitDirtyCards(visitors_[0]);
+    visitors_[0]->VisitingOldPointers(false);
+    for (intptr_t i = 1; i < num_tasks_; i++) {
+      Dart::thread_pool()->Run(new ScavengeTask(this, i));
+    }
+    isolate_->VisitObjectPointers(visitors_[0],
+                                  visit_prologue_weak_persistent_handles,
+                                  StackFrameIterator::kDontValidateFrames);
+    RunTask(0);
+    {
+      MonitorLocker ml(&monitor_);
+      while (num_finished_ < (num_tasks_ - 1)) {
+        ml.Wait();
+      }
+    }
+    for (intptr_t i = 0; i < num_tasks_; i++) {
+      visitors_[i]->ReleaseBuffers();
+    }
+    isolate_->store_buffer_block()->Reset();
+  }
+
+  void RunTask(intptr_t task_index) {
+    ParallelScavengerVisitor* visitor = visitors_[task_index];
+    VisitRootSlices(visitor);
+    do {
+      DrainWorkStack(visitor);
+    } while (StealWork(task_index) || WaitForWork(task_index));
+  }
+
+  void TaskFinished() {
+    MonitorLocker ml(&monitor_);
+    num_finished_++;
+    ml.Notify();
+  }
+
+  bool InFromSpace(uword addr) const {
+    return scavenger_->from_->Contains(addr);
+  }
+
+  bool ShouldPromote(uword header) const {
+    return scavenger_->ShouldPromote(header);
+  }
+
+  // The objects promoted while the old space is marked incrementally have to
+  // be shaded once all tasks have finished.
+  bool shade_promoted_objects() const { return shade_promoted_objects_; }
+
+  // Bump allocates in the shared to space. Returns 0 if the remaining space
+  // is too small.
+  uword TryAllocateInToSpace(intptr_t size) {
+    uword* top = &scavenger_->top_;
+    uword result = *top;
+    while (static_cast<intptr_t>(scavenger_->end_ - result) >= size) {
+      uword old_top =
+          AtomicOperations::CompareAndSwapWord(top, result, result + size);
+      if (old_top == result) {
+        return result;
+      }
+      result = old_top;
+    }
+    return 0;
+  }
+
+  // Old space pages still pending a lazy sweep are swept on demand while
+  // the lock is held.
+  uword TryAllocateOld(intptr_t size) {
+    MutexLocker ml(&old_space_mutex_);
+    return heap_->TryAllocate(size, Heap::kOld);
+  }
+
+  void FreeOld(uword addr, intptr_t size) {
+    MutexLocker ml(&old_space_mutex_);
+    heap_->FreeOld(addr, size);
+  }
+
+  void PromotionFailed() {
+    scavenger_->had_promotion_failure_ = true;
+  }
+
+ private:
+  static const intptr_t kStoreBufferBlockSlice = -1;
+
+  // Slices are the store buffer block followed by the deduplication sets.
+  void VisitRootSlices(ParallelScavengerVisitor* visitor) {
+    visitor->VisitingOldPointers(true);
+    while (true) {
+      intptr_t slice =
+          AtomicOperations::FetchAndIncrementBy(&next_root_slice_, 1) - 1;
+      if (slice == kStoreBufferBlockSlice) {
+        StoreBufferBlock* block = isolate_->store_buffer_block();
+        for (intptr_t i = 0; i < block->Count(); i++) {
+          VisitStoreBufferPointer(visitor,
+                                  reinterpret_cast<RawObject**>(block->At(i)));
+        }
+      } else if (slice < static_cast<intptr_t>(dedup_sets_.size())) {
+        HashSet* set = dedup_sets_[slice]->set();
+        intptr_t count = set->Count();
+        intptr_t size = set->Size();
+        intptr_t handled = 0;
+        for (intptr_t i = 0; (i < size) && (handled < count); i++) {
+          RawObject** pointer = reinterpret_cast<RawObject**>(set->At(i));
+          if (pointer != NULL) {
+            VisitStoreBufferPointer(visitor, pointer);
+            handled++;
+          }
+        }
+      } else {
+        break;
+      }
+    }
+    visitor->VisitingOldPointers(false);
+  }
+
+  void VisitStoreBufferPointer(ParallelScavengerVisitor* visitor,
+                               RawObject** pointer) {
+    RawObject* value = *pointer;
+    // Skip entries that have been overwritten with Smis and duplicates which
+    // have already been scavenged.
+    if (value->IsHeapObject() && InFromSpace(RawObject::ToAddr(value))) {
+      visitor->VisitPointer(pointer);
+    }
+  }
+
+  void DrainWorkStack(ParallelScavengerVisitor* visitor) {
+    MarkingStack* work_stack = visitor->work_stack();
+    while (!work_stack->IsEmpty()) {
+      RawObject* raw_obj = work_stack->Pop();
+      if (raw_obj->IsOldObject()) {
+        // Promoted objects, like objects in the store buffer, need their
+        // pointers to new objects remembered.
+        visitor->VisitingOldPointers(true);
+        raw_obj->VisitPointers(visitor);
+        visitor->VisitingOldPointers(false);
+      } else if (raw_obj->GetClassId() == kWeakPropertyCid) {
+        // Weak properties in the to space are processed by the mutator once
+        // all tasks are done.
+        visitor->DeferWeakProperty(reinterpret_cast<RawWeakProperty*>(raw_obj));
+      } else {
+        raw_obj->VisitPointers(visitor);
+      }
+    }
+  }
+
+  // Takes a shared chunk, preferably one published by the task itself.
+  bool StealWork(intptr_t task_index) {
+    MarkingStack* work_stack = stacks_[task_index];
+    for (intptr_t i = 0; i < num_tasks_; i++) {
+      intptr_t victim = (task_index + i) % num_tasks_;
+      if (work_stack->StealFrom(stacks_[victim])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool HasSharedWork() {
+    for (intptr_t i = 0; i < num_tasks_; i++) {
+      if (stacks_[i]->HasSharedChunks()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Waits until either another task shares work, in which case true is
+  // returned, or all tasks are out of work and the scavenge is complete.
+  bool WaitForWork(intptr_t task_index) {
+    MonitorLocker ml(&monitor_);
+    num_idle_++;
+    while (true) {
+      if (num_idle_ == num_tasks_) {
+        ml.NotifyAll();
+        return false;
+      }
+      if (HasSharedWork()) {
+        num_idle_--;
+        return true;
+      }
+      ml.Wait(kIdleWaitMillis);
+    }
+  }
+
+  static const int64_t kIdleWaitMillis = 1;
+
+  Isolate* isolate_;
+  Scavenger* scavenger_;
+  Heap* heap_;
+  intptr_t num_tasks_;
+  MarkingStack** stacks_;
+  ParallelScavengerVisitor** visitors_;
+  std::vector<StoreBuffer::DedupSet*> dedup_sets_;
+  intptr_t next_root_slice_;
+
+  // Serializes old space allocation.
+  Mutex old_space_mutex_;
+
+  // Protects num_idle_ and num_finished_.
+  Monitor monitor_;
+  intptr_t num_idle_;
+  intptr_t num_finished_;
+
+  bool shade_promoted_objects_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelScavenger);
+};
+
+
+void ScavengeTask::Run() {
+  scavenger_->RunTask(task_index_);
+  // The scavenger may be deleted as soon as the last task has finished.
+  scavenger_->TaskFinished();
+}
+
+
+void ParallelScavengerVisitor::ScavengePointer(RawObject** p) {
+  RawObject* raw_obj = *p;
+
+  // Fast exit if the raw object is a Smi or an old object.
+  if (!raw_obj->IsHeapObject() || raw_obj->IsOldObject()) {
+    return;
+  }
+
+  uword raw_addr = RawObject::ToAddr(raw_obj);
+  // The scavenger is only interested in objects located in the from space.
+  if (!scavenger_->InFromSpace(raw_addr)) {
+    return;
+  }
+
+  uword header = *reinterpret_cast<volatile uword*>(raw_addr);
+  uword new_addr = 0;
+  if (IsForwarding(header)) {
+    new_addr = ForwardedAddr(header);
+  } else {
+    new_addr = CopyObject(raw_obj, header);
+  }
+  RawObject* new_obj = RawObject::FromAddr(new_addr);
+  *p = new_obj;
+  if (visiting_old_pointers_ && new_obj->IsNewObject()) {
+    deferred_store_buffer_pointers_.push_back(reinterpret_cast<uword>(p));
+  }
+}
+
+
+// Copies the object and tries to install the forwarding pointer. Returns the
+// address of the copy which won.
+uword ParallelScavengerVisitor::CopyObject(RawObject* raw_obj, uword header) {
+  uword raw_addr = RawObject::ToAddr(raw_obj);
+  intptr_t size = raw_obj->SizeFromTags(isolate(), header);
+  uword new_addr = 0;
+  if (scavenger_->ShouldPromote(header)) {
+    new_addr = TryPromote(size);
+    if (new_addr == 0) {
+      scavenger_->PromotionFailed();
+    }
+  }
+  if (new_addr == 0) {
+    new_addr = AllocateInToSpace(size);
+    if (new_addr == 0) {
+      // The to space can only run out due to the space lost at the ends of
+      // the buffers, move the object to old space instead.
+      new_addr = TryPromote(size);
+      if (new_addr == 0) {
+        FATAL("Out of memory during parallel scavenge");
+      }
+    }
+  }
+  memmove(reinterpret_cast<void*>(new_addr),
+          reinterpret_cast<void*>(raw_addr),
+          size);
+  RawObject* new_obj = RawObject::FromAddr(new_addr);
+  const bool promoted = new_obj->IsOldObject();
+  // The header of the original may have been replaced by another task in the
+  // meantime.
+  *reinterpret_cast<uword*>(new_addr) = CopiedHeader(header, promoted);
+  uword old_header = AtomicOperations::CompareAndSwapWord(
+      reinterpret_cast<uword*>(raw_addr),
+      header,
+      new_addr | kForwarded);
+  if (old_header != header) {
+    // Another task copied the object first. Turn this copy into a free list
+    // element so that the space stays iterable.
+    if (promoted) {
+      scavenger_->FreeOld(new_addr, size);
+    } else {
+      FreeListElement::AsElement(new_addr, size);
+    }
+    return ForwardedAddr(old_header);
+  }
+  if (promoted) {
+    promoted_ += size;
+    if (scavenger_->shade_promoted_objects()) {
+      promoted_objects_.push_back(new_obj);
+    }
+  }
+  work_stack_->Push(new_obj);
+  return new_addr;
+}
+
+
+uword ParallelScavengerVisitor::AllocateInToSpace(intptr_t size) {
+  if (size > (kToSpaceBufferSize / kBufferFraction)) {
+    return scavenger_->TryAllocateInToSpace(size);
+  }
+  if ((to_end_ - to_top_) < static_cast<uword>(size)) {
+    ReleaseToSpaceBuffer();
+    uword buffer = scavenger_->TryAllocateInToSpace(kToSpaceBufferSize);
+    if (buffer == 0) {
+      // Close to the end of the to space, allocate the object on its own.
+      return scavenger_->TryAllocateInToSpace(size);
+    }
+    to_top_ = buffer;
+    to_end_ = buffer + kToSpaceBufferSize;
+  }
+  uword result = to_top_;
+  to_top_ += size;
+  return result;
+}
+
+
+uword ParallelScavengerVisitor::TryPromote(intptr_t size) {
+  if (size > (kPromotionBufferSize / kBufferFraction)) {
+    return scavenger_->TryAllocateOld(size);
+  }
+  if ((promotion_end_ - promotion_top_) < static_cast<uword>(size)) {
+    ReleasePromotionBuffer();
+    uword buffer = scavenger_->TryAllocateOld(kPromotionBufferSize);
+    if (buffer == 0) {
+      return scavenger_->TryAllocateOld(size);
+    }
+    promotion_top_ = buffer;
+    promotion_end_ = buffer + kPromotionBufferSize;
+  }
+  uword result = promotion_top_;
+  promotion_top_ += size;
+  return result;
+}
+
+
+void ParallelScavengerVisitor::ReleaseToSpaceBuffer() {
+  if (to_top_ < to_end_) {
+    FreeListElement::AsElement(to_top_, to_end_ - to_top_);
+  }
+  to_top_ = 0;
+  to_end_ = 0;
+}
+
+
+void ParallelScavengerVisitor::ReleasePromotionBuffer() {
+  if (promotion_top_ < promotion_end_) {
+    scavenger_->FreeOld(promotion_top_, promotion_end_ - promotion_top_);
+  }
+  promotion_top_ = 0;
+  promotion_end_ = 0;
+}
+
+
+void ParallelScavengerVisitor::ReleaseBuffers() {
+  ReleaseToSpaceBuffer();
+  ReleasePromotionBuffer();
+}
+
+
 Scavenger::Scavenger(Heap* heap, intptr_t max_capacity, uword object_alignment)
     : heap_(heap),
+      tenuring_threshold_(0),
+      promoted_(0),
       object_alignment_(object_alignment),
       count_(0),
       scavenging_(false) {
@@ -241,18 +831,32 @@ Scavenger::Scavenger(Heap* heap, intptr_t max_capacity, uword object_alignment)
   ASSERT(Object::tags_offset() == 0);
   ASSERT(kForwardingMask == (1 << RawObject::kFreeBit));
 
-  // Allocate the virtual memory for this scavenge heap.
-  space_ = VirtualMemory::Reserve(max_capacity);
+  // Allocate the virtual memory for this scavenge heap. Huge pages can only
+  // back 2MB aligned memory.
+  if (FLAG_use_huge_pages) {
+    space_ = VirtualMemory::ReserveAligned(max_capacity,
+                                           VirtualMemory::kHugePageSize);
+  } else {
+    space_ = VirtualMemory::Reserve(max_capacity);
+  }
   ASSERT(space_ != NULL);
 
-  // Allocate the entire space at the beginning.
+  // Allocate the entire space at the beginning. The pages of the semi-spaces
+  // beyond their current size are not touched until the semi-spaces grow.
   space_->Commit(false);
+  if (FLAG_use_huge_pages) {
+    space_->AdviseHugePages();
+  }
 
-  // Setup the semi spaces.
-  uword semi_space_size = space_->size() / 2;
-  ASSERT((semi_space_size & (VirtualMemory::PageSize() - 1)) == 0);
+  // Setup the semi spaces. Each semi-space may grow up to half of the space.
+  max_semi_space_size_ = space_->size() / 2;
+  ASSERT((max_semi_space_size_ & (VirtualMemory::PageSize() - 1)) == 0);
+  intptr_t semi_space_size = max_semi_space_size_;
+  if (FLAG_adaptive_new_gen) {
+    semi_space_size = MinSemiSpaceSize();
+  }
   to_ = new MemoryRegion(space_->address(), semi_space_size);
-  uword middle = space_->start() + semi_space_size;
+  uword middle = space_->start() + max_semi_space_size_;
   from_ = new MemoryRegion(reinterpret_cast<void*>(middle), semi_space_size);
 
   // Make sure that the two semi-spaces are aligned properly.
@@ -263,8 +867,10 @@ Scavenger::Scavenger(Heap* heap, intptr_t max_capacity, uword object_alignment)
   top_ = FirstObjectStart();
   resolved_top_ = top_;
   end_ = to_->end();
+  SetSamplingPoint();
 
-  survivor_end_ = FirstObjectStart();
+  tenuring_threshold_ = TenuringThresholdFlag();
+  last_scavenge_end_ = OS::GetCurrentTimeMicros();
 
 #if defined(DEBUG)
   memset(to_->pointer(), 0xf3, to_->size());
@@ -280,10 +886,38 @@ Scavenger::~Scavenger() {
 }
 
 
+uword Scavenger::TryAllocateSampled(intptr_t size) {
+  ASSERT(!scavenging_);
+  end_ = to_->end();
+  uword result = TryAllocate(size);
+  if (result == 0) {
+    // The sampling point is set again by the scavenge to come.
+    return 0;
+  }
+  heap_->allocation_sampler()->set_pending_address(result);
+  SetSamplingPoint();
+  return result;
+}
+
+
+void Scavenger::SetSamplingPoint() {
+  end_ = to_->end();
+  intptr_t interval = Utils::RoundUp(
+      heap_->allocation_sampler()->NextInterval(), kObjectAlignment);
+  if ((interval > 0) && (interval < static_cast<intptr_t>(end_ - top_))) {
+    end_ = top_ + interval;
+  }
+}
+
+
 void Scavenger::Prologue(Isolate* isolate, bool invoke_api_callbacks) {
   if (invoke_api_callbacks) {
     isolate->gc_prologue_callbacks().Invoke();
   }
+  // While incremental marking is in progress the write barrier records
+  // entries which are not old to new pointers. Filter them out of the
+  // store buffer block before it is scanned below.
+  isolate->store_buffer_block()->ProcessBuffer(isolate);
   // Flip the two semi-spaces so that to_ is always the space for allocating
   // objects.
   MemoryRegion* temp = from_;
@@ -292,13 +926,19 @@ void Scavenger::Prologue(Isolate* isolate, bool invoke_api_callbacks) {
   top_ = FirstObjectStart();
   resolved_top_ = top_;
   end_ = to_->end();
+  promoted_ = 0;
+  // A pending sample that was not recorded is gone with the from space.
+  heap_->allocation_sampler()->set_pending_address(0);
+  if (!FLAG_adaptive_tenuring) {
+    tenuring_threshold_ = TenuringThresholdFlag();
+  }
 }
 
 
 void Scavenger::Epilogue(Isolate* isolate, bool invoke_api_callbacks) {
   // All objects in the to space have been copied from the from space at this
   // moment.
-  survivor_end_ = top_;
+  UpdateTenuringThreshold();
 
 #if defined(DEBUG)
   VerifyStoreBufferPointerVisitor verify_store_buffer_visitor(isolate, to_);
@@ -312,6 +952,97 @@ void Scavenger::Epilogue(Isolate* isolate, bool invoke_api_callbacks) {
 }
 
 
+void Scavenger::UpdateTenuringThreshold() {
+  if (!FLAG_adaptive_tenuring) {
+    return;
+  }
+  intptr_t survivors = top_ - FirstObjectStart();
+  intptr_t semi_space_size = to_->size();
+  if ((survivors > (semi_space_size / 2)) && (tenuring_threshold_ > 1)) {
+    // Copying this many survivors back and forth is expensive.
+    tenuring_threshold_--;
+  } else if ((promoted_ > (semi_space_size / 8)) &&
+             (survivors < (semi_space_size / 4)) &&
+             (tenuring_threshold_ < RawObject::kMaxAge)) {
+    // Keep the objects in new space for longer, giving them more time to die
+    // before they fill up the old space.
+    tenuring_threshold_++;
+  }
+}
+
+
+intptr_t Scavenger::MinSemiSpaceSize() const {
+  intptr_t min_size = (Utils::Maximum(FLAG_new_gen_min_heap_size, 1) * MB) / 2;
+  return Utils::Minimum(static_cast<intptr_t>(
+                            Utils::RoundUpToPowerOfTwo(min_size)),
+                        max_semi_space_size_);
+}
+
+
+void Scavenger::UpdateSemiSpaceSize(int64_t pause_micros) {
+  int64_t now = OS::GetCurrentTimeMicros();
+  int64_t interval_micros = now - last_scavenge_end_;
+  last_scavenge_end_ = now;
+  if (!FLAG_adaptive_new_gen) {
+    return;
+  }
+  intptr_t semi_space_size = to_->size();
+  intptr_t survivors = top_ - FirstObjectStart();
+  intptr_t survival_ratio = ((survivors + promoted_) * 100) / semi_space_size;
+  intptr_t new_size = semi_space_size;
+  if (pause_micros > FLAG_new_gen_target_pause_micros) {
+    // The pause time grows with the survivors, which are bounded by the size
+    // of the semi-spaces.
+    new_size = semi_space_size / 2;
+  } else if ((2 * pause_micros) <= FLAG_new_gen_target_pause_micros) {
+    // Scavenging less often reduces the time spent in scavenges, and gives
+    // the objects more time to die before they are copied again.
+    if (((pause_micros * 100) > (interval_micros * FLAG_new_gen_time_ratio)) ||
+        (survival_ratio > FLAG_new_gen_survival_ratio)) {
+      new_size = semi_space_size * 2;
+    }
+  }
+  new_size = Utils::Maximum(new_size, MinSemiSpaceSize());
+  new_size = Utils::Minimum(new_size, max_semi_space_size_);
+  if (new_size > semi_space_size) {
+    // Both semi-spaces count towards the limits on the heap footprint.
+    intptr_t growth = Utils::RoundDown(heap_->GrowthBudget() / 2,
+                                       VirtualMemory::PageSize());
+    new_size = Utils::Minimum(new_size, semi_space_size + growth);
+  }
+  // The survivors have to leave room for allocation in the smaller space.
+  if ((new_size == semi_space_size) ||
+      ((new_size < semi_space_size) && ((2 * survivors) > new_size))) {
+    return;
+  }
+  if (new_size < semi_space_size) {
+    // Return the memory the semi-spaces no longer use to the OS.
+    VirtualMemory::ReleaseMemory(to_->start() + new_size,
+                                 semi_space_size - new_size);
+    VirtualMemory::ReleaseMemory(from_->start() + new_size,
+                                 semi_space_size - new_size);
+  }
+  MemoryRegion* to = new MemoryRegion(to_->pointer(), new_size);
+  MemoryRegion* from = new MemoryRegion(from_->pointer(), new_size);
+  delete to_;
+  delete from_;
+  to_ = to;
+  from_ = from;
+  end_ = to_->end();
+  ASSERT(top_ <= end_);
+  if (FLAG_verbose_gc) {
+    OS::PrintErr("Resized new space semi-spaces from %"Pd"K to %"Pd"K "
+                 "(%"Pd"%% survived, %"Pd64"us pause, "
+                 "%"Pd64"us since last scavenge)\n",
+                 semi_space_size / KB,
+                 new_size / KB,
+                 survival_ratio,
+                 pause_micros,
+                 interval_micros);
+  }
+}
+
+
 void Scavenger::IterateStoreBuffers(Isolate* isolate,
                                     ScavengerVisitor* visitor) {
   // Iterating through the store buffers.
@@ -371,6 +1102,10 @@ void Scavenger::IterateStoreBuffers(Isolate* isolate,
     OS::PrintErr("StoreBufferBlock: %"Pd", %"Pd" (entries, dups)\n",
                  entries, duplicates);
   }
+  intptr_t dirty_cards = heap_->VisitDirtyCards(visitor);
+  if (FLAG_verbose_gc) {
+    OS::PrintErr("Cards: %"Pd" (dirty)\n", dirty_cards);
+  }
   // Done iterating through the store buffers.
   visitor->VisitingOldPointers(false);
 }
@@ -379,13 +1114,50 @@ void Scavenger::IterateStoreBuffers(Isolate* isolate,
 void Scavenger::IterateRoots(Isolate* isolate,
                              ScavengerVisitor* visitor,
                              bool visit_prologue_weak_persistent_handles) {
-  IterateStoreBuffers(isolate, visitor);
+  {
+    GCPhaseScope phase(heap_, Dart_GcEvent::kStoreBuffer);
+    IterateStoreBuffers(isolate, visitor);
+  }
+  GCPhaseScope phase(heap_, Dart_GcEvent::kRoots);
   isolate->VisitObjectPointers(visitor,
                                visit_prologue_weak_persistent_handles,
                                StackFrameIterator::kDontValidateFrames);
 }
 
 
+void Scavenger::ScavengeInParallel(
+    Isolate* isolate,
+    ScavengerVisitor* visitor,
+    bool visit_prologue_weak_persistent_handles) {
+  ParallelScavenger parallel_scavenger(isolate, this, FLAG_scavenger_tasks + 1);
+  parallel_scavenger.Run(visit_prologue_weak_persistent_handles);
+
+  // Everything up to the current top has been copied and scanned by the
+  // scavenging tasks, finish the work they left for the mutator thread.
+  resolved_top_ = top_;
+  StoreBuffer* store_buffer = isolate->store_buffer();
+  for (intptr_t i = 0; i < parallel_scavenger.num_tasks(); i++) {
+    ParallelScavengerVisitor* task_visitor = parallel_scavenger.visitor_at(i);
+    const std::vector<uword>& pointers =
+        task_visitor->deferred_store_buffer_pointers();
+    for (size_t j = 0; j < pointers.size(); j++) {
+      store_buffer->AddPointer(pointers[j]);
+    }
+    promoted_ += task_visitor->promoted();
+    const std::vector<RawWeakProperty*>& weak_properties =
+        task_visitor->deferred_weak_properties();
+    for (size_t j = 0; j < weak_properties.size(); j++) {
+      ProcessWeakProperty(weak_properties[j], visitor);
+    }
+    const std::vector<RawObject*>& promoted_objects =
+        task_visitor->promoted_objects();
+    for (size_t j = 0; j < promoted_objects.size(); j++) {
+      heap_->ShadeObject(promoted_objects[j]);
+    }
+  }
+}
+
+
 bool Scavenger::IsUnreachable(RawObject** p) {
   RawObject* raw_obj = *p;
   if (!raw_obj->IsHeapObject()) {
@@ -484,6 +1256,9 @@ void Scavenger::ProcessToSpace(ScavengerVisitor* visitor) {
     visitor->VisitingOldPointers(true);
     while (PromotedStackHasMore()) {
       RawObject* raw_object = RawObject::FromAddr(PopFromPromotedStack());
+      // The pointers to promoted objects are installed without a write
+      // barrier, an incremental marking in progress has to visit them.
+      heap_->ShadeObject(raw_object);
       // Resolve or copy all objects referred to by the current object. This
       // can potentially push more objects on this stack as well as add more
       // objects to be resolved in the to space.
@@ -496,11 +1271,11 @@ void Scavenger::ProcessToSpace(ScavengerVisitor* visitor) {
 
 uword Scavenger::ProcessWeakProperty(RawWeakProperty* raw_weak,
                                      ScavengerVisitor* visitor) {
-  // The fate of the weak property is determined by its key.
+  // The fate of the weak property is determined by its key. Old keys are
+  // not collected by a scavenge.
   RawObject* raw_key = raw_weak->ptr()->key_;
-  uword raw_addr = RawObject::ToAddr(raw_key);
-  uword header = *reinterpret_cast<uword*>(raw_addr);
-  if (!IsForwarding(header)) {
+  if (raw_key->IsHeapObject() && raw_key->IsNewObject() &&
+      !IsForwarding(*reinterpret_cast<uword*>(RawObject::ToAddr(raw_key)))) {
     // Key is white.  Delay the weak property.
     visitor->DelayWeakProperty(raw_weak);
     return raw_weak->Size();
@@ -556,21 +1331,37 @@ void Scavenger::Scavenge(bool invoke_api_callbacks, const char* gc_reason) {
   }
   Timer timer(FLAG_verbose_gc, "Scavenge");
   timer.Start();
+  int64_t start = OS::GetCurrentTimeMicros();
   // Setup the visitor and run a scavenge.
   ScavengerVisitor visitor(isolate, this);
   Prologue(isolate, invoke_api_callbacks);
-  IterateRoots(isolate, &visitor, !invoke_api_callbacks);
-  ProcessToSpace(&visitor);
-  IterateWeakReferences(isolate, &visitor);
-  ScavengerWeakVisitor weak_visitor(this);
-  IterateWeakRoots(isolate, &weak_visitor, invoke_api_callbacks);
-  visitor.Finalize();
+  if (FLAG_scavenger_tasks > 0) {
+    GCPhaseScope phase(heap_, Dart_GcEvent::kScavengeCopy);
+    ScavengeInParallel(isolate, &visitor, !invoke_api_callbacks);
+  } else {
+    IterateRoots(isolate, &visitor, !invoke_api_callbacks);
+  }
+  {
+    GCPhaseScope phase(heap_, Dart_GcEvent::kScavengeCopy);
+    ProcessToSpace(&visitor);
+  }
+  {
+    GCPhaseScope phase(heap_, Dart_GcEvent::kWeakProcessing);
+    IterateWeakReferences(isolate, &visitor);
+    ScavengerWeakVisitor weak_visitor(this);
+    IterateWeakRoots(isolate, &weak_visitor, invoke_api_callbacks);
+    visitor.Finalize();
+  }
+  UpdateSemiSpaceSize(OS::GetCurrentTimeMicros() - start);
   Epilogue(isolate, invoke_api_callbacks);
   timer.Stop();
   if (FLAG_verbose_gc) {
-    OS::PrintErr("Scavenge[%d]: %"Pd64"us\n",
+    OS::PrintErr("Scavenge[%d]: %"Pd64"us (%"Pd"K promoted, "
+                 "tenuring threshold %"Pd")\n",
                  count_,
-                 timer.TotalElapsedTime());
+                 timer.TotalElapsedTime(),
+                 promoted_ / KB,
+                 tenuring_threshold_);
   }
 
   if (FLAG_verify_after_gc) {
@@ -583,6 +1374,7 @@ void Scavenger::Scavenge(bool invoke_api_callbacks, const char* gc_reason) {
   // Done scavenging. Reset the marker.
   ASSERT(scavenging_);
   scavenging_ = false;
+  SetSamplingPoint();
 }
 
 
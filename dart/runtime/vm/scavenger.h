@@ -49,6 +49,10 @@ class Scavenger {
     uword result = top_;
     intptr_t remaining = end_ - top_;
     if (remaining < size) {
+      // The end may have been lowered to the next allocation sampling point.
+      if (!scavenging_ && (end_ < to_->end())) {
+        return TryAllocateSampled(size);
+      }
       return 0;
     }
     ASSERT(to_->Contains(result));
@@ -70,7 +74,8 @@ class Scavenger {
   static intptr_t end_offset() { return OFFSET_OF(Scavenger, end_); }
 
   intptr_t in_use() const { return (top_ - FirstObjectStart()); }
-  intptr_t capacity() const { return space_->size(); }
+  // The current size of both semi-spaces.
+  intptr_t capacity() const { return 2 * to_->size(); }
 
   void VisitObjects(ObjectVisitor* visitor) const;
   void VisitObjectPointers(ObjectPointerVisitor* visitor) const;
@@ -85,15 +90,30 @@ class Scavenger {
     return had_promotion_failure_;
   }
 
+  // The size of the objects promoted to old space by the last scavenge.
+  intptr_t promoted() const { return promoted_; }
+
+  // The number of scavenges an object has to survive before it is promoted.
+  intptr_t tenuring_threshold() const { return tenuring_threshold_; }
+
   void WriteProtect(bool read_only);
 
  private:
   uword FirstObjectStart() const { return to_->start() | object_alignment_; }
+
+  // Allocates the object crossing the allocation sampling point and marks it
+  // as pending to be sampled.
+  uword TryAllocateSampled(intptr_t size);
+  // Lowers the end of the allocation area to the next sampling point.
+  void SetSamplingPoint();
   void Prologue(Isolate* isolate, bool invoke_api_callbacks);
   void IterateStoreBuffers(Isolate* isolate, ScavengerVisitor* visitor);
   void IterateRoots(Isolate* isolate,
                     ScavengerVisitor* visitor,
                     bool visit_prologue_weak_persistent_handles);
+  void ScavengeInParallel(Isolate* isolate,
+                          ScavengerVisitor* visitor,
+                          bool visit_prologue_weak_persistent_handles);
   void IterateWeakProperties(Isolate* isolate, ScavengerVisitor* visitor);
   void IterateWeakReferences(Isolate* isolate, ScavengerVisitor* visitor);
   void IterateWeakRoots(Isolate* isolate,
@@ -106,6 +126,21 @@ class Scavenger {
 
   bool IsUnreachable(RawObject** p);
 
+  // Objects are promoted once they have survived tenuring_threshold_
+  // scavenges, their age is found in the header of the original.
+  bool ShouldPromote(uword header) const {
+    return RawObject::AgeTag::decode(header) >= tenuring_threshold_;
+  }
+  // Adjust the tenuring threshold to the amount of objects promoted and kept
+  // in new space by the last scavenge.
+  void UpdateTenuringThreshold();
+
+  intptr_t MinSemiSpaceSize() const;
+  // Resize the semi-spaces for the next scavenge, depending on the duration
+  // of the last scavenge, the time since the previous one and the size of
+  // the surviving objects.
+  void UpdateSemiSpaceSize(int64_t pause_micros);
+
   // During a scavenge we need to remember the promoted objects.
   // This is implemented as a stack of objects at the end of the to space. As
   // object sizes are always greater than sizeof(uword) and promoted objects do
@@ -125,14 +160,21 @@ class Scavenger {
     return end_ < to_->end();
   }
 
+  // The semi-spaces are located at the start and in the middle of the
+  // reserved space and cover a prefix of their half of it.
   VirtualMemory* space_;
   MemoryRegion* to_;
   MemoryRegion* from_;
+  intptr_t max_semi_space_size_;
+
+  // The end of the last scavenge in microseconds.
+  int64_t last_scavenge_end_;
 
   Heap* heap_;
 
   // Current allocation top and end. These values are being accessed directly
-  // from generated code.
+  // from generated code. Outside of scavenges the end may be below the end of
+  // the to space, at the next allocation sampling point.
   uword top_;
   uword end_;
 
@@ -140,8 +182,11 @@ class Scavenger {
   // this value meets the allocation top.
   uword resolved_top_;
 
-  // Objects below this address have survived a scavenge.
-  uword survivor_end_;
+  // Objects which have survived this many scavenges are promoted.
+  intptr_t tenuring_threshold_;
+
+  // The size of the objects promoted by the current or last scavenge.
+  intptr_t promoted_;
 
   // All object are aligned to this value.
   uword object_alignment_;
@@ -153,6 +198,7 @@ class Scavenger {
   // Keep track whether the scavenge had a promotion failure.
   bool had_promotion_failure_;
 
+  friend class ParallelScavenger;
   friend class ScavengerVisitor;
   friend class ScavengerWeakVisitor;
 
@@ -887,6 +887,7 @@ void FullSnapshotWriter::WriteFullSnapshot() {
   ASSERT(isolate != NULL);
   ObjectStore* object_store = isolate->object_store();
   ASSERT(object_store != NULL);
+  isolate->heap()->CompleteSweep();
 
   // Reserve space in the output buffer for a snapshot header.
   ReserveHeader();
@@ -965,8 +966,13 @@ bool SnapshotWriter::CheckAndWritePredefinedObject(RawObject* rawobj) {
 
   // Now check if it is an object from the VM isolate (NOTE: premarked objects
   // are considered to be objects in the VM isolate). These objects are shared
-  // by all isolates.
-  if (rawobj->IsMarked()) {
+  // by all isolates. While the old space of the current isolate is marked
+  // incrementally, or still has pages left unswept by the last collection,
+  // its objects may carry mark bits as well.
+  Heap* heap = Isolate::Current()->heap();
+  if (rawobj->IsMarked() &&
+      ((!heap->MarkingInProgress() && !heap->SweepPending()) ||
+       Dart::vm_isolate()->heap()->Contains(RawObject::ToAddr(rawobj)))) {
     HandleVMIsolateObject(rawobj);
     return true;
   }
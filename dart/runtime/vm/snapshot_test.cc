@@ -15,6 +15,9 @@
 
 namespace dart {
 
+DECLARE_FLAG(int, compaction_threshold);
+DECLARE_FLAG(bool, lazy_sweep);
+
 // Check if serialized and deserialized objects are equal.
 static bool Equals(const Object& expected, const Object& actual) {
   if (expected.IsNull()) {
@@ -567,6 +570,55 @@ TEST_CASE(SerializeArray) {
 }
 
 
+TEST_CASE(SerializeArrayWithSweepPending) {
+  Zone zone(Isolate::Current());
+  Heap* heap = Isolate::Current()->heap();
+  const bool saved_lazy_sweep = FLAG_lazy_sweep;
+  const bool saved_verify_before_gc = FLAG_verify_before_gc;
+  const bool saved_verify_after_gc = FLAG_verify_after_gc;
+  const int saved_compaction_threshold = FLAG_compaction_threshold;
+  FLAG_lazy_sweep = true;
+  // Verifying or compacting the heap completes the sweeping.
+  FLAG_verify_before_gc = false;
+  FLAG_verify_after_gc = false;
+  FLAG_compaction_threshold = 100;
+
+  // The live old objects keep their mark bits until their page is swept.
+  const int kArrayLength = 10;
+  Array& array = Array::Handle(Array::New(kArrayLength, Heap::kOld));
+  String& str = String::Handle();
+  for (int i = 0; i < kArrayLength; i++) {
+    str = String::New("old string", Heap::kOld);
+    array.SetAt(i, str);
+  }
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT(heap->SweepPending());
+
+  // Writing a message neither sweeps nor mistakes the marked objects for
+  // objects of the VM isolate.
+  uint8_t* buffer;
+  MessageWriter writer(&buffer, &zone_allocator);
+  writer.WriteMessage(array);
+  intptr_t buffer_len = writer.BytesWritten();
+  EXPECT(heap->SweepPending());
+  FLAG_lazy_sweep = saved_lazy_sweep;
+  FLAG_verify_before_gc = saved_verify_before_gc;
+  FLAG_verify_after_gc = saved_verify_after_gc;
+  FLAG_compaction_threshold = saved_compaction_threshold;
+
+  ApiNativeScope scope;
+  ApiMessageReader api_reader(buffer, buffer_len, &zone_allocator);
+  Dart_CObject* root = api_reader.ReadMessage();
+  EXPECT_EQ(Dart_CObject::kArray, root->type);
+  EXPECT_EQ(kArrayLength, root->value.as_array.length);
+  for (int i = 0; i < kArrayLength; i++) {
+    Dart_CObject* element = root->value.as_array.values[i];
+    EXPECT_EQ(Dart_CObject::kString, element->type);
+    EXPECT_STREQ("old string", element->value.as_string);
+  }
+}
+
+
 TEST_CASE(SerializeEmptyArray) {
   Zone zone(Isolate::Current());
 
@@ -5,6 +5,10 @@
 #include "vm/store_buffer.h"
 
 #include "platform/assert.h"
+#include "vm/heap.h"
+#include "vm/isolate.h"
+#include "vm/pages.h"
+#include "vm/raw_object.h"
 #include "vm/runtime_entry.h"
 
 namespace dart {
@@ -22,9 +26,22 @@ void StoreBufferBlock::ProcessBuffer() {
 
 void StoreBufferBlock::ProcessBuffer(Isolate* isolate) {
   StoreBuffer* buffer = isolate->store_buffer();
+  Heap* heap = isolate->heap();
   int32_t end = top_;
   for (int32_t i = 0; i < end; i++) {
-    buffer->AddPointer(pointers_[i]);
+    // While incremental marking is in progress the write barrier records all
+    // stores, including those into new objects and those of Smis and old
+    // objects. The old objects stored are handed to the marker.
+    uword pointer = pointers_[i];
+    RawObject* value = *reinterpret_cast<RawObject**>(pointer);
+    if (!value->IsHeapObject() || heap->NewContains(pointer)) {
+      continue;
+    }
+    if (value->IsNewObject()) {
+      buffer->AddPointer(pointer);
+    } else {
+      heap->ShadeObject(value);
+    }
   }
   top_ = 0;  // Reset back to the beginning.
 }
@@ -52,6 +69,7 @@ StoreBuffer::~StoreBuffer() {
 
 
 void StoreBuffer::Reset() {
+  Isolate::Current()->heap()->ClearCards();
   DedupSet* current = DedupSets();
   while (current != NULL) {
     DedupSet* next = current->next();
@@ -62,8 +80,29 @@ void StoreBuffer::Reset() {
 
 
 void StoreBuffer::AddPointer(uword address) {
+  ASSERT(dedup_sets_ != NULL);
+  Heap* heap = Isolate::Current()->heap();
+  ASSERT(heap->OldContains(address));
+  // The slots of large objects are remembered in the card table of their
+  // page, which keeps the store buffer small for large arrays.
+  if (heap->MarkCard(address)) {
+    return;
+  }
+  AddToDedupSet(address);
+}
+
+
+void StoreBuffer::AddPointer(RawObject* raw_obj, uword address) {
   ASSERT(dedup_sets_ != NULL);
   ASSERT(Isolate::Current()->heap()->OldContains(address));
+  if (HeapPage::TryMarkCard(raw_obj, address)) {
+    return;
+  }
+  AddToDedupSet(address);
+}
+
+
+void StoreBuffer::AddToDedupSet(uword address) {
   if (!dedup_sets_->set()->Add(address)) {
     // Add a new DedupSet. Schedule an interrupt if we have run over the max
     // number of DedupSets.
@@ -13,6 +13,7 @@ namespace dart {
 
 // Forward declarations.
 class Isolate;
+class RawObject;
 
 class StoreBufferBlock {
  public:
@@ -91,9 +92,16 @@ class StoreBuffer {
   StoreBuffer() : dedup_sets_(new DedupSet(NULL)), count_(1) {}
   ~StoreBuffer();
 
+  // Forget all remembered slots, including those in the card tables of the
+  // large pages.
   void Reset();
 
+  // Remember a slot of an old object. Slots located in large pages are
+  // recorded by marking their card instead, see Heap::MarkCard.
   void AddPointer(uword address);
+  // Same as above, but finds the card table of a large page in the header of
+  // the page of 'raw_obj', the old object containing the slot.
+  void AddPointer(RawObject* raw_obj, uword address);
 
   void ProcessBlock(StoreBufferBlock* block);
 
@@ -105,6 +113,8 @@ class StoreBuffer {
   }
 
  private:
+  void AddToDedupSet(uword address);
+
   DedupSet* dedup_sets_;
   intptr_t count_;
 
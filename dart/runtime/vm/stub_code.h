@@ -55,6 +55,7 @@ class RawCode;
   V(OneArgCheckInlineCache)                                                    \
   V(TwoArgsCheckInlineCache)                                                   \
   V(ThreeArgsCheckInlineCache)                                                 \
+  V(MegamorphicLookup)                                                         \
   V(BreakpointDynamic)                                                         \
 
 
@@ -93,6 +93,11 @@ void StubCode::GenerateTwoArgsCheckInlineCacheStub(Assembler* assembler) {
 }
 
 
+void StubCode::GenerateMegamorphicLookupStub(Assembler* assembler) {
+  __ Unimplemented("MegamorphicLookup stub");
+}
+
+
 void StubCode::GenerateBreakpointStaticStub(Assembler* assembler) {
   __ Unimplemented("BreakpointStatic stub");
 }
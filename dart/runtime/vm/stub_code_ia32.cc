@@ -517,12 +517,13 @@ static void GenerateDeoptimizationSequence(Assembler* assembler,
   for (intptr_t i = kNumberOfCpuRegisters - 1; i >= 0; i--) {
     __ pushl(static_cast<Register>(i));
   }
-  __ subl(ESP, Immediate(kNumberOfXmmRegisters * kDoubleSize));
+  // Save all 128 bits of the XMM registers, they may hold vectors.
+  __ subl(ESP, Immediate(kNumberOfXmmRegisters * kQuadSize));
   intptr_t offset = 0;
   for (intptr_t reg_idx = 0; reg_idx < kNumberOfXmmRegisters; ++reg_idx) {
     XmmRegister xmm_reg = static_cast<XmmRegister>(reg_idx);
-    __ movsd(Address(ESP, offset), xmm_reg);
-    offset += kDoubleSize;
+    __ movups(Address(ESP, offset), xmm_reg);
+    offset += kQuadSize;
   }
 
   __ movl(ECX, ESP);  // Saved saved registers block.
@@ -566,7 +567,7 @@ static void GenerateDeoptimizationSequence(Assembler* assembler,
   if (preserve_eax) {
     __ pushl(EAX);  // Preserve result, it will be GC-d here.
   }
-  __ CallRuntime(kDeoptimizeMaterializeDoublesRuntimeEntry);
+  __ CallRuntime(kDeoptimizeMaterializeRuntimeEntry);
   if (preserve_eax) {
     __ popl(EAX);  // Restore result.
   }
@@ -1544,22 +1545,9 @@ void StubCode::GenerateCallNoSuchMethodFunctionStub(Assembler* assembler) {
 
 
 
-// Generate inline cache check for 'num_args'.
-//  ECX: Inline cache data object.
-//  EDX: Arguments descriptor array.
-//  TOS(0): return address
-// Control flow:
-// - If receiver is null -> jump to IC miss.
-// - If receiver is Smi -> load Smi class.
-// - If receiver is not-Smi -> load receiver's class.
-// - Check if 'num_args' (including receiver) match any IC data group.
-// - Match found -> jump to target.
-// - Match not found -> jump to IC miss.
-void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
-                                                 intptr_t num_args) {
-  const Immediate raw_null =
-      Immediate(reinterpret_cast<intptr_t>(Object::null()));
-
+// Counts the call in the usage counter of the function containing the call
+// site, the one of the IC data object in ECX.  Uses EBX.
+static void GenerateUsageCounterIncrement(Assembler* assembler) {
   __ movl(EBX, FieldAddress(ECX, ICData::function_offset()));
   Label is_hot;
   if (FlowGraphCompiler::CanOptimize()) {
@@ -1573,12 +1561,32 @@ void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
     // The equality should be reached only at exit of the method
     // (return instruction).
     __ j(EQUAL, &is_hot, Assembler::kNearJump);
-    // As long as VM has no OSR do not optimize in the middle of the function
-    // but only at exit so that we have collected all type feedback before
-    // optimizing.
+    // Do not optimize in the middle of the function but only at exit so that
+    // we have collected all type feedback before optimizing. Only the stack
+    // checks of hot loops continue in optimized code (on-stack replacement).
   }
   __ incl(FieldAddress(EBX, Function::usage_counter_offset()));
   __ Bind(&is_hot);
+}
+
+
+// Generate inline cache check for 'num_args'.
+//  ECX: Inline cache data object.
+//  EDX: Arguments descriptor array.
+//  TOS(0): return address
+// Control flow:
+// - If receiver is null -> jump to IC miss.
+// - If receiver is Smi -> load Smi class.
+// - If receiver is not-Smi -> load receiver's class.
+// - Check if 'num_args' (including receiver) match any IC data group.
+// - Match found -> jump to target.
+// - Match not found -> jump to IC miss.
+void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
+                                                 intptr_t num_args) {
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+
+  GenerateUsageCounterIncrement(assembler);
 
   ASSERT(num_args > 0);
   // Get receiver (first read number of arguments from argument descriptor array
@@ -1615,7 +1623,8 @@ void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
     __ movl(EDI, Address(EBX, 0));  // Get class id (Smi) to check.
     __ cmpl(EAX, EDI);  // Class id match?
     __ j(EQUAL, &found, Assembler::kNearJump);
-    __ addl(EBX, Immediate(kWordSize * 2));  // Next element (class + target).
+    // Next element (class + target + count).
+    __ addl(EBX, Immediate(kWordSize * 3));
     __ cmpl(EDI, Immediate(Smi::RawValue(kIllegalCid)));  // Done?
     __ j(NOT_EQUAL, &loop, Assembler::kNearJump);
   } else {
@@ -1635,8 +1644,8 @@ void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
       }
     }
     __ Bind(&no_match);
-    // Each test entry has (1 + num_args) array elements.
-    __ addl(EBX, Immediate(kWordSize * (1 + num_args)));  // Next element.
+    // Each test entry has (2 + num_args) array elements.
+    __ addl(EBX, Immediate(kWordSize * (2 + num_args)));  // Next element.
     __ cmpl(EDI, Immediate(Smi::RawValue(kIllegalCid)));  // Done?
     __ j(NOT_EQUAL, &loop, Assembler::kNearJump);
   }
@@ -1681,7 +1690,14 @@ void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
   __ jmp(&StubCode::InstanceFunctionLookupLabel());
 
   __ Bind(&found);
-  // EBX: Pointer to an IC data check group (classes + target)
+  // EBX: Pointer to an IC data check group (classes + target + count)
+  // Count the hit.  The count sticks at the maximal Smi.
+  Label counted;
+  const Address count_address(EBX, kWordSize * (num_args + 1));
+  __ addl(count_address, Immediate(Smi::RawValue(1)));
+  __ j(NO_OVERFLOW, &counted, Assembler::kNearJump);
+  __ addl(count_address, Immediate(Smi::RawValue(-1)));
+  __ Bind(&counted);
   __ movl(EAX, Address(EBX, kWordSize * num_args));  // Target function.
 
   __ Bind(&call_target_function);
@@ -1718,6 +1734,7 @@ void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
 // 2 .. (length - 1): group of checks, each check containing:
 //   - N classes.
 //   - 1 target function.
+//   - 1 count of the calls which found the check (Smi).
 void StubCode::GenerateOneArgCheckInlineCacheStub(Assembler* assembler) {
   return GenerateNArgsCheckInlineCacheStub(assembler, 1);
 }
@@ -1733,6 +1750,92 @@ void StubCode::GenerateThreeArgsCheckInlineCacheStub(Assembler* assembler) {
 }
 
 
+// Looks up the target of a megamorphic instance call in the megamorphic
+// cache of its IC data and jumps to it, or continues in the miss handler.
+// The buckets are probed linearly starting at the receiver's class id.
+//  ECX: Inline cache data object with a megamorphic cache.
+//  EDX: Arguments descriptor array.
+//  TOS(0): return address
+void StubCode::GenerateMegamorphicLookupStub(Assembler* assembler) {
+  GenerateUsageCounterIncrement(assembler);
+
+  // Get receiver.
+  __ movl(EAX, FieldAddress(EDX, Array::data_offset()));
+  __ movl(EAX, Address(ESP, EAX, TIMES_2, 0));  // EAX (argument_count) is Smi.
+
+  Label have_class_id;
+  __ movl(EDI, Immediate(Smi::RawValue(kSmiCid)));
+  __ testl(EAX, Immediate(kSmiTagMask));
+  __ j(ZERO, &have_class_id, Assembler::kNearJump);
+  __ LoadClassId(EDI, EAX);
+  __ SmiTag(EDI);
+  __ Bind(&have_class_id);
+  // EDI: receiver's class id as Smi.
+
+  // Free EDX for the bucket index.  The arguments array is restored when
+  // leaving the probing loop, the receiver is reloaded on a miss.
+  __ pushl(EDX);
+  __ movl(EAX, FieldAddress(ECX, ICData::megamorphic_cache_offset()));
+  __ movl(EBX, FieldAddress(EAX, MegamorphicCache::buckets_offset()));
+  __ movl(EAX, FieldAddress(EAX, MegamorphicCache::mask_offset()));
+  __ movl(EDX, EDI);
+  // EAX: mask of the bucket index as Smi.
+  // EBX: buckets array.
+
+  // The Smi bucket index EDX scaled by 4 is the offset of a bucket of two
+  // elements.
+  ASSERT(MegamorphicCache::kEntryLength == 2);
+  const intptr_t class_id_offset =
+      Array::data_offset() + (MegamorphicCache::kClassIdIndex * kWordSize);
+  const intptr_t target_offset = Array::data_offset() +
+      (MegamorphicCache::kTargetFunctionIndex * kWordSize);
+  Label loop, found, miss;
+  __ Bind(&loop);
+  __ andl(EDX, EAX);
+  __ cmpl(EDI, FieldAddress(EBX, EDX, TIMES_4, class_id_offset));
+  __ j(EQUAL, &found, Assembler::kNearJump);
+  __ cmpl(FieldAddress(EBX, EDX, TIMES_4, class_id_offset),
+          Immediate(Smi::RawValue(kIllegalCid)));
+  __ j(EQUAL, &miss, Assembler::kNearJump);
+  __ addl(EDX, Immediate(Smi::RawValue(1)));
+  __ jmp(&loop, Assembler::kNearJump);
+
+  __ Bind(&miss);
+  __ popl(EDX);  // Restore arguments array.
+  __ movl(EAX, FieldAddress(EDX, Array::data_offset()));
+  __ movl(EAX, Address(ESP, EAX, TIMES_2, 0));  // Receiver.
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+  AssemblerMacros::EnterStubFrame(assembler);
+  __ pushl(EDX);  // Preserve arguments array.
+  __ pushl(ECX);  // Preserve IC data object.
+  __ pushl(raw_null);  // Setup space on stack for result (target function).
+  __ pushl(EAX);  // Receiver.
+  __ CallRuntime(kMegamorphicCacheMissHandlerRuntimeEntry);
+  __ popl(EAX);  // Remove receiver.
+  __ popl(EAX);  // Pop returned function into EAX (null if not found).
+  __ popl(ECX);  // Restore IC data object.
+  __ popl(EDX);  // Restore arguments array.
+  __ LeaveFrame();
+  Label call_target_function;
+  __ cmpl(EAX, raw_null);
+  __ j(NOT_EQUAL, &call_target_function, Assembler::kNearJump);
+  // NoSuchMethod or closure.
+  __ jmp(&StubCode::InstanceFunctionLookupLabel());
+
+  __ Bind(&found);
+  __ movl(EAX, FieldAddress(EBX, EDX, TIMES_4, target_offset));
+  __ popl(EDX);  // Restore arguments array.
+
+  __ Bind(&call_target_function);
+  // EAX: Target function.
+  __ movl(EAX, FieldAddress(EAX, Function::code_offset()));
+  __ movl(EAX, FieldAddress(EAX, Code::instructions_offset()));
+  __ addl(EAX, Immediate(Instructions::HeaderSize() - kHeapObjectTag));
+  __ jmp(EAX);
+}
+
+
 //  ECX: Function object.
 //  EDX: Arguments array.
 //  TOS(0): return address (Dart code).
@@ -509,12 +509,13 @@ static void GenerateDeoptimizationSequence(Assembler* assembler,
   for (intptr_t i = kNumberOfCpuRegisters - 1; i >= 0; i--) {
     __ pushq(static_cast<Register>(i));
   }
-  __ subq(RSP, Immediate(kNumberOfXmmRegisters * kDoubleSize));
+  // Save all 128 bits of the XMM registers, they may hold vectors.
+  __ subq(RSP, Immediate(kNumberOfXmmRegisters * kQuadSize));
   intptr_t offset = 0;
   for (intptr_t reg_idx = 0; reg_idx < kNumberOfXmmRegisters; ++reg_idx) {
     XmmRegister xmm_reg = static_cast<XmmRegister>(reg_idx);
-    __ movsd(Address(RSP, offset), xmm_reg);
-    offset += kDoubleSize;
+    __ movups(Address(RSP, offset), xmm_reg);
+    offset += kQuadSize;
   }
 
   __ movq(RCX, RSP);  // Saved saved registers block.
@@ -558,7 +559,7 @@ static void GenerateDeoptimizationSequence(Assembler* assembler,
   if (preserve_rax) {
     __ pushq(RAX);  // Preserve result, it will be GC-d here.
   }
-  __ CallRuntime(kDeoptimizeMaterializeDoublesRuntimeEntry);
+  __ CallRuntime(kDeoptimizeMaterializeRuntimeEntry);
   if (preserve_rax) {
     __ popq(RAX);  // Restore result.
   }
@@ -1524,21 +1525,11 @@ void StubCode::GenerateCallNoSuchMethodFunctionStub(Assembler* assembler) {
 
 
 
-// Generate inline cache check for 'num_args'.
-//  RBX: Inline cache data object.
-//  R10: Arguments descriptor array.
-//  TOS(0): return address
-// Control flow:
-// - If receiver is null -> jump to IC miss.
-// - If receiver is Smi -> load Smi class.
-// - If receiver is not-Smi -> load receiver's class.
-// - Check if 'num_args' (including receiver) match any IC data group.
-// - Match found -> jump to target.
-// - Match not found -> jump to IC miss.
-void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
-                                                 intptr_t num_args) {
+// Counts the call in the usage counter of the function containing the call
+// site, the one of the IC data object in RBX.  Uses RCX.
+static void GenerateUsageCounterIncrement(Assembler* assembler) {
   __ movq(RCX, FieldAddress(RBX, ICData::function_offset()));
-    Label is_hot;
+  Label is_hot;
   if (FlowGraphCompiler::CanOptimize()) {
     ASSERT(FLAG_optimization_counter_threshold > 1);
     // The usage_counter is always less than FLAG_optimization_counter_threshold
@@ -1550,12 +1541,29 @@ void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
     // The equality should be reached only at exit of the method
     // (return instruction).
     __ j(EQUAL, &is_hot, Assembler::kNearJump);
-    // As long as VM has no OSR do not optimize in the middle of the function
-    // but only at exit so that we have collected all type feedback before
-    // optimizing.
+    // Do not optimize in the middle of the function but only at exit so that
+    // we have collected all type feedback before optimizing. Only the stack
+    // checks of hot loops continue in optimized code (on-stack replacement).
   }
   __ incq(FieldAddress(RCX, Function::usage_counter_offset()));
   __ Bind(&is_hot);
+}
+
+
+// Generate inline cache check for 'num_args'.
+//  RBX: Inline cache data object.
+//  R10: Arguments descriptor array.
+//  TOS(0): return address
+// Control flow:
+// - If receiver is null -> jump to IC miss.
+// - If receiver is Smi -> load Smi class.
+// - If receiver is not-Smi -> load receiver's class.
+// - Check if 'num_args' (including receiver) match any IC data group.
+// - Match found -> jump to target.
+// - Match not found -> jump to IC miss.
+void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
+                                                 intptr_t num_args) {
+  GenerateUsageCounterIncrement(assembler);
 
   ASSERT(num_args > 0);
   // Get receiver (first read number of arguments from argument descriptor array
@@ -1594,7 +1602,8 @@ void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
     __ movq(R13, Address(R12, 0));  // Get class if (Smi) to check.
     __ cmpq(RAX, R13);  // Match?
     __ j(EQUAL, &found, Assembler::kNearJump);
-    __ addq(R12, Immediate(kWordSize * 2));  // Next element (class + target).
+    // Next element (class + target + count).
+    __ addq(R12, Immediate(kWordSize * 3));
     __ cmpq(R13, Immediate(Smi::RawValue(kIllegalCid)));  // Done?
     __ j(NOT_EQUAL, &loop, Assembler::kNearJump);
   } else {
@@ -1614,8 +1623,8 @@ void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
       }
     }
     __ Bind(&no_match);
-    // Each test entry has (1 + num_args) array elements.
-    __ addq(R12, Immediate(kWordSize * (1 + num_args)));  // Next element.
+    // Each test entry has (2 + num_args) array elements.
+    __ addq(R12, Immediate(kWordSize * (2 + num_args)));  // Next element.
     __ cmpq(R13, Immediate(Smi::RawValue(kIllegalCid)));  // Done?
     __ j(NOT_EQUAL, &loop, Assembler::kNearJump);
   }
@@ -1658,7 +1667,14 @@ void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
   __ jmp(&StubCode::InstanceFunctionLookupLabel());
 
   __ Bind(&found);
-  // R12: Pointer to an IC data check group (classes + target)
+  // R12: Pointer to an IC data check group (classes + target + count)
+  // Count the hit.  The count sticks at the maximal Smi.
+  Label counted;
+  const Address count_address(R12, kWordSize * (num_args + 1));
+  __ addq(count_address, Immediate(Smi::RawValue(1)));
+  __ j(NO_OVERFLOW, &counted, Assembler::kNearJump);
+  __ addq(count_address, Immediate(Smi::RawValue(-1)));
+  __ Bind(&counted);
   __ movq(RAX, Address(R12, kWordSize * num_args));  // Target function.
 
   __ Bind(&call_target_function);
@@ -1694,6 +1710,7 @@ void StubCode::GenerateNArgsCheckInlineCacheStub(Assembler* assembler,
 // 2 .. (length - 1): group of checks, each check containing:
 //   - N classes.
 //   - 1 target function.
+//   - 1 count of the calls which found the check (Smi).
 void StubCode::GenerateOneArgCheckInlineCacheStub(Assembler* assembler) {
   return GenerateNArgsCheckInlineCacheStub(assembler, 1);
 }
@@ -1709,6 +1726,85 @@ void StubCode::GenerateThreeArgsCheckInlineCacheStub(Assembler* assembler) {
 }
 
 
+// Looks up the target of a megamorphic instance call in the megamorphic
+// cache of its IC data and jumps to it, or continues in the miss handler.
+// The buckets are probed linearly starting at the receiver's class id.
+//  RBX: Inline cache data object with a megamorphic cache.
+//  R10: Arguments descriptor array.
+//  TOS(0): return address
+void StubCode::GenerateMegamorphicLookupStub(Assembler* assembler) {
+  GenerateUsageCounterIncrement(assembler);
+
+  // Get receiver.
+  __ movq(RAX, FieldAddress(R10, Array::data_offset()));
+  __ movq(RAX, Address(RSP, RAX, TIMES_4, 0));  // RAX (argument count) is Smi.
+
+  Label have_class_id;
+  __ movq(RCX, Immediate(Smi::RawValue(kSmiCid)));
+  __ testq(RAX, Immediate(kSmiTagMask));
+  __ j(ZERO, &have_class_id, Assembler::kNearJump);
+  __ LoadClassId(RCX, RAX);
+  __ SmiTag(RCX);
+  __ Bind(&have_class_id);
+  // RCX: receiver's class id as Smi.
+
+  __ movq(RDI, FieldAddress(RBX, ICData::megamorphic_cache_offset()));
+  __ movq(R13, FieldAddress(RDI, MegamorphicCache::mask_offset()));
+  __ movq(RDI, FieldAddress(RDI, MegamorphicCache::buckets_offset()));
+  // R13: mask of the bucket index as Smi.
+  // RDI: buckets array.
+  __ movq(R12, RCX);
+
+  // The Smi bucket index R12 scaled by 8 is the offset of a bucket of two
+  // elements.
+  ASSERT(MegamorphicCache::kEntryLength == 2);
+  const intptr_t class_id_offset =
+      Array::data_offset() + (MegamorphicCache::kClassIdIndex * kWordSize);
+  const intptr_t target_offset = Array::data_offset() +
+      (MegamorphicCache::kTargetFunctionIndex * kWordSize);
+  Label loop, found, miss;
+  __ Bind(&loop);
+  __ andq(R12, R13);
+  __ movq(RDX, FieldAddress(RDI, R12, TIMES_8, class_id_offset));
+  __ cmpq(RDX, RCX);
+  __ j(EQUAL, &found, Assembler::kNearJump);
+  __ cmpq(RDX, Immediate(Smi::RawValue(kIllegalCid)));
+  __ j(EQUAL, &miss, Assembler::kNearJump);
+  __ addq(R12, Immediate(Smi::RawValue(1)));
+  __ jmp(&loop, Assembler::kNearJump);
+
+  __ Bind(&miss);
+  const Immediate raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+  AssemblerMacros::EnterStubFrame(assembler);
+  __ pushq(R10);  // Preserve arguments array.
+  __ pushq(RBX);  // Preserve IC data object.
+  __ pushq(raw_null);  // Setup space on stack for result (target function).
+  __ pushq(RAX);  // Receiver.
+  __ CallRuntime(kMegamorphicCacheMissHandlerRuntimeEntry);
+  __ popq(RAX);  // Remove receiver.
+  __ popq(RAX);  // Pop returned function into RAX (null if not found).
+  __ popq(RBX);  // Restore IC data object.
+  __ popq(R10);  // Restore arguments array.
+  __ LeaveFrame();
+  Label call_target_function;
+  __ cmpq(RAX, raw_null);
+  __ j(NOT_EQUAL, &call_target_function, Assembler::kNearJump);
+  // NoSuchMethod or closure.
+  __ jmp(&StubCode::InstanceFunctionLookupLabel());
+
+  __ Bind(&found);
+  __ movq(RAX, FieldAddress(RDI, R12, TIMES_8, target_offset));
+
+  __ Bind(&call_target_function);
+  // RAX: Target function.
+  __ movq(RAX, FieldAddress(RAX, Function::code_offset()));
+  __ movq(RAX, FieldAddress(RAX, Code::instructions_offset()));
+  __ addq(RAX, Immediate(Instructions::HeaderSize() - kHeapObjectTag));
+  __ jmp(RAX);
+}
+
+
 //  RBX: Function object.
 //  R10: Arguments array.
 //  TOS(0): return address (Dart code).
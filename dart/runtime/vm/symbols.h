@@ -88,6 +88,7 @@ class ObjectPointerVisitor;
   V(Context, "Context")                                                        \
   V(ContextScope, "ContextScope")                                              \
   V(ICData, "ICData")                                                          \
+  V(MegamorphicCache, "MegamorphicCache")                                      \
   V(SubtypeTestCache, "SubtypeTestCache")                                      \
   V(ApiError, "ApiError")                                                      \
   V(LanguageError, "LanguageError")                                            \
@@ -132,6 +133,8 @@ class ObjectPointerVisitor;
   V(_ExternalUint64Array, "_ExternalUint64Array")                              \
   V(_ExternalFloat32Array, "_ExternalFloat32Array")                            \
   V(_ExternalFloat64Array, "_ExternalFloat64Array")                            \
+  V(Float32x4, "Float32x4")                                                    \
+  V(Int32x4, "Int32x4")                                                        \
   V(_WeakProperty, "_WeakProperty")                                            \
 
 // Contains a list of frequently used strings in a canonicalized form. This
@@ -15,6 +15,9 @@ VirtualMemory* VirtualMemory::ReserveAligned(intptr_t size,
   ASSERT(Utils::IsPowerOfTwo(alignment));
   ASSERT(alignment >= PageSize());
   VirtualMemory* result = VirtualMemory::Reserve(size + alignment);
+  if (result == NULL) {
+    return NULL;
+  }
   uword start = result->start();
   uword real_start = (start + alignment - 1) & ~(alignment - 1);
   result->Truncate(real_start, size);
@@ -37,4 +40,15 @@ void VirtualMemory::Truncate(uword new_start, intptr_t new_size) {
   region_.Subregion(region_, 0, new_size);
 }
 
+
+intptr_t VirtualMemory::ReleaseMemory(uword addr, intptr_t size) {
+  uword start = Utils::RoundUp(addr, PageSize());
+  uword end = Utils::RoundDown(addr + size, PageSize());
+  if (start >= end) {
+    return 0;
+  }
+  DiscardPages(reinterpret_cast<void*>(start), end - start);
+  return end - start;
+}
+
 }  // namespace dart
@@ -21,6 +21,9 @@ class VirtualMemory {
     kReadWriteExecute
   };
 
+  // The size of the huge pages used by the OS, if it supports them.
+  static const intptr_t kHugePageSize = 2 * MB;
+
   // The reserved memory is unmapped on destruction.
   ~VirtualMemory();
 
@@ -43,6 +46,16 @@ class VirtualMemory {
   // Changes the protection of the virtual memory area.
   bool Protect(Protection mode);
 
+  // Asks the OS to back the committed area with huge pages where possible.
+  // This has no effect on operating systems which do not support it.
+  void AdviseHugePages();
+
+  // Returns the physical memory of the pages located entirely within the
+  // committed range [addr, addr + size) to the OS. The pages stay accessible,
+  // their contents are undefined after the release. Returns the number of
+  // bytes released.
+  static intptr_t ReleaseMemory(uword addr, intptr_t size);
+
   // Reserves a virtual memory segment with size. If a segment of the requested
   // size cannot be allocated NULL is returned.
   static VirtualMemory* Reserve(intptr_t size);
@@ -65,6 +78,9 @@ class VirtualMemory {
   // can give back the virtual memory to the system.
   void FreeSubSegment(void* address, intptr_t size);
 
+  // Discard the contents of a range of committed pages.
+  static void DiscardPages(void* address, intptr_t size);
+
   // This constructor is only used internally when reserving new virtual spaces.
   // It does not reserve any virtual address space on its own.
   VirtualMemory(const MemoryRegion& region, void* reserved_pointer) :
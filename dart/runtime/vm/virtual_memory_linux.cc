@@ -73,6 +73,22 @@ bool VirtualMemory::Commit(uword addr, intptr_t size, bool executable) {
 }
 
 
+void VirtualMemory::DiscardPages(void* address, intptr_t size) {
+  // Private anonymous pages read as zero after they have been discarded.
+  if (madvise(address, size, MADV_DONTNEED) != 0) {
+    FATAL("madvise failed\n");
+  }
+}
+
+
+void VirtualMemory::AdviseHugePages() {
+#if defined(MADV_HUGEPAGE)
+  // Failure only means that transparent huge pages are not available.
+  madvise(address(), size(), MADV_HUGEPAGE);
+#endif  // defined(MADV_HUGEPAGE)
+}
+
+
 bool VirtualMemory::Protect(Protection mode) {
   int prot = 0;
   switch (mode) {
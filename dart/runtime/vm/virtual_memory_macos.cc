@@ -73,6 +73,18 @@ bool VirtualMemory::Commit(uword addr, intptr_t size, bool executable) {
 }
 
 
+void VirtualMemory::DiscardPages(void* address, intptr_t size) {
+  if (madvise(address, size, MADV_FREE) != 0) {
+    FATAL("madvise failed\n");
+  }
+}
+
+
+void VirtualMemory::AdviseHugePages() {
+  // Not supported.
+}
+
+
 bool VirtualMemory::Protect(Protection mode) {
   int prot = 0;
   switch (mode) {
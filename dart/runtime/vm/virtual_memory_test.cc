@@ -44,4 +44,33 @@ UNIT_TEST_CASE(AllocateVirtualMemory) {
   delete vm;
 }
 
+
+UNIT_TEST_CASE(ReleaseVirtualMemory) {
+  const intptr_t kPageSize = VirtualMemory::PageSize();
+  const intptr_t kVirtualMemoryBlockSize = 16 * kPageSize;
+  VirtualMemory* vm = VirtualMemory::Reserve(kVirtualMemoryBlockSize);
+  EXPECT(vm != NULL);
+  vm->Commit(false);
+  memset(vm->address(), 0xab, kVirtualMemoryBlockSize);
+  // Only the pages entirely within the range are released.
+  EXPECT_EQ(0, VirtualMemory::ReleaseMemory(vm->start() + 1, kPageSize));
+  EXPECT_EQ(2 * kPageSize,
+            VirtualMemory::ReleaseMemory(vm->start() + 1, 3 * kPageSize));
+  uint8_t* bytes = reinterpret_cast<uint8_t*>(vm->address());
+  EXPECT_EQ(0xab, bytes[kPageSize - 1]);
+  EXPECT_EQ(0xab, bytes[3 * kPageSize]);
+  // The released pages stay accessible.
+  bytes[kPageSize] = 0xcd;
+  EXPECT_EQ(0xcd, bytes[kPageSize]);
+  delete vm;
+
+  vm = VirtualMemory::ReserveAligned(kVirtualMemoryBlockSize,
+                                     VirtualMemory::kHugePageSize);
+  EXPECT(Utils::IsAligned(vm->start(), VirtualMemory::kHugePageSize));
+  vm->Commit(false);
+  vm->AdviseHugePages();
+  memset(vm->address(), 0, kVirtualMemoryBlockSize);
+  delete vm;
+}
+
 }  // namespace dart
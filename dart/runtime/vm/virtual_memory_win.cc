@@ -60,6 +60,18 @@ bool VirtualMemory::Commit(uword addr, intptr_t size, bool executable) {
 }
 
 
+void VirtualMemory::DiscardPages(void* address, intptr_t size) {
+  if (VirtualAlloc(address, size, MEM_RESET, PAGE_READWRITE) == NULL) {
+    FATAL("VirtualAlloc failed\n");
+  }
+}
+
+
+void VirtualMemory::AdviseHugePages() {
+  // Large pages require a privilege and cannot be committed lazily.
+}
+
+
 bool VirtualMemory::Protect(Protection mode) {
   DWORD prot = 0;
   switch (mode) {